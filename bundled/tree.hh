@@ -525,12 +525,14 @@ template <class T, class tree_node_allocator>
 tree<T, tree_node_allocator>::tree(tree<T, tree_node_allocator>&& x) 
 	{
 	head_initialise_();
-	head->next_sibling=x.head->next_sibling;
-	feet->prev_sibling=x.head->prev_sibling;
-	x.head->next_sibling->prev_sibling=head;
-	x.feet->prev_sibling->next_sibling=feet;
-	x.head->next_sibling=x.feet;
-	x.feet->prev_sibling=x.head;
+	if(x.head->next_sibling!=x.feet) { // move tree if non-empty only
+		head->next_sibling=x.head->next_sibling;
+		feet->prev_sibling=x.feet->prev_sibling;
+		x.head->next_sibling->prev_sibling=head;
+		x.feet->prev_sibling->next_sibling=feet;
+		x.head->next_sibling=x.feet;
+		x.feet->prev_sibling=x.head;
+		}
 	}
 
 template <class T, class tree_node_allocator>
@@ -584,12 +586,15 @@ template <class T, class tree_node_allocator>
 tree<T,tree_node_allocator>& tree<T, tree_node_allocator>::operator=(tree<T, tree_node_allocator>&& x)
 	{
 	if(this != &x) {
-		head->next_sibling=x.head->next_sibling;
-		feet->prev_sibling=x.head->prev_sibling;
-		x.head->next_sibling->prev_sibling=head;
-		x.feet->prev_sibling->next_sibling=feet;
-		x.head->next_sibling=x.feet;
-		x.feet->prev_sibling=x.head;
+		clear(); // freshly clear the tree
+		if(x.head->next_sibling!=x.feet) { // move tree if non-empty only
+			head->next_sibling=x.head->next_sibling;
+			feet->prev_sibling=x.feet->prev_sibling;
+			x.head->next_sibling->prev_sibling=head;
+			x.feet->prev_sibling->next_sibling=feet;
+			x.head->next_sibling=x.feet;
+			x.feet->prev_sibling=x.head;
+			}
 		}
 	return *this;
 	}
@@ -0,0 +1,184 @@
+#ifndef NEUROSTR_CORE_ARENA_H_
+#define NEUROSTR_CORE_ARENA_H_
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace neurostr {
+
+/**
+ * @class Arena
+ * @file arena.h
+ * @brief Monotonic memory arena for the data model (nodes, neurite tree nodes
+ * and property maps). Memory is taken from large chunks and never reused:
+ * freeing an element is just a counter decrement, and every chunk is released
+ * at once when the owner is gone and the last element has been freed.
+ *
+ * An arena is used through ArenaScope: while a scope is active, the elements
+ * created by its thread are allocated in the arena. Elements created out of
+ * any scope are allocated in the heap, exactly as with the default operator
+ * new. Only one thread at a time may allocate from an arena, but its elements
+ * can be freed from any thread: the arena that owns a block is found by its
+ * address, so blocks carry no header.
+ */
+class Arena {
+
+  public:
+
+  /**
+   * @brief Default chunk size (bytes)
+   */
+  static constexpr std::size_t default_chunk_size = 64 * 1024;
+
+  /**
+   * @brief Creates an arena
+   * @param chunk_size Chunk size in bytes
+   * @return Owner pointer. Arena memory is released after the last owner and
+   * the last allocated element
+   */
+  static std::shared_ptr<Arena> create(std::size_t chunk_size = default_chunk_size);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  /**
+   * @brief Arena active in the calling thread
+   * @return Arena pointer (nullptr if there is none)
+   */
+  static Arena* current();
+
+  /**
+   * @brief Number of elements allocated in the arena and not freed yet
+   * @return Live element count
+   */
+  std::size_t live() const { return refs_.load() - 1; }
+
+  /**
+   * @brief Memory taken from the heap (bytes)
+   * @return Total chunk size
+   */
+  std::size_t reserved() const { return reserved_; }
+
+  /**
+   * @brief Allocates memory from the current arena or the heap
+   * @param n Size in bytes
+   * @return Memory block aligned to max_align_t
+   */
+  static void* allocate(std::size_t n);
+
+  /**
+   * @brief Frees memory allocated with allocate
+   * @param p Memory block (nullptr is ignored)
+   */
+  static void deallocate(void* p) noexcept;
+
+  private:
+
+  explicit Arena(std::size_t chunk_size);
+  ~Arena();
+
+  /**
+   * @brief Allocates n bytes from the chunks
+   */
+  void* bump_(std::size_t n);
+
+  /**
+   * @brief Drops a reference. Deletes the arena with the last one
+   */
+  void unref_() noexcept;
+
+  std::size_t chunk_size_;
+  std::vector<char*> chunks_;
+  char* pos_;
+  char* end_;
+  std::size_t reserved_;
+
+  // Owner + live elements
+  std::atomic<std::size_t> refs_;
+};
+
+/**
+ * @class ArenaScope
+ * @file arena.h
+ * @brief Activates an arena in the calling thread until destruction. Scopes
+ * can be nested, the previous arena is restored on destruction
+ */
+class ArenaScope {
+
+  public:
+
+  /**
+   * @brief Activates the arena
+   * @param a Arena. nullptr activates the heap
+   */
+  explicit ArenaScope(Arena* a);
+
+  /**
+   * @brief Activates the arena
+   * @param a Arena owner pointer (it has to outlive the scope)
+   */
+  explicit ArenaScope(const std::shared_ptr<Arena>& a) : ArenaScope(a.get()) {}
+
+  /**
+   * @brief Restores the previous arena
+   */
+  ~ArenaScope();
+
+  ArenaScope(const ArenaScope&) = delete;
+  ArenaScope& operator=(const ArenaScope&) = delete;
+
+  private:
+  Arena* previous_;
+};
+
+/**
+ * @brief Standard allocator over Arena::allocate. It is stateless: the arena
+ * is chosen on allocation and found by address on deallocation
+ */
+template <typename T>
+struct arena_allocator {
+
+  using value_type      = T;
+  using pointer         = T*;
+  using const_pointer   = const T*;
+  using reference       = T&;
+  using const_reference = const T&;
+  using size_type       = std::size_t;
+  using difference_type = std::ptrdiff_t;
+
+  template <typename U>
+  struct rebind { using other = arena_allocator<U>; };
+
+  arena_allocator() noexcept {}
+
+  template <typename U>
+  arena_allocator(const arena_allocator<U>&) noexcept {}
+
+  T* allocate(std::size_t n, const void* = nullptr){
+    return static_cast<T*>(Arena::allocate(n * sizeof(T)));
+  }
+
+  void deallocate(T* p, std::size_t) noexcept { Arena::deallocate(p); }
+
+  template <typename U, typename... Args>
+  void construct(U* p, Args&&... args){
+    ::new(static_cast<void*>(p)) U(std::forward<Args>(args)...);
+  }
+
+  template <typename U>
+  void destroy(U* p){ p->~U(); }
+};
+
+template <typename T, typename U>
+bool operator==(const arena_allocator<T>&, const arena_allocator<U>&){ return true; }
+
+template <typename T, typename U>
+bool operator!=(const arena_allocator<T>&, const arena_allocator<U>&){ return false; }
+
+} // namespace neurostr
+
+#endif
@@ -19,6 +19,8 @@
 #include <neurostr/core/node.h>
 #include <neurostr/core/log.h>
 
+// Neurite tree node (tree.hh)
+template<class T> class tree_node_;
 
 /**
 * @brief Neurostr namespace contains all other namespaces in the library as well
@@ -39,6 +41,7 @@ class Branch : public WithProperties{
 
   // In class definitions
   using id_type = std::vector<int>;
+  using number_type = int;
   using storage_type = std::vector< std::unique_ptr<Node> >;
   using size_type = typename storage_type::size_type;
   
@@ -95,8 +98,12 @@ class Branch : public WithProperties{
   Branch(const id_type& id, int order, 
          const Node& root, const Iter& b, const Iter& e)
       : WithProperties()
-      , id_(id)
+      , number_(-1)
+      , position_(id.empty() ? -1 : id.back())
       , neurite_(nullptr)
+      , tree_node_ptr_(nullptr)
+      , id_()
+      , id_version_(0)
       , order_(order)
       , root_(new Node(root))
       , nodes_() {
@@ -107,11 +114,13 @@ class Branch : public WithProperties{
                   >(),
                   "Iterator must defers to node type");
     root_->branch(this);
+    root_->parent(nullptr);
     for(auto it = b; it != e ; ++it){
       Node* tmp = new Node(*it);
       tmp->branch(this);
       nodes_.emplace_back(tmp);
     }
+    update_nodes_parent_(0, nodes_.size());
   };
 
   /**
@@ -148,10 +157,13 @@ class Branch : public WithProperties{
   int order() const { return order_; }
   
   /**
-   * @brief ID accessor
+   * @brief Path ID: position of each branch from the neurite root to this
+   * one (1-based, among its siblings). Only the position is stored - the path
+   * is built from the neurite tree on first use and cached until the tree
+   * changes
    * @return Branch Id
    */
-  const id_type& id() const { return id_; }
+  const id_type& id() const;
   
   /**
    * @brief Returns Branch ID as a string
@@ -159,6 +171,19 @@ class Branch : public WithProperties{
    */
   std::string idString() const;
   
+  /**
+   * @brief Position among its siblings (last element of the path ID)
+   * @return Position (-1 if not set)
+   */
+  int position() const { return position_; }
+  
+  /**
+   * @brief Compact branch number, unique in its neurite. Neurite assigns it
+   * when the branch is inserted and reassign_branch_ids makes it the DFS index
+   * @return Branch number (-1 if not set)
+   */
+  number_type number() const { return number_; }
+  
   /**
    * @brief Branch neurite reference validity check
    * @return True if Neurite reference is valid
@@ -178,12 +203,27 @@ class Branch : public WithProperties{
   Neurite& neurite();
 
   /**
-   * @brief Set branch id
+   * @brief Set branch id. Only the last element (the position) is kept, the
+   * path prefix is given by the neurite tree
    * @param id new id
    * @return Update branch reference
    */
   Branch& id(const id_type& id);
   
+  /**
+   * @brief Set branch position among its siblings
+   * @param p new position
+   * @return Update branch reference
+   */
+  Branch& position(int p);
+  
+  /**
+   * @brief Set branch number
+   * @param n new number
+   * @return Update branch reference
+   */
+  Branch& number(number_type n);
+  
   
   /**
    * @brief Set branch centrifugal order
@@ -199,12 +239,38 @@ class Branch : public WithProperties{
    */
   Branch& neurite(Neurite* n);
   
+  /**
+   * @brief Neurite tree node that stores the branch
+   * @return Tree node pointer (nullptr if the branch is not in a neurite tree)
+   */
+  tree_node_<Branch>* tree_node() const { return tree_node_ptr_; }
+  
+  /**
+   * @brief Set the neurite tree node that stores the branch
+   * @param n Tree node pointer
+   * @return Update branch reference
+   */
+  Branch& tree_node(tree_node_<Branch>* n);
+  
+  /**
+   * @brief Parent branch in the neurite tree
+   * @return Parent branch pointer (nullptr if there is none)
+   */
+  const Branch* parent_branch() const;
+  
+  /**
+   * @brief Invalidates the cached parent of the root and first nodes. They
+   * depend on the neurite tree and are resolved again on demand
+   */
+  void invalidate_first_parent() const;
+  
   /**
    * @brief Copy a node as new root
    * @param n node to copy
    */
   void root(const Node& n) { 
     root_.reset(new Node(n)); 
+    invalidate_first_parent();
     if(size() > 0){
       begin()->invalidate_basis();
       begin()->invalidate_length();
@@ -214,7 +280,10 @@ class Branch : public WithProperties{
   /**
    * @brief Removes the current root
    */
-  void remove_root() { root_.reset(nullptr); }
+  void remove_root() { 
+    root_.reset(nullptr);
+    invalidate_first_parent();
+  }
   
   /**
    * @brief Move a node as new root
@@ -222,6 +291,7 @@ class Branch : public WithProperties{
    */
   void root(Node&& n) { 
     root_.reset(new Node(n)); 
+    invalidate_first_parent();
     if(size() > 0){
       begin()->invalidate_basis();
       begin()->invalidate_length();
@@ -234,9 +304,8 @@ class Branch : public WithProperties{
    * @return True if two ids are equal
    */
   bool operator==(const Branch& b) const {
-    return (id_.size() == b.id_.size()) && (nodes_.size() == b.nodes_.size()) &&
-           std::equal(id_.cbegin(), id_.cend(), b.id_.cbegin()) && (root_ == b.root_) && 
-           std::equal(begin(), end(), b.begin());
+    return (nodes_.size() == b.nodes_.size()) && (root_ == b.root_) && 
+           same_id_(b) && std::equal(begin(), end(), b.begin());
   }
   
   /**
@@ -443,11 +512,16 @@ class Branch : public WithProperties{
     }
     // Change node branch
     Node * tmp;
+    auto first = std::distance(begin(), pos);
     for(auto it = b ; it != e ; ++it){
       tmp = new Node(*it);
       tmp->branch(this);
       pos = nodes_.emplace(pos.base(),tmp);
+      ++pos; // Keep range order
     }
+    // Inserted nodes and the next one
+    update_nodes_parent_(first, std::distance(begin(), pos) + 1);
+    invalidate_children_parent_();
   };
   
   /**
@@ -468,7 +542,10 @@ class Branch : public WithProperties{
   /**
    * @brief Deletes all nodes in the brnach
    */
-  void clear() { nodes_.clear(); }
+  void clear() { 
+    nodes_.clear(); 
+    invalidate_children_parent_();
+  }
 
   /**
    * @brief Divides the branch at given position and creates a new branch
@@ -537,6 +614,16 @@ class Branch : public WithProperties{
    */
   float discrete_frechet( const Branch& other) const;
   
+  /**
+   * @brief Computes the frechet distance between two branches, stopping as
+   * soon as it is known to be greater than bound
+   * @param other Branch
+   * @param bound Distance bound
+   * @return Discrete frechet distance if it is not greater than bound.
+   * Otherwise, a value greater than bound
+   */
+  float discrete_frechet( const Branch& other, float bound) const;
+  
   /**
    * @brief Computes the distance between both branches.
    * Ignores nodes shared by both branches
@@ -557,6 +644,33 @@ class Branch : public WithProperties{
   
   private:
   
+  /**
+   * @brief Compares the path ids position by position, without building them
+   * @param b Other branch
+   * @return True if the ids are equal
+   */
+  bool same_id_(const Branch& b) const;
+  
+  /**
+   * @brief Parent branch through the tree node (nullptr if there is none)
+   */
+  const Branch* tree_parent_() const;
+  
+  /**
+   * @brief Sets the parent of the nodes in [from,to). Non-first nodes parent
+   * is the previous node. First node parent depends on the neurite tree, so
+   * it is just invalidated. Setting a parent resets the node length and basis
+   * @param from First node index to update
+   * @param to Index past the last node to update (clamped to the branch size)
+   */
+  void update_nodes_parent_(size_type from, size_type to);
+  
+  /**
+   * @brief Invalidates the first node parent in the child branches (i.e.
+   * when our last node changes)
+   */
+  void invalidate_children_parent_() const;
+  
   /**
    * @brief Throw an exception if root is null
    */
@@ -585,11 +699,21 @@ class Branch : public WithProperties{
 
   // DATA MEMBERS
 
-  // Branch identifier
-  std::vector<int> id_;
+  // Branch number in the neurite
+  number_type number_;
+  
+  // Position among siblings (last path id element)
+  int position_;
   
   // Parent branch
   Neurite* neurite_;
+  
+  // Tree node that holds the branch
+  tree_node_<Branch>* tree_node_ptr_;
+  
+  // Cached path id and the neurite tree version it was built for (0: none)
+  mutable id_type id_;
+  mutable std::size_t id_version_;
 
   // Centrifugal order
   int order_;
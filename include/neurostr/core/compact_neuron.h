@@ -0,0 +1,292 @@
+#ifndef NEUROSTR_CORE_COMPACT_NEURON_H_
+#define NEUROSTR_CORE_COMPACT_NEURON_H_
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/neurite_type.h>
+
+namespace neurostr {
+
+// Fw declaration
+class Neuron;
+
+/**
+ * @class CompactNeuron
+ * @brief Frozen, read-only copy of a neuron stored as a structure of arrays.
+ *
+ * Every point (soma nodes, neurite roots and neurite nodes) is stored in
+ * contiguous position/radius/parent/id arrays. Soma nodes come first, then
+ * each neurite stores its root (if any) followed by its branches in pre-order,
+ * each branch being a contiguous node range. Parent indexes always point to
+ * lower positions, so a forward pass visits parents before their children.
+ *
+ * Node parents follow the same rules as selector::node_parent: the first node
+ * of a branch is parented to the last node of its parent branch, and the first
+ * node in the neurite to the neurite root. Properties, markers and contours are
+ * not kept.
+ */
+class CompactNeuron {
+
+  public:
+
+  using size_type = std::size_t;
+  using index_type = std::int32_t;
+
+  /** Index value for "no element" */
+  static constexpr index_type npos = -1;
+
+  /**
+   * @brief Builds the compact representation of a neuron
+   * @param n Neuron to copy
+   */
+  explicit CompactNeuron(const Neuron& n);
+
+  CompactNeuron(const CompactNeuron&) = default;
+  CompactNeuron& operator=(const CompactNeuron&) = default;
+  CompactNeuron(CompactNeuron&&) = default;
+  CompactNeuron& operator=(CompactNeuron&&) = default;
+
+  /**
+   * @brief Neuron id
+   * @return Id string
+   */
+  const std::string& id() const { return id_; }
+
+  /**
+   * Points
+   */
+
+  /**
+   * @brief Number of stored points (soma, neurite roots and nodes)
+   * @return Point count
+   */
+  size_type size() const { return x_.size(); }
+
+  /**
+   * @brief Number of neurite nodes (roots and soma excluded)
+   * @return Node count
+   */
+  size_type node_count() const { return node_count_; }
+
+  float x(index_type i) const { return x_[i]; }
+  float y(index_type i) const { return y_[i]; }
+  float z(index_type i) const { return z_[i]; }
+  float radius(index_type i) const { return r_[i]; }
+  int node_id(index_type i) const { return id_v_[i]; }
+
+  /**
+   * @brief Parent point index
+   * @param i Point index
+   * @return Parent index or npos
+   */
+  index_type parent(index_type i) const { return parent_[i]; }
+
+  /**
+   * @brief Parent point index as in selector::node_parent (the point itself
+   * if it has no parent)
+   * @param i Point index
+   * @return Parent index
+   */
+  index_type node_parent(index_type i) const {
+    return parent_[i] == npos ? i : parent_[i];
+  }
+
+  /**
+   * @brief Point position
+   * @param i Point index
+   * @return Position
+   */
+  point_type position(index_type i) const {
+    return point_type(x_[i], y_[i], z_[i]);
+  }
+
+  /**
+   * @brief Euclidean distance between two points
+   * @param i First point index
+   * @param j Second point index
+   * @return Distance
+   */
+  float distance(index_type i, index_type j) const {
+    float dx = x_[i] - x_[j];
+    float dy = y_[i] - y_[j];
+    float dz = z_[i] - z_[j];
+    return std::sqrt(dx*dx + dy*dy + dz*dz);
+  }
+
+  /**
+   * Soma
+   */
+
+  /**
+   * @brief Number of soma nodes. Soma nodes are stored at [0, soma_size())
+   * @return Soma size
+   */
+  size_type soma_size() const { return soma_size_; }
+
+  /**
+   * Branches
+   */
+
+  /**
+   * @brief Total number of branches
+   * @return Branch count
+   */
+  size_type branch_count() const { return branch_begin_.size(); }
+
+  /**
+   * @brief First node of the branch
+   * @param b Branch index
+   * @return Point index
+   */
+  index_type branch_begin(index_type b) const { return branch_begin_[b]; }
+
+  /**
+   * @brief Past-the-end node of the branch
+   * @param b Branch index
+   * @return Point index
+   */
+  index_type branch_end(index_type b) const { return branch_end_[b]; }
+
+  /**
+   * @brief Number of nodes in the branch (root excluded)
+   * @param b Branch index
+   * @return Branch size
+   */
+  size_type branch_size(index_type b) const {
+    return branch_end_[b] - branch_begin_[b];
+  }
+
+  /**
+   * @brief Branch root point (parent of its first node)
+   * @param b Branch index
+   * @return Point index or npos if the branch has no root
+   */
+  index_type branch_root(index_type b) const {
+    return branch_size(b) == 0 ? npos : parent_[branch_begin_[b]];
+  }
+
+  /**
+   * @brief Parent branch
+   * @param b Branch index
+   * @return Branch index or npos
+   */
+  index_type branch_parent(index_type b) const { return branch_parent_[b]; }
+
+  /**
+   * @brief Branch centrifugal order
+   * @param b Branch index
+   * @return Order
+   */
+  int branch_order(index_type b) const { return branch_order_[b]; }
+
+  /**
+   * @brief Number of child branches
+   * @param b Branch index
+   * @return Child count
+   */
+  int branch_children(index_type b) const { return branch_children_[b]; }
+
+  /**
+   * @brief First child branch (only valid if the branch has children)
+   * @param b Branch index
+   * @return Branch index
+   */
+  index_type branch_first_child(index_type b) const { return b+1; }
+
+  /**
+   * @brief Next sibling of a branch (only valid if it has one)
+   * @param b Branch index
+   * @return Branch index
+   */
+  index_type branch_next_sibling(index_type b) const { return branch_subtree_end_[b]; }
+
+  /**
+   * @brief Past-the-end branch of the subtree rooted at b. Subtree
+   * branches are stored at [b, branch_subtree_end(b))
+   * @param b Branch index
+   * @return Branch index
+   */
+  index_type branch_subtree_end(index_type b) const { return branch_subtree_end_[b]; }
+
+  /**
+   * @brief Neurite that contains the branch
+   * @param b Branch index
+   * @return Neurite index
+   */
+  index_type branch_neurite(index_type b) const { return branch_neurite_[b]; }
+
+  /**
+   * Neurites
+   */
+
+  /**
+   * @brief Number of neurites
+   * @return Neurite count
+   */
+  size_type neurite_count() const { return neurite_id_.size(); }
+
+  int neurite_id(index_type k) const { return neurite_id_[k]; }
+  NeuriteType neurite_type(index_type k) const { return neurite_type_[k]; }
+
+  /**
+   * @brief Neurite root point
+   * @param k Neurite index
+   * @return Point index or npos
+   */
+  index_type neurite_root(index_type k) const { return neurite_root_[k]; }
+
+  /**
+   * @brief First branch in the neurite
+   * @param k Neurite index
+   * @return Branch index
+   */
+  index_type neurite_branch_begin(index_type k) const { return neurite_branch_begin_[k]; }
+
+  /**
+   * @brief Past-the-end branch in the neurite
+   * @param k Neurite index
+   * @return Branch index
+   */
+  index_type neurite_branch_end(index_type k) const { return neurite_branch_begin_[k+1]; }
+
+  private:
+
+  // Appends a point and returns its index
+  index_type push_point_(const point_type& p, float r, int id, index_type parent);
+
+  std::string id_;
+  size_type soma_size_;
+  size_type node_count_;
+
+  // Points
+  std::vector<float> x_;
+  std::vector<float> y_;
+  std::vector<float> z_;
+  std::vector<float> r_;
+  std::vector<index_type> parent_;
+  std::vector<int> id_v_;
+
+  // Branches
+  std::vector<index_type> branch_begin_;
+  std::vector<index_type> branch_end_;
+  std::vector<index_type> branch_parent_;
+  std::vector<index_type> branch_subtree_end_;
+  std::vector<index_type> branch_neurite_;
+  std::vector<int> branch_order_;
+  std::vector<int> branch_children_;
+
+  // Neurites
+  std::vector<int> neurite_id_;
+  std::vector<NeuriteType> neurite_type_;
+  std::vector<index_type> neurite_root_;
+  std::vector<index_type> neurite_branch_begin_;
+};
+
+} // neurostr
+
+#endif
@@ -2,8 +2,15 @@
 #define NEUROSTR_CORE_GEOMETRY_H_
 
 #include <math.h>
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 #include <boost/geometry.hpp>
 #include <boost/geometry/geometries/point.hpp>
 #include <Eigen/Core>
@@ -553,6 +560,16 @@ namespace geometry
    */
   float triangle_area( const triangle_type& t);
                             
+  /**
+   * @brief Applies RDP simplification to a line-segment. Sub-segments are
+   * processed with an explicit stack instead of recursion
+   * @param line Line-segment points
+   * @param eps Tolerance
+   * @param keep Output: true for the points that are kept (endpoints are
+   * always kept)
+   */
+  void rdp_simplify(const std::vector<point_type>& line, float eps, std::vector<bool>& keep);
+
   /**
    * @class RDPSimplifier
    * @author luis
@@ -576,47 +593,27 @@ namespace geometry
       RDPSimplifier(float eps, std::vector<Node>& v) : eps(eps), v(v) {};
       
       /**
-       * @brief Applies the simplification to the line-segment
+       * @brief Applies the simplification to the line-segment. Removed nodes
+       * are erased at once, keeping the order of the remaining ones
        */
       void simplify(){
-        simplify_recursive(v.begin(), v.end() );
-      }
-      
-    private:
-      /**
-       * @brief Auxiliar function to recursively simplify the line-segment
-       * @param end
-       */
-      void simplify_recursive(const typename std::vector<Node>::iterator ini, 
-                              const typename std::vector<Node>::iterator end){
-        
-        // Stop condition
-        if(std::distance(ini,end) < 2 ) return ;
-        
-        segment_type segm(ini->position(),end->position());
-        float maxd = 0.;
-        float tmp;
+        std::vector<point_type> line;
+        line.reserve(v.size());
+        for(auto it = v.begin(); it != v.end(); ++it){
+          line.push_back(it->position());
+        }
         
-        typename std::vector<Node>::iterator m;
+        std::vector<bool> keep;
+        rdp_simplify(line, eps, keep);
         
-        //Check distance bw every node and the line ini->end
-        for(auto it = (ini+1); it != end ; ++it){
-          tmp = bg::distance(segm, it->position() );
-          if( tmp > maxd ) {
-            maxd = tmp;
-            m = it;
+        std::size_t n = 0;
+        for(std::size_t i = 0; i < v.size(); ++i){
+          if(keep[i]){
+            if(n != i) v[n] = std::move(v[i]);
+            ++n;
           }
         }
-        
-        // Check if we shoud keep m and simplify recursively
-        if (maxd > eps) {
-          simplify_recursive(ini,m);
-          simplify_recursive(m,end);
-        }
-        else{
-          // DELETE intermediate nodes
-          v.erase(ini+1,end);
-        }
+        v.erase(v.begin() + n, v.end());
       }
   }; // RDP simplifier
   
@@ -625,7 +622,10 @@ namespace geometry
    * @author luis
    * @date 28/09/16
    * @file geometry.h
-   * @brief Class to compute the discrete frechet distance in a line-segment
+   * @brief Class to compute the discrete frechet distance in a line-segment.
+   * The coupling matrix is computed row by row, keeping only two rows over
+   * the shortest line-segment. The object can be reused with other
+   * line-segments (see reset) to avoid reallocating its buffer
    */
   template< typename IterA, typename IterB >
   class DiscreteFrechet {
@@ -642,10 +642,24 @@ namespace geometry
       int p;
       int q;
       
-      // Axuiliar DP matrix
-      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> buffer;
+      // Axuiliar DP rows (previous and current)
+      std::vector<double> buffer;
       
     public:
+      
+      /**
+       * @brief Empty constructor. Ranges have to be set with reset
+       * @return DiscreteFrechet class
+       */
+      DiscreteFrechet()
+        : ini_a()
+        , end_a()
+        , ini_b()
+        , end_b()
+        , p(0)
+        , q(0)
+        , buffer() {}
+      
       /**
        * @brief Base constructor. Initializes the class with the tow line-segment
        * @param ini_a First branch line-segment begin iterator
@@ -661,50 +675,99 @@ namespace geometry
         , end_b(end_b)
         , p(std::distance(ini_a,end_a))
         , q(std::distance(ini_b,end_b))
-        , buffer( p, q) {
-          buffer.fill(-1.0); // Fill buffer 
+        , buffer() {}
+      
+      /**
+       * @brief Changes the line-segments. The buffer is kept
+       * @param a_b First branch line-segment begin iterator
+       * @param a_e First branch line-segment end iterator
+       * @param b_b Second branch line-segment begin iterator
+       * @param b_e Secondbranch line-segment end iterator
+       */
+      void reset(IterA a_b, IterA a_e, IterB b_b, IterB b_e){
+        ini_a = a_b;
+        end_a = a_e;
+        ini_b = b_b;
+        end_b = b_e;
+        p = std::distance(ini_a,end_a);
+        q = std::distance(ini_b,end_b);
       }
     
       /**
-       * @brief Computes de discrete frechet distance recursively
-       * @return Discrete frechet distance
+       * @brief Computes de discrete frechet distance
+       * @return Discrete frechet distance (NaN if any line-segment is empty)
        */
-      double value(){        
-        return recursive_value(p-1,q-1);
+      double value(){
+        return value(std::numeric_limits<double>::infinity());
+      };
+      
+      /**
+       * @brief Computes de discrete frechet distance, but stops as soon as it
+       * is known to be greater than bound
+       * @param bound Distance bound
+       * @return Discrete frechet distance if it is not greater than bound.
+       * Otherwise a lower bound of the distance greater than bound. NaN if any
+       * line-segment is empty
+       */
+      double value(double bound){
+        if(p == 0 || q == 0) return std::numeric_limits<double>::quiet_NaN();
+        
+        // The coupling matrix is symmetric: rows over the longest line-segment
+        if(p >= q) return rolling_value(ini_a, p, ini_b, q, bound);
+        else return rolling_value(ini_b, q, ini_a, p, bound);
       };
     
     private:
       
       /**
-       * @brief Internal function. Computes the value i,j of the DP matrix
-       * @param i Row
-       * @param j Column
-       * @return  i-j value in DP matrix
-       */
-      double recursive_value(int i, int j){
-        // Computed already
-        if (buffer(i,j) < 0) {  
-          if ( i == 0 ) {
-            // I = 0 CASE
-            if ( j == 0) {
-              // Base case (first step)
-              buffer(0,0) =  boost::geometry::distance(*ini_a,*ini_b);
-            } else {
-              buffer(0,j) = std::max(recursive_value(0,j-1), boost::geometry::distance(*ini_a,*(ini_b+j)) );
-            }
-          } else {
-            // I != 0
-            if ( j == 0) {
-              buffer(i,0) = std::max(recursive_value(i-1,0),boost::geometry::distance(*(ini_a+i),*ini_b) );
-            } else {
-              // Both are not 0
-              buffer(i,j) = std::max(
-                std::min({ recursive_value(i-1,j),recursive_value(i,j-1), recursive_value(i-1,j-1)}),
-                boost::geometry::distance(*(ini_a+i),*(ini_b+j)) );
-            }
+       * @brief Internal function. Computes the DP matrix row by row
+       * @param rows Row line-segment begin
+       * @param nr Row count
+       * @param cols Column line-segment begin
+       * @param nc Column count
+       * @param bound Distance bound
+       * @return Last value in the DP matrix, or a row minimum greater than bound
+       */
+      template <typename IterR, typename IterC>
+      double rolling_value(IterR rows, int nr, IterC cols, int nc, double bound){
+        
+        // Both line-segment ends are always coupled
+        double ends = std::max(boost::geometry::distance(*rows,*cols),
+                               boost::geometry::distance(*std::next(rows,nr-1),*std::next(cols,nc-1)));
+        if(ends > bound) return ends;
+        
+        buffer.resize(2*nc);
+        double* prev = buffer.data();
+        double* cur = prev + nc;
+        
+        // First row
+        IterC c_it = cols;
+        cur[0] = boost::geometry::distance(*rows,*c_it);
+        for(int j = 1; j < nc; ++j){
+          ++c_it;
+          cur[j] = std::max(cur[j-1], boost::geometry::distance(*rows,*c_it));
+        }
+        
+        IterR r_it = rows;
+        for(int i = 1; i < nr; ++i){
+          ++r_it;
+          std::swap(prev,cur);
+          
+          c_it = cols;
+          cur[0] = std::max(prev[0], boost::geometry::distance(*r_it,*c_it));
+          double row_min = cur[0];
+          for(int j = 1; j < nc; ++j){
+            ++c_it;
+            cur[j] = std::max(
+              std::min({ prev[j], cur[j-1], prev[j-1] }),
+              boost::geometry::distance(*r_it,*c_it) );
+            row_min = std::min(row_min, cur[j]);
           }
+          
+          // Every coupling goes through this row
+          if(row_min > bound) return row_min;
         }
-        return buffer(i,j);
+        return cur[nc-1];
       };
   }; // Discrete frechet class template
 
@@ -738,8 +801,35 @@ namespace geometry
     
     private:
       
+      /**
+       * @brief Bounding volume hierarchy node. Nodes are stored in depth-first
+       * order: the left child follows its parent. Leaves have a non-zero count
+       * of faces starting at first (in bvh_faces_)
+       */
+      struct bvh_node {
+        std::array<float,3> lo;
+        std::array<float,3> hi;
+        index_type first;  // First face (leaves) or right child (inner nodes)
+        index_type count;  // Face count. 0 in inner nodes
+      };
+      
+      using cell_type = std::array<std::int64_t,3>;
+      
+      struct cell_hash {
+        std::size_t operator()(const cell_type& c) const {
+          return std::hash<std::int64_t>()(c[0] * 73856093 ^ c[1] * 19349663 ^ c[2] * 83492791);
+        }
+      };
+      
       vertex_storage vertices_;
       index_face_storage faces_;
+      
+      // Vertex positions by grid cell (duplicate vertex search)
+      std::unordered_multimap<cell_type, index_type, cell_hash> vertex_grid_;
+      
+      // Face hierarchy (empty if not built)
+      std::vector<bvh_node> bvh_;
+      std::vector<index_type> bvh_faces_;
     
     public:
       
@@ -921,6 +1011,18 @@ namespace geometry
       std::size_t face_count() const;
       
       
+      /**
+       * @brief Builds a bounding volume hierarchy over the mesh faces, used by
+       * point_inside and ray_intersection. Adding or removing faces drops it
+       */
+      void build_index();
+      
+      /**
+       * @brief Checks if the face hierarchy is built
+       * @return True if ray queries use the face hierarchy
+       */
+      bool indexed() const;
+      
       /**
        * @brief Using ray-tracing method computes if the point p is Inside the
        * triangular mesh assuming that it is closed
@@ -930,10 +1032,10 @@ namespace geometry
       bool point_inside(const point_type& p, const point_type& ray_direction = point_type(1,0,0)) const;
       
       /**
-       * @brief 
-       * @param p
-       * @param ray_direction
-       * @return 
+       * @brief Computes the closest intersection of a ray with the mesh
+       * @param p Ray origin
+       * @param ray_direction Ray direction
+       * @return Intersection point (undefined if there is none)
        */
       point_type ray_intersection(const point_type& p, const point_type& ray_direction = point_type(1,0,0)) const;
       
@@ -957,6 +1059,25 @@ namespace geometry
       static bool vertex_of_face(const vertex_type& v, const face_type& f);
       static bool vertex_of_face(const index_type& v, const index_face_type& f);
       
+      /**
+       * @brief Builds the hierarchy node for the faces in bvh_faces_[b,e)
+       * @param b First face position
+       * @param e One-past last face position
+       * @param centroids Face centroids
+       */
+      void build_index_(std::size_t b, std::size_t e,
+                        const std::vector<std::array<float,3>>& centroids);
+      
+      /**
+       * @brief Calls f(face) for every face that the ray may hit. f returns
+       * the ray parameter beyond which faces are not needed anymore
+       * @param p Ray origin
+       * @param v Ray direction
+       * @param f Face visitor
+       */
+      template <typename F>
+      void visit_ray_faces_(const point_type& p, const point_type& v, F f) const;
+      
       
 
       
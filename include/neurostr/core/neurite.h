@@ -15,6 +15,7 @@
 
 #include <neurostr/core/definitions.h>
 #include <neurostr/core/property.h>
+#include <neurostr/core/arena.h>
 #include <tree.hh>
 #include <neurostr/core/branch.h>
 #include <neurostr/core/neurite_type.h>
@@ -41,7 +42,7 @@ class Neurite : public WithProperties  {
     class const_node_iterator;
 
   // Traits
-  using tree_type     = tree<Branch>;
+  using tree_type     = tree<Branch, arena_allocator<tree_node_<Branch>>>;
   using tree_node     = tree_node_<Branch>;
   using id_type       = int;
 
@@ -86,9 +87,9 @@ class Neurite : public WithProperties  {
   Neurite(const Neurite& n) = default;
   
   /**
-  * @brief Default move constructor
+  * @brief Move constructor. Branches are re-linked to the new neurite
   **/
-  Neurite(Neurite&& n) = default;
+  Neurite(Neurite&& n);
   
   /**
   * @brief Default copy assign
@@ -96,9 +97,9 @@ class Neurite : public WithProperties  {
   Neurite& operator=(const Neurite& n) = default;
   
   /**
-  * @brief Default move assign
+  * @brief Move assign. Branches are re-linked to this neurite
   **/
-  Neurite& operator=(Neurite&& n) = default;
+  Neurite& operator=(Neurite&& n);
 
   /**
    * @brief Empty destructor (Default)
@@ -122,6 +123,33 @@ class Neurite : public WithProperties  {
   
   // Markers
   marker_container markers_;
+  
+  // Number for the next inserted branch
+  Branch::number_type next_branch_number_;
+  
+  // Bumped on every change of the tree shape or branch positions. Branches
+  // compare it with the version of their cached path id
+  std::size_t tree_version_;
+  
+  friend class Branch;
+  
+  /**
+   * @brief Sets the neurite and tree node of every branch (after a move)
+   */
+  void relink_branches_();
+  
+  /**
+   * @brief Links a branch just inserted in the tree: neurite, tree node and
+   * a new branch number
+   * @param it Branch position
+   */
+  template <typename iter>
+  void link_branch_(const iter& it){
+    it->neurite(this);
+    it->tree_node(it.node);
+    it->number(next_branch_number_++);
+    ++tree_version_;
+  }
 
   public:
  
@@ -712,7 +740,9 @@ class Neurite : public WithProperties  {
   /*** Find methods ****/
   
   /**
-   * @brief Looks for a branch in the tree that matches \code{b}
+   * @brief Looks for a branch in the tree that matches \code{b}. Branches
+   * stored in this neurite are found in constant time through their tree node,
+   * other branches are compared by id
    * @param b Branch to find
    * @return Iterator to the branch in the tree. returns end_branch() otherwise
    */
@@ -779,13 +809,12 @@ class Neurite : public WithProperties  {
       if (pos.branch().number_of_children() == 0) {
         return insert_node(pos.branch(),node);
       } else {
-        // Create new branch id
-        std::vector<int> id{pos.branch()->id()};
-        id.push_back(pos.branch().number_of_children() + 1);
+        // New branch id: last child
+        Branch::id_type id{static_cast<int>(pos.branch().number_of_children()) + 1};
 
         // Create branch - pos node will be the root        
         auto aux = tree_.append_child(pos.branch(), Branch(id, pos.branch()->order() + 1, *pos) );
-        aux->neurite(this); // Set branch neurite
+        link_branch_(aux);
         
         // Insert in aux
         return insert_node(aux,node);
@@ -832,13 +861,13 @@ class Neurite : public WithProperties  {
   template <typename iter> 
   iter append_branch(iter pos, Branch&& b) { 
     
-    b.neurite(this);
-    
     // Set root
     if(pos->size()>0)
       b.root(pos->last());
       
-    return tree_.append_child(pos, std::move(b)); 
+    iter ret = tree_.append_child(pos, std::move(b)); 
+    link_branch_(ret);
+    return ret;
   }
   
   /**
@@ -851,28 +880,23 @@ class Neurite : public WithProperties  {
       if (pos.branch().node == tree_.feet || pos.branch().node == tree_.head) 
           return ;
 
-      // Create new branch id
-      int id_len = pos.branch()->id().size();
-      std::vector<int> id{pos.branch()->id()};
-      id.push_back(1);  // This new branch is the first
-
       // Split branch - this modifies the it.current branch
 
       // Preppend child
       branch_iterator new_pos = tree_.prepend_child(pos.branch(), pos.branch()->split(pos.node()) );
-      new_pos->neurite(this);
-      new_pos->id(id);
+      link_branch_(new_pos);
+      new_pos->position(1); // This new branch is the first
       new_pos->order(pos.branch()->order()+1);
       new_pos->set_nodes_branch();
 
       // Reparent
       tree_.reparent(new_pos, ++pos.branch().begin(), pos.branch().end());  // Reparent the rest of nodes
+      ++tree_version_;
+      pos.branch()->invalidate_first_parent();
+      for (auto ch = new_pos.begin(); ch != new_pos.end(); ++ch) ch->invalidate_first_parent();
 
-      // Update id and order
+      // Update order (ids follow the tree)
       for (branch_iterator desc_it = new_pos.begin(); desc_it != new_pos.end(); ++desc_it) {
-        id = desc_it->id();  // Get id
-        id.insert(id.begin() + id_len, 1);
-        desc_it->id(id);                       // Set id
         desc_it->order(desc_it->order() + 1);  // Update order
       }
       return ;
@@ -884,7 +908,9 @@ class Neurite : public WithProperties  {
   void correct(const point_type up = point_type(0,0,1));
   
   /**
-   * @brief Updates branch ids to match its order in the neurite
+   * @brief Updates branch ids to match its order in the neurite. Branch
+   * numbers become the DFS index of the branch. Linear in the number of
+   * branches
    */
   void reassign_branch_ids();
   
@@ -9,6 +9,7 @@
 #include <boost/iterator/indirect_iterator.hpp>
 
 #include <neurostr/core/property.h>
+#include <neurostr/core/arena.h>
 #include <neurostr/core/contour.h>
 #include <neurostr/core/neurite_type.h>
 #include <neurostr/core/neurite.h>
@@ -552,8 +553,10 @@ class Neuron : public WithProperties {
   /**
    * @brief Applies RDP simplification to all branches in the neruon
    * @param eps Tolerance
+   * @param nthreads Worker threads, branches are simplified concurrently
+   * (0: one per core, 1: sequential)
    */
-  void simplify(float eps = -1.5);
+  void simplify(float eps = -1.5, std::size_t nthreads = 0);
 
   // Output!
   friend std::ostream& operator<<(std::ostream&, const Neuron&);
@@ -642,9 +645,25 @@ class Reconstruction : public WithProperties{
   std::vector<std::unique_ptr<Neuron>> neurons_;
   
   std::vector<contour_type> contours_;
+  
+  // Memory of the neurons (optional)
+  std::shared_ptr<Arena> arena_;
 
   public:
   
+  /**
+   * @brief Arena where the reconstruction neurons were allocated
+   * @return Arena owner pointer (empty if they are in the heap)
+   */
+  const std::shared_ptr<Arena>& arena() const { return arena_; }
+  
+  /**
+   * @brief Keeps an arena alive with the reconstruction, i.e. to add more
+   * elements to it later in an ArenaScope
+   * @param a Arena owner pointer
+   */
+  void arena(const std::shared_ptr<Arena>& a) { arena_ = a; }
+  
   /**
    * @brief Adds a neuron to the reconstruction
    * @param n Neuron pointer
@@ -653,6 +672,16 @@ class Reconstruction : public WithProperties{
     if(n!=nullptr)
       neurons_.emplace_back(n); 
   };
+  
+  /**
+   * @brief Removes all neurons from the reconstruction
+   * @return Removed neurons (Ownership)
+   */
+  std::vector<std::unique_ptr<Neuron>> release_neurons() {
+    std::vector<std::unique_ptr<Neuron>> ret;
+    ret.swap(neurons_);
+    return ret;
+  }
 
   /**
    * @brief Sets a vector of points as reconstruction contour
@@ -13,6 +13,7 @@
 
 #include <neurostr/core/definitions.h>
 #include <neurostr/core/property.h>
+#include <neurostr/core/arena.h>
 #include <neurostr/core/geometry.h>
 
 namespace neurostr {
@@ -87,6 +88,14 @@ class Node : public WithProperties{
    * @return 
    */
   ~Node() {}
+  
+  /**
+   * @brief Heap nodes are allocated in the active arena (see Arena)
+   */
+  static void* operator new(std::size_t n) { return Arena::allocate(n); }
+  static void operator delete(void* p) noexcept { Arena::deallocate(p); }
+  static void* operator new(std::size_t, void* p) noexcept { return p; }
+  static void operator delete(void*, void*) noexcept {}
 
   /**
    * @brief Compare two nodes by ID.
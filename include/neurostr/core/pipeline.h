@@ -0,0 +1,102 @@
+#ifndef NEUROSTR_CORE_PIPELINE_H_
+#define NEUROSTR_CORE_PIPELINE_H_
+
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace neurostr {
+
+/**
+ * @brief Runs a two-thread ordered pipeline. produce(i) is called for i in
+ * [0, count) sequentially in a reader thread, and each value is passed to
+ * consume in the calling thread in the same order. The reader is kept at most
+ * window values ahead of the consumer. Combined with a ThreadPool (produce
+ * submits the work, consume waits for it) it gives a reader/worker/ordered
+ * writer pipeline.
+ *
+ * An exception thrown by produce(i) is rethrown when value i is consumed.
+ * Exceptions thrown by consume stop the reader and are propagated.
+ *
+ * @param count Number of values
+ * @param window Maximum number of values produced and not yet consumed
+ * @param produce Callable size_t -> T (Move constructible T)
+ * @param consume Callable T& -> void
+ */
+template <typename Produce, typename Consume>
+void ordered_pipeline(std::size_t count, std::size_t window,
+                      Produce&& produce, Consume&& consume){
+
+  using value_type = typename std::decay<typename std::result_of<Produce&(std::size_t)>::type>::type;
+
+  struct slot {
+    std::unique_ptr<value_type> value;
+    std::exception_ptr error;
+  };
+
+  if(window == 0) window = 1;
+
+  std::deque<slot> ready;
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool stop = false;
+
+  std::thread reader([&](){
+    for(std::size_t i = 0; i < count; ++i){
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&](){ return stop || ready.size() < window; });
+        if(stop) return;
+      }
+
+      slot s;
+      try {
+        s.value.reset(new value_type(produce(i)));
+      } catch(...) {
+        s.error = std::current_exception();
+      }
+
+      {
+        std::lock_guard<std::mutex> lock(mutex);
+        ready.push_back(std::move(s));
+      }
+      cv.notify_all();
+    }
+  });
+
+  try {
+    for(std::size_t i = 0; i < count; ++i){
+      slot s;
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        cv.wait(lock, [&](){ return !ready.empty(); });
+        s = std::move(ready.front());
+        ready.pop_front();
+      }
+      cv.notify_all();
+
+      if(s.error) std::rethrow_exception(s.error);
+      consume(*s.value);
+    }
+  } catch(...) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      stop = true;
+    }
+    cv.notify_all();
+    reader.join();
+    throw;
+  }
+
+  reader.join();
+}
+
+} // neurostr
+
+#endif
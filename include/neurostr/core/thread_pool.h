@@ -0,0 +1,83 @@
+#ifndef NEUROSTR_CORE_THREAD_POOL_H_
+#define NEUROSTR_CORE_THREAD_POOL_H_
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace neurostr {
+
+/**
+ * @class ThreadPool
+ * @brief Fixed size pool of worker threads that run submitted tasks in FIFO
+ * order. Pending tasks are completed before the pool is destroyed.
+ */
+class ThreadPool {
+  
+  public:
+  
+  /**
+   * @brief Creates the pool and starts the workers
+   * @param nthreads Number of worker threads. 0 means one per hardware thread
+   */
+  explicit ThreadPool(std::size_t nthreads = 0);
+  
+  /**
+   * @brief Waits for every pending task and joins the workers
+   */
+  ~ThreadPool();
+  
+  ThreadPool(const ThreadPool&) = delete;
+  ThreadPool& operator=(const ThreadPool&) = delete;
+  
+  /**
+   * @brief Number of worker threads
+   * @return Pool size
+   */
+  std::size_t size() const { return workers_.size(); }
+  
+  /**
+   * @brief Queues a task
+   * @param f Callable without arguments
+   * @return Future with the task result (or the exception it threw)
+   */
+  template <typename F>
+  std::future<typename std::result_of<F()>::type> submit(F&& f){
+    using result_type = typename std::result_of<F()>::type;
+    
+    // std::function requires a copyable target
+    auto task = std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(f));
+    std::future<result_type> ret = task->get_future();
+    enqueue_([task](){ (*task)(); });
+    return ret;
+  }
+  
+  /**
+   * @brief Number of threads used when the size is not given
+   * @return Hardware concurrency (at least 1)
+   */
+  static std::size_t default_size();
+  
+  private:
+  
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> tasks_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  bool stop_;
+  
+  void enqueue_(std::function<void()>&& f);
+  void worker_loop_();
+};
+
+} // neurostr
+
+#endif
@@ -24,6 +24,8 @@
 #include <neurostr/core/neurite.h>
 #include <neurostr/core/neuron.h>
 
+#include <neurostr/io/reconstruction_stream.h>
+
 
 
 namespace neurostr {
@@ -67,6 +69,20 @@ class ASCParser : public Parser{
    */
   std::unique_ptr<Reconstruction> read(const std::string& name);
 
+  /**
+   * @brief Reads the stream passing each neuron and contour to the callbacks
+   * as soon as they are complete (see ReconstructionStream)
+   * @param name Reconstruction ID
+   * @param on_neuron Neuron callback
+   * @param on_contour Contour callback
+   * @param grouped If true, each cell (soma and trees) is expected to be 
+   * declared before the next soma, so neurons are passed during the read
+   * @return Reconstruction with the file properties (no neurons nor contours)
+   */
+  std::unique_ptr<Reconstruction> read(const std::string& name,
+                                       const neuron_callback& on_neuron,
+                                       const contour_callback& on_contour,
+                                       bool grouped = false);
   
 
     protected:
@@ -80,9 +96,17 @@ class ASCParser : public Parser{
   
   /**
    * @brief Process a single reconstruction 
-   * @param r Reconstruction to be fill
+   * @param r Reconstruction to be fill (properties)
+   * @param s Neuron and contour output
+   */
+  void process_(Reconstruction& r, ReconstructionStream& s);
+  
+  /**
+   * @brief Reads the stream and registers the errors
+   * @param r Reconstruction to be fill (properties)
+   * @param s Neuron and contour output
    */
-  void process_(Reconstruction& r);
+  void read_(Reconstruction& r, ReconstructionStream& s);
 
   /**
    * @brief Process a property in the stream
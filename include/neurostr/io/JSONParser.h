@@ -24,8 +24,6 @@
 #include <neurostr/core/log.h>
 
 #include <rapidjson/document.h>
-#include <rapidjson/istreamwrapper.h>
-#include <rapidjson/error/en.h>
 
 
 
@@ -64,7 +62,8 @@ class JSONParser : public Parser{
   public:
 
   /**
-   * @brief Reads a reconstruction from the stream
+   * @brief Reads a reconstruction from the stream. The document is processed
+   * as a stream of SAX events, without building the full JSON DOM.
    * @param name Reconstruction ID
    * @return Unique ptr to the reconstruction (Ownership)
    */
@@ -105,29 +104,6 @@ class JSONParser : public Parser{
    */
   Node parseNode(const rapidjson::Value::ConstObject& v );
   
-  /**
-   * @brief Parses a single neuron object
-   * @param v Single neuron object
-   * @return Neuron
-   */
-  Neuron* parseNeuron(const rapidjson::Value::ConstObject& v );
-  
-  /**
-   * @brief Processes a single neurite object 
-   * @param v Neurite object
-   * @return  Neurite
-   */
-  Neurite* parseNeurite(const rapidjson::Value::ConstObject& v );
-  
-  /**
-   * @brief Parses a single branch and interts its content in the Branch
-   * pointed by pos
-   * @param v JSON BRanch object
-   * @param pos Branch position
-   */
-  void parseBranch(const rapidjson::Value::ConstObject& v,
-                     const Neurite::branch_iterator& pos);
-
   /**
   * @brief Parses a markers object and adds them to the neurite
   * @param v JSON Marker object
@@ -135,22 +111,13 @@ class JSONParser : public Parser{
   */
   void parseMarkers(const rapidjson::Value::ConstObject& v,
                    Neurite& n);
-                     
-  /**
-   * @brief Processes a contour JSON object
-   * @param v JOSN Object
-   * @return Contour
-   */
-  Contour parseContour(const rapidjson::Value::ConstObject& v);
-                    
+
   /**
-   * @brief Reads a JSON document and produces a Reconstruction.
-   *  It supports single-neuron documents and reconstruction objects
-   * @param name Reconstruction name
-   * @param doc Parsed JSON document
+   * @brief SAX handler that builds the reconstruction as the document is read.
+   * Only small values (nodes, points, properties, markers and soma) are
+   * materialized, and processed by the functions above.
    */
-  std::unique_ptr<Reconstruction> 
-    parse_document(const std::string& name, const rapidjson::Document& doc);
+  class SAXHandler;
 
 };
 
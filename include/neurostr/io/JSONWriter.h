@@ -58,6 +58,10 @@ namespace io {
     private:
       OutputStream buffer;
       std::unique_ptr<writer_type> writer; // JSON Document
+      
+      // Incremental writing state
+      enum class state { kIdle, kNeurons, kContours };
+      state state_;
     
     // TODO: Define possible parameters (FLAGS)
     
@@ -75,6 +79,39 @@ namespace io {
      */
     void writeNeuron(const neurostr::Neuron& n);
     
+    // Incremental writing
+    
+    /**
+     * @brief Starts a reconstruction object. Neurons and contours are
+     * then written one by one with addNeuron/addContour, so the full
+     * reconstruction doesnt need to be in memory
+     * @throws logic_error If a reconstruction is already open
+     */
+    void beginReconstruction();
+    
+    /**
+     * @brief Writes a neuron in the open reconstruction. Neurons should
+     * be added before any contour
+     * @param n Neuron
+     * @throws logic_error If there is no open reconstruction or contours 
+     * were already added
+     */
+    void addNeuron(const neurostr::Neuron& n);
+    
+    /**
+     * @brief Writes a contour in the open reconstruction
+     * @param c Contour
+     * @throws logic_error If there is no open reconstruction
+     */
+    void addContour(const neurostr::Contour& c);
+    
+    /**
+     * @brief Closes the reconstruction object and flushes the stream
+     * @param p Reconstruction properties
+     * @throws logic_error If there is no open reconstruction
+     */
+    void endReconstruction(const neurostr::PropertyMap& p = neurostr::PropertyMap());
+    
     protected:
 
     /**
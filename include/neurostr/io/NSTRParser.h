@@ -0,0 +1,121 @@
+#ifndef NEUROSTRLIB_IO_NSTRPARSER_H_
+#define NEUROSTRLIB_IO_NSTRPARSER_H_
+
+#include <iostream>
+#include <string>
+#include <cstdint>
+
+#include <neurostr/io/parser.h>
+#include <neurostr/io/nstr_structure.h>
+
+#include <neurostr/core/property.h>
+#include <neurostr/core/node.h>
+#include <neurostr/core/branch.h>
+#include <neurostr/core/neurite.h>
+#include <neurostr/core/neuron.h>
+
+namespace neurostr {
+namespace io {
+
+/**
+ * @class NSTRParser
+ * @file NSTRParser.h
+ * @brief Parser for the NeuroSTR native binary format (see nstr_structure.h
+ * and NSTRWriter). The reconstruction is rebuilt as it was written, without
+ * correction.
+ */
+class NSTRParser : public Parser {
+
+  public:
+
+  /**
+   * @brief Creates a NSTR parser
+   * @param stream Input stream (binary mode)
+   */
+  NSTRParser(std::istream& stream) : Parser(stream) {};
+
+  /**
+   * @brief Default
+   */
+  ~NSTRParser() {};
+
+  /**
+   * @brief Reads a reconstruction from the stream
+   * @param name Reconstruction ID
+   * @return Unique ptr to the reconstruction (Ownership)
+   */
+  std::unique_ptr<Reconstruction> read(const std::string& name);
+
+  /**
+   * @brief Reads a reconstruction from a memory-mapped file instead of the
+   * stream. Sections are read in place.
+   * @param path File path
+   * @param name Reconstruction ID
+   * @throws filesystem_error If the file doesnt exist
+   * @return Unique ptr to the reconstruction (Ownership)
+   */
+  std::unique_ptr<Reconstruction> read_mapped(const std::string& path,
+                                              const std::string& name);
+
+  /**
+   * @brief Reads a reconstruction from a memory buffer
+   * @param data Buffer begin. 8-byte aligned
+   * @param size Buffer size
+   * @param name Reconstruction ID
+   * @return Unique ptr to the reconstruction (Ownership)
+   */
+  std::unique_ptr<Reconstruction> read_buffer(const char* data,
+                                              std::size_t size,
+                                              const std::string& name);
+
+  protected:
+
+  /**
+   * @brief Section view over the buffer
+   */
+  template <typename T>
+  struct section_view {
+    const T* data = nullptr;
+    std::size_t count = 0;
+
+    const T& at(std::uint32_t i) const {
+      if(i >= count) throw std::out_of_range("Record index out of range");
+      return data[i];
+    }
+  };
+
+  /**
+   * @brief Locates the sections in the buffer
+   * @throws runtime_error If the header or the section table are not valid
+   */
+  void map_sections_(const char* data, std::size_t size);
+
+  template <typename T>
+  void map_section_(const char* data, std::size_t size,
+                    const nstr::section_entry& e, section_view<T>& v);
+
+  std::string string_(const nstr::string_ref& s) const;
+  PropertyMap properties_(std::uint32_t i) const;
+  Node node_(std::uint32_t i) const;
+  Neuron* neuron_(const nstr::neuron_record& n) const;
+  Neurite* neurite_(const nstr::neurite_record& n) const;
+  Contour contour_(const nstr::contour_record& c) const;
+
+  section_view<char> strings_;
+  section_view<nstr::reconstruction_record> reconstruction_;
+  section_view<nstr::node_record> nodes_;
+  section_view<nstr::neuron_record> neurons_;
+  section_view<nstr::neurite_record> neurites_;
+  section_view<nstr::branch_record> branches_;
+  section_view<std::int32_t> branch_ids_;
+  section_view<nstr::marker_record> markers_;
+  section_view<nstr::contour_record> contours_;
+  section_view<nstr::point_record> points_;
+  section_view<nstr::property_map_record> property_maps_;
+  section_view<nstr::property_record> properties_records_;
+};
+
+} // io
+} // neurostr
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef NEUROSTRLIB_IO_NSTRWRITER_H_
+#define NEUROSTRLIB_IO_NSTRWRITER_H_
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neurostr/core/property.h>
+#include <neurostr/core/node.h>
+#include <neurostr/core/contour.h>
+#include <neurostr/core/neurite.h>
+#include <neurostr/core/neuron.h>
+
+#include <neurostr/io/nstr_structure.h>
+
+namespace neurostr {
+namespace io {
+
+  /**
+   * @class NSTRWriter
+   * @file NSTRWriter.h
+   * @brief Writes a reconstruction in the NeuroSTR native binary format
+   * (see nstr_structure.h). The stream should be opened in binary mode.
+   */
+  class NSTRWriter {
+
+    public:
+
+      /**
+       * @brief Creates a writer over the given stream
+       * @param s Output stream
+       */
+      NSTRWriter(std::ostream& s);
+
+      /**
+       * @brief Default
+       */
+      ~NSTRWriter() {};
+
+      /**
+       * @brief Writes the reconstruction (neurons, contours and properties)
+       * @param r Reconstruction
+       * @return Output stream reference
+       */
+      std::ostream& write(const Reconstruction& r);
+
+    private:
+
+      /**
+       * @brief Empties the section buffers
+       */
+      void clear_();
+
+      /**
+       * @brief Adds a string to the string section
+       * @param s String
+       * @return String reference
+       */
+      nstr::string_ref add_string_(const std::string& s);
+
+      /**
+       * @brief Adds a property map
+       * @param p Property map
+       * @return Property map index. npos if the map is empty
+       */
+      std::uint32_t add_properties_(const PropertyMap& p);
+
+      /**
+       * @brief Adds a node
+       * @param n Node
+       * @return Node index
+       */
+      std::uint32_t add_node_(const Node& n);
+
+      void add_neuron_(const Neuron& n);
+      void add_neurite_(const Neurite& n);
+      void add_contour_(const Contour& c);
+
+      /**
+       * @brief Writes the header, section table and sections
+       */
+      void write_file_();
+
+      std::ostream& stream_;
+
+      // Section content
+      std::string strings_;
+      std::vector<nstr::reconstruction_record> reconstruction_;
+      std::vector<nstr::node_record> nodes_;
+      std::vector<nstr::neuron_record> neurons_;
+      std::vector<nstr::neurite_record> neurites_;
+      std::vector<nstr::branch_record> branches_;
+      std::vector<std::int32_t> branch_ids_;
+      std::vector<nstr::marker_record> markers_;
+      std::vector<nstr::contour_record> contours_;
+      std::vector<nstr::point_record> points_;
+      std::vector<nstr::property_map_record> property_maps_;
+      std::vector<nstr::property_record> properties_;
+  };
+
+} // io
+} // neurostr
+
+#endif
@@ -3,6 +3,8 @@
 
 #include <iostream>
 #include <string>
+#include <array>
+#include <unordered_map>
 #include <boost/tokenizer.hpp>
 
 #include <neurostr/io/parser.h>
@@ -65,6 +67,17 @@ class SWCParser : public Parser{ // Could be templated
    */
   std::unique_ptr<Reconstruction> read(const std::string& name);
   
+  /**
+   * @brief Reads a reconstruction from a memory-mapped file instead of the
+   * stream. Lines are scanned in place, without copying them.
+   * @param path File path
+   * @param name Reconstruction ID
+   * @throws filesystem_error If the file doesnt exist
+   * @return Unique ptr to the reconstruction (Ownership)
+   */
+  std::unique_ptr<Reconstruction> read_mapped(const std::string& path, 
+                                              const std::string& name);
+  
   /**
    * @brief Checks if the given string is a known property name
    * @param s String to check
@@ -94,25 +107,64 @@ class SWCParser : public Parser{ // Could be templated
   
   // Data members
   separator sep_;
+  std::array<bool, 256> separator_table_;
   Neuron* neuron_;
   std::set<std::string> property_keys_;
   
   private:
   mutable Neurite::base_node_iterator last_node_pos_;
   
+  // Node position in its branch. Nodes are heap allocated, so pointers
+  // remain valid even when their branch is split
+  struct node_position {
+    Node* node;
+    std::size_t index;
+  };
+  
+  // Node id index
+  std::unordered_map<Node::id_type, node_position> node_index_;
+  
+  // Branch -> tree position index (branches are never erased while reading)
+  std::unordered_map<const Branch*, Neurite::branch_iterator> branch_index_;
+  
+  // Soma node id -> position in the neuron soma vector
+  std::unordered_map<Node::id_type, std::size_t> soma_index_;
+  
   
   /**
    * @brief Initialize property key set to the default values
    */
   void initialize_property_keys();
+  
+  /**
+   * @brief Initialize data field separator lookup table (same separators as
+   * the tokenizer)
+   * @param separators Separator characters
+   */
+  void initialize_separators(const std::string& separators);
+  
+  /**
+   * @brief Checks whether c separates data fields
+   * @param c Character
+   * @return True if \param{c} is a separator
+   */
+  bool is_separator(char c) const { return separator_table_[static_cast<unsigned char>(c)]; }
 
     private:
   
+  /**
+   * @brief Corrects the neuron and wraps it in a reconstruction
+   * @param name Reconstruction ID
+   * @return Unique ptr to the reconstruction (Ownership)
+   */
+  std::unique_ptr<Reconstruction> build_reconstruction_(const std::string& name);
+  
   /**
    * @brief Process a single line
-   * @param s Line to process
+   * @param b Line begin
+   * @param e Line end (new line character excluded)
    */
-  void process_line_(const std::string& s);
+  void process_line_(const char* b, const char* e);
   
   /**
    * @brief Process a line as header line
@@ -121,17 +173,59 @@ class SWCParser : public Parser{ // Could be templated
   void process_header_(const std::string& s);
   
   /**
-   * @brief Process a line as data line
-   * @param s Line to process
+   * @brief Process a line as data line. Fields are parsed in place
+   * @param b Line begin
+   * @param e Line end
    */
-  void process_data_(const std::string& s);
+  void process_data_(const char* b, const char* e);
+  
+  /**
+   * @brief Adds a sample to the neuron
+   * @param id Sample id
+   * @param type Sample type
+   * @param x X coordinate
+   * @param y Y coordinate
+   * @param z Z coordinate
+   * @param d Diameter
+   * @param parent Parent sample id
+   */
+  void add_node_(int id, int type, float x, float y, float z, float d, int parent);
   
   /**
    * @brief Checks whether a line is a header line or a data line
-   * @param s Line to check
-   * @return True if \param{s} is a header line
+   * @param b Line begin
+   * @param e Line end
+   * @return True if the line is a header line
+   */
+  bool is_headerline(const char* b, const char* e) const;
+  
+  /**
+   * @brief Clears the node, branch and soma indexes
+   */
+  void clear_index_();
+  
+  /**
+   * @brief Adds the node pointed by \code{pos} to the node index. The branch
+   * that contains it and its siblings are added to the branch index as well,
+   * since a branch split creates a new sibling
+   * @param pos Inserted node position
+   */
+  void index_node_(const Neurite::base_node_iterator& pos);
+  
+  /**
+   * @brief Updates the node index positions of all nodes in the branch (i.e.
+   * after a split moves them to a new branch)
+   * @param b Branch
+   */
+  void reindex_branch_(Branch& b);
+  
+  /**
+   * @brief Finds a (non-soma) node by id in constant time
+   * @param id Node id
+   * @return Node iterator. If node is not found returns the iterator created
+   * by the empty constructor
    */
-  bool is_headerline(const std::string& s) const;
+  Neurite::base_node_iterator find_node_(Node::id_type id) const;
 
 };  // Class swc parser
 
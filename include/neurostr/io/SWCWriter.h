@@ -20,7 +20,8 @@ namespace io {
   /**
    * @class SWCWriter
    * @file SWCWriter.h
-   * @brief Writes a reconstruction in standard SWC format
+   * @brief Writes a reconstruction in standard SWC format. Output is 
+   * formatted in a memory buffer that is flushed to the stream in large chunks
    */
   class SWCWriter {
     
@@ -91,10 +92,23 @@ namespace io {
        * @param type SWC numeric type
        * @param parent Parent id (-1 if its an orphan node)
        */
-      void writeNode(Node& n, unsigned int type, int parent) const ;
-    
+      void writeNode(const Node& n, unsigned int type, int parent) const ;
+      
+      /**
+       * @brief Parent id of the first node in a branch (as node_parent)
+       * @param b Branch
+       * @param parent Parent branch in the neurite tree (nullptr if b is root)
+       * @return Parent node id. no_parent_id if there is no parent
+       */
+      int firstParentId(const Branch& b, const Branch* parent) const;
+      
+      /**
+       * @brief Writes the buffer content to the stream
+       */
+      void flush_() const;
     
       std::ostream& stream_;
+      mutable std::string buffer_;
     
   };
   
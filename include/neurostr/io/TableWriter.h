@@ -0,0 +1,87 @@
+#ifndef NEUROSTRLIB_IO_TABLEWRITER_H_
+#define NEUROSTRLIB_IO_TABLEWRITER_H_
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neurostr/measure/column_table.h>
+
+namespace neurostr {
+namespace io {
+
+  /**
+   * @brief Table output formats
+   */
+  enum class table_format {
+    kCSV,       // Header line + one line per row. NaN values are empty
+    kJSONLines, // One JSON object per row. NaN values are omitted
+    kBinary     // Columnar binary table (see TableWriter)
+  };
+
+  /**
+   * @class TableWriter
+   * @file TableWriter.h
+   * @brief Writes measure tables (ColumnTable). Column names are escaped
+   * once per table and rows are formatted in a memory buffer.
+   *
+   * CSV and JSON lines tables can be written in several calls (the CSV header
+   * is only written once). Each binary write is a complete table:
+   *
+   * - Header: magic "NSTRTBL" + '\\0', uint32 version (1), uint32 byte
+   *   order mark (0x01020304), uint32 key column count, uint32 value column
+   *   count, uint64 row count
+   * - Column names (keys, then values): uint32 length + bytes
+   * - Key columns, one after another: uint32 length + bytes per row
+   * - Value columns, one after another: float32 per row
+   *
+   * Numbers are stored in the machine byte order.
+   */
+  class TableWriter {
+
+    public:
+
+      /**
+       * @brief Creates a writer over the given stream
+       * @param s Output stream (binary mode for kBinary)
+       * @param f Output format
+       */
+      TableWriter(std::ostream& s, table_format f);
+
+      /**
+       * @brief Writes the table rows
+       * @param t Table
+       * @return Output stream reference
+       */
+      std::ostream& write(const measure::ColumnTable& t);
+
+      /**
+       * @brief Format by name: csv, jsonl or bin
+       * @param name Format name
+       * @throws runtime_error If the name is not recognized
+       * @return Format
+       */
+      static table_format format_by_name(const std::string& name);
+
+    private:
+
+      void write_csv_(const measure::ColumnTable& t);
+      void write_json_lines_(const measure::ColumnTable& t);
+      void write_binary_(const measure::ColumnTable& t);
+
+      /**
+       * @brief Writes the buffer content to the stream
+       */
+      void flush_();
+
+      std::ostream& stream_;
+      table_format format_;
+      bool header_written_;
+      std::string buffer_;
+  };
+
+} // io
+} // neurostr
+
+#endif
@@ -0,0 +1,188 @@
+/**
+ * NeuroSTR native binary format structure
+ *
+ */
+#ifndef NEUROSTRLIB_IO_NSTR_STRUCTURE_H_
+#define NEUROSTRLIB_IO_NSTR_STRUCTURE_H_
+
+#include <cstdint>
+
+namespace neurostr {
+namespace io {
+namespace nstr {
+
+/********************
+ * @note The file is a header followed by a section table and a set of flat
+ * record arrays (sections). Every section starts at an 8-byte aligned offset
+ * and records only contain 4-byte fields, so a memory-mapped file can be read
+ * in place. Elements reference each other by record index; strings are
+ * (offset,length) references into the string section. Values are stored in
+ * the writer byte order, checked through header.byte_order.
+ *
+ * Neurons own a soma node range and a neurite range; neurites own a branch
+ * range (DFS pre-order, parents are indices relative to the neurite), a
+ * marker range and flags (i.e. whether they are attached to the soma); branches own a node range, an optional root node and an id
+ * range. Properties are stored as property map records (ranges of property
+ * records). Nothing is computed on load - the stored reconstruction is
+ * rebuilt as it was written.
+ */
+
+/** File magic (8 bytes) */
+constexpr char magic[8] = {'N','S','T','R','B','I','N','\0'};
+
+/** Format version. Readers reject other versions */
+constexpr std::uint32_t version = 2;
+
+/** Byte order mark */
+constexpr std::uint32_t byte_order = 0x01020304;
+
+/** Null index */
+constexpr std::uint32_t npos = 0xFFFFFFFF;
+
+/** Neurite flag: the root branch root node is a soma node */
+constexpr std::uint32_t neurite_root_is_soma = 0x1;
+
+/**
+ * @brief Section identifiers
+ */
+enum class section_id : std::uint32_t {
+  kReconstruction = 1,
+  kStrings,
+  kNodes,
+  kNeurons,
+  kNeurites,
+  kBranches,
+  kBranchIds,
+  kMarkers,
+  kContours,
+  kPoints,
+  kPropertyMaps,
+  kProperties
+};
+
+/** Number of section types */
+constexpr std::uint32_t section_count = 12;
+
+/**
+ * @brief Property value types
+ */
+enum class property_kind : std::uint32_t {
+  kEmpty = 0,
+  kInt,
+  kFloat,
+  kBool,
+  kPoint,
+  kString
+};
+
+struct file_header {
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t byte_order;
+  std::uint32_t section_count;
+  std::uint32_t reserved;
+};
+
+struct section_entry {
+  std::uint32_t id;
+  std::uint32_t record_size;
+  std::uint64_t offset;
+  std::uint64_t count;
+};
+
+struct string_ref {
+  std::uint32_t offset;
+  std::uint32_t length;
+};
+
+struct reconstruction_record {
+  string_ref id;
+  std::uint32_t properties;
+  std::uint32_t reserved;
+};
+
+struct node_record {
+  std::int32_t id;
+  float x;
+  float y;
+  float z;
+  float r;
+  std::uint32_t properties;
+};
+
+struct neuron_record {
+  string_ref id;
+  float up[3];
+  std::uint32_t properties;
+  std::uint32_t soma_begin;
+  std::uint32_t soma_count;
+  std::uint32_t neurite_begin;
+  std::uint32_t neurite_count;
+};
+
+struct neurite_record {
+  std::int32_t id;
+  std::uint32_t type;
+  std::uint32_t flags;
+  std::uint32_t properties;
+  std::uint32_t branch_begin;
+  std::uint32_t branch_count;
+  std::uint32_t marker_begin;
+  std::uint32_t marker_count;
+};
+
+struct branch_record {
+  std::uint32_t parent;
+  std::int32_t order;
+  std::uint32_t id_begin;
+  std::uint32_t id_count;
+  std::uint32_t root;
+  std::uint32_t node_begin;
+  std::uint32_t node_count;
+  std::uint32_t properties;
+};
+
+struct marker_record {
+  string_ref name;
+  std::uint32_t node_begin;
+  std::uint32_t node_count;
+};
+
+struct contour_record {
+  string_ref name;
+  string_ref face_color;
+  string_ref back_color;
+  std::uint32_t closed;
+  float fill;
+  float resolution;
+  std::uint32_t point_begin;
+  std::uint32_t point_count;
+};
+
+struct point_record {
+  float x;
+  float y;
+  float z;
+};
+
+struct property_map_record {
+  std::uint32_t begin;
+  std::uint32_t count;
+};
+
+/**
+ * @brief Property record. Value layout depends on kind: int/float/bool in
+ * value[0], point in value[0..2] (float bits) and string as a string_ref
+ * in value[0..1]
+ */
+struct property_record {
+  string_ref key;
+  std::uint32_t kind;
+  std::uint32_t value[3];
+};
+
+} // nstr
+} // io
+} // neurostr
+
+#endif
@@ -3,6 +3,7 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <iostream>
 #include <fstream>
 
@@ -16,6 +17,8 @@
 #include <neurostr/io/DATParser.h>
 #include <neurostr/io/SWCParser.h>
 #include <neurostr/io/JSONParser.h>
+#include <neurostr/io/NSTRParser.h>
+#include <neurostr/io/reconstruction_stream.h>
 
 namespace neurostr {
 namespace io{
@@ -28,7 +31,7 @@ namespace io{
   Parser* get_parser_by_ext(const std::string& ext);
 
   /**
-   * @brief Opens a filestream. If the extension is DAT the file is open with the binary flag activated
+   * @brief Opens a filestream. If the extension is DAT or NSTR the file is open with the binary flag activated
    * @param path File path
    * @param s File extension
    * @param ret Stream to be opened
@@ -38,9 +41,38 @@ namespace io{
   /**
    * @brief Given a file path, selects the parser by the file extension and processes its content
    * @param path File path
+   * @param use_arena If true, the reconstruction elements are allocated in 
+   * a new arena owned by the reconstruction (see Arena)
    * @return Reconstruction
    */
-  std::unique_ptr<Reconstruction> read_file_by_ext(const std::string& path);
+  std::unique_ptr<Reconstruction> read_file_by_ext(const std::string& path, bool use_arena = false);
+
+  /**
+   * @brief Given a file path, selects the parser by the file extension and 
+   * passes each neuron and contour to the callbacks. Neurolucida files (ASC/DAT)
+   * are streamed (see ReconstructionStream), other formats are read completely
+   * before the first callback
+   * @param path File path
+   * @param on_neuron Neuron callback
+   * @param on_contour Contour callback
+   * @param grouped Grouped mode flag for neurolucida files
+   * @return Reconstruction with the file properties (no neurons nor contours)
+   */
+  std::unique_ptr<Reconstruction> read_file_by_ext(const std::string& path,
+                                                   const neuron_callback& on_neuron,
+                                                   const contour_callback& on_contour,
+                                                   bool grouped = false);
+  
+  /**
+   * @brief Lists reconstruction files for batch processing. If path is a 
+   * directory, it is scanned recursively for files with a known extension 
+   * (swc, asc, dat, json, nstr) and sorted. Otherwise it is read as a file 
+   * list with one path per line
+   * @param path Directory or file list
+   * @throws runtime_error If the file list can't be opened
+   * @return File paths
+   */
+  std::vector<std::string> list_reconstruction_files(const std::string& path);
 }
 }
 
@@ -0,0 +1,110 @@
+#ifndef NEUROSTRLIB_IO_RECONSTRUCTION_STREAM_H_
+#define NEUROSTRLIB_IO_RECONSTRUCTION_STREAM_H_
+
+#include <string>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include <neurostr/core/node.h>
+#include <neurostr/core/contour.h>
+#include <neurostr/core/neurite.h>
+#include <neurostr/core/neuron.h>
+
+namespace neurostr {
+namespace io {
+
+  /**
+   * @brief Called with each neuron once it is complete (ownership)
+   */
+  using neuron_callback = std::function<void(std::unique_ptr<Neuron>)>;
+  
+  /**
+   * @brief Called with each reconstruction contour once it is read
+   */
+  using contour_callback = std::function<void(const Contour&)>;
+
+  /**
+   * @class ReconstructionStream
+   * @file reconstruction_stream.h
+   * @brief Collects the somas, trees and contours of neurolucida files
+   * (ASC/DAT) and passes them to the callbacks as soon as they are complete.
+   *
+   * Contours are passed as soon as they are read. Trees are attached to the
+   * closest soma, so in general a neuron is only complete at the end of the 
+   * file. In grouped mode, the file is expected to declare each cell (soma 
+   * followed by its trees) before the next one: pending neurons are passed 
+   * when a soma follows a tree.
+   */
+  class ReconstructionStream {
+    
+    public:
+    
+    /**
+     * @brief Creates a stream
+     * @param id Reconstruction ID (Used to name the neurons)
+     * @param on_neuron Neuron callback
+     * @param on_contour Contour callback
+     * @param grouped Grouped mode flag
+     */
+    ReconstructionStream(const std::string& id,
+                         const neuron_callback& on_neuron,
+                         const contour_callback& on_contour,
+                         bool grouped = false);
+    
+    /**
+     * @brief Passes any pending neuron to the callback
+     */
+    ~ReconstructionStream();
+    
+    ReconstructionStream(const ReconstructionStream&) = delete;
+    ReconstructionStream& operator=(const ReconstructionStream&) = delete;
+    
+    /**
+     * @brief Creates a new neuron with the given soma
+     * @param soma Soma nodes
+     */
+    void add_soma(const std::vector<Node>& soma);
+    
+    /**
+     * @brief Adds the neurite to the closest pending neuron. A neuron 
+     * without soma is created if there is none
+     * @param n Neurite (Ownership)
+     * @throws runtime_error If there is no neuron with soma to attach it to
+     */
+    void add_neurite(Neurite* n);
+    
+    /**
+     * @brief Passes the contour to the callback
+     * @param c Contour
+     */
+    void add_contour(const Contour& c);
+    
+    /**
+     * @brief Passes the pending neurons to the callback. Called at the end
+     * of the file
+     */
+    void flush();
+    
+    /**
+     * @brief Number of neurons created so far
+     */
+    std::size_t neuron_count() const { return count_; }
+    
+    private:
+    
+    Reconstruction pending_;
+    std::string id_;
+    neuron_callback on_neuron_;
+    contour_callback on_contour_;
+    bool grouped_;
+    bool trees_since_soma_;
+    std::size_t count_;
+    
+    Neuron* new_neuron_(const std::vector<Node>& soma);
+  };
+
+} // io
+} // neurostr
+
+#endif
@@ -4,7 +4,11 @@
 #include <algorithm>
 #include <numeric>
 #include <array>
+#include <cmath>
+#include <functional>
 #include <iostream>
+#include <limits>
+#include <vector>
 
 namespace neurostr {
 namespace measure {
@@ -138,6 +142,295 @@ const auto all_aggr_factory(T zero){
   };
 };
   
+/**
+ * Online accumulators. Values are pushed one at a time so the aggregated range
+ * doesn't need to be stored. Each accumulator can also be called with an
+ * iterator range, as the aggregators above.
+ */
+
+/**
+ * @class online_sum
+ * @brief Running sum
+ */
+template <typename U = float, typename T = U>
+class online_sum {
+  public:
+  using value_type = U;
+  
+  explicit online_sum(T zero = T(0)) : zero_(zero), sum_(zero) {};
+  
+  void reset() { sum_ = zero_; }
+  void push(const U& v) { sum_ += v; }
+  T result() const { return sum_; }
+  
+  T operator()(const detail::iterator_type<U>& b, 
+               const detail::iterator_type<U>& e) const {
+    online_sum<U,T> acc(zero_);
+    for(auto it = b; it != e; ++it) acc.push(*it);
+    return acc.result();
+  }
+  
+  private:
+  T zero_;
+  T sum_;
+};
+
+/**
+ * @class online_min_max
+ * @brief Running min and max. Both are infinity if there are no values (as
+ * min and max)
+ */
+template <typename U = float, typename T = U>
+class online_min_max {
+  public:
+  using value_type = U;
+  
+  online_min_max() : count_(0), min_(), max_() {};
+  
+  void reset() { count_ = 0; }
+  void push(const U& v) {
+    if(count_ == 0){
+      min_ = v;
+      max_ = v;
+    } else {
+      if(v < min_) min_ = v;
+      if(max_ < v) max_ = v;
+    }
+    ++count_;
+  }
+  
+  T min() const { 
+    return count_ == 0 ? std::numeric_limits<T>::infinity() : static_cast<T>(min_); 
+  }
+  T max() const { 
+    return count_ == 0 ? std::numeric_limits<T>::infinity() : static_cast<T>(max_); 
+  }
+  
+  std::array<T,2> operator()(const detail::iterator_type<U>& b, 
+                             const detail::iterator_type<U>& e) const {
+    online_min_max<U,T> acc;
+    for(auto it = b; it != e; ++it) acc.push(*it);
+    return std::array<T,2>{ {acc.min(), acc.max()} };
+  }
+  
+  private:
+  std::size_t count_;
+  U min_;
+  U max_;
+};
+
+/**
+ * @class online_mean_sd
+ * @brief Running mean and sample standard deviation (Welford's method)
+ */
+template <typename U = float, typename T = U>
+class online_mean_sd {
+  public:
+  using value_type = U;
+  
+  explicit online_mean_sd(T zero = T(0)) : zero_(zero), count_(0), mean_(zero), m2_(zero) {};
+  
+  void reset() { count_ = 0; mean_ = zero_; m2_ = zero_; }
+  void push(const U& v) {
+    ++count_;
+    T delta = static_cast<T>(v) - mean_;
+    mean_ += delta / static_cast<T>(count_);
+    m2_ += delta * (static_cast<T>(v) - mean_);
+  }
+  
+  std::size_t count() const { return count_; }
+  
+  // NAN without values, as mean_sd_factory
+  T mean() const { 
+    return count_ == 0 ? zero_ / static_cast<T>(0) : mean_; 
+  }
+  T sd() const { 
+    return std::sqrt(m2_ / (static_cast<T>(count_) - 1)); 
+  }
+  
+  std::array<T,2> operator()(const detail::iterator_type<U>& b, 
+                             const detail::iterator_type<U>& e) const {
+    online_mean_sd<U,T> acc(zero_);
+    for(auto it = b; it != e; ++it) acc.push(*it);
+    return std::array<T,2>{ {acc.mean(), acc.sd()} };
+  }
+  
+  private:
+  T zero_;
+  std::size_t count_;
+  T mean_;
+  T m2_;
+};
+
+/**
+ * @class p2_median
+ * @brief Streaming median estimate with the P-square algorithm (Jain and 
+ * Chlamtac, 1985). Uses constant memory; the median is exact up to five 
+ * values and an estimate afterwards.
+ */
+template <typename U = float, typename T = U>
+class p2_median {
+  public:
+  using value_type = U;
+  
+  p2_median() : count_(0) {};
+  
+  void reset() { count_ = 0; }
+  
+  void push(const U& v) {
+    double x = static_cast<double>(v);
+    
+    // Initial values are stored sorted
+    if(count_ < 5){
+      q_[count_] = x;
+      std::sort(q_.begin(), q_.begin() + count_ + 1);
+      if(++count_ == 5){
+        for(int i = 0; i < 5; ++i){
+          n_[i] = i;
+          np_[i] = i;
+        }
+      }
+      return;
+    }
+    ++count_;
+    
+    // Find the cell of x and update extreme markers
+    int k;
+    if(x < q_[0]){
+      q_[0] = x;
+      k = 0;
+    } else if(x >= q_[4]){
+      q_[4] = x;
+      k = 3;
+    } else {
+      k = 0;
+      while(x >= q_[k+1]) ++k;
+    }
+    
+    // Marker positions
+    for(int i = k + 1; i < 5; ++i) n_[i] += 1;
+    for(int i = 0; i < 5; ++i) np_[i] += dn_(i);
+    
+    // Adjust middle marker heights
+    for(int i = 1; i < 4; ++i){
+      double d = np_[i] - n_[i];
+      if( (d >= 1. && n_[i+1] - n_[i] > 1.) || 
+          (d <= -1. && n_[i-1] - n_[i] < -1.) ){
+        d = d < 0 ? -1. : 1.;
+        double qp = parabolic_(i, d);
+        if(q_[i-1] < qp && qp < q_[i+1]){
+          q_[i] = qp;
+        } else {
+          int j = i + static_cast<int>(d);
+          q_[i] += d * (q_[j] - q_[i]) / (n_[j] - n_[i]);
+        }
+        n_[i] += d;
+      }
+    }
+  }
+  
+  std::size_t count() const { return count_; }
+  
+  // Infinity without values, as median
+  T result() const {
+    if(count_ == 0) return std::numeric_limits<T>::infinity();
+    if(count_ > 5) return static_cast<T>(q_[2]);
+    
+    std::size_t n = count_ / 2;
+    if(count_ % 2 == 1) return static_cast<T>(q_[n]);
+    return static_cast<T>((static_cast<U>(q_[n-1]) + static_cast<U>(q_[n])) / 2);
+  }
+  
+  T operator()(const detail::iterator_type<U>& b, 
+               const detail::iterator_type<U>& e) const {
+    p2_median<U,T> acc;
+    for(auto it = b; it != e; ++it) acc.push(*it);
+    return acc.result();
+  }
+  
+  private:
+  
+  // Desired position increments for p = 0.5
+  static double dn_(int i) { return i * 0.25; }
+  
+  double parabolic_(int i, double d) const {
+    return q_[i] + d / (n_[i+1] - n_[i-1]) * 
+      ( (n_[i] - n_[i-1] + d) * (q_[i+1] - q_[i]) / (n_[i+1] - n_[i]) + 
+        (n_[i+1] - n_[i] - d) * (q_[i] - q_[i-1]) / (n_[i] - n_[i-1]) );
+  }
+  
+  std::size_t count_;
+  std::array<double,5> q_;  // Marker heights
+  std::array<double,5> n_;  // Marker positions
+  std::array<double,5> np_; // Desired marker positions
+};
+
+/**
+ * @class online_all_aggr
+ * @brief Online version of all_aggr_factory. Median is a P-square estimate
+ */
+template <typename U = float, typename T = U>
+class online_all_aggr {
+  public:
+  using value_type = U;
+  using result_type = aggr_pack<U,T>;
+  
+  explicit online_all_aggr(T zero = T(0)) 
+    : sum_(zero), min_max_(), mean_sd_(zero), median_() {};
+  
+  void reset() { 
+    sum_.reset();
+    min_max_.reset();
+    mean_sd_.reset();
+    median_.reset();
+  }
+  
+  void push(const U& v){
+    sum_.push(v);
+    min_max_.push(v);
+    mean_sd_.push(v);
+    median_.push(v);
+  }
+  
+  std::size_t count() const { return mean_sd_.count(); }
+  
+  result_type result() const {
+    return result_type(sum_.result(), min_max_.min(), min_max_.max(), 
+                       median_.result(), mean_sd_.mean(), mean_sd_.sd());
+  }
+  
+  result_type operator()(const detail::iterator_type<U>& b, 
+                         const detail::iterator_type<U>& e) const {
+    online_all_aggr<U,T> acc(*this);
+    acc.reset();
+    for(auto it = b; it != e; ++it) acc.push(*it);
+    return acc.result();
+  }
+  
+  private:
+  online_sum<U,T> sum_;
+  online_min_max<U,T> min_max_;
+  online_mean_sd<U,T> mean_sd_;
+  p2_median<U,T> median_;
+};
+
+template <typename U = float, typename T = U>
+online_all_aggr<U,T> online_all_aggr_factory(T zero){
+  return online_all_aggr<U,T>(zero);
+}
+
+/**
+ * @brief True if the aggregator is an online accumulator (has push and result)
+ */
+template <typename A, typename = void>
+struct is_online_aggregator : std::false_type {};
+
+template <typename A>
+struct is_online_aggregator<A, 
+  decltype( std::declval<A&>().push(std::declval<const typename A::value_type&>()), 
+            std::declval<const A&>().result(), 
+            void()) > : std::true_type {};
+  
 } // Aggreg
 }  // measures
 }  // neurostr
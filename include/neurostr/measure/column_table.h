@@ -0,0 +1,108 @@
+#ifndef NEUROSTR_MEASURE_COLUMN_TABLE_H_
+#define NEUROSTR_MEASURE_COLUMN_TABLE_H_
+
+#include <string>
+#include <vector>
+
+namespace neurostr {
+namespace measure {
+
+/**
+ * @class ColumnTable
+ * @file column_table.h
+ * @brief Measure results stored by columns: string key columns (element ids)
+ * and float value columns (one per measure). Missing values are NaN.
+ *
+ * Rows are added in a single thread. Once added, different rows can be
+ * filled concurrently.
+ */
+class ColumnTable {
+
+  public:
+
+  /**
+   * @brief Reference to the values of a row
+   */
+  class row_ref {
+    public:
+    row_ref(ColumnTable& t, std::size_t r) : table_(&t), row_(r) {}
+    float& operator[](std::size_t col) const { return table_->values_[col][row_]; }
+    private:
+    ColumnTable* table_;
+    std::size_t row_;
+  };
+
+  /**
+   * @brief Creates an empty table
+   * @param keys Key column names
+   * @param values Value column names
+   */
+  ColumnTable(const std::vector<std::string>& keys,
+              const std::vector<std::string>& values);
+
+  std::size_t key_count() const { return key_names_.size(); }
+  std::size_t value_count() const { return value_names_.size(); }
+  std::size_t rows() const { return rows_; }
+
+  const std::string& key_name(std::size_t col) const { return key_names_[col]; }
+  const std::string& value_name(std::size_t col) const { return value_names_[col]; }
+
+  /**
+   * @brief Reserves space for n rows
+   * @param n Row count
+   */
+  void reserve(std::size_t n);
+
+  /**
+   * @brief Adds a row with empty keys and NaN values
+   * @return Row index
+   */
+  std::size_t add_row();
+
+  /**
+   * @brief Sets a key of a row
+   */
+  void key(std::size_t row, std::size_t col, const std::string& v) { keys_[col][row] = v; }
+  const std::string& key(std::size_t row, std::size_t col) const { return keys_[col][row]; }
+
+  /**
+   * @brief Row values (writable)
+   * @param r Row index
+   * @return Row reference
+   */
+  row_ref row(std::size_t r) { return row_ref(*this, r); }
+
+  float value(std::size_t row, std::size_t col) const { return values_[col][row]; }
+
+  /**
+   * @brief Value column
+   * @param col Column index
+   * @return Column values (one per row)
+   */
+  const std::vector<float>& column(std::size_t col) const { return values_[col]; }
+
+  /**
+   * @brief Appends the rows of other table
+   * @param other Table with the same columns
+   * @throws runtime_error If the columns don't match
+   */
+  void append(const ColumnTable& other);
+
+  /**
+   * @brief Removes all rows (columns and capacity are kept)
+   */
+  void clear();
+
+  private:
+
+  std::vector<std::string> key_names_;
+  std::vector<std::string> value_names_;
+  std::vector<std::vector<std::string>> keys_;
+  std::vector<std::vector<float>> values_;
+  std::size_t rows_;
+};
+
+} // measure
+} // neurostr
+
+#endif
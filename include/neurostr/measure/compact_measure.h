@@ -0,0 +1,470 @@
+#ifndef NEUROSTR_MEASURE_COMPACT_MEASURE_H_
+#define NEUROSTR_MEASURE_COMPACT_MEASURE_H_
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <boost/math/tools/minima.hpp>
+#include <boost/math/constants/constants.hpp>
+
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/compact_neuron.h>
+#include <neurostr/measure/aggregate.h>
+#include <neurostr/measure/measure_operations.h>
+
+/**
+ * L-Measure kernels over a CompactNeuron. Each kernel matches the measure with
+ * the same name in lmeasure_decl.h (same selection and return type) but works
+ * on the contiguous arrays instead of selecting node/branch references.
+ */
+namespace neurostr{
+namespace measure{
+namespace lmeasure{
+namespace compact{
+
+  using index_type = CompactNeuron::index_type;
+
+  namespace detail {
+
+    // Applies f(n,i,b) to every neurite node (b is the node branch)
+    template <typename T, typename F>
+    std::vector<T> node_values(const CompactNeuron& n, const F& f){
+      std::vector<T> v;
+      v.reserve(n.node_count());
+      for(index_type b = 0; b < static_cast<index_type>(n.branch_count()); ++b){
+        for(index_type i = n.branch_begin(b); i < n.branch_end(b); ++i){
+          v.push_back(f(n,i,b));
+        }
+      }
+      return v;
+    }
+
+    // Applies f(n,b) to every branch that satisfies pred(n,b)
+    template <typename T, typename P, typename F>
+    std::vector<T> branch_values(const CompactNeuron& n, const P& pred, const F& f){
+      std::vector<T> v;
+      for(index_type b = 0; b < static_cast<index_type>(n.branch_count()); ++b){
+        if(pred(n,b)) v.push_back(f(n,b));
+      }
+      return v;
+    }
+
+    // Number of terminal branches in each branch subtree
+    inline std::vector<int> subtree_tips(const CompactNeuron& n){
+      std::vector<int> tips(n.branch_count(), 0);
+      for(index_type b = n.branch_count() - 1; b >= 0; --b){
+        if(n.branch_children(b) == 0) tips[b] += 1;
+        if(n.branch_parent(b) != CompactNeuron::npos) tips[n.branch_parent(b)] += tips[b];
+      }
+      return tips;
+    }
+
+    // Node::vectorTo
+    inline point_type vector_to(const CompactNeuron& n, index_type a, index_type b){
+      if(n.node_id(a) == -1 || n.node_id(b) == -1) return point_type(0,0,0);
+      return geometry::vectorFromTo(n.position(a), n.position(b));
+    }
+
+    const auto all_branches = [](const CompactNeuron&, index_type) { return true; };
+
+    const auto non_terminal_branches = [](const CompactNeuron& n, index_type b) {
+      return n.branch_children(b) != 0;
+    };
+
+    // Point the children of b are attached to: its last node, or the last
+    // node of its closest non-empty ancestor (the neurite root if there is
+    // none), as in the CompactNeuron construction. npos if there is none
+    inline index_type bifurcation_point(const CompactNeuron& n, index_type b){
+      index_type q = b;
+      while(q != CompactNeuron::npos && n.branch_size(q) == 0) q = n.branch_parent(q);
+      if(q == CompactNeuron::npos) return n.neurite_root(n.branch_neurite(b));
+      else return n.branch_end(q)-1;
+    }
+
+    // Bifurcation point and first child nodes diameters of a bifurcation.
+    // NAN if any of them does not exist
+    inline std::array<float,3> bifurcation_diameters(const CompactNeuron& n, index_type b){
+      index_type ca = n.branch_first_child(b);
+      index_type cb = n.branch_next_sibling(ca);
+      index_type p = bifurcation_point(n,b);
+      if(p == CompactNeuron::npos || n.branch_size(ca) == 0 || n.branch_size(cb) == 0)
+        return std::array<float,3>{ { NAN, NAN, NAN } };
+      return std::array<float,3>{ { n.radius(p)*2,
+                                    n.radius(n.branch_begin(ca))*2,
+                                    n.radius(n.branch_begin(cb))*2 } };
+    }
+
+    // NAN values are not aggregated, as in measureEachAggregate. Median is
+    // exact, as in the lmeasure_decl.h measures
+    template <typename U>
+    aggregate::aggr_pack<U,float> all_aggr(const std::vector<U>& v){
+      std::vector<U> tmp;
+      tmp.reserve(v.size());
+      for(const auto& x : v){
+        if(!measure::detail::is_nan_value(x)) tmp.push_back(x);
+      }
+      return aggregate::all_aggr_factory<U,float>(0.)(tmp.begin(), tmp.end());
+    }
+
+  } // Detail namespace
+
+  const auto soma_surface = [](const CompactNeuron& n) -> float {
+    index_type soma_size = n.soma_size();
+
+    if(soma_size == 1){
+      return M_PI*4*std::pow(n.radius(0),2);
+    } else {
+      // Barycenter
+      float cx = 0, cy = 0, cz = 0;
+      for(index_type i = 0; i < soma_size; ++i){
+        cx += n.x(i);
+        cy += n.y(i);
+        cz += n.z(i);
+      }
+      point_type c(cx/soma_size, cy/soma_size, cz/soma_size);
+
+      // Avg rad
+      float dist = 0.;
+      for(index_type i = 0; i < soma_size; ++i){
+        dist += n.radius(i) + geometry::distance(n.position(i), c);
+      }
+      return M_PI*4*std::pow(dist/soma_size,2);
+    }
+  };
+
+  const auto n_stems = [](const CompactNeuron& n) -> int {
+    return n.neurite_count();
+  };
+
+  const auto n_bifs = [](const CompactNeuron& n) -> unsigned int {
+    unsigned int count = 0;
+    for(index_type b = 0; b < static_cast<index_type>(n.branch_count()); ++b)
+      if(n.branch_children(b) != 0) ++count;
+    return count;
+  };
+
+  const auto n_branch = [](const CompactNeuron& n) -> unsigned int {
+    return n.branch_count();
+  };
+
+  const auto n_tips = [](const CompactNeuron& n) -> unsigned int {
+    unsigned int count = 0;
+    for(index_type b = 0; b < static_cast<index_type>(n.branch_count()); ++b)
+      if(n.branch_children(b) == 0) ++count;
+    return count;
+  };
+
+  namespace detail {
+    // Range length of a coordinate over the neurite nodes
+    template <typename F>
+    float coordinate_range(const CompactNeuron& n, const F& coord){
+      if(n.node_count() == 0) return NAN;
+      float min_ = std::numeric_limits<float>::max();
+      float max_ = std::numeric_limits<float>::lowest();
+      for(index_type b = 0; b < static_cast<index_type>(n.branch_count()); ++b){
+        for(index_type i = n.branch_begin(b); i < n.branch_end(b); ++i){
+          float v = coord(i);
+          if(v < min_) min_ = v;
+          if(v > max_) max_ = v;
+        }
+      }
+      return max_ - min_;
+    }
+  } // Detail namespace
+
+  const auto width = [](const CompactNeuron& n) -> float {
+    return detail::coordinate_range(n, [&n](index_type i){ return n.x(i); });
+  };
+
+  const auto height = [](const CompactNeuron& n) -> float {
+    return detail::coordinate_range(n, [&n](index_type i){ return n.y(i); });
+  };
+
+  const auto depth = [](const CompactNeuron& n) -> float {
+    return detail::coordinate_range(n, [&n](index_type i){ return n.z(i); });
+  };
+
+  const auto diameter = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type){
+      return n.radius(i)*2;
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto diameter_pow = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type){
+      return std::pow(n.radius(i)*2,1.5);
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto length = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type){
+      return n.distance(i, n.node_parent(i));
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto surface = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type){
+      index_type p = n.node_parent(i);
+      float s = std::sqrt( std::pow(n.distance(i,p),2) +
+                           std::pow(n.radius(p)-n.radius(i),2));
+      return M_PI * (n.radius(p)+n.radius(i)) * s;
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto section_area = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type){
+      index_type p = n.node_parent(i);
+      return M_PI * std::pow( ((n.radius(p)+n.radius(i))/2.),2);
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto volume = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type){
+      const float pi = boost::math::constants::pi<float>();
+      index_type p = n.node_parent(i);
+      float pr = n.radius(p);
+      float nr = n.radius(i);
+      return pi/3. * (pr*pr + pr*nr + nr*nr) * n.distance(i,p);
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto euc_distance = [](const CompactNeuron& n) {
+    auto v = detail::node_values<float>(n, [](const CompactNeuron& n, index_type i, index_type b){
+      // Neurite root, or its first node if there is none
+      index_type k = n.branch_neurite(b);
+      index_type root = n.neurite_root(k);
+      if(root == CompactNeuron::npos) root = n.branch_begin(n.neurite_branch_begin(k));
+      return n.distance(i, root);
+    });
+    return detail::all_aggr(v);
+  };
+
+  const auto path_distance = [](const CompactNeuron& n) {
+    // Parents are stored before their children: accumulate in one pass.
+    // The distance to the neurite root is not part of the path
+    std::vector<float> path(n.size(), 0.);
+    std::vector<float> v;
+    v.reserve(n.node_count());
+    for(index_type b = 0; b < static_cast<index_type>(n.branch_count()); ++b){
+      index_type root = n.neurite_root(n.branch_neurite(b));
+      for(index_type i = n.branch_begin(b); i < n.branch_end(b); ++i){
+        index_type p = n.parent(i);
+        if(p != CompactNeuron::npos && p != root)
+          path[i] = path[p] + n.distance(i,p);
+        v.push_back(path[i]);
+      }
+    }
+    return detail::all_aggr(v);
+  };
+
+  const auto branch_order = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<int>(n, detail::all_branches,
+      [](const CompactNeuron& n, index_type b){ return n.branch_order(b); });
+    return detail::all_aggr(v);
+  };
+
+  const auto terminal_degree = [](const CompactNeuron& n) {
+    auto tips = detail::subtree_tips(n);
+    // As in selector::node_subtree_terminals, terminal branches count 0
+    auto v = detail::node_values<int>(n, [&tips](const CompactNeuron& n, index_type, index_type b){
+      return n.branch_children(b) == 0 ? 0 : tips[b];
+    });
+    return detail::all_aggr(v);
+  };
+
+  // Burker taper rate
+  const auto taper_1 = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::all_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_size(b) == 0) return NAN;
+        index_type first = n.branch_root(b);
+        if(first == CompactNeuron::npos) first = n.branch_begin(b);
+        index_type last = n.branch_end(b)-1;
+        float dist = n.distance(first, last);
+        if(dist == 0.0) return NAN;
+        else return 2*(n.radius(first) - n.radius(last))/dist;
+      });
+    return detail::all_aggr(v);
+  };
+
+  // Hillman taper rate
+  const auto taper_2 = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::all_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_size(b) == 0) return NAN;
+        index_type first = n.branch_root(b);
+        if(first == CompactNeuron::npos) first = n.branch_begin(b);
+        index_type last = n.branch_end(b)-1;
+        if(n.radius(first) == n.radius(last)) return 0.0;
+        else if(n.radius(first) == 0.0) return NAN;
+        else return (n.radius(first) - n.radius(last))/n.radius(first);
+      });
+    return detail::all_aggr(v);
+  };
+
+  namespace detail {
+    // Branch length (from its root, if any)
+    inline float branch_length(const CompactNeuron& n, index_type b){
+      if(n.branch_size(b) == 0) return NAN;
+      index_type i = n.branch_begin(b);
+      float len = n.branch_root(b) == CompactNeuron::npos ? 0. : n.distance(i, n.branch_root(b));
+      for(++i ; i < n.branch_end(b); ++i) len += n.distance(i, i-1);
+      return len;
+    }
+  } // Detail namespace
+
+  const auto branch_pathlength = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::all_branches, detail::branch_length);
+    return detail::all_aggr(v);
+  };
+
+  const auto contraction = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::all_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_size(b) == 0) return NAN;
+        index_type first = n.branch_root(b);
+        if(first == CompactNeuron::npos) first = n.branch_begin(b);
+        float d = n.distance(n.branch_end(b)-1, first);
+        if(d == 0) return 1.;
+        else return detail::branch_length(n,b) / d;
+      });
+    return detail::all_aggr(v);
+  };
+
+  const auto fragmentation = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<int>(n, detail::all_branches,
+      [](const CompactNeuron& n, index_type b){ return static_cast<int>(n.branch_size(b)); });
+    return detail::all_aggr(v);
+  };
+
+  const auto partition_asymmetry = [](const CompactNeuron& n) {
+    auto tips = detail::subtree_tips(n);
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [&tips](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_children(b) < 2) return NAN;
+        index_type ca = n.branch_first_child(b);
+        long n1 = tips[ca];
+        long n2 = tips[n.branch_next_sibling(ca)];
+        if(n1 == n2) return 0;
+        else return std::abs(n1 - n2) / (n1 + n2 - 2);
+      });
+    return detail::all_aggr(v);
+  };
+
+  namespace detail {
+    inline float rall_power_fit(const CompactNeuron& n, index_type b, float min, float max){
+      auto d = bifurcation_diameters(n,b);
+      if(std::isnan(d[0])) return NAN;
+      auto aux_fun = [p_ = d[0], a_ = d[1], b_ = d[2]](float r) -> float {
+        return std::pow(std::pow(p_,r) - std::pow(a_,r) - std::pow(b_,r) ,2);
+      };
+      return boost::math::tools::brent_find_minima(aux_fun, min, max,
+                                                   std::numeric_limits<float>::digits).first;
+    }
+
+    inline float pk(const CompactNeuron& n, index_type b, float r){
+      auto d = bifurcation_diameters(n,b);
+      return (std::pow(d[1],r) + std::pow(d[2],r))/std::pow(d[0],r);
+    }
+  } // Detail namespace
+
+  const auto rall_power = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_children(b) < 2) return NAN;
+        return detail::rall_power_fit(n, b, 0, 5);
+      });
+    return detail::all_aggr(v);
+  };
+
+  const auto pk = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_children(b) < 2) return NAN;
+        return detail::pk(n, b, detail::rall_power_fit(n, b, 0, 5));
+      });
+    return detail::all_aggr(v);
+  };
+
+  const auto pk_classic = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_children(b) < 2) return NAN;
+        return detail::pk(n, b, 1.5);
+      });
+    return detail::all_aggr(v);
+  };
+
+  const auto pk_2 = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [](const CompactNeuron& n, index_type b) -> float {
+        if(n.branch_children(b) < 2) return NAN;
+        return detail::pk(n, b, 2);
+      });
+    return detail::all_aggr(v);
+  };
+
+  namespace detail {
+    // Angle between the vectors from the bifurcation point to a node in
+    // each of the first two children (first or last node)
+    inline float bifurcation_angle(const CompactNeuron& n, index_type b, bool remote){
+      if(n.branch_size(b) == 0 || n.branch_children(b) < 2) return NAN;
+      index_type ca = n.branch_first_child(b);
+      index_type cb = n.branch_next_sibling(ca);
+      if(n.branch_size(ca) == 0 || n.branch_size(cb) == 0) return NAN;
+      index_type last = n.branch_end(b)-1;
+      index_type na = remote ? n.branch_end(ca)-1 : n.branch_begin(ca);
+      index_type nb = remote ? n.branch_end(cb)-1 : n.branch_begin(cb);
+      return geometry::vector_vector_angle(vector_to(n, last, na),
+                                           vector_to(n, last, nb));
+    }
+  } // Detail namespace
+
+  const auto bif_ampl_local = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [](const CompactNeuron& n, index_type b){ return detail::bifurcation_angle(n, b, false); });
+    return detail::all_aggr(v);
+  };
+
+  const auto bif_ampl_remote = [](const CompactNeuron& n) {
+    auto v = detail::branch_values<float>(n, detail::non_terminal_branches,
+      [](const CompactNeuron& n, index_type b){ return detail::bifurcation_angle(n, b, true); });
+    return detail::all_aggr(v);
+  };
+
+  const auto last_parent_diam = [](const CompactNeuron& n) {
+    std::vector<float> v;
+    std::vector<index_type> parents;
+    for(index_type k = 0; k < static_cast<index_type>(n.neurite_count()); ++k){
+      // Parent of each terminal branch, in leaf order. As
+      // selector::neurite_pre_terminal_branches, std::unique keeps the size
+      parents.clear();
+      for(index_type b = n.neurite_branch_begin(k); b < n.neurite_branch_end(k); ++b){
+        if(n.branch_children(b) == 0 && n.branch_parent(b) != CompactNeuron::npos)
+          parents.push_back(n.branch_parent(b));
+      }
+      std::unique(parents.begin(), parents.end());
+      
+      for(auto it = parents.begin(); it != parents.end(); ++it){
+        index_type p = detail::bifurcation_point(n, *it);
+        v.push_back(p == CompactNeuron::npos ? NAN : n.radius(p)*2);
+      }
+    }
+    return detail::all_aggr(v);
+  };
+
+} // compact
+} // lmeasure
+} // measure
+} // neurostr
+
+#endif
@@ -0,0 +1,153 @@
+#ifndef NEUROSTR_MEASURE_LMEASURE_ENGINE_H_
+#define NEUROSTR_MEASURE_LMEASURE_ENGINE_H_
+
+#include <bitset>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <neurostr/core/neuron.h>
+#include <neurostr/measure/aggregate.h>
+
+namespace neurostr{
+namespace measure{
+namespace lmeasure{
+
+/**
+ * @brief L-Measure identifiers. One for each measure in lmeasure_decl.h
+ */
+enum class LMeasure : int {
+  kSomaSurface = 0,
+  kNStems,
+  kNBifs,
+  kNBranch,
+  kNTips,
+  kWidth,
+  kHeight,
+  kDepth,
+  kDiameter,
+  kDiameterPow,
+  kLength,
+  kSurface,
+  kBranchSurface,
+  kSectionArea,
+  kVolume,
+  kBranchVolume,
+  kEucDistance,
+  kPathDistance,
+  kBranchOrder,
+  kTerminalDegree,
+  kTaper1,
+  kTaper2,
+  kBranchPathlength,
+  kContraction,
+  kFragmentation,
+  kDaughterRatio,
+  kPartitionAsymmetry,
+  kRallPower,
+  kPk,
+  kPkClassic,
+  kPk2,
+  kBifAmplLocal,
+  kBifAmplRemote,
+  kBifTiltLocal,
+  kBifTiltRemote,
+  kBifTorqueLocal,
+  kBifTorqueRemote,
+  kLastParentDiam,
+  kHillmanThreshold,
+  kFractalDim
+};
+
+/** Number of L-Measures */
+constexpr int lmeasure_count = static_cast<int>(LMeasure::kFractalDim) + 1;
+
+/**
+ * @brief Measure name (same as its lmeasure_decl.h declaration)
+ * @param m Measure
+ * @return Name
+ */
+const std::string& lmeasure_name(LMeasure m);
+
+std::ostream& operator<<(std::ostream& os, const LMeasure& m);
+
+/**
+ * @class Engine
+ * @brief Computes a set of L-Measures in a single traversal of the neuron.
+ *
+ * Values shared by several measures (compartment lengths, path distances,
+ * subtree terminal counts...) are computed once per node/branch. Results are
+ * the same as evaluating each lmeasure_decl.h measure on its own.
+ */
+class Engine {
+
+  public:
+
+  using summary_type = aggregate::aggr_pack<float,float>;
+
+  /**
+   * @brief Value of a single measure. Counts and ranges (n_bifs, width...)
+   * are scalar; the rest are summary stats over the selected elements
+   */
+  struct value_type {
+    value_type(LMeasure m);
+
+    LMeasure measure;
+    bool is_summary;
+    float value;
+    summary_type summary;
+  };
+
+  /**
+   * @brief Creates an engine that computes every L-Measure
+   */
+  Engine();
+
+  /**
+   * @brief Creates an engine that computes the given measures
+   * @param m Measure list. Output follows this order
+   */
+  explicit Engine(const std::vector<LMeasure>& m);
+
+  /**
+   * @brief Measure list
+   * @return Measures in output order
+   */
+  const std::vector<LMeasure>& measures() const { return measures_; }
+
+  /**
+   * @brief Whether summaries use the online aggregators
+   * @return True if online aggregation is enabled
+   */
+  bool online() const { return online_; }
+
+  /**
+   * @brief Enables online aggregation of the summaries. The median becomes
+   * a P-square estimate (exact up to five values) instead of the exact
+   * lmeasure_decl.h median. Disabled by default
+   * @param b Enable flag
+   * @return Engine reference
+   */
+  Engine& online(bool b) { online_ = b; return *this; }
+
+  /**
+   * @brief Computes the measure set
+   * @param n Neuron
+   * @return One value per measure, in the same order as measures()
+   */
+  std::vector<value_type> compute(const Neuron& n) const;
+
+  private:
+
+  bool enabled_(LMeasure m) const { return enabled_set_[static_cast<int>(m)]; }
+
+  std::vector<LMeasure> measures_;
+  std::bitset<lmeasure_count> enabled_set_;
+  bool online_;
+};
+
+} // lmeasure
+} // measure
+} // neurostr
+
+#endif
@@ -1,7 +1,12 @@
 #ifndef NEUROSTR_MEASURES_MEASURE_OPS_H_
 #define NEUROSTR_MEASURES_MEASURE_OPS_H_
 
+#include <cmath>
+#include <type_traits>
+#include <vector>
+
 #include <neurostr/measure/measure_traits.h>
+#include <neurostr/measure/aggregate.h>
 #include <neurostr/measure/aggregator_traits.h>
 
 #include <neurostr/measure/detail/compose_selector_measure_detail.h>
@@ -82,10 +87,62 @@ std::vector<long double>
   remove_nan_values<long double>( typename  std::vector<long double>::iterator b,  
                      typename  std::vector<long double>::iterator e);
 
+namespace detail {
+  
+  // isnan for floating point types, false otherwise
+  template <typename T>
+  bool is_nan_value_(const T&, std::false_type){ return false; }
+  
+  template <typename T>
+  bool is_nan_value_(const T& v, std::true_type){ return std::isnan(v); }
+  
+  template <typename T>
+  bool is_nan_value(const T& v){ 
+    return is_nan_value_(v, std::is_floating_point<T>{}); 
+  }
+  
+  // Range aggregator: values are stored and then aggregated
+  template <typename Out, typename Fn, typename Aggr, typename Iter>
+  auto measure_each_aggregate_(const Fn& f, const Aggr& a, bool nan, 
+                               const Iter& b, const Iter& e, std::false_type){
+    std::vector<Out> ret;
+    
+    for (auto it = b ; it != e ; ++it) {
+      ret.emplace_back( f(it->get()) );
+    }
+    
+    // Remove NAN values before aggregate
+    if(nan){
+      ret = remove_nan_values<Out>(ret.begin(),ret.end());
+    }
+        
+    return a(ret.begin(), ret.end());
+  }
+  
+  // Online aggregator: values are pushed as they are computed
+  template <typename Out, typename Fn, typename Aggr, typename Iter>
+  auto measure_each_aggregate_(const Fn& f, const Aggr& a, bool nan, 
+                               const Iter& b, const Iter& e, std::true_type){
+    Aggr acc(a);
+    acc.reset();
+    
+    for (auto it = b ; it != e ; ++it) {
+      Out v = f(it->get());
+      if(!nan || !is_nan_value(v)){
+        acc.push(v);
+      }
+    }
+    
+    return acc.result();
+  }
+  
+} // detail
+
 /**
  * @brief Convert a single-input measure into a set measure that applies the
  * original measure to each element of the input set and then aggregates the 
- * output.
+ * output. Online aggregators (aggregate::online_all_aggr...) consume the values
+ * as they are computed, without storing them.
  * 
  * @param f Original single-input measure
  * @param aggr Aggregator function
@@ -105,23 +162,13 @@ auto measureEachAggregate(const Fn& f, const Aggr& aggr, bool removeNaN = true){
   
   // Types
   using iterator_type = typename std::vector< detail::measure_fn_reference<Fn> >::iterator;
+  using online = aggregate::is_online_aggregator<Aggr>;
                           
   // Return (create) function
   return [f_ = f, a_ = aggr, nan_ = removeNaN](const iterator_type& b, const iterator_type& e ) 
                             ->  typename aggr_traits::out_type {
-    
-    std::vector<typename measure_traits::out_type> ret;
-    
-    for (auto it = b ; it != e ; ++it) {
-      ret.emplace_back( f_(it->get()) );
-    }
-    
-    // Remove NAN values before aggregate
-    if(nan_){
-      ret = remove_nan_values<typename measure_traits::out_type>(ret.begin(),ret.end());
-    }
-        
-    return a_(ret.begin(), ret.end());
+    return detail::measure_each_aggregate_<typename measure_traits::out_type>(
+              f_, a_, nan_, b, e, online{});
   };
 };
 
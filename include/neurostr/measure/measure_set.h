@@ -0,0 +1,106 @@
+#ifndef NEUROSTR_MEASURE_MEASURE_SET_H_
+#define NEUROSTR_MEASURE_MEASURE_SET_H_
+
+#include <array>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace neurostr {
+namespace measure {
+
+/**
+ * @brief Measure with its output (column) name
+ */
+template <typename F>
+struct named_measure {
+  const char* name;
+  F f;
+};
+
+/**
+ * @brief Creates a named measure
+ * @param name Column name
+ * @param f Measure. Its result is converted to float
+ * @return Named measure
+ */
+template <typename F>
+named_measure<typename std::decay<F>::type> named(const char* name, F&& f){
+  return named_measure<typename std::decay<F>::type>{name, std::forward<F>(f)};
+}
+
+/**
+ * @class MeasureSet
+ * @file measure_set.h
+ * @brief Fixed list of measures over the same element type. Measures are
+ * stored in a tuple, so the list and every call are resolved at compile time,
+ * and values are written straight into an output row (float*, a ColumnTable
+ * row or anything with operator[]) without intermediate containers.
+ */
+template <typename... Fs>
+class MeasureSet {
+
+  public:
+
+  /**
+   * @brief Creates the set
+   * @param m Named measures. Output follows this order
+   */
+  explicit MeasureSet(named_measure<Fs>... m)
+    : names_{{m.name...}}, measures_(m.f...) {}
+
+  /**
+   * @brief Number of measures
+   */
+  static constexpr std::size_t size() { return sizeof...(Fs); }
+
+  /**
+   * @brief Measure names in output order
+   */
+  const std::array<const char*, sizeof...(Fs)>& names() const { return names_; }
+
+  /**
+   * @brief Measure names as strings (ColumnTable columns)
+   */
+  std::vector<std::string> column_names() const {
+    return std::vector<std::string>(names_.begin(), names_.end());
+  }
+
+  /**
+   * @brief Computes every measure and writes the values in order
+   * @param e Element
+   * @param out Output row. out[i] receives the i-th measure
+   */
+  template <typename T, typename Row>
+  void operator()(const T& e, Row&& out) const {
+    apply_(e, out, std::index_sequence_for<Fs...>());
+  }
+
+  private:
+
+  template <typename T, typename Row, std::size_t... I>
+  void apply_(const T& e, Row& out, std::index_sequence<I...>) const {
+    using expand = int[];
+    (void) expand{0, ((out[I] = static_cast<float>(std::get<I>(measures_)(e))), 0)...};
+  }
+
+  std::array<const char*, sizeof...(Fs)> names_;
+  std::tuple<Fs...> measures_;
+};
+
+/**
+ * @brief Creates a measure set
+ * @param m Named measures (see named)
+ * @return Measure set
+ */
+template <typename... Fs>
+MeasureSet<Fs...> make_measure_set(named_measure<Fs>... m){
+  return MeasureSet<Fs...>(m...);
+}
+
+} // measure
+} // neurostr
+
+#endif
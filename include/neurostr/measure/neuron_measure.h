@@ -25,7 +25,7 @@ const auto has_soma = [](const Neuron& i) -> bool {
   return i.has_soma();
 };
 
-auto neuron_neurite_count = [](const Neuron &n){
+const auto neuron_neurite_count = [](const Neuron &n){
   return n.size();
 };
 
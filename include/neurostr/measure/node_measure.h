@@ -351,6 +351,28 @@ const auto node_set_fractal_dim = [](const const_node_iterator& b,
                                        
 };
 
+/**
+ * @brief Fills the lazily computed node values (parent, length and local
+ * basis) of every node in the neuron, branch roots included, and the branch
+ * path ids. Measures and validators write them on first use, so this has to
+ * be called before they run concurrently on the same neuron
+ */
+const auto fill_node_caches = [](const Neuron& n) -> void {
+  auto fill = [&n](const Node& node){
+    const Node& parent = selector::node_parent(node);
+    node.length();
+    node.local_basis(parent, n.up());
+  };
+  
+  for(auto ne = n.begin_neurite(); ne != n.end_neurite(); ++ne){
+    for(auto b = ne->begin_branch(); b != ne->end_branch(); ++b){
+      b->id();
+      if(b->has_root()) fill(b->root());
+      for(auto it = b->begin(); it != b->end(); ++it) fill(*it);
+    }
+  }
+};
+
 } // Measure ns
 } // Neurostr ns
 
@@ -1,10 +1,12 @@
 #ifndef NEUROSTR_METHOD_BRANCHCOMPARISON_H_
 #define NEUROSTR_METHOD_BRANCHCOMPARISON_H_
 
+#include <limits>
 #include <vector>
 
 #include <neurostr/core/branch.h>
 #include <neurostr/core/neuron.h>
+#include <neurostr/core/thread_pool.h>
 
 #include <neurostr/selector/selector.h>
 #include <neurostr/selector/node_selector.h>
@@ -20,10 +22,39 @@ namespace neurostr {
 namespace methods {
   
   // align branches and computes theri f. dist
-  float oriented_frechet_branch_distance(const Branch &a, const  Branch &b, bool normalize = false);
+  // If it is greater than bound, returns a value greater than bound (not the distance)
+  float oriented_frechet_branch_distance(const Branch &a, const  Branch &b, bool normalize = false,
+                                         float bound = std::numeric_limits<float>::infinity());
   
-  std::vector<float> inter_pair_distance( Neuron& n , bool restrict_order = false, bool sided = false  );
-  std::vector<std::vector<float>> inter_pair_distance_byorder( Neuron& n, bool sided = false);
+  /**
+   * @brief Oriented frechet distance between every pair of branches in the
+   * neuron (row-major order). Each branch is prepared once, and the pair
+   * matrix is split in tiles computed concurrently if a pool is given
+   * @param n Neuron
+   * @param restrict_order Only pairs with the same order (grouped by order)
+   * @param sided Only pairs with the same side (index among its siblings)
+   * when restrict_order is set
+   * @param pool Thread pool for the tiles (nullptr: sequential)
+   * @param threshold Greater distances are reported as infinity. Pairs are
+   * discarded early by cheap lower bounds if it is finite
+   * @return Pair distances
+   */
+  std::vector<float> inter_pair_distance( const Neuron& n , bool restrict_order = false, bool sided = false,
+                                          ThreadPool* pool = nullptr,
+                                          float threshold = std::numeric_limits<float>::infinity() );
+  
+  /**
+   * @brief Same as inter_pair_distance with restrict_order, but with a
+   * separate vector for each order
+   * @param n Neuron
+   * @param sided Only pairs with the same side
+   * @param pool Thread pool for the tiles (nullptr: sequential)
+   * @param threshold Greater distances are reported as infinity
+   * @return Pair distances by order
+   */
+  std::vector<std::vector<float>> inter_pair_distance_byorder( const Neuron& n, bool sided = false,
+                                                               ThreadPool* pool = nullptr,
+                                                               float threshold = std::numeric_limits<float>::infinity() );
   
 } // Selector
 } // Neurostr
@@ -0,0 +1,75 @@
+#ifndef NEUROSTR_METHODS_BRANCHINDEX_H_
+#define NEUROSTR_METHODS_BRANCHINDEX_H_
+
+#include <vector>
+#include <utility>
+#include <unordered_map>
+
+#include <boost/geometry/index/rtree.hpp>
+
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/branch.h>
+#include <neurostr/core/neuron.h>
+
+namespace neurostr {
+namespace methods {
+
+/**
+ * @class BranchIndex
+ * @brief Axis aligned bounding box tree (R-tree) over the branches of a neuron.
+ * Branch bounding boxes are computed once, at construction. The index keeps
+ * references to the branches: any structural change or node movement in the
+ * neuron invalidates it.
+ */
+class BranchIndex {
+
+  public:
+    
+    /**
+     * @brief Builds the index over every branch in the neuron
+     * @param n Neuron to index
+     */
+    BranchIndex(const Neuron& n);
+    
+    /**
+     * @brief Branches whose bounding box intersects the given branch box
+     * (other than b itself), in neuron traversal order (neurite, then branch)
+     * @param b Query branch
+     * @return Candidate branches
+     */
+    std::vector<const Branch*> candidates(const Branch& b) const;
+    
+    /**
+     * @brief First branch (in neuron traversal order) that collides with b.
+     * Same result as measure::branch_intersects_factory
+     * @param b Query branch
+     * @param ignore_radius If true, node radius is ignored
+     * @return Colliding branch or nullptr if there is none
+     */
+    const Branch* first_collision(const Branch& b, bool ignore_radius = false) const;
+    
+    /**
+     * @brief Number of indexed branches
+     * @return Branch count
+     */
+    std::size_t size() const { return branches_.size(); }
+    
+  private:
+    
+    using value_type = std::pair<geometry::box_type, std::size_t>;
+    using rtree_type = boost::geometry::index::rtree<value_type,
+                                                     boost::geometry::index::rstar<16>>;
+    
+    std::vector<const Branch*> branches_;  // Traversal order
+    std::vector<geometry::box_type> boxes_;
+    std::unordered_map<const Branch*, std::size_t> positions_;
+    rtree_type rtree_;
+    
+    // Bounding box of b - cached one if b is indexed
+    geometry::box_type box(const Branch& b) const;
+};
+
+} // methods
+} // neurostr
+
+#endif
@@ -0,0 +1,71 @@
+#ifndef NEUROSTR_METHODS_SEGMENTINDEX_H_
+#define NEUROSTR_METHODS_SEGMENTINDEX_H_
+
+#include <vector>
+#include <utility>
+
+#include <boost/geometry/index/rtree.hpp>
+
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/node.h>
+#include <neurostr/core/neuron.h>
+
+namespace neurostr {
+namespace methods {
+
+/**
+ * @class SegmentIndex
+ * @brief Spatial index (R-tree) over the segments (node - parent) of a neuron.
+ * Each segment is stored as its bounding box inflated by the mean radius of its
+ * two ends, so the box distance is a lower bound of the segment surface distance.
+ * The index keeps references to the nodes: any structural change
+ * or node movement in the neuron invalidates it.
+ */
+class SegmentIndex {
+
+  public:
+    
+    /**
+     * @brief Builds the index over every node segment in the neuron
+     * @param n Neuron to index
+     */
+    SegmentIndex(const Neuron& n);
+    
+    /**
+     * @brief Minimum distance between the segment ending in n and any other
+     * non-adjacent segment in the indexed neuron. Same result as
+     * measure::segment_distance_to_closest
+     * @param n Segment end node
+     * @return Minimum distance (0 when they collide)
+     */
+    float distance_to_closest(const Node& n) const;
+    
+    /**
+     * @brief Number of indexed segments
+     * @return Segment count
+     */
+    std::size_t size() const { return segments_.size(); }
+    
+  private:
+  
+    // Segment is defined by its end node and the parent node
+    struct segment {
+      const Node* node;
+      const Node* parent;
+    };
+    
+    using value_type = std::pair<geometry::box_type, std::size_t>;
+    using rtree_type = boost::geometry::index::rtree<value_type,
+                                                     boost::geometry::index::rstar<16>>;
+    
+    std::vector<segment> segments_;
+    rtree_type rtree_;
+    
+    // Segment bounding box inflated by the mean radius
+    static geometry::box_type segment_box(const Node& n, const Node& parent);
+};
+
+} // methods
+} // neurostr
+
+#endif
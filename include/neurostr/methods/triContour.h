@@ -182,7 +182,7 @@ namespace methods{
   
   /**
    * @brief Given an ordered set of Contours, joins them and creates a
-   * triangular-faced mesh
+   * triangular-faced mesh (with its face hierarchy built)
    * @param b Contour set begin
    * @param e Contour set end
    * @return Triangular faced mesh
@@ -217,6 +217,9 @@ namespace methods{
         mesh.add(*t_it);
     }
     
+    // Face hierarchy for the ray queries
+    mesh.build_index();
+    
     return mesh;
   }
   
@@ -228,6 +231,21 @@ namespace methods{
    */
   void reconstructionContourProcess( Reconstruction& r, const std::string& name, int component = 2, bool nointer_nodes = false);
   
+  /**
+   * @brief Applies reconstructionContourProcess for each contour name (in
+   * order). Meshes are built concurrently and neurites are classified
+   * concurrently; tags and virtual nodes are applied afterwards in the
+   * sequential order, so the result does not depend on the thread count
+   * @param r Reconstruction
+   * @param names Contour names
+   * @param component Contour plane normal component
+   * @param nointer_nodes If true, virtual nodes are not added
+   * @param nthreads Worker threads (0: one per core, 1: sequential)
+   */
+  void reconstructionContoursProcess( Reconstruction& r, const std::vector<std::string>& names,
+                                      int component = 2, bool nointer_nodes = false,
+                                      std::size_t nthreads = 0);
+  
   /**
    * @brief 
    * @param n
@@ -17,12 +17,12 @@ namespace selector {
  */
 
 // IN: Branch - Out: Neurite
-auto branch_neurite_selector = [](const Branch& b) -> const Neurite& {
+const auto branch_neurite_selector = [](const Branch& b) -> const Neurite& {
   return b.neurite();
 };
 
 // IN: Branch - Out: Branch
-auto branch_parent_selector = [](const Branch& b) -> const Branch& {
+const auto branch_parent_selector = [](const Branch& b) -> const Branch& {
   auto branch_it = b.neurite().find(b);
   if(branch_it.node->parent == nullptr){
     return b;
@@ -32,7 +32,7 @@ auto branch_parent_selector = [](const Branch& b) -> const Branch& {
 };
 
 // IN: Branch - Out: Branch
-auto branch_sibling_selector = [](const Branch& b) -> const Branch& {
+const auto branch_sibling_selector = [](const Branch& b) -> const Branch& {
   auto branch_it = b.neurite().find(b);
   if (branch_it.node->next_sibling != nullptr){
     return branch_it.node->next_sibling->data;
@@ -44,7 +44,7 @@ auto branch_sibling_selector = [](const Branch& b) -> const Branch& {
 };
 
 // IN: Branch - Out: Node
-auto branch_last_node_selector = [](const Branch& b) -> const Node& {
+const auto branch_last_node_selector = [](const Branch& b) -> const Node& {
   if (b.size() == 0)
     return b.root();
   else
@@ -52,7 +52,7 @@ auto branch_last_node_selector = [](const Branch& b) -> const Node& {
 };
 
 // IN: Branch - Out: Node
-auto branch_first_node_selector = [](const Branch& b) -> const Node& {
+const auto branch_first_node_selector = [](const Branch& b) -> const Node& {
   if (b.size() == 0)
     return  b.root();
   else
@@ -60,7 +60,7 @@ auto branch_first_node_selector = [](const Branch& b) -> const Node& {
 };
 
 // IN: Branch - Out: Node set
-auto branch_node_selector = [](const Branch& b) -> std::vector<const_node_reference> {
+const auto branch_node_selector = [](const Branch& b) -> std::vector<const_node_reference> {
   std::vector<const_node_reference> selection;
   for (auto it = b.begin(); it != b.end(); ++it) 
     selection.emplace_back(*it);
@@ -68,7 +68,7 @@ auto branch_node_selector = [](const Branch& b) -> std::vector<const_node_refere
 };
 
 // IN: Branch - Out: Branch SET
-auto branch_subtree_selector = [](const Branch &b) -> std::vector<const_branch_reference> {
+const auto branch_subtree_selector = [](const Branch &b) -> std::vector<const_branch_reference> {
   auto branch_it = b.neurite().find(b);
   std::vector<const_branch_reference> st;
   for (auto it =  b.neurite().begin_branch_subtree(branch_it); 
@@ -80,7 +80,7 @@ auto branch_subtree_selector = [](const Branch &b) -> std::vector<const_branch_r
 };
 
 // IN: Branch - Out: Branch SET
-auto branch_stem_selector = [](const Branch &b) -> std::vector<const_branch_reference> {
+const auto branch_stem_selector = [](const Branch &b) -> std::vector<const_branch_reference> {
   std::vector<const_branch_reference> st;
   auto branch_it = b.neurite().find(b);
   for (auto it =  b.neurite().begin_stem(branch_it);
@@ -19,20 +19,24 @@ const auto node_self = [](const Node& n) -> const Node& {
 
 const auto node_parent = [](const Node& n) -> const Node& {
   
+  // Non-first nodes parent is set eagerly by the branch
   if(n.valid_parent()) return n.parent();
   if(!n.valid_branch()) return n;
   
   // If node is root (if any)
   if(n.branch().has_root() && n == n.branch().root()){
-    // Find branch
-    auto branch_it = n.branch().neurite().find(n.branch());
-    if(branch_it.node->parent == nullptr){
+    // Parent branch (O(1) through the neurite tree node)
+    const Branch* parent = n.branch().parent_branch();
+    if(parent == nullptr){
       // No parent branch - no parent (poor node)
       return n;
-    }
-    else{
+    } else if(parent->size() >= 2){
       // Parent branch is the end-2th node
-      n.parent(&(*(branch_it.node->parent->data.end()-2)));
+      n.parent(&(*(parent->end()-2)));
+    } else if(parent->has_root()){
+      n.parent(&(parent->root()));
+    } else {
+      return n;
     }
   // Node is not the first
   }else if(n.branch().first() != n){
@@ -41,8 +45,8 @@ const auto node_parent = [](const Node& n) -> const Node& {
     n.parent(&(*it));
   // Node is the first
   } else {
-    auto branch_it = n.branch().neurite().find(n.branch());
-    if(branch_it.node->parent == nullptr){
+    const Branch* parent = n.branch().parent_branch();
+    if(parent == nullptr || parent->size() == 0){
       if(n.branch().has_root()){
         n.parent(&(n.branch().root()));
         return n.branch().root();
@@ -52,7 +56,7 @@ const auto node_parent = [](const Node& n) -> const Node& {
     }
     else{
       // Parent branch is the last node
-      n.parent(&(branch_it.node->parent->data.last()));
+      n.parent(&(parent->last()));
     }
   }
   
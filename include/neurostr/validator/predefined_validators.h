@@ -2,6 +2,7 @@
 #define NEUROSTR_VALIDATION_PREDEFINED_VALIDATORS_H_
 
 #include <string>
+#include <memory>
 
 #include <neurostr/selector/selector.h>
 
@@ -10,6 +11,9 @@
 #include <neurostr/measure/branch_measure.h>
 #include <neurostr/measure/neuron_measure.h>
 
+#include <neurostr/methods/segmentIndex.h>
+#include <neurostr/methods/branchIndex.h>
+
 #include <neurostr/validator/checks.h>
 #include <neurostr/validator/validator.h>
 
@@ -44,7 +48,7 @@ const auto neuron_has_soma =
 * @brief Neurite validator. Verifies that neurite reconstruction is not planar by
 * checking that its non-axis aligned box volume is over the minimum value (close to 0)
 **/
-auto planar_reconstruction_validator_factory(float min) {
+inline auto planar_reconstruction_validator_factory(float min) {
   return nv::create_validator( 
                               nm::selectorMeasureCompose(ns::neurite_node_selector, nm::box_volume),
                               nv::range_check_factory(min),
@@ -55,7 +59,7 @@ auto planar_reconstruction_validator_factory(float min) {
 /**
 * @brief Neuron validator. Checks that the number of dendrites in the neuron is in the range [min,max)
 **/
-auto dendrite_count_validator_factory(unsigned int min, unsigned int max) {
+inline auto dendrite_count_validator_factory(unsigned int min, unsigned int max) {
   return nv::create_validator(
                               nm::neuron_dendrite_counter,
                               nv::range_check_factory<unsigned int>(min, max),
@@ -67,7 +71,7 @@ auto dendrite_count_validator_factory(unsigned int min, unsigned int max) {
 * @brief Neuron validator. Checks that the number of apical dendrites in the neuron is not greater than 2
 * @param strict If true, Neurons with no apical dendrite are rejected
 **/
-auto apical_count_validator_factory(bool strict = false) {
+inline auto apical_count_validator_factory(bool strict = false) {
   if(strict) {
     return nv::create_validator(
                               nm::neuron_apical_counter,
@@ -87,7 +91,7 @@ auto apical_count_validator_factory(bool strict = false) {
 * @brief Neuron validator. Checks that the number of axons in the neuron is not greater than 2
 * @param strict If true, Neurons with no axon are rejected
 **/
-auto axon_count_validator_factory(bool strict = false) {
+inline auto axon_count_validator_factory(bool strict = false) {
   if(strict) {
     return nv::create_validator(
                               nm::neuron_axon_counter,
@@ -117,7 +121,7 @@ const auto no_trifurcations_validator = nv::create_validator(
  * checking that its tortuosity value is not equal to 1
  * @param min Minimum accepted tortuosity value
  */
-auto linear_branches_validator_factory(float min = 1.01) {
+inline auto linear_branches_validator_factory(float min = 1.01) {
     return nv::create_validator(
                          nm::tortuosity,
                          nv::range_check_factory<float>(min),
@@ -165,18 +169,55 @@ const auto segment_collision_validator =
                          "Segment collision validator",
                          "Fails when the distance between any two segments is too close to zero");
 
+/**
+ * @brief Node validator. Same as segment_collision_validator, but segment
+ * distances are computed through a spatial index built over the given neuron.
+ * The validator is only valid for that neuron (and while it is not modified)
+ * @param n Neuron to validate
+ */
+inline auto segment_collision_validator_factory(const Neuron& n){
+  auto index = std::make_shared<neurostr::methods::SegmentIndex>(n);
+  return nv::create_validator( [index](const Node& node) -> float {
+                                  return index->distance_to_closest(node);
+                                },
+                         nv::range_check_factory<float>(0.01),
+                         "Segment collision validator",
+                         "Fails when the distance between any two segments is too close to zero");
+}
+
 
 /**
  * @brief Branch validator. Check that the Branch dont collide with any other branch in the neuron
  * @param ignore_diams If true, node diameter value are ignored
  */
-auto branch_collision_validator_factory(bool ignore_diams=false){
+inline auto branch_collision_validator_factory(bool ignore_diams=false){
   return nv::create_validator(  nm::branch_intersects_factory(ignore_diams),
                          nv::empty_string,
                          "Branch collision validator",
                          "Fails when the distance between any two branches is zero");
 }
 
+/**
+ * @brief Branch validator. Same as branch_collision_validator_factory(bool),
+ * but candidate branches are taken from a bounding box tree built once over
+ * the given neuron. The validator is only valid for that neuron (and while it
+ * is not modified)
+ * @param n Neuron to validate
+ * @param ignore_diams If true, node diameter value are ignored
+ */
+inline auto branch_collision_validator_factory(const Neuron& n, bool ignore_diams=false){
+  auto index = std::make_shared<neurostr::methods::BranchIndex>(n);
+  return nv::create_validator( [index, ignore_diams](const Branch& b) -> std::string {
+                                  if(!b.valid_neurite()) return std::string();
+                                  const Branch* other = index->first_collision(b, ignore_diams);
+                                  if(other == nullptr) return std::string();
+                                  return other->idString()+" @ Neurite: "+std::to_string(other->neurite().id());
+                                },
+                         nv::empty_string,
+                         "Branch collision validator",
+                         "Fails when the distance between any two branches is zero");
+}
+
 /**
 * @brief Node validator. Check that the elongation/bifurcation angle are not too high to be plausible
 */
@@ -0,0 +1,100 @@
+#ifndef NEUROSTR_VALIDATOR_VALIDATION_SUITE_H_
+#define NEUROSTR_VALIDATOR_VALIDATION_SUITE_H_
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <neurostr/core/neuron.h>
+#include <neurostr/validator/validator.h>
+
+namespace neurostr {
+namespace validator {
+
+/**
+ * @class ValidationSuite
+ * @file validation_suite.h
+ * @brief Set of validators that are run concurrently over the same neuron.
+ * Validators only read the neuron, so each one runs as an independent task.
+ * Results are kept in insertion order, so the output does not depend on the
+ * task scheduling.
+ */
+class ValidationSuite {
+  
+  public:
+  
+  /**
+   * @brief Creates an empty suite
+   * @param nthreads Maximum number of worker threads. 0 means one per
+   * hardware thread, 1 runs the validators sequentially
+   */
+  explicit ValidationSuite(std::size_t nthreads = 0);
+  
+  /**
+   * @brief Adds a copy of the validator to the suite
+   * @param v Validator
+   */
+  template <typename M, typename C>
+  void add(const Validator<M,C>& v){
+    validators_.emplace_back(new suite_entry<Validator<M,C>>(v));
+  }
+  
+  /**
+   * @brief Number of validators in the suite
+   * @return Validator count
+   */
+  std::size_t size() const { return validators_.size(); }
+  
+  /**
+   * @brief Runs every validator for the given neuron. If any validator
+   * throws, the first exception (in insertion order) is rethrown once every
+   * validator has finished
+   * @param n Neuron to be validated
+   */
+  void validate(const Neuron& n);
+  
+  /**
+   * @brief Check if all validators passed
+   * @return True if every validator passed
+   */
+  bool pass() const;
+  
+  /**
+   * @brief Writes the validators output as a JSON array, in insertion order
+   * @param os Output stream
+   * @param failuresOnly Write only failing ValidatorItem
+   * @return Stream
+   */
+  std::ostream& toJSON(std::ostream& os, bool failuresOnly = true) const;
+  
+  private:
+  
+  // Type erasure for the validator templates
+  struct suite_entry_base {
+    virtual ~suite_entry_base() {}
+    virtual void validate(const Neuron& n) = 0;
+    virtual bool pass() const = 0;
+    virtual std::ostream& toJSON(std::ostream& os, bool failuresOnly) const = 0;
+  };
+  
+  template <typename V>
+  struct suite_entry : public suite_entry_base {
+    V validator;
+    
+    suite_entry(const V& v) : validator(v) {}
+    
+    void validate(const Neuron& n) { validator.validate(n); }
+    bool pass() const { return validator.pass(); }
+    std::ostream& toJSON(std::ostream& os, bool failuresOnly) const {
+      return validator.toJSON(os, failuresOnly);
+    }
+  };
+  
+  std::vector<std::unique_ptr<suite_entry_base>> validators_;
+  std::size_t nthreads_;
+};
+
+}  // validation
+}  // neurostr
+
+#endif
@@ -0,0 +1,141 @@
+#include <neurostr/core/arena.h>
+
+#include <algorithm>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+
+namespace neurostr {
+
+namespace {
+
+  // Active arena in this thread
+  thread_local Arena* current_arena = nullptr;
+
+  constexpr std::size_t align_up(std::size_t n){
+    return (n + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+  }
+
+  // Arena chunk address range
+  struct chunk_range {
+    const char* begin;
+    const char* end;
+    Arena* arena;
+  };
+
+  // Chunks of every live arena, sorted by address. Blocks carry no header:
+  // the owner of a block is found by its address. The registry is never
+  // destroyed, so elements can be freed during static destruction
+  struct chunk_registry {
+    std::shared_timed_mutex mutex;
+    std::vector<chunk_range> chunks;
+    std::atomic<std::size_t> size{0};
+  };
+
+  chunk_registry& registry(){
+    static chunk_registry* r = new chunk_registry();
+    return *r;
+  }
+
+  void register_chunk(const char* c, std::size_t n, Arena* a){
+    chunk_registry& r = registry();
+    std::unique_lock<std::shared_timed_mutex> lock(r.mutex);
+    auto it = std::upper_bound(r.chunks.begin(), r.chunks.end(), c,
+                               [](const char* p, const chunk_range& ch){ return std::less<const char*>()(p, ch.begin); });
+    r.chunks.insert(it, chunk_range{c, c + n, a});
+    r.size.store(r.chunks.size(), std::memory_order_release);
+  }
+
+  void unregister_chunks(const Arena* a){
+    chunk_registry& r = registry();
+    std::unique_lock<std::shared_timed_mutex> lock(r.mutex);
+    r.chunks.erase(std::remove_if(r.chunks.begin(), r.chunks.end(),
+                                  [a](const chunk_range& ch){ return ch.arena == a; }),
+                   r.chunks.end());
+    r.size.store(r.chunks.size(), std::memory_order_release);
+  }
+
+  // Arena that owns the block (nullptr: heap)
+  Arena* find_owner(const void* p){
+    chunk_registry& r = registry();
+    // No arenas - every block is in the heap
+    if(r.size.load(std::memory_order_acquire) == 0) return nullptr;
+
+    const char* c = static_cast<const char*>(p);
+    std::shared_lock<std::shared_timed_mutex> lock(r.mutex);
+    auto it = std::upper_bound(r.chunks.begin(), r.chunks.end(), c,
+                               [](const char* q, const chunk_range& ch){ return std::less<const char*>()(q, ch.begin); });
+    if(it == r.chunks.begin()) return nullptr;
+    --it;
+    return std::less<const char*>()(c, it->end) ? it->arena : nullptr;
+  }
+
+} // anonymous
+
+std::shared_ptr<Arena> Arena::create(std::size_t chunk_size){
+  return std::shared_ptr<Arena>(new Arena(chunk_size), [](Arena* a){ a->unref_(); });
+}
+
+Arena::Arena(std::size_t chunk_size)
+  : chunk_size_(align_up(std::max<std::size_t>(chunk_size, alignof(std::max_align_t))))
+  , chunks_()
+  , pos_(nullptr)
+  , end_(nullptr)
+  , reserved_(0)
+  , refs_(1) {}
+
+Arena::~Arena(){
+  unregister_chunks(this);
+  for(auto c : chunks_) ::operator delete(c);
+}
+
+Arena* Arena::current(){
+  return current_arena;
+}
+
+void* Arena::bump_(std::size_t n){
+  if(pos_ == nullptr || static_cast<std::size_t>(end_ - pos_) < n){
+    // Big blocks get their own chunk, the current one is kept
+    std::size_t size = std::max(n, chunk_size_);
+    char* c = static_cast<char*>(::operator new(size));
+    chunks_.push_back(c);
+    register_chunk(c, size, this);
+    reserved_ += size;
+    if(size > chunk_size_) return c;
+    pos_ = c;
+    end_ = c + size;
+  }
+  char* ret = pos_;
+  pos_ += n;
+  return ret;
+}
+
+void Arena::unref_() noexcept {
+  if(refs_.fetch_sub(1) == 1) delete this;
+}
+
+void* Arena::allocate(std::size_t n){
+  Arena* a = current_arena;
+  if(a == nullptr) return ::operator new(n);
+
+  void* block = a->bump_(align_up(n == 0 ? 1 : n));
+  a->refs_.fetch_add(1, std::memory_order_relaxed);
+  return block;
+}
+
+void Arena::deallocate(void* p) noexcept {
+  if(p == nullptr) return;
+  Arena* a = find_owner(p);
+  if(a == nullptr) ::operator delete(p);
+  else a->unref_();
+}
+
+ArenaScope::ArenaScope(Arena* a) : previous_(current_arena) {
+  current_arena = a;
+}
+
+ArenaScope::~ArenaScope(){
+  current_arena = previous_;
+}
+
+} // namespace neurostr
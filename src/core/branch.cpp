@@ -1,6 +1,9 @@
 #include <neurostr/core/branch.h>
+#include <neurostr/core/neurite.h>
 #include <iostream>
 #include <ios>
+#include <cmath>
+#include <limits>
 
 namespace neurostr{
  
@@ -19,8 +22,12 @@ namespace neurostr{
    */
   Branch::Branch() 
     : WithProperties()
-    , id_()
+    , number_(-1)
+    , position_(-1)
     , neurite_(nullptr)
+    , tree_node_ptr_(nullptr)
+    , id_()
+    , id_version_(0)
     , order_(-1)
     , root_(nullptr)
     , nodes_() {};
@@ -33,8 +40,12 @@ namespace neurostr{
    */
   Branch::Branch(const Branch::id_type& id, int order) 
     : WithProperties()
-    , id_(id)
+    , number_(-1)
+    , position_(id.empty() ? -1 : id.back())
     , neurite_(nullptr)
+    , tree_node_ptr_(nullptr)
+    , id_()
+    , id_version_(0)
     , order_(order)
     , root_(nullptr)
     , nodes_() {
@@ -49,11 +60,16 @@ namespace neurostr{
    */
   Branch::Branch(const Branch::id_type& id, int order, const Node& root)
       : WithProperties()
-      , id_(id)
+      , number_(-1)
+      , position_(id.empty() ? -1 : id.back())
       , neurite_(nullptr)
+      , tree_node_ptr_(nullptr)
+      , id_()
+      , id_version_(0)
       , order_(order)
       , root_(new Node(root) ) {
         root_->branch(this);
+        root_->parent(nullptr);
   };
   
   /**
@@ -67,17 +83,23 @@ namespace neurostr{
   Branch::Branch(const Branch::id_type& id, int order, 
          const Node& root, const std::vector<Node>& nodes)
       : WithProperties()
-      , id_(id)
+      , number_(-1)
+      , position_(id.empty() ? -1 : id.back())
       , neurite_(nullptr)
+      , tree_node_ptr_(nullptr)
+      , id_()
+      , id_version_(0)
       , order_(order)
       , root_(new Node(root))
       , nodes_() {
         root_->branch(this);
+        root_->parent(nullptr);
         for(auto it = std::begin(nodes); it != std::end(nodes); ++it ){
           Node* tmp = new Node(*it);
           tmp->branch(this);
           nodes_.emplace_back(tmp);
         }
+        update_nodes_parent_(0, nodes_.size());
   };
   
   const Neurite& Branch::neurite() const { 
@@ -96,10 +118,57 @@ namespace neurostr{
    * @return Update branch reference
    */
   Branch& Branch::id(const Branch::id_type& id) {
-    id_ = id;
+    return position(id.empty() ? -1 : id.back());
+  }
+  
+  Branch& Branch::position(int p) {
+    position_ = p;
+    // Our id and the ids of our descendants change
+    id_version_ = 0;
+    if(neurite_ != nullptr) ++neurite_->tree_version_;
     return *this;
   }
   
+  Branch& Branch::number(Branch::number_type n) {
+    number_ = n;
+    return *this;
+  }
+  
+  const Branch::id_type& Branch::id() const {
+    // Detached branches have no tree to change: version 1 is always valid
+    std::size_t version = (neurite_ == nullptr) ? 1 : neurite_->tree_version_;
+    if(id_version_ == version) return id_;
+    
+    id_.clear();
+    if(position_ != -1){
+      for(const Branch* b = this; b != nullptr; b = b->tree_parent_()){
+        id_.push_back(b->position_);
+      }
+      std::reverse(id_.begin(), id_.end());
+    }
+    id_version_ = version;
+    return id_;
+  }
+  
+  bool Branch::same_id_(const Branch& other) const {
+    if(position_ == -1 || other.position_ == -1)
+      return position_ == other.position_;
+    
+    const Branch* a = this;
+    const Branch* b = &other;
+    while(a != nullptr && b != nullptr){
+      if(a->position_ != b->position_) return false;
+      a = a->tree_parent_();
+      b = b->tree_parent_();
+    }
+    return a == b;
+  }
+  
+  const Branch* Branch::tree_parent_() const {
+    if(tree_node_ptr_ == nullptr || tree_node_ptr_->parent == nullptr) return nullptr;
+    else return &(tree_node_ptr_->parent->data);
+  }
+  
   
   /**
    * @brief Set branch centrifugal order
@@ -118,9 +187,53 @@ namespace neurostr{
    */
   Branch& Branch::neurite(Neurite* n) {
     neurite_ = n;
+    id_version_ = 0;
     return *this;
   }
   
+  Branch& Branch::tree_node(tree_node_<Branch>* n) {
+    tree_node_ptr_ = n;
+    id_version_ = 0;
+    invalidate_first_parent();
+    return *this;
+  }
+  
+  const Branch* Branch::parent_branch() const {
+    if(tree_node_ptr_ != nullptr) return tree_parent_();
+    
+    // Not linked - search it in the neurite
+    if(neurite_ == nullptr) return nullptr;
+    auto it = neurite_->find(*this);
+    if(it.node == nullptr || it.node->parent == nullptr) return nullptr;
+    else return &(it.node->parent->data);
+  }
+  
+  void Branch::invalidate_first_parent() const {
+    if(root_.get() != nullptr)
+      root_->parent(nullptr);
+    if(nodes_.size() > 0)
+      nodes_.front()->parent(nullptr);
+  }
+  
+  void Branch::update_nodes_parent_(size_type from, size_type to) {
+    to = std::min(to, nodes_.size());
+    for(size_type i = from; i < to; ++i){
+      if(i == 0){
+        nodes_[i]->parent(nullptr);
+      } else {
+        const Node* p = nodes_[i-1].get();
+        if(!nodes_[i]->valid_parent() || &(nodes_[i]->parent()) != p)
+          nodes_[i]->parent(p);
+      }
+    }
+  }
+  
+  void Branch::invalidate_children_parent_() const {
+    if(tree_node_ptr_ == nullptr) return;
+    for(auto ch = tree_node_ptr_->first_child; ch != nullptr; ch = ch->next_sibling)
+      ch->data.invalidate_first_parent();
+  }
+  
   
   /**
    * @brief Get root node reference
@@ -206,6 +319,8 @@ namespace neurostr{
     Node* ncopy = new Node(n);
     ncopy->branch(this);
     nodes_.emplace_back(ncopy); 
+    update_nodes_parent_(nodes_.size()-1, nodes_.size());
+    invalidate_children_parent_();
   }
   
   /**
@@ -215,6 +330,8 @@ namespace neurostr{
   void Branch::push_back(Node&& n) { 
     n.branch(this);
     nodes_.emplace_back(new Node(n));
+    update_nodes_parent_(nodes_.size()-1, nodes_.size());
+    invalidate_children_parent_();
   }
 
   /**
@@ -230,12 +347,19 @@ namespace neurostr{
     }
     Node* ncopy = new Node(n);
     ncopy->branch(this);
-    return (nodes_.emplace(pos.base(), ncopy));
+    auto ret = nodes_.emplace(pos.base(), ncopy);
+    
+    // Inserted node and the next one
+    size_type idx = std::distance(nodes_.begin(), ret);
+    update_nodes_parent_(idx, idx + 2);
+    invalidate_children_parent_();
+    return ret;
   }
   
   Branch Branch::split(const Branch::iterator& pos) {
     
-    Branch splitbranch{id_, order_+1};
+    Branch splitbranch;
+    splitbranch.order(order_+1);
     splitbranch.neurite(neurite_); // Set neurite
     
     if (pos == end() ){
@@ -257,11 +381,12 @@ namespace neurostr{
   }
  
  std::string Branch::idString() const {
-   if(id_.size() == 0){
+   id_type id = this->id();
+   if(id.size() == 0){
      return std::string();
    } else {
-    std::string ret = std::to_string(*(id_.begin()));
-    for( auto it = ++id_.begin(); it != id_.end() ; it++ ){
+    std::string ret = std::to_string(*(id.begin()));
+    for( auto it = ++id.begin(); it != id.end() ; it++ ){
      ret += std::string("-") + std::to_string(*it);
     }
     return ret;
@@ -404,10 +529,7 @@ std::ostream& operator<<(std::ostream& os, const Branch& b){
   os << padding << "Branch ";
   
   // Print id
-  os << *b.id().begin();
-  for( auto it = ++b.id().cbegin(); it != b.id().cend() ; it++ )
-    os << "-" << *it;
-  os << std::endl;
+  os << b.idString() << std::endl;
   // Print order
   os << padding << "\t order: " << b.order() << std::endl;
   
@@ -441,6 +563,9 @@ std::ostream& operator<<(std::ostream& os, const Branch& b){
       } else {
         next->parent(nullptr);
       }
+    } else {
+      // Our last node changes
+      invalidate_children_parent_();
     }
     return nodes_.erase(pos.base());
   }
@@ -449,9 +574,16 @@ std::ostream& operator<<(std::ostream& os, const Branch& b){
     if( last != end() ){
       last->invalidate_basis();
       last->invalidate_length();
+    } else if (first != last) {
+      // Our last node changes
+      invalidate_children_parent_();
     }
     
-    return nodes_.erase(first.base(), last.base());
+    auto idx = std::distance(nodes_.begin(), first.base());
+    auto ret = nodes_.erase(first.base(), last.base());
+    if(ret != nodes_.end())
+      update_nodes_parent_(idx, idx + 1);
+    return ret;
   }
   
   // Transformations
@@ -461,32 +593,47 @@ std::ostream& operator<<(std::ostream& os, const Branch& b){
       return;
       
     } else if(eps < 0) {
-      eps = (-eps) * (root_->radius() + last().radius() ) / 2.0 ;
+      const Node& ini = has_root() ? *root_ : first();
+      eps = (-eps) * (ini.radius() + last().radius() ) / 2.0 ;
     }
     
-    std::vector<Node> tmp;
-    
-    // Add root
-    tmp.push_back(*root_);
-    
-    // Add nodes
-    tmp.insert(tmp.end(), begin(), end() );
+    // Line-segment positions (root included)
+    std::vector<point_type> line;
+    line.reserve(size() + 1);
+    if(has_root())
+      line.push_back(root_->position());
+    for(auto it = begin(); it != end() ; ++it ){
+      line.push_back(it->position());
+    }
     
     // RDP Simplification
-    geometry::RDPSimplifier<Node>(eps,tmp).simplify();
-    
-    // Remove nodes
-    auto ref = begin();
-    for(auto it = std::next(tmp.begin(),1); it != tmp.end(); ++it){
-      while(*ref != *it){
-        ref = erase(ref);
+    std::vector<bool> keep;
+    geometry::rdp_simplify(line, eps, keep);
+    
+    // Remove nodes at once. Kept nodes keep their addresses
+    size_type offset = has_root() ? 1 : 0;
+    const Node* first_parent = nodes_.front()->valid_parent() ? &(nodes_.front()->parent()) : nullptr;
+    bool removed = false;
+    size_type n = 0;
+    for(size_type i = 0; i < nodes_.size(); ++i){
+      if(!keep[i + offset]){
+        removed = true;
+        continue;
       }
       
-      if (ref != end()){
-        ++ref;
-      }
+      // Previous node changed
+      if(removed){
+        nodes_[i]->parent(n == 0 ? first_parent : nodes_[n-1].get());
+        removed = false;
+      }
+      if(n != i) nodes_[n] = std::move(nodes_[i]);
+      ++n;
     }
     
+    // Children first node depends on our last two nodes
+    if(!keep[line.size() - 1] || !keep[line.size() - 2])
+      invalidate_children_parent_();
+    nodes_.resize(n);
   }
   
   void Branch::scale(float r){
@@ -642,18 +789,33 @@ std::ostream& operator<<(std::ostream& os, const Branch& b){
         if(mindist <= 0.0 ) return 0.0;
       }
       
-      if (d < mindist) mindist = d;    }
+      if (d < mindist) mindist = d;
+    }
     
     return mindist;
   }
   
   float Branch::discrete_frechet(const Branch& other) const {
+    return discrete_frechet(other, std::numeric_limits<float>::infinity());
+  }
+  
+  float Branch::discrete_frechet(const Branch& other, float bound) const {
     
     using iter_type = std::vector<point_type>::const_iterator;
     
+    // Point and DP buffers, reused between calls in each thread
+    struct frechet_buffers {
+      std::vector<point_type> a;
+      std::vector<point_type> b;
+      geometry::DiscreteFrechet<iter_type,iter_type> frechet;
+    };
+    thread_local frechet_buffers buffers;
+    
     // Create point_type vectors to include root
-    std::vector<point_type> a;
-    std::vector<point_type> b;
+    std::vector<point_type>& a = buffers.a;
+    std::vector<point_type>& b = buffers.b;
+    a.clear();
+    b.clear();
     
     // Add roots
     if(has_root())
@@ -671,10 +833,11 @@ std::ostream& operator<<(std::ostream& os, const Branch& b){
     }
     
     // Compute discrete frechet
-    return geometry::DiscreteFrechet<iter_type,iter_type>(a.begin(),
-                                                          a.end(),
-                                                          b.begin(),
-                                                          b.end()).value();
+    buffers.frechet.reset(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+    
+    // Values that round to the bound are not abandoned, and abandoned values
+    // have to stay above the bound once rounded
+    return buffers.frechet.value(std::nextafter(bound, std::numeric_limits<float>::infinity()));
   }
 
       
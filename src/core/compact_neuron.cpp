@@ -0,0 +1,114 @@
+#include <neurostr/core/compact_neuron.h>
+
+#include <algorithm>
+#include <unordered_map>
+
+#include <neurostr/core/neuron.h>
+
+namespace neurostr {
+
+  constexpr CompactNeuron::index_type CompactNeuron::npos;
+
+  CompactNeuron::CompactNeuron(const Neuron& n)
+    : id_(n.id())
+    , soma_size_(0)
+    , node_count_(0) {
+
+    // Reserve memory
+    size_type npoints = std::distance(n.begin_soma(), n.end_soma());
+    size_type nbranches = 0;
+    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
+      npoints += it->node_count() + (it->has_root() ? 1 : 0);
+      nbranches += it->size();
+    }
+
+    x_.reserve(npoints);
+    y_.reserve(npoints);
+    z_.reserve(npoints);
+    r_.reserve(npoints);
+    parent_.reserve(npoints);
+    id_v_.reserve(npoints);
+
+    branch_begin_.reserve(nbranches);
+    branch_end_.reserve(nbranches);
+    branch_parent_.reserve(nbranches);
+    branch_subtree_end_.reserve(nbranches);
+    branch_neurite_.reserve(nbranches);
+    branch_order_.reserve(nbranches);
+    branch_children_.reserve(nbranches);
+
+    // Soma
+    for(auto it = n.begin_soma(); it != n.end_soma(); ++it){
+      push_point_(it->position(), it->radius(), it->id(), npos);
+    }
+    soma_size_ = size();
+
+    // Neurites
+    std::unordered_map<const Branch*, index_type> branch_pos;
+    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
+      index_type k = neurite_id_.size();
+      neurite_id_.push_back(it->id());
+      neurite_type_.push_back(it->type());
+      neurite_branch_begin_.push_back(branch_count());
+
+      index_type root = npos;
+      if(it->has_root()){
+        const Node& rn = it->root();
+        root = push_point_(rn.position(), rn.radius(), rn.id(), npos);
+      }
+      neurite_root_.push_back(root);
+
+      // Branches in pre-order
+      branch_pos.clear();
+      for(auto b_it = it->begin_branch(); b_it != it->end_branch(); ++b_it){
+        index_type b = branch_count();
+        branch_pos.emplace(&(*b_it), b);
+
+        index_type pb = npos;
+        if(b_it.node->parent != nullptr)
+          pb = branch_pos.at(&(b_it.node->parent->data));
+
+        // First node parent: last node in the closest non-empty ancestor
+        index_type prev = npos;
+        index_type q = pb;
+        while(q != npos && branch_size(q) == 0) q = branch_parent_[q];
+        if(q == npos) prev = root;
+        else prev = branch_end_[q]-1;
+
+        branch_begin_.push_back(size());
+        for(auto n_it = b_it->begin(); n_it != b_it->end(); ++n_it){
+          prev = push_point_(n_it->position(), n_it->radius(), n_it->id(), prev);
+        }
+        branch_end_.push_back(size());
+        node_count_ += b_it->size();
+
+        branch_parent_.push_back(pb);
+        branch_subtree_end_.push_back(b+1);
+        branch_neurite_.push_back(k);
+        branch_order_.push_back(b_it->order());
+        branch_children_.push_back(b_it.number_of_children());
+      }
+
+      // Subtree ends (children are always after their parent)
+      for(index_type b = branch_count() - 1; b >= neurite_branch_begin_.back(); --b){
+        index_type pb = branch_parent_[b];
+        if(pb != npos)
+          branch_subtree_end_[pb] = std::max(branch_subtree_end_[pb], branch_subtree_end_[b]);
+      }
+    }
+    neurite_branch_begin_.push_back(branch_count());
+  }
+
+  CompactNeuron::index_type CompactNeuron::push_point_(const point_type& p,
+                                                       float r, int id,
+                                                       index_type parent){
+    x_.push_back(geometry::get<0>(p));
+    y_.push_back(geometry::get<1>(p));
+    z_.push_back(geometry::get<2>(p));
+    r_.push_back(r);
+    id_v_.push_back(id);
+    parent_.push_back(parent);
+    return x_.size() - 1;
+  }
+
+} // neurostr
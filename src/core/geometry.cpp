@@ -1,5 +1,11 @@
 #include <neurostr/core/geometry.h>
 
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+#include <vector>
+
 namespace neurostr {
 namespace geometry {
   
@@ -569,18 +575,13 @@ bool within_triangle(const triangle_type& t, const point_type& p){
   
 }
 
-/**
-   * @brief Computes Triangle-ray intersection with the moller-trumbore algorithm
-   * @param t Triangle
-   * @param ray_o Ray origin
-   * @param ray_v Ray direction (Normalized)
-   * @param intersection Output: intersection point
-   * @return True if the ray intersects the triangle
-   */
-  bool triangle_ray_intersection( const triangle_type& t,
-                                  const point_type& ray_o,
-                                  const point_type& ray_v,
-                                  point_type& intersection ){
+namespace {
+  
+  // Moller-trumbore test. g is the hit distance in ray_v units
+  bool triangle_ray_hit( const triangle_type& t,
+                         const point_type& ray_o,
+                         const point_type& ray_v,
+                         float& g ){
   point_type e1 = t[1]; // Vector t0-t1
   point_type e2 = t[2]; // vector t0-t2
   
@@ -613,19 +614,78 @@ bool within_triangle(const triangle_type& t, const point_type& p){
     // Intersection outside triangle
     if( v < 0. || (u+v) > 1.) return false;
     
-    float g = bg::dot_product(e2,q) * inv_det;
-    if(g > 1E-6){
-      // g is the distance 
-      intersection = ray_v;
-      bg::multiply_value(intersection,g);
-      bg::add_point(intersection,ray_o);
-      return true;      
-    }
+    g = bg::dot_product(e2,q) * inv_det;
     
-    // No hit
-    return false;
+    // g is the distance. Otherwise no hit
+    return g > 1E-6;
   }
 }
+  
+  point_type ray_point(const point_type& ray_o, const point_type& ray_v, float g){
+    point_type p = ray_v;
+    bg::multiply_value(p,g);
+    bg::add_point(p,ray_o);
+    return p;
+  }
+  
+  // Ray - box slab test in [0,t_max]
+  bool ray_box_hit( const std::array<float,3>& lo, const std::array<float,3>& hi,
+                    const std::array<float,3>& o, const std::array<float,3>& inv_v,
+                    float t_max){
+    float t_min = 0;
+    for(int k = 0; k < 3; ++k){
+      if(std::isinf(inv_v[k])){
+        // Parallel to the slab
+        if(o[k] < lo[k] || o[k] > hi[k]) return false;
+      } else {
+        float t0 = (lo[k] - o[k]) * inv_v[k];
+        float t1 = (hi[k] - o[k]) * inv_v[k];
+        if(t0 > t1) std::swap(t0,t1);
+        t_min = std::max(t_min,t0);
+        t_max = std::min(t_max,t1);
+        if(t_min > t_max) return false;
+      }
+    }
+    return true;
+  }
+  
+  // Faces per hierarchy leaf
+  constexpr std::size_t bvh_leaf_size = 4;
+  
+  // Vertices closer than this are merged
+  constexpr float vertex_tolerance = 1E-3;
+  
+  // Vertex grid cell size. Twice the tolerance: merged vertices are always
+  // in neighbour cells
+  constexpr double vertex_cell_size = 2 * vertex_tolerance;
+  
+  std::array<std::int64_t,3> vertex_cell(const point_type& p){
+    return { static_cast<std::int64_t>(std::floor(getx(p) / vertex_cell_size)),
+             static_cast<std::int64_t>(std::floor(gety(p) / vertex_cell_size)),
+             static_cast<std::int64_t>(std::floor(getz(p) / vertex_cell_size)) };
+  }
+  
+} // anonymous
+
+/**
+   * @brief Computes Triangle-ray intersection with the moller-trumbore algorithm
+   * @param t Triangle
+   * @param ray_o Ray origin
+   * @param ray_v Ray direction (Normalized)
+   * @param intersection Output: intersection point
+   * @return True if the ray intersects the triangle
+   */
+  bool triangle_ray_intersection( const triangle_type& t,
+                                  const point_type& ray_o,
+                                  const point_type& ray_v,
+                                  point_type& intersection ){
+    float g;
+    if(triangle_ray_hit(t,ray_o,ray_v,g)){
+      intersection = ray_point(ray_o,ray_v,g);
+      return true;
+    }
+    return false;
+  }
 
 // Heron's formula
 float triangle_area( const triangle_type& t){
@@ -648,6 +708,45 @@ float triangle_area( const triangle_type& t){
   return std::sqrt( s * (s-a) * (s-b) * (s-c));
 }
 
+void rdp_simplify(const std::vector<point_type>& line, float eps, std::vector<bool>& keep){
+  
+  keep.assign(line.size(), false);
+  if(line.empty()) return;
+  keep.front() = true;
+  keep.back() = true;
+  
+  // Pending sub-segments (first and last point, both kept)
+  std::vector<std::pair<std::size_t, std::size_t>> pending;
+  pending.emplace_back(0, line.size() - 1);
+  
+  while(!pending.empty()){
+    std::size_t ini = pending.back().first;
+    std::size_t end = pending.back().second;
+    pending.pop_back();
+    
+    if(end - ini < 2) continue;
+    
+    // Farthest point from the line ini->end
+    segment_type segm(line[ini], line[end]);
+    float maxd = 0.;
+    std::size_t m = ini;
+    for(std::size_t i = ini + 1; i < end; ++i){
+      float tmp = bg::distance(segm, line[i]);
+      if(tmp > maxd){
+        maxd = tmp;
+        m = i;
+      }
+    }
+    
+    // Keep m and simplify both sides. Otherwise the intermediate points are removed
+    if(maxd > eps){
+      keep[m] = true;
+      pending.emplace_back(m, end);
+      pending.emplace_back(ini, m);
+    }
+  }
+}
+
 float tetrahedron_volume( const point_type& p0, 
                           const point_type& p1,
                           const point_type& p2,
@@ -669,12 +768,18 @@ float tetrahedron_volume( const point_type& p0,
 
 TriangleMesh::TriangleMesh()
     : vertices_()
-    , faces_(){};
+    , faces_()
+    , vertex_grid_()
+    , bvh_()
+    , bvh_faces_(){};
 
 
 TriangleMesh::TriangleMesh(const face_storage& faces)
     : vertices_()
-    , faces_(){
+    , faces_()
+    , vertex_grid_()
+    , bvh_()
+    , bvh_faces_(){
       
       // Add faces
       for(auto it = faces.begin(); it!= faces.end() ; ++it){
@@ -685,11 +790,26 @@ TriangleMesh::TriangleMesh(const face_storage& faces)
 TriangleMesh::~TriangleMesh(){};
 
 TriangleMesh::vertex_iterator TriangleMesh::add(const point_type& p){
-  vertex_iterator pos;
-  for(pos = begin_vertex(); pos != end_vertex(); ++pos){
-    if(distance(*pos,p)<1E-3) return pos;
+  
+  // First existing vertex close to p (in the neighbour cells)
+  cell_type c = vertex_cell(p);
+  index_type found = vertices_.size();
+  cell_type n;
+  for(n[0] = c[0]-1; n[0] <= c[0]+1; ++n[0]){
+    for(n[1] = c[1]-1; n[1] <= c[1]+1; ++n[1]){
+      for(n[2] = c[2]-1; n[2] <= c[2]+1; ++n[2]){
+        auto range = vertex_grid_.equal_range(n);
+        for(auto it = range.first; it != range.second; ++it){
+          if(it->second < found && distance(vertices_[it->second],p) < vertex_tolerance){
+            found = it->second;
+          }
+        }
+      }
+    }
   }
+  if(found < vertices_.size()) return std::next(vertices_.begin(),found);
   
+  vertex_grid_.emplace(c, vertices_.size());
   vertices_.push_back(p);
   return std::prev(vertices_.end(),1);
 }
@@ -717,6 +837,9 @@ void TriangleMesh::remove(const TriangleMesh::vertex_iterator& b, const Triangle
 void TriangleMesh::clear(){
   faces_.clear();
   vertices_.clear();
+  vertex_grid_.clear();
+  bvh_.clear();
+  bvh_faces_.clear();
 }
 
 
@@ -752,6 +875,7 @@ TriangleMesh::index_face_iterator TriangleMesh::add(const point_type& v0, const
   // IT could BE REALLOCATED!!!!
   index_face_type t = {v0_p,v1_p,v2_p};
   faces_.push_back(t);
+  bvh_.clear();
   return std::prev(faces_.end(),1);
 }
 
@@ -763,6 +887,7 @@ TriangleMesh::index_face_iterator TriangleMesh::add(const index_type& v0, const
   
   index_face_type t = {v0,v1,v2};
   faces_.push_back(t);
+  bvh_.clear();
   return std::prev(faces_.end(),1);
 }
 
@@ -772,6 +897,7 @@ TriangleMesh::index_face_iterator TriangleMesh::add(const triangle_type& t){
 
 void TriangleMesh::remove(const TriangleMesh::index_face_iterator& it){
   faces_.erase(it);
+  bvh_.clear();
 }
 
 void TriangleMesh::remove(const TriangleMesh::index_face_iterator& b, const TriangleMesh::index_face_iterator& e){
@@ -782,6 +908,7 @@ void TriangleMesh::remove(const TriangleMesh::index_face_iterator& b, const Tria
 
 void TriangleMesh::clear_faces(){
   faces_.clear();
+  bvh_.clear();
 }
 
 TriangleMesh::index_face_iterator TriangleMesh::begin_face(){
@@ -804,6 +931,129 @@ std::size_t TriangleMesh::face_count() const{
   return faces_.size();
 }
 
+void TriangleMesh::build_index(){
+  bvh_.clear();
+  bvh_faces_.resize(faces_.size());
+  if(faces_.empty()) return;
+  
+  std::vector<std::array<float,3>> centroids;
+  centroids.reserve(faces_.size());
+  for(index_type i = 0; i < faces_.size(); ++i){
+    bvh_faces_[i] = i;
+    triangle_type t = get_triangle(faces_[i]);
+    centroids.push_back({ (getx(t[0]) + getx(t[1]) + getx(t[2])) / 3,
+                          (gety(t[0]) + gety(t[1]) + gety(t[2])) / 3,
+                          (getz(t[0]) + getz(t[1]) + getz(t[2])) / 3 });
+  }
+  
+  bvh_.reserve(2 * (faces_.size() / bvh_leaf_size) + 1);
+  build_index_(0, faces_.size(), centroids);
+}
+
+void TriangleMesh::build_index_(std::size_t b, std::size_t e,
+                                const std::vector<std::array<float,3>>& centroids){
+  
+  std::size_t pos = bvh_.size();
+  bvh_.emplace_back();
+  
+  // Face and centroid bounds
+  bvh_node node;
+  std::array<float,3> c_lo, c_hi;
+  node.lo.fill(std::numeric_limits<float>::max());
+  node.hi.fill(std::numeric_limits<float>::lowest());
+  c_lo = node.lo;
+  c_hi = node.hi;
+  
+  for(std::size_t i = b; i < e; ++i){
+    triangle_type t = get_triangle(faces_[bvh_faces_[i]]);
+    for(const auto& v : t){
+      std::array<float,3> c = {getx(v), gety(v), getz(v)};
+      for(int k = 0; k < 3; ++k){
+        node.lo[k] = std::min(node.lo[k], c[k]);
+        node.hi[k] = std::max(node.hi[k], c[k]);
+      }
+    }
+    for(int k = 0; k < 3; ++k){
+      c_lo[k] = std::min(c_lo[k], centroids[bvh_faces_[i]][k]);
+      c_hi[k] = std::max(c_hi[k], centroids[bvh_faces_[i]][k]);
+    }
+  }
+  
+  // Padding: the box test should never discard a hit at a face border
+  for(int k = 0; k < 3; ++k){
+    float pad = 1E-5 * (1 + std::max(std::abs(node.lo[k]), std::abs(node.hi[k])));
+    node.lo[k] -= pad;
+    node.hi[k] += pad;
+  }
+  
+  // Split axis: longest centroid extent
+  int axis = 0;
+  for(int k = 1; k < 3; ++k){
+    if(c_hi[k] - c_lo[k] > c_hi[axis] - c_lo[axis]) axis = k;
+  }
+  
+  if(e - b <= bvh_leaf_size || c_hi[axis] <= c_lo[axis]){
+    // Leaf
+    node.first = b;
+    node.count = e - b;
+    bvh_[pos] = node;
+    return;
+  }
+  
+  // Median split
+  std::size_t m = b + (e - b) / 2;
+  std::nth_element(bvh_faces_.begin() + b, bvh_faces_.begin() + m, bvh_faces_.begin() + e,
+                   [&centroids, axis](index_type i, index_type j){
+                     return centroids[i][axis] < centroids[j][axis];
+                   });
+  
+  build_index_(b, m, centroids);
+  node.first = bvh_.size();
+  node.count = 0;
+  build_index_(m, e, centroids);
+  bvh_[pos] = node;
+}
+
+bool TriangleMesh::indexed() const {
+  return !bvh_.empty();
+}
+
+template <typename F>
+void TriangleMesh::visit_ray_faces_(const point_type& p, const point_type& v, F f) const {
+  
+  if(bvh_.empty()){
+    for(index_type i = 0; i < faces_.size(); ++i){
+      f(i);
+    }
+    return;
+  }
+  
+  std::array<float,3> o = {getx(p), gety(p), getz(p)};
+  std::array<float,3> inv_v = {1 / getx(v), 1 / gety(v), 1 / getz(v)};
+  float t_max = std::numeric_limits<float>::infinity();
+  
+  // Depth-first traversal
+  std::vector<index_type> stack;
+  stack.reserve(64);
+  stack.push_back(0);
+  while(!stack.empty()){
+    const bvh_node& node = bvh_[stack.back()];
+    index_type pos = stack.back();
+    stack.pop_back();
+    
+    if(!ray_box_hit(node.lo, node.hi, o, inv_v, t_max)) continue;
+    
+    if(node.count > 0){
+      for(index_type i = node.first; i < node.first + node.count; ++i){
+        t_max = f(bvh_faces_[i]);
+      }
+    } else {
+      stack.push_back(node.first);
+      stack.push_back(pos + 1);
+    }
+  }
+}
+
 /**
  * @brief Using ray-tracing method computes if the point p is Inside the
  * triangular mesh assuming that it is closed
@@ -815,7 +1065,7 @@ bool TriangleMesh::point_inside(const point_type& p, const point_type& ray_direc
   /** Steps:
   *
   *  1. ray with source p and direction 1,0,0 
-  *  2. Check intersections with all mesh faces
+  *  2. Check intersections with the mesh faces
   *  3. Odd number of intersections - Its inside
   *  
   *  Special cases: 
@@ -824,47 +1074,47 @@ bool TriangleMesh::point_inside(const point_type& p, const point_type& ray_direc
   *  Easy way to go: Count distinct intersection points instead.
   */
   
-  // Intersection points
-  std::vector<point_type> intersections;
-  point_type i_point;
-  bool new_point;
-  
-  for (auto it = begin_face(); it != end_face(); ++it) {
-      if(triangle_ray_intersection(get_triangle(*it),
-                                     p,
-                                     ray_direction,
-                                     i_point)){
-        // Hit!
-        new_point = true;
-        
-        // Its a new intersection point?
-        for(auto ip_it = intersections.begin(); 
-            new_point && ip_it != intersections.end(); ++ip_it){
-          if( distance(i_point,*ip_it) < 1E-6 )
-            new_point = false;
-        }
-        
-        // Add new point
-        if (new_point) {
-          intersections.push_back(i_point);
-        }
-      }
+  // Intersection distances and points
+  std::vector<std::pair<float,point_type>> hits;
+  
+  visit_ray_faces_(p, ray_direction, [&](index_type f) -> float {
+    float g;
+    if(triangle_ray_hit(get_triangle(faces_[f]), p, ray_direction, g)){
+      hits.emplace_back(g, ray_point(p, ray_direction, g));
+    }
+    return std::numeric_limits<float>::infinity();
+  });
+  
+  // Points along the ray: repeated ones are consecutive once sorted
+  std::sort(hits.begin(), hits.end(),
+            [](const std::pair<float,point_type>& a, const std::pair<float,point_type>& b){
+              return a.first < b.first;
+            });
+  
+  std::size_t count = 0;
+  for(std::size_t i = 0; i < hits.size(); ++i){
+    if(i == 0 || distance(hits[i].second, hits[count-1].second) >= 1E-6){
+      hits[count++] = hits[i];
+    }
   }
+  
   // Return is even
-  return ( (intersections.size() % 2) == 1);
+  return ( (count % 2) == 1);
 }
 
 point_type TriangleMesh::ray_intersection(const point_type& p, 
                                           const point_type& ray_direction) const {
   point_type i_point;
-  for (auto it = begin_face(); it != end_face(); ++it) {
-      if(triangle_ray_intersection(get_triangle(*it),
-                                     p,
-                                     ray_direction,
-                                     i_point)){
-        return i_point;
-      }
-  }
+  float best = std::numeric_limits<float>::infinity();
+  
+  visit_ray_faces_(p, ray_direction, [&](index_type f) -> float {
+    float g;
+    if(triangle_ray_hit(get_triangle(faces_[f]), p, ray_direction, g) && g < best){
+      best = g;
+      i_point = ray_point(p, ray_direction, g);
+    }
+    return best;
+  });
   return i_point;
 }
 
@@ -11,7 +11,9 @@ Neurite::Neurite()
       , type_(NeuriteType::kUndefined)
       , root_is_soma_(false)
       , neuron_()
-      , markers_(){
+      , markers_()
+      , next_branch_number_(0)
+      , tree_version_(1){
         tree_.head->data.neurite(this);
         tree_.feet->data.neurite(this);
         //set_root();
@@ -24,7 +26,9 @@ Neurite::Neurite(int id)
       , type_(NeuriteType::kUndefined)
       , root_is_soma_(false)
       , neuron_()
-      , markers_(){
+      , markers_()
+      , next_branch_number_(0)
+      , tree_version_(1){
         //set_root();
         tree_.head->data.neurite(this);
         tree_.feet->data.neurite(this);
@@ -37,12 +41,52 @@ Neurite::Neurite(int id, const NeuriteType& t)
       , type_(t)
       , root_is_soma_(false)
       , neuron_()
-      , markers_(){
+      , markers_()
+      , next_branch_number_(0)
+      , tree_version_(1){
         tree_.head->data.neurite(this);
         tree_.feet->data.neurite(this);
         //set_root();
   };
   
+Neurite::Neurite(Neurite&& n)
+      : WithProperties(std::move(n))
+      , tree_(std::move(n.tree_))
+      , id_(n.id_)
+      , type_(n.type_)
+      , root_is_soma_(n.root_is_soma_)
+      , neuron_(n.neuron_)
+      , markers_(std::move(n.markers_))
+      , next_branch_number_(n.next_branch_number_)
+      , tree_version_(n.tree_version_){
+        relink_branches_();
+  }
+
+Neurite& Neurite::operator=(Neurite&& n){
+  if(this != &n){
+    WithProperties::operator=(std::move(n));
+    tree_ = std::move(n.tree_);
+    id_ = n.id_;
+    type_ = n.type_;
+    root_is_soma_ = n.root_is_soma_;
+    neuron_ = n.neuron_;
+    markers_ = std::move(n.markers_);
+    next_branch_number_ = n.next_branch_number_;
+    tree_version_ = n.tree_version_;
+    relink_branches_();
+  }
+  return *this;
+}
+
+void Neurite::relink_branches_(){
+  tree_.head->data.neurite(this);
+  tree_.feet->data.neurite(this);
+  for( auto it = tree_.begin(); it != tree_.end() ; ++it ) {
+    it->neurite(this);
+    it->tree_node(it.node);
+  }
+}
+
 // ROOT SET
 
 // Empty root
@@ -50,7 +94,7 @@ void Neurite::set_root() {
   if (tree_.empty()) {    
     // Set branch neurite
     tree_.set_head(Branch(std::vector<int>{1}, 0));
-    tree_.begin()->neurite(this);
+    link_branch_(tree_.begin());
   } else {
     tree_.begin()->remove_root();
     tree_.begin()->neurite(this);
@@ -129,7 +173,7 @@ void Neurite::scale(float r){
   for( auto it = tree_.begin_post(); it != tree_.end_post() ; ++it ) {
     // We are using post_order iterator. Children are always scaled before parents
     
-    // Scale this branch
+    // Scale this branch
     it->scale(r);
     
     // Set child root (child is already scaled) :D
@@ -183,6 +227,12 @@ void Neurite::simplify(float eps) {
 }
 
 Neurite::branch_iterator Neurite::find(const Branch& b) const{
+  // Branch stored in our tree
+  tree_node* tn = b.tree_node();
+  if(tn != nullptr && &(tn->data) == &b && b.valid_neurite() && &b.neurite() == this){
+    return branch_iterator(tn);
+  }
+  
   for( auto it = tree_.begin(); it != tree_.end() ; ++it ) {
     if(*it == b) return it;
   }
@@ -209,6 +259,7 @@ void Neurite::childOrder(const point_type up){
       if( geometry::vector_vector_directed_angle(v0,v1,up) > 
           geometry::vector_vector_directed_angle(v0,v2,up)){
         tree_.swap(ch,std::next(ch,1));
+        ++tree_version_;
       }
     }
   }
@@ -228,22 +279,24 @@ void Neurite::reassign_branch_ids() {
     if (tree_.empty())
       return;
     else {  // reassign root id
-      begin_branch()->id(std::vector<int>{1});
+      begin_branch()->position(1);
       begin_branch()->order(0);
     }
 
-    std::vector<int> tmp;
-
-    // Iterate over the tree rassigning ids
-    for (auto it = ++begin_branch(); it != end_branch(); ++it) {
-      tmp = tree_type::parent(it)->id();                                         // Get parent id
-      tmp.push_back(tree_.index(typename tree_type::sibling_iterator(it)) + 1);  // add our position to the id
-      it->id(tmp);                                                               // set id
-      it->order(tree_type::parent(it)->order() + 1);                             // set order
+    // DFS numbering. Each branch sets the position and order of its children
+    Branch::number_type count = 0;
+    for (auto it = begin_branch(); it != end_branch(); ++it) {
+      it->number(count++);
+      int pos = 1;
+      for (tree_node* ch = it.node->first_child; ch != nullptr; ch = ch->next_sibling) {
+        ch->data.position(pos++);
+        ch->data.order(it->order() + 1);
+      }
     }
+    next_branch_number_ = count;
 };
 
-bool Neurite::remove_empty_branches(){
+bool Neurite::remove_empty_branches(){
   
   bool trigger = false;
   typename tree_type::sibling_iterator ch;
@@ -260,10 +313,12 @@ bool Neurite::remove_empty_branches(){
           NSTR_LOG_(info, std::string("Removing empty branch") + it->idString() + " in neurite " + std::to_string(id()) );
           // We assing our children to the parent node.
           if(it.number_of_children()>0){
+            for (auto ch = it.begin(); ch != it.end(); ++ch) ch->invalidate_first_parent();
             tree_.reparent(tree_type::parent(it), it.begin(), it.end());
           }
           // Erase branch
           it = std::prev(tree_.erase(it),1);
+          ++tree_version_;
         }
       }
   }
@@ -291,10 +346,12 @@ bool Neurite::collapse_single_branches(){
         //it->insert(it->end(), ch->begin(), ch->end());
 
         // Reparent nodes
+        for (auto gch = ch.begin(); gch != ch.end(); ++gch) gch->invalidate_first_parent();
         tree_.reparent(it, ch.begin(), ch.end());
 
         // Remove ch
         tree_.erase(ch);
+        ++tree_version_;
         
         // Update it so we check it again
         it = std::prev(it,1);
@@ -306,7 +363,7 @@ bool Neurite::collapse_single_branches(){
 void Neurite::reassign_branch_roots(){
   
   if(size() <= 1) return;
-  
+  
   for( auto it = std::next(begin_branch(),1); it != end_branch(); ++it){
     if(tree_type::parent(it)->size() > 0){
       it->root(tree_type::parent(it)->last());
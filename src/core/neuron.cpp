@@ -1,12 +1,21 @@
 #include <neurostr/core/neuron.h>
 
+#include <algorithm>
+#include <future>
 #include <limits>
 #include <boost/any.hpp>
 #include <boost/geometry/geometry.hpp>
 
+#include <neurostr/core/thread_pool.h>
+
 
 namespace neurostr {
 
+namespace {
+  // Branches per simplification task
+  constexpr std::size_t simplify_chunk_size = 16;
+} // anonymous
+
  /****************
  * 
  * Neuron
@@ -331,9 +340,36 @@ namespace neurostr {
       it->childOrder();*/
   }
   
-  void Neuron::simplify(float eps){
+  void Neuron::simplify(float eps, std::size_t nthreads){
+    
+    // Branches only modify their own nodes
+    std::vector<Branch*> branches;
     for(auto it = begin_neurite(); it != end_neurite(); ++it)
-      it->simplify(eps);
+      for(auto b = it->begin_branch(); b != it->end_branch(); ++b)
+        branches.push_back(&(*b));
+    
+    if(nthreads == 0) nthreads = ThreadPool::default_size();
+    
+    // Sequential
+    if(nthreads == 1 || branches.size() <= simplify_chunk_size){
+      for(auto it = branches.begin(); it != branches.end(); ++it)
+        (*it)->simplify(eps);
+      return;
+    }
+    
+    ThreadPool pool(nthreads);
+    std::vector<std::future<void>> done;
+    for(std::size_t i = 0; i < branches.size(); i += simplify_chunk_size){
+      std::size_t last = std::min(i + simplify_chunk_size, branches.size());
+      done.push_back(pool.submit([&branches, eps, i, last](){
+        for(std::size_t j = i; j < last; ++j)
+          branches[j]->simplify(eps);
+      }));
+    }
+    
+    // Rethrow in order
+    for(auto it = done.begin(); it != done.end(); ++it)
+      it->get();
   }
   
   // Print neuron
@@ -387,9 +423,9 @@ std::ostream& operator<<(std::ostream& os, const Neuron& n) {
  * 
  *****************/
  
-Reconstruction::Reconstruction() : WithProperties(), id_(), neurons_(), contours_() {};
+Reconstruction::Reconstruction() : WithProperties(), id_(), neurons_(), contours_(), arena_() {};
   
-Reconstruction::Reconstruction(const std::string& id) : WithProperties(), id_(id), neurons_(), contours_() {};
+Reconstruction::Reconstruction(const std::string& id) : WithProperties(), id_(id), neurons_(), contours_(), arena_() {};
 
 void Reconstruction::addContour(const contour_type& v) {
     contours_.push_back(v);
@@ -0,0 +1,55 @@
+#include <neurostr/core/thread_pool.h>
+
+namespace neurostr {
+  
+  ThreadPool::ThreadPool(std::size_t nthreads) 
+    : workers_(), tasks_(), mutex_(), cv_(), stop_(false) {
+    if(nthreads == 0) nthreads = default_size();
+    
+    workers_.reserve(nthreads);
+    for(std::size_t i = 0; i < nthreads; ++i)
+      workers_.emplace_back(&ThreadPool::worker_loop_, this);
+  }
+  
+  ThreadPool::~ThreadPool(){
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      stop_ = true;
+    }
+    cv_.notify_all();
+    for(auto it = workers_.begin(); it != workers_.end(); ++it)
+      it->join();
+  }
+  
+  std::size_t ThreadPool::default_size(){
+    std::size_t n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+  }
+  
+  void ThreadPool::enqueue_(std::function<void()>&& f){
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      tasks_.push_back(std::move(f));
+    }
+    cv_.notify_one();
+  }
+  
+  void ThreadPool::worker_loop_(){
+    std::function<void()> task;
+    while(true){
+      {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cv_.wait(lock, [this](){ return stop_ || !tasks_.empty(); });
+        
+        // Stop only once the queue is drained
+        if(tasks_.empty()) return;
+        
+        task = std::move(tasks_.front());
+        tasks_.pop_front();
+      }
+      // Exceptions are stored in the task future
+      task();
+    }
+  }
+  
+} // neurostr
@@ -330,7 +330,7 @@ block_type ASCParser::next_block_type(bool inBlock) {
   }
 }
 
-void ASCParser::process_(Reconstruction & r) {
+void ASCParser::process_(Reconstruction & r, ReconstructionStream& s) {
 
   block_type btype;
 
@@ -389,21 +389,11 @@ void ASCParser::process_(Reconstruction & r) {
       
         Contour c(p);
         c.properties_from_map(aux.properties);
-        r.addContour(c);
+        s.add_contour(c);
           
       } else {
         // ITS A SOMA! - new neuron
-        
-        // Create neuron
-        Neuron* n = new Neuron(r.id() + std::string("_") + std::to_string(r.size() + 1),
-                               std::vector<Node>(aux.begin_node(), aux.end_node()));
-        // Invalidate all branches and parent int soma nodes!
-        for(auto it = n->begin_soma(); it != n->end_soma(); ++it){
-          it->parent(nullptr);
-          it->branch(nullptr);
-        }
-        
-        r.addNeuron(n);
+        s.add_soma(std::vector<Node>(aux.begin_node(), aux.end_node()));
       }
 
       break;
@@ -428,15 +418,7 @@ void ASCParser::process_(Reconstruction & r) {
       set_neurite_type_by_nlproperties(*n);
 
       // And check to which neuron it corresponds if any.
-      // Somas are required to be defined before neurites
-      if(r.size() == 0){
-        
-        // We need to create the neuron before
-        Neuron* neuro = new Neuron(r.id() + std::string("_1"));
-        r.addNeuron(neuro);
-      }
-      
-      r.add_neurite_to_closest_soma(n);  
+      s.add_neurite(n);
       
 
       break;
@@ -529,8 +511,7 @@ Neurite::branch_iterator ASCParser::process_container_(
         }
       } else if (btype == block_type::SUB_TREE) {
         // Create branch
-        std::vector<int> id = current_pos->id();
-        id.push_back(current_pos.number_of_children()+1);
+        Branch::id_type id{static_cast<int>(current_pos.number_of_children())+1};
         
         
         // Insert branch at current posititon with last node as root
@@ -598,14 +579,34 @@ void ASCParser::recover_from_error(){
 }
 
 // Main function
- std::unique_ptr<Reconstruction> ASCParser::read(const std::string& name) {
+std::unique_ptr<Reconstruction> ASCParser::read(const std::string& name) {
 
-  Reconstruction* r = new Reconstruction(name);
+  std::unique_ptr<Reconstruction> r(new Reconstruction(name));
+  Reconstruction& rec = *r;
+  
+  ReconstructionStream s(name, 
+                         [&rec](std::unique_ptr<Neuron> n){ rec.addNeuron(n.release()); },
+                         [&rec](const Contour& c){ rec.addContour(c); });
+  read_(rec, s);
+  return r;
+}
+
+std::unique_ptr<Reconstruction> ASCParser::read(const std::string& name,
+                                                const neuron_callback& on_neuron,
+                                                const contour_callback& on_contour,
+                                                bool grouped) {
+  std::unique_ptr<Reconstruction> r(new Reconstruction(name));
+  ReconstructionStream s(name, on_neuron, on_contour, grouped);
+  read_(*r, s);
+  return r;
+}
+
+void ASCParser::read_(Reconstruction& r, ReconstructionStream& s) {
 
   node_count_ = 0;
   reset_errors();
   try{
-    process_(*r);
+    process_(r, s);
   } catch (std::exception e){
     // Any error at this point is critical
     NSTR_LOG_(critical, e.what());
@@ -614,21 +615,12 @@ void ASCParser::recover_from_error(){
     ++error_count;
   }
   
-  // Correct neurites
-  /*for (auto it = r->begin(); it != r->end(); ++it) {
-    it->correct();
-    //for (auto neur_it = (*it)->begin_neurite(); neur_it != (*it)->end_neurite(); ++neur_it)
-    //  (*neur_it)->correct();
-  }*/
-
-  // root->tree_type_by_properties();
-  // root->block_color_by_properties();
+  // Remaining neurons are complete
+  s.flush();
   
   if(error_count > 0){
     NSTR_LOG_(warn, std::to_string(error_count) + " errors were detected while processing the file. Please, send us an email with the conflicting file attached to solve the issue ASAP.")
   }
-
-  return std::unique_ptr<Reconstruction>(r);
 }
 
 }  // Namespace io
@@ -24,6 +24,36 @@ const std::uint32_t DATParser::footer = 0xAABBCCDD;
 
 /***** PUBLIC METHODS **/
 std::unique_ptr<Reconstruction> DATParser::read(const std::string &name) {
+  std::unique_ptr<Reconstruction> r(new Reconstruction(name));
+  Reconstruction& rec = *r;
+  
+  ReconstructionStream s(name, 
+                         [&rec](std::unique_ptr<Neuron> n){ rec.addNeuron(n.release()); },
+                         [&rec](const Contour& c){ rec.addContour(c); });
+  read_(rec, s);
+  return r;
+}
+
+std::unique_ptr<Reconstruction> DATParser::read(const std::string &name,
+                                                const neuron_callback& on_neuron,
+                                                const contour_callback& on_contour,
+                                                bool grouped) {
+  std::unique_ptr<Reconstruction> r(new Reconstruction(name));
+  ReconstructionStream s(name, on_neuron, on_contour, grouped);
+  read_(*r, s);
+  return r;
+}
+
+bool DATParser::valid_header() {
+  if (!checked_header_)
+    return check_header_();
+  else
+    return valid_header_;
+}
+
+/***** PROTECTED METHODS ***/
+
+void DATParser::read_(Reconstruction& r, ReconstructionStream& s) {
   // Check header
   if (!valid_header()) throw std::runtime_error("Stream header is not valid");
 
@@ -31,10 +61,9 @@ std::unique_ptr<Reconstruction> DATParser::read(const std::string &name) {
   reset_errors();
 
   // Root block
-  Reconstruction *r = new Reconstruction(name);
   try{
     while (read_next_block_() > 0) {
-      process_block_(*r);
+      process_block_(r, s);
     }
   } catch (std::exception e){
     // Any error at this point is critical
@@ -48,29 +77,14 @@ std::unique_ptr<Reconstruction> DATParser::read(const std::string &name) {
   checked_header_ = false;
   valid_header_ = false;
   
-    // Correct neuron
-  /*for (auto it = r->begin(); it != r->end(); ++it) {
-    it->correct();
-    //for (auto neur_it = (*it)->begin_neurite(); neur_it != (*it)->end_neurite(); ++neur_it)
-    //  (*neur_it)->correct();
-  }*/
+  // Remaining neurons are complete
+  s.flush();
   
   if(error_count > 0){
     NSTR_LOG_(warn, std::to_string(error_count) + " errors were detected while processing the file. Please, send us an email with the conflicting file attached to solve the issue ASAP.")
   }
-
-  return std::unique_ptr<Reconstruction>(r);
-}
-
-bool DATParser::valid_header() {
-  if (!checked_header_)
-    return check_header_();
-  else
-    return valid_header_;
 }
 
-/***** PROTECTED METHODS ***/
-
 // PROCESS STRING BLOCK
 std::string DATParser::process_string(std::size_t len) {
   std::string s;
@@ -265,7 +279,8 @@ std::vector<Node> DATParser::process_samplelist_() {
     
     // Read sample
     if (type_in_buffer_ != block_type::SAMPLE) {
-      throw std::logic_error("Unexpected non-sample block inside a sample list");    } else {
+      throw std::logic_error("Unexpected non-sample block inside a sample list");
+    } else {
       v.push_back(process_sample());
     }
   }
@@ -448,8 +463,7 @@ std::size_t DATParser::process_container_(
 
       } else if (type_in_buffer_ == block_type::SUB_TREE) {
         // Create branch
-        std::vector<int> id = current_pos->id();
-        id.push_back(current_pos.number_of_children()+1);      
+        Branch::id_type id{static_cast<int>(current_pos.number_of_children())+1};      
         Neurite::branch_iterator inserted = current_pos->neurite()
           .append_branch(current_pos,
             Branch(id, current_pos->order()+1, current_pos->last()));
@@ -521,7 +535,7 @@ std::size_t DATParser::process_container_(
 
 void DATParser::skip_block() { buffer_head_ = buffer_ + in_buffer_; }
 
-void DATParser::process_block_(Reconstruction &r) {
+void DATParser::process_block_(Reconstruction &r, ReconstructionStream& s) {
 
   if (type_in_buffer_ == block_type::TREE) {
     // Here we should create a neurite - we do not know its id, neuron or type yet
@@ -534,13 +548,7 @@ void DATParser::process_block_(Reconstruction &r) {
     set_neurite_type_by_nlproperties(*n);
     
     // And check to which neuron it corresponds if any.
-    // Somas are required to be defined before neurites
-    if(r.size() == 0){
-      // We need to create the neuron before
-      Neuron* neuro = new Neuron(r.id() + std::string("_1"));
-      r.addNeuron(neuro);
-    }
-    r.add_neurite_to_closest_soma(n);  
+    s.add_neurite(n);
 
   } else if (type_in_buffer_ == block_type::CONTOUR) {
     // Auxiliar neurite structure for reading purposes
@@ -564,18 +572,11 @@ void DATParser::process_block_(Reconstruction &r) {
       
       Contour c(p);
       c.properties_from_map(aux.properties);
-      r.addContour(c);
+      s.add_contour(c);
       
     } else {
       // Create neuron
-      Neuron *n = new Neuron(r.id() + std::string("_") + std::to_string(r.size() + 1),
-                             std::vector<Node>(aux.begin_node(), aux.end_node()));
-      for(auto it = n->begin_soma(); it != n->end_soma(); ++it){
-          it->parent(nullptr);
-          it->branch(nullptr);
-        }
-        
-      r.addNeuron(n);
+      s.add_soma(std::vector<Node>(aux.begin_node(), aux.end_node()));
     }
   /** Add properties to the whole reconstruction / neuron */
   }  else if (type_in_buffer_ == block_type::PROPERTY ){
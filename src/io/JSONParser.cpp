@@ -1,5 +1,12 @@
 #include <neurostr/io/JSONParser.h>
 
+#include <map>
+#include <vector>
+
+#include <rapidjson/reader.h>
+#include <rapidjson/istreamwrapper.h>
+#include <rapidjson/error/en.h>
+
 namespace neurostr {
 namespace io {
   
@@ -105,145 +112,6 @@ namespace io {
     
   }
   
-
-  
-  
-  //assert(v.HasValue("type") && v["type"].IsUint() ); 
-  void JSONParser::parseBranch(const rapidjson::Value::ConstObject& v,
-                     const Neurite::branch_iterator& pos){
-                       
-    //assert(v.HasMember["root"] && v["root"].IsObject());
-    //assert(v.HasMember["nodes"] && v["nodes"].IsArray());
-    
-    // Branch has root
-    if(!v.HasMember("root")){
-      ++warn_count;
-      NSTR_LOG_(warn, "Unrooted branch");
-    } else {
-      // Root (may throw error)
-      try{
-        pos->root( parseNode(v["root"].GetObject()) );  
-      } catch( std::logic_error e){
-        // We kjust ignore the root
-        process_error(e);
-        NSTR_LOG_(info, "Error while parsing branch root. Skipped.");  
-        pos->remove_root();  
-      }
-    }
-    
-    if(!v.HasMember("nodes")){
-      throw std::logic_error("Missing nodes field in branch");
-    } else if(!v["nodes"].IsArray()){
-      throw std::logic_error("Branch nodes field is not an array");
-    }
-    
-    // nodes
-    auto tmp = v["nodes"].GetArray();
-    pos->clear();
-    for(auto it = tmp.begin() ; it != tmp.end() ; ++it){
-      try{
-        if(!it->IsObject()){
-          throw std::logic_error("Unexpected non object node");
-        }
-        pos->push_back( parseNode(it->GetObject()));
-      } catch( std::logic_error e){
-        process_error(e);
-        NSTR_LOG_(info, "Conflicting nodes will are omitted");  
-      }
-    }
-    
-    // Properties
-     if(v.HasMember("properties")){
-      if(!v["properties"].IsObject() ){
-        NSTR_LOG_(warn,"Branch properties field is not an object - Ignoring");
-        ++warn_count;
-      } else {
-        pos->properties = parseProperties(v["properties"].GetObject());
-      }
-    }
-    
-    // Children
-     if(v.HasMember("children")){
-      if(!v["children"].IsArray()){
-          throw std::logic_error("Branch children field is not an array");
-      }
-       //assert(v["children"].IsArray());
-       auto tmp = v["children"].GetArray();
-       for(auto it = tmp.begin() ; it != tmp.end() ; ++it){
-         
-         // Add temporal branch
-         auto newpos = pos->neurite()
-                        .append_branch(pos,Branch()); // This copies neurite in b.
-         newpos->order(pos->order()+1);
-         
-         // Parse recursive
-         try{
-          if(!it->IsObject()){
-            throw std::logic_error("Unexpected non object branch");
-          }
-          parseBranch(it->GetObject(), newpos);
-         } catch(std::logic_error e){
-           process_error(e);
-           NSTR_LOG_(info, "Ignoring conflicting branch");  
-         }
-       }
-     }                  
-  }
-  
-  
-  Neurite* JSONParser::parseNeurite(const rapidjson::Value::ConstObject& v ){
-    //assert(v.HasValue("id") && v["id"].IsUint() );
-    //assert(v.HasValue("type") && v["type"].IsUint()) );
-    //assert(v.HasValue("tree") && v["tree"].IsObject()) );
-    if(!v.HasMember("id")){
-      throw std::logic_error("Missing neurite id field");
-    } else if ( !v["id"].IsUint()){
-      throw std::logic_error("Neurite id field is not an unsigned integer");
-    }
-    
-    if(!v.HasMember("type")){
-      throw std::logic_error("Missing neurite type field");
-    } else if ( !v["type"].IsUint()){
-      throw std::logic_error("Neurite type field is not an unsigned integer");
-    }
-    
-    if(!v.HasMember("tree")){
-      throw std::logic_error("Missing neurite tree field");
-    } else if ( !v["tree"].IsObject()){
-      throw std::logic_error("Neurite tree field is not an object");
-    }
-    
-    // Create neurite
-    Neurite * n = new Neurite(v["id"].GetUint(), NeuriteType(v["type"].GetUint()) );
-    
-    // Properties..
-    if(v.HasMember("properties")){
-      if(!v["properties"].IsObject() ){
-        NSTR_LOG_(warn,"Neurite properties field is not an object - Ignoring");
-        ++warn_count;
-      } else {
-        n->properties = parseProperties(v["properties"].GetObject());
-      }
-    }
-    
-    // Markers
-    if(v.HasMember("markers")){
-       if(!v["markers"].IsObject() ){
-        NSTR_LOG_(warn,"Neurite markers field is not an object - Ignoring");
-        ++warn_count;
-      } else {
-        parseMarkers(v["markers"].GetObject(),*n);
-      }
-    }
-    
-    // Tree
-    n->set_root(); // Create empty root
-    n->begin_branch()->order(0);
-    parseBranch(v["tree"].GetObject(), n->begin_branch());
-    
-    return n;
-  }
-  
   
   void JSONParser::parseMarkers(const rapidjson::Value::ConstObject& v, Neurite& n){
     
@@ -279,37 +147,684 @@ namespace io {
     }
   }
   
-  Neuron* JSONParser::parseNeuron(const rapidjson::Value::ConstObject& v ){
-    //assert(v.HasValue("id") && v["id"].IsString() );
-    //assert(v.HasValue("neurites") && v["neurites"].IsArray()) );
+  namespace {
+  
+  /**
+   * @brief Builds small JSON values from SAX events. Memory is taken from
+   * an internal buffer that is reused after each clear
+   */
+  class value_builder {
+    public:
+    
+    using value_type = rapidjson::Value;
+    
+    value_builder() : depth_(0), allocator_(buffer_, sizeof(buffer_)) {}
+    value_builder(const value_builder&) = delete;
+    value_builder& operator=(const value_builder&) = delete;
+    
+    bool complete() const { return depth_ == 0 && stack_.size() == 1; }
+    const value_type& value() const { return stack_.back(); }
+    
+    void clear(){
+      stack_.clear();
+      depth_ = 0;
+      allocator_.Clear();
+    }
     
-    if(!v.HasMember("id")){
-      throw std::logic_error("Missing neuron id field");
-    } else if ( !v["id"].IsString()){
-      throw std::logic_error("Neuron id field is not a string");
+    void Null() { stack_.emplace_back(); }
+    void Bool(bool b) { stack_.emplace_back(b); }
+    void Int(int i) { stack_.emplace_back(i); }
+    void Uint(unsigned i) { stack_.emplace_back(i); }
+    void Int64(std::int64_t i) { stack_.emplace_back(i); }
+    void Uint64(std::uint64_t i) { stack_.emplace_back(i); }
+    void Double(double d) { stack_.emplace_back(d); }
+    void String(const char* s, rapidjson::SizeType l) { stack_.emplace_back(s, l, allocator_); }
+    
+    void StartObject() { ++depth_; }
+    void StartArray() { ++depth_; }
+    
+    void EndObject(rapidjson::SizeType count){
+      value_type v(rapidjson::kObjectType);
+      std::size_t first = stack_.size() - 2*count;
+      for(std::size_t i = first; i < stack_.size(); i += 2){
+        v.AddMember(stack_[i], stack_[i+1], allocator_);
+      }
+      stack_.resize(first);
+      stack_.push_back(std::move(v));
+      --depth_;
     }
     
-    Neuron* n = new Neuron(v["id"].GetString());
+    void EndArray(rapidjson::SizeType count){
+      value_type v(rapidjson::kArrayType);
+      v.Reserve(count, allocator_);
+      std::size_t first = stack_.size() - count;
+      for(std::size_t i = first; i < stack_.size(); ++i){
+        v.PushBack(stack_[i], allocator_);
+      }
+      stack_.resize(first);
+      stack_.push_back(std::move(v));
+      --depth_;
+    }
+    
+    private:
+    int depth_;
+    std::uint64_t buffer_[512];
+    rapidjson::MemoryPoolAllocator<> allocator_;
+    std::vector<value_type> stack_;
+  };
+  
+  } // anonymous
+  
+  /**
+   * Frames keep track of the object/array we are in. Branches, neurites and
+   * neurons are created as their members arrive; nodes, points, properties,
+   * markers and soma are captured as small values (leaf frames) and processed
+   * with the parse* functions.
+   */
+  class JSONParser::SAXHandler 
+    : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, JSONParser::SAXHandler> {
+    
+    public:
+    
+    SAXHandler(JSONParser& p, Reconstruction& r) : parser_(p), rec_(r) {}
+    
+    /**
+     * @brief Fatal error message (empty if the parse was stopped by rapidjson)
+     */
+    const std::string& error() const { return fatal_; }
+    
+    bool Null() { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Null(); 
+      return leaf_end_(); 
+    }
+    
+    bool Bool(bool b) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Bool(b); 
+      return leaf_end_();
+    }
     
-    // If has soma
-    if(v.HasMember("soma")){
-      //assert(v["soma"].IsObject());
-      //assert(v["soma"].HasValue("nodes"));
+    bool Int(int i) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Int(i);
+      return leaf_end_();
+    }
+    
+    bool Uint(unsigned i) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Uint(i);
+      return leaf_end_();
+    }
+    
+    bool Int64(std::int64_t i) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Int64(i);
+      return leaf_end_();
+    }
+    
+    bool Uint64(std::uint64_t i) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Uint64(i);
+      return leaf_end_();
+    }
+    
+    bool Double(double d) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.Double(d);
+      return leaf_end_();
+    }
+    
+    bool String(const char* s, rapidjson::SizeType l, bool) { 
+      if(!value_(value_kind::kScalar)) return false;
+      if(capturing_()) leaf_.String(s, l);
+      return leaf_end_();
+    }
+    
+    bool StartObject() {
+      if(!value_(value_kind::kObject)) return false;
+      if(capturing_()) leaf_.StartObject();
+      return true;
+    }
+    
+    bool Key(const char* s, rapidjson::SizeType l, bool) {
+      if(capturing_()) leaf_.String(s, l);
+      else frames_.back().key = field_(std::string(s, l));
+      return true;
+    }
+    
+    bool EndObject(rapidjson::SizeType count) {
+      if(capturing_()){
+        leaf_.EndObject(count);
+        return leaf_end_();
+      }
+      return end_();
+    }
+    
+    bool StartArray() {
+      if(!value_(value_kind::kArray)) return false;
+      if(capturing_()) leaf_.StartArray();
+      return true;
+    }
+    
+    bool EndArray(rapidjson::SizeType count) {
+      if(capturing_()){
+        leaf_.EndArray(count);
+        return leaf_end_();
+      }
+      return end_();
+    }
+    
+    private:
+    
+    enum class value_kind { kScalar, kObject, kArray };
+    
+    enum class frame_type { kRoot, kNeurons, kNeuron, kNeurites, kNeurite, 
+                            kBranch, kNodes, kChildren, kContours, kContour, 
+                            kPoints, kLeaf, kSkip };
+    
+    enum class field { kUnknown, kNeurons, kContours, kProperties, kId, kSoma, 
+                       kNeurites, kType, kMarkers, kTree, kRoot, kNodes, 
+                       kChildren, kName, kFaceColor, kBackColor, kClosed, 
+                       kFill, kResolution, kPoints };
+    
+    struct frame {
+      frame_type type;
+      field key;
+    };
+    
+    // Neuron being read
+    struct neuron_state {
+      bool has_id = false;
+      bool has_neurites = false;
+      bool neurites_array = false;
+      std::string id;
+      std::vector<Node> soma;
+      PropertyMap properties;
+      std::vector<std::unique_ptr<Neurite>> neurites;
+      std::string error;
+    };
+    
+    // Neurite being read
+    struct neurite_state {
+      bool has_id = false;
+      bool has_type = false;
+      bool has_tree = false;
+      bool tree_object = false;
+      int id = -1;
+      int type = -1;
+      std::unique_ptr<Neurite> neurite;
+      std::string error;
+    };
+    
+    // Branch being read (one per tree level)
+    struct branch_state {
+      branch_state(const Neurite::branch_iterator& p) 
+        : pos(p), has_root(false), has_nodes(false) {}
+      Neurite::branch_iterator pos;
+      bool has_root;
+      bool has_nodes;
+      std::string error;
+    };
+    
+    // Contour being read
+    enum class status { kMissing, kWrong, kOk };
+    struct contour_state {
+      status name = status::kMissing;
+      status face_color = status::kMissing;
+      status back_color = status::kMissing;
+      status closed = status::kMissing;
+      status fill = status::kMissing;
+      status resolution = status::kMissing;
+      status points = status::kMissing;
+      std::string name_value;
+      std::string face_color_value;
+      std::string back_color_value;
+      bool closed_value = false;
+      float fill_value = 0.0;
+      float resolution_value = 0.0;
+      std::vector<point_type> point_values;
+    };
+    
+    JSONParser& parser_;
+    Reconstruction& rec_;
+    
+    std::vector<frame> frames_;
+    value_builder leaf_;
+    std::string fatal_;
+    
+    // Reconstruction-level state
+    bool has_neurons_ = false;
+    bool has_properties_ = false;
+    bool properties_object_ = false;
+    PropertyMap properties_;
+    
+    neuron_state neuron_;
+    neurite_state neurite_;
+    std::vector<branch_state> branches_;
+    contour_state contour_;
+    
+    bool capturing_() const {
+      return !frames_.empty() && frames_.back().type == frame_type::kLeaf;
+    }
+    
+    void push_(frame_type t){
+      frames_.push_back(frame{t, field::kUnknown});
+    }
+    
+    // Ignores the value (and its content)
+    bool skip_(value_kind k){
+      if(k != value_kind::kScalar) push_(frame_type::kSkip);
+      return true;
+    }
+    
+    // Captures the value
+    bool capture_(){
+      push_(frame_type::kLeaf);
+      return true;
+    }
+    
+    // Non fatal error - logs and counts it
+    void error_(const std::string& msg, const std::string& info){
+      parser_.process_error(std::logic_error(msg));
+      NSTR_LOG_(info, info);
+    }
+    
+    void warn_(const std::string& msg){
+      NSTR_LOG_(warn, msg);
+      ++parser_.warn_count;
+    }
+    
+    static field field_(const std::string& s){
+      static const std::map<std::string, field> fields = {
+        {"neurons", field::kNeurons}, {"contours", field::kContours}, 
+        {"properties", field::kProperties}, {"id", field::kId},
+        {"soma", field::kSoma}, {"neurites", field::kNeurites},
+        {"type", field::kType}, {"markers", field::kMarkers},
+        {"tree", field::kTree}, {"root", field::kRoot},
+        {"nodes", field::kNodes}, {"children", field::kChildren},
+        {"name", field::kName}, {"face_color", field::kFaceColor},
+        {"back_color", field::kBackColor}, {"closed", field::kClosed},
+        {"fill", field::kFill}, {"resolution", field::kResolution},
+        {"points", field::kPoints}
+      };
+      auto it = fields.find(s);
+      return (it == fields.end()) ? field::kUnknown : it->second;
+    }
+    
+    /**
+     * @brief Called when a value starts. Decides where it goes based on
+     * the current frame and key
+     * @return False if the value is a fatal error
+     */
+    bool value_(value_kind k);
+    
+    /**
+     * @brief Neuron fields. Used by neuron objects and single-neuron documents
+     */
+    bool neuron_value_(field key, value_kind k);
+    
+    /**
+     * @brief Processes the captured value once it is complete
+     */
+    bool leaf_end_();
+    void leaf_neuron_(field key, const rapidjson::Value& v);
+    void leaf_contour_(field key, const rapidjson::Value& v);
+    
+    /**
+     * @brief Ends an object or array frame
+     */
+    bool end_();
+    void end_branch_();
+    void end_neurite_();
+    void end_neuron_();
+    void end_contour_();
+    void end_root_();
+    
+    Neuron* build_neuron_();
+    Neurite* build_neurite_();
+    Contour build_contour_();
+  };
+  
+  bool JSONParser::SAXHandler::value_(value_kind k){
+    
+    // Document
+    if(frames_.empty()){
+      if(k != value_kind::kObject){
+        fatal_ = "Unexpected non object document";
+        return false;
+      }
+      push_(frame_type::kRoot);
+      return true;
+    }
+    
+    const frame& f = frames_.back();
+    switch(f.type){
       
-      if(!v["soma"].IsObject()){
-        NSTR_LOG_(warn,"Neuron soma is not an object - Skipping");
-        ++warn_count;
-      } else if (!v["soma"].HasMember("nodes")) {
-        NSTR_LOG_(warn,"Missing nodes field in soma - Skipping");
-        ++warn_count;
-      } else if ( !v["soma"]["nodes"].IsArray() ){
-        NSTR_LOG_(warn,"Soma nodes is not an array - Skipping");
-        ++warn_count;
+      case frame_type::kLeaf:
+        return true;
+        
+      case frame_type::kSkip:
+        return skip_(k);
+        
+      case frame_type::kRoot:
+        if(f.key == field::kNeurons){
+          if(k != value_kind::kArray){
+            fatal_ = "neurons field is not an array";
+            return false;
+          }
+          has_neurons_ = true;
+          push_(frame_type::kNeurons);
+          return true;
+        } else if(f.key == field::kContours){
+          if(k != value_kind::kArray){
+            warn_("Contours field is not an array - skipping");
+            return skip_(k);
+          }
+          push_(frame_type::kContours);
+          return true;
+        } else if(f.key == field::kProperties){
+          return capture_();
+        }
+        // Single neuron document
+        return neuron_value_(f.key, k);
+        
+      case frame_type::kNeurons:
+        if(k != value_kind::kObject){
+          error_("Unexpected non object neuron", "Erroneous neurons are ignored");
+          return skip_(k);
+        }
+        neuron_ = neuron_state();
+        push_(frame_type::kNeuron);
+        return true;
+        
+      case frame_type::kNeuron:
+        if(f.key == field::kProperties) return capture_();
+        return neuron_value_(f.key, k);
+        
+      case frame_type::kNeurites:
+        if(k != value_kind::kObject){
+          error_("Unexpected non object neurite", "Conflicting neurites are ignored");
+          return skip_(k);
+        }
+        neurite_ = neurite_state();
+        neurite_.neurite.reset(new Neurite());
+        push_(frame_type::kNeurite);
+        return true;
+        
+      case frame_type::kNeurite:
+        switch(f.key){
+          case field::kId:
+          case field::kType:
+          case field::kProperties:
+          case field::kMarkers:
+            return capture_();
+          case field::kTree:
+            neurite_.has_tree = true;
+            if(k != value_kind::kObject) return skip_(k);
+            neurite_.tree_object = true;
+            // Create empty root
+            neurite_.neurite->set_root(); 
+            neurite_.neurite->begin_branch()->order(0);
+            branches_.emplace_back(neurite_.neurite->begin_branch());
+            push_(frame_type::kBranch);
+            return true;
+          default:
+            return skip_(k);
+        }
+        
+      case frame_type::kBranch: {
+        branch_state& b = branches_.back();
+        switch(f.key){
+          case field::kRoot:
+            b.has_root = true;
+            return capture_();
+          case field::kProperties:
+            return capture_();
+          case field::kNodes:
+            b.has_nodes = true;
+            if(k != value_kind::kArray){
+              b.error = "Branch nodes field is not an array";
+              return skip_(k);
+            }
+            b.pos->clear();
+            push_(frame_type::kNodes);
+            return true;
+          case field::kChildren:
+            if(k != value_kind::kArray){
+              if(b.error.empty()) b.error = "Branch children field is not an array";
+              return skip_(k);
+            }
+            push_(frame_type::kChildren);
+            return true;
+          default:
+            return skip_(k);
+        }
+      }
+      
+      case frame_type::kNodes:
+        if(k != value_kind::kObject){
+          error_("Unexpected non object node", "Conflicting nodes will are omitted");
+          return skip_(k);
+        }
+        return capture_();
+        
+      case frame_type::kChildren: {
+        // Add temporal branch
+        Neurite::branch_iterator pos = branches_.back().pos;
+        auto newpos = pos->neurite().append_branch(pos, Branch());
+        newpos->order(pos->order()+1);
+        
+        if(k != value_kind::kObject){
+          error_("Unexpected non object branch", "Ignoring conflicting branch");
+          return skip_(k);
+        }
+        branches_.emplace_back(newpos);
+        push_(frame_type::kBranch);
+        return true;
+      }
+        
+      case frame_type::kContours:
+        if(k != value_kind::kObject){
+          error_("Unexpected non object contour", "Erroneous contours are ignored");
+          return skip_(k);
+        }
+        contour_ = contour_state();
+        push_(frame_type::kContour);
+        return true;
+        
+      case frame_type::kContour:
+        switch(f.key){
+          case field::kName:
+          case field::kFaceColor:
+          case field::kBackColor:
+          case field::kClosed:
+          case field::kFill:
+          case field::kResolution:
+            return capture_();
+          case field::kPoints:
+            if(k != value_kind::kArray){
+              contour_.points = status::kWrong;
+              return skip_(k);
+            }
+            contour_.points = status::kOk;
+            push_(frame_type::kPoints);
+            return true;
+          default:
+            return skip_(k);
+        }
+        
+      case frame_type::kPoints:
+        if(k != value_kind::kObject){
+          error_("Unexpected non object point", "Erroneous contour points are omitted");
+          return skip_(k);
+        }
+        return capture_();
+    }
+    return skip_(k);
+  }
+  
+  bool JSONParser::SAXHandler::neuron_value_(field key, value_kind k){
+    switch(key){
+      case field::kId:
+      case field::kSoma:
+        return capture_();
+      case field::kNeurites:
+        neuron_.has_neurites = true;
+        if(k != value_kind::kArray) return skip_(k);
+        neuron_.neurites_array = true;
+        push_(frame_type::kNeurites);
+        return true;
+      default:
+        return skip_(k);
+    }
+  }
+  
+  bool JSONParser::SAXHandler::leaf_end_(){
+    if(!capturing_() || !leaf_.complete()) return true;
+    
+    frames_.pop_back();
+    const rapidjson::Value& v = leaf_.value();
+    const frame& f = frames_.back();
+    
+    try{
+      switch(f.type){
+        
+        case frame_type::kRoot:
+          if(f.key == field::kProperties){
+            // Reconstruction or neuron properties - decided at the end
+            has_properties_ = true;
+            properties_object_ = v.IsObject();
+            if(properties_object_) properties_ = parser_.parseProperties(v.GetObject());
+          } else {
+            leaf_neuron_(f.key, v);
+          }
+          break;
+          
+        case frame_type::kNeuron:
+          if(f.key == field::kProperties){
+            if(!v.IsObject()){
+              warn_("Neuron properties field is not an object - Ignoring");
+            } else {
+              neuron_.properties = parser_.parseProperties(v.GetObject());
+            }
+          } else {
+            leaf_neuron_(f.key, v);
+          }
+          break;
+          
+        case frame_type::kNeurite:
+          if(f.key == field::kId){
+            neurite_.has_id = true;
+            if(v.IsUint()) neurite_.id = v.GetUint();
+          } else if(f.key == field::kType){
+            neurite_.has_type = true;
+            if(v.IsUint()) neurite_.type = v.GetUint();
+          } else if(f.key == field::kProperties){
+            if(!v.IsObject()){
+              warn_("Neurite properties field is not an object - Ignoring");
+            } else {
+              neurite_.neurite->properties = parser_.parseProperties(v.GetObject());
+            }
+          } else if(f.key == field::kMarkers){
+            if(!v.IsObject()){
+              warn_("Neurite markers field is not an object - Ignoring");
+            } else {
+              parser_.parseMarkers(v.GetObject(), *neurite_.neurite);
+            }
+          }
+          break;
+          
+        case frame_type::kBranch: {
+          branch_state& b = branches_.back();
+          if(f.key == field::kRoot){
+            // Root (may throw error)
+            try{
+              if(!v.IsObject()){
+                throw std::logic_error("Unexpected non object node");
+              }
+              b.pos->root(parser_.parseNode(v.GetObject()));
+            } catch(std::logic_error& e){
+              // We just ignore the root
+              parser_.process_error(e);
+              NSTR_LOG_(info, "Error while parsing branch root. Skipped.");  
+              b.pos->remove_root();  
+            }
+          } else if(f.key == field::kProperties){
+            if(!v.IsObject()){
+              warn_("Branch properties field is not an object - Ignoring");
+            } else {
+              b.pos->properties = parser_.parseProperties(v.GetObject());
+            }
+          }
+          break;
+        }
+          
+        case frame_type::kNodes:
+          try{
+            branches_.back().pos->push_back(parser_.parseNode(v.GetObject()));
+          } catch(std::logic_error& e){
+            parser_.process_error(e);
+            NSTR_LOG_(info, "Conflicting nodes will are omitted");  
+          }
+          break;
+          
+        case frame_type::kContour:
+          leaf_contour_(f.key, v);
+          break;
+          
+        case frame_type::kPoints:
+          try{
+            contour_.point_values.push_back(parser_.parsePoint(v.GetObject()));
+          } catch(std::logic_error& e){
+            parser_.process_error(e);
+            NSTR_LOG_(info, "Erroneous contour points are omitted");  
+          }
+          break;
+          
+        default:
+          break;
+      }
+    } catch(std::logic_error& e){
+      // Errors in properties discard the object that owns them
+      switch(f.type){
+        case frame_type::kBranch:
+          if(branches_.back().error.empty()) branches_.back().error = e.what();
+          break;
+        case frame_type::kNeurite:
+          if(neurite_.error.empty()) neurite_.error = e.what();
+          break;
+        case frame_type::kRoot:
+          if(has_neurons_){
+            parser_.process_error(e);
+            has_properties_ = false;
+            break;
+          }
+          // Fall through - single neuron document
+        default:
+          if(neuron_.error.empty()) neuron_.error = e.what();
+      }
+    }
+    
+    leaf_.clear();
+    return true;
+  }
+  
+  void JSONParser::SAXHandler::leaf_neuron_(field key, const rapidjson::Value& v){
+    if(key == field::kId){
+      neuron_.has_id = true;
+      if(v.IsString()) neuron_.id = v.GetString();
+      else if(neuron_.error.empty()) neuron_.error = "Neuron id field is not a string";
+    } else if(key == field::kSoma){
+      if(!v.IsObject()){
+        warn_("Neuron soma is not an object - Skipping");
+      } else if (!v.HasMember("nodes")) {
+        warn_("Missing nodes field in soma - Skipping");
+      } else if ( !v["nodes"].IsArray() ){
+        warn_("Soma nodes is not an array - Skipping");
       } else {
-        // Get soma nodes
-        auto tmp = v["soma"]["nodes"].GetArray();
-
-        std::vector<Node> soma(tmp.Size());
+        auto tmp = v["nodes"].GetArray();
+        neuron_.soma.reserve(tmp.Size());
         
         // Parse each node
         for( auto it = tmp.begin(); it != tmp.end() ; ++it){
@@ -317,229 +832,263 @@ namespace io {
             if(!it->IsObject()){
               throw std::logic_error("Unexpected non object node");
             }
-            soma.push_back(parseNode(it->GetObject()));
-          } catch (std::logic_error e){
-            process_error(e);
+            neuron_.soma.push_back(parser_.parseNode(it->GetObject()));
+          } catch (std::logic_error& e){
+            parser_.process_error(e);
             NSTR_LOG_(info, "Conflicting soma nodes will be ignored");
           }
         }
-        n->add_soma(soma);
       }
     }
+  }
+  
+  void JSONParser::SAXHandler::leaf_contour_(field key, const rapidjson::Value& v){
+    switch(key){
+      case field::kName:
+        contour_.name = v.IsString() ? status::kOk : status::kWrong;
+        if(v.IsString()) contour_.name_value = v.GetString();
+        break;
+      case field::kFaceColor:
+        contour_.face_color = v.IsString() ? status::kOk : status::kWrong;
+        if(v.IsString()) contour_.face_color_value = v.GetString();
+        break;
+      case field::kBackColor:
+        contour_.back_color = v.IsString() ? status::kOk : status::kWrong;
+        if(v.IsString()) contour_.back_color_value = v.GetString();
+        break;
+      case field::kClosed:
+        contour_.closed = v.IsBool() ? status::kOk : status::kWrong;
+        if(v.IsBool()) contour_.closed_value = v.GetBool();
+        break;
+      case field::kFill:
+        contour_.fill = v.IsNumber() ? status::kOk : status::kWrong;
+        if(v.IsNumber()) contour_.fill_value = v.GetFloat();
+        break;
+      case field::kResolution:
+        contour_.resolution = v.IsNumber() ? status::kOk : status::kWrong;
+        if(v.IsNumber()) contour_.resolution_value = v.GetFloat();
+        break;
+      default:
+        break;
+    }
+  }
+  
+  bool JSONParser::SAXHandler::end_(){
+    frame_type t = frames_.back().type;
+    frames_.pop_back();
+    
+    switch(t){
+      case frame_type::kRoot: end_root_(); break;
+      case frame_type::kNeuron: end_neuron_(); break;
+      case frame_type::kNeurite: end_neurite_(); break;
+      case frame_type::kBranch: end_branch_(); break;
+      case frame_type::kContour: end_contour_(); break;
+      default: break;
+    }
+    return true;
+  }
+  
+  void JSONParser::SAXHandler::end_branch_(){
+    branch_state b = std::move(branches_.back());
+    branches_.pop_back();
     
-    // Properties..
-    if(v.HasMember("properties")){
-      if(!v["properties"].IsObject() ){
-        NSTR_LOG_(warn,"Neuron properties field is not an object - Ignoring");
-        ++warn_count;
+    if(!b.has_root){
+      warn_("Unrooted branch");
+    }
+    if(!b.has_nodes){
+      b.error = "Missing nodes field in branch";
+    }
+    
+    if(!b.error.empty()){
+      if(branches_.empty()){
+        // Tree root error discards the neurite
+        if(neurite_.error.empty()) neurite_.error = b.error;
       } else {
-        n->properties = parseProperties(v["properties"].GetObject());
+        error_(b.error, "Ignoring conflicting branch");
       }
     }
+  }
+  
+  Neurite* JSONParser::SAXHandler::build_neurite_(){
+    if(!neurite_.has_id){
+      throw std::logic_error("Missing neurite id field");
+    } else if (neurite_.id < 0){
+      throw std::logic_error("Neurite id field is not an unsigned integer");
+    }
     
-    if(!v.HasMember("neurites")){
-      throw std::logic_error("Missing neurites field in Neuron");
-    } else if ( !v["neurites"].IsArray()){
-      throw std::logic_error("Neuron neurites field is not an array");
+    if(!neurite_.has_type){
+      throw std::logic_error("Missing neurite type field");
+    } else if (neurite_.type < 0){
+      throw std::logic_error("Neurite type field is not an unsigned integer");
     }
     
-    // Tree
-    auto tmp = v["neurites"].GetArray();
-    for(auto it = tmp.begin() ; it != tmp.end() ; ++it){
-      try{
-        if(!it->IsObject()){
-          throw std::logic_error("Unexpected non object neurite");
-        }
-        n->add_neurite(parseNeurite(it->GetObject()));
-      } catch (std::logic_error e){
-        process_error(e);
-        NSTR_LOG_(info, "Conflicting neurites are ignored");
-      }
+    if(!neurite_.has_tree){
+      throw std::logic_error("Missing neurite tree field");
+    } else if (!neurite_.tree_object){
+      throw std::logic_error("Neurite tree field is not an object");
     }
     
-    return n;
+    if(!neurite_.error.empty()){
+      throw std::logic_error(neurite_.error);
+    }
+    
+    neurite_.neurite->id(neurite_.id);
+    neurite_.neurite->type(NeuriteType(neurite_.type));
+    return neurite_.neurite.release();
   }
   
-  Contour JSONParser::parseContour(const rapidjson::Value::ConstObject& v){
+  void JSONParser::SAXHandler::end_neurite_(){
+    try{
+      neuron_.neurites.emplace_back(build_neurite_());
+    } catch (std::logic_error& e){
+      error_(e.what(), "Conflicting neurites are ignored");
+    }
+    neurite_ = neurite_state();
+  }
+  
+  Neuron* JSONParser::SAXHandler::build_neuron_(){
+    if(!neuron_.has_id){
+      throw std::logic_error("Missing neuron id field");
+    } else if(!neuron_.error.empty()){
+      throw std::logic_error(neuron_.error);
+    }
     
-    std::vector<point_type> points;
+    if(!neuron_.has_neurites){
+      throw std::logic_error("Missing neurites field in Neuron");
+    } else if (!neuron_.neurites_array){
+      throw std::logic_error("Neuron neurites field is not an array");
+    }
     
+    Neuron* n = new Neuron(neuron_.id, neuron_.soma);
+    n->properties = std::move(neuron_.properties);
+    for(auto& it : neuron_.neurites){
+      n->add_neurite(it.release());
+    }
+    return n;
+  }
+  
+  void JSONParser::SAXHandler::end_neuron_(){
+    try{
+      rec_.addNeuron(build_neuron_());
+    } catch (std::logic_error& e){
+      error_(e.what(), "Erroneous neurons are ignored");
+    }
+    neuron_ = neuron_state();
+  }
+  
+  Contour JSONParser::SAXHandler::build_contour_(){
     
-    if(!v.HasMember("name")){
+    if(contour_.name == status::kMissing){
       throw std::logic_error("Missing contour name");
-    } else if(!v["name"].IsString()){
+    } else if(contour_.name == status::kWrong){
       throw std::logic_error("Contour name is not a string");
     }
     
-    
-    if(!v.HasMember("face_color")){
+    if(contour_.face_color == status::kMissing){
       throw std::logic_error("Missing contour face_color");
-    } else if(!v["face_color"].IsString()){
+    } else if(contour_.face_color == status::kWrong){
       throw std::logic_error("Contour face_color is not a string");
     }
     
-    
-    if(!v.HasMember("back_color")){
+    if(contour_.back_color == status::kMissing){
       throw std::logic_error("Missing contour back_color");
-    } else if(!v["back_color"].IsString()){
+    } else if(contour_.back_color == status::kWrong){
       throw std::logic_error("Contour back_color is not a string");
     }
     
-    
-    if(!v.HasMember("closed")){
+    if(contour_.closed == status::kMissing){
       throw std::logic_error("Missing contour closed field");
-    } else if(!v["closed"].IsBool()){
+    } else if(contour_.closed == status::kWrong){
       throw std::logic_error("Contour closed is not boolean");
     }
     
-    
-    if(!v.HasMember("fill")){
+    if(contour_.fill == status::kMissing){
       throw std::logic_error("Missing contour fill field");
-    } else if(!v["fill"].IsNumber()){
+    } else if(contour_.fill == status::kWrong){
       throw std::logic_error("Contour fill is not numeric");
     }
     
-    
-    if(!v.HasMember("resolution")){
+    if(contour_.resolution == status::kMissing){
       throw std::logic_error("Missing contour resolution field");
-    } else if(!v["resolution"].IsNumber()){
+    } else if(contour_.resolution == status::kWrong){
       throw std::logic_error("Contour resolution is not numeric");
     }
     
-    
-    if(!v.HasMember("points")){
+    if(contour_.points == status::kMissing){
       throw std::logic_error("Missing contour points field");
-    } else if(!v["points"].IsArray()){
+    } else if(contour_.points == status::kWrong){
       throw std::logic_error("Contour points is not an array");
     }
     
-    auto tmp = v["points"].GetArray();
-    for(auto it = tmp.begin() ; it != tmp.end() ; ++it){
-      try{
-        if(!it->IsObject()){
-          throw std::logic_error("Unexpected non object point");
-        }
-        points.push_back( parsePoint(it->GetObject()));
-      } catch( std::logic_error e){
-        process_error(e);
-        NSTR_LOG_(info, "Erroneous contour points are omitted");  
-      }
-    }
-    
-    Contour c(points);
+    Contour c(contour_.point_values);
     
-    c.name(v["name"].GetString());
-    c.face_color(v["face_color"].GetString());
-    c.back_color(v["back_color"].GetString());
-    c.fill_density(v["fill"].GetFloat());
-    c.resolution(v["resolution"].GetFloat());
+    c.name(contour_.name_value);
+    c.face_color(contour_.face_color_value);
+    c.back_color(contour_.back_color_value);
+    c.fill_density(contour_.fill_value);
+    c.resolution(contour_.resolution_value);
     
-    if(v["closed"].GetBool())
+    if(contour_.closed_value)
       c.close();
     
     return c;
   }
   
-  std::unique_ptr<Reconstruction> JSONParser::parse_document(const std::string& name ,
-                                                             const rapidjson::Document& doc){
-    
-     // Create reconstruction
-    Reconstruction* r = new Reconstruction(name);
-    
-    
-    // Check if it is a single neuron or a neuron set
-    if(doc.HasMember("neurons")){
-      if(!doc["neurons"].IsArray()){
-        throw std::logic_error("neurons field is not an array");
-      }
-      
-      // Is a rec. set
-      auto tmp = doc["neurons"].GetArray();
-      for(auto it = tmp.Begin() ; it != tmp.End() ; ++it){
-        try{
-          if(!it->IsObject()){
-            throw std::logic_error("Unexpected non object neuron");
-          }
-          r->addNeuron(parseNeuron(it->GetObject()));
-        } catch (std::logic_error e){
-          process_error(e);
-          NSTR_LOG_(info, "Erroneous neurons are ignored");
-        }
-      }
-      
-      // Read contour
-      if(doc.HasMember("contours")){
-        if(!doc["contours"].IsArray()){
-          NSTR_LOG_(warn,"Contours field is not an array - skipping");
-          ++warn_count;
+  void JSONParser::SAXHandler::end_contour_(){
+    try{
+      rec_.addContour(build_contour_());
+    } catch (std::logic_error& e){
+      error_(e.what(), "Erroneous contours are ignored");
+    }
+    contour_ = contour_state();
+  }
+  
+  void JSONParser::SAXHandler::end_root_(){
+    if(has_neurons_){
+      // Reconstruction object
+      if(has_properties_){
+        if(!properties_object_){
+          warn_("Reconstruction properties field is not an object - Skipping");
         } else {
-          auto tmp = doc["contours"].GetArray();
-          for(auto it = tmp.Begin() ; it != tmp.End() ; ++it){
-            try{
-              if(!it->IsObject()){
-                throw std::logic_error("Unexpected non object contour");
-              }
-              r->addContour(parseContour(it->GetObject()));
-            } catch (std::logic_error e){
-              process_error(e);
-              NSTR_LOG_(info, "Erroneous contours are ignored");
-            }
-          }
+          rec_.properties = std::move(properties_);
         }
       }
-      
-      // Read properties
-      if(doc.HasMember("properties")){
-        if(!doc["properties"].IsObject() ){
-          NSTR_LOG_(warn,"Reconstruction properties field is not an object - Skipping");
-          ++warn_count;
+    } else {
+      // Single neuron document
+      if(has_properties_){
+        if(!properties_object_){
+          warn_("Neuron properties field is not an object - Ignoring");
         } else {
-          r->properties = parseProperties(doc["properties"].GetObject());
+          neuron_.properties = std::move(properties_);
         }
       }
-      
-      
-    
-    } else {
-      // Single
-      
-      try{
-        r->addNeuron(parseNeuron(doc.GetObject()));
-      } catch (std::logic_error e){
-          process_error(e);
-          NSTR_LOG_(info, "Erroneous neurons are ignored");
-      }
+      end_neuron_();
     }
-    
-    return std::unique_ptr<Reconstruction>(r);
   }
   
   std::unique_ptr<Reconstruction> JSONParser::read(const std::string& name){
     
-    // Create and open doc
-    rapidjson::Document doc;
-    
     reset_errors();
     
+    std::unique_ptr<Reconstruction> ret(new Reconstruction(name));
+    SAXHandler handler(*this, *ret);
+    
+    rapidjson::Reader reader;
     rapidjson::IStreamWrapper isw(stream_);
-    doc.ParseStream(isw);
+    rapidjson::ParseResult res = reader.Parse(isw, handler);
     
-    if(doc.HasParseError()){
+    if(res.IsError()){
+      // The partial content is discarded
+      reset_errors();
       critical_error = true;
-      NSTR_LOG_(critical, rapidjson::GetParseError_En(doc.GetParseError()));
+      if(handler.error().empty()){
+        NSTR_LOG_(critical, rapidjson::GetParseError_En(res.Code()));
+      } else {
+        NSTR_LOG_(critical, handler.error());
+      }
       ++error_count;
       return std::unique_ptr<Reconstruction>( new Reconstruction(name) );
     }
-    //assert(doc.IsObject());
-    std::unique_ptr<Reconstruction> ret;
-    try{
-      ret = parse_document(name,doc);
-      
-    } catch(std::exception e){
-      critical_error = true;
-      NSTR_LOG_(critical, e.what());
-      ++error_count;
-    }
     
     if(error_count > 0){
       NSTR_LOG_(warn, std::to_string(error_count) + 
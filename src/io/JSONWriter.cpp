@@ -9,11 +9,15 @@
 
 #include <neurostr/io/JSONWriter.h>
 
+#include <stdexcept>
+
 namespace neurostr {
 namespace io {
   
  
-    JSONWriter::JSONWriter(std::ostream& s,bool pretty) : buffer(s) {
+    JSONWriter::JSONWriter(std::ostream& s,bool pretty) 
+      : buffer(s)
+      , state_(state::kIdle) {
       if(pretty)
         writer = std::unique_ptr<writer_type>(new rapidjson::PrettyWriter<OutputStream>(buffer));
       else 
@@ -54,6 +58,57 @@ namespace io {
         writer->EndObject();
     }
     
+    void JSONWriter::beginReconstruction(){
+      if(state_ != state::kIdle){
+        throw std::logic_error("JSON reconstruction already open");
+      }
+      
+      writer->StartObject();
+      writer->Key("neurons");
+      writer->StartArray();
+      state_ = state::kNeurons;
+    }
+    
+    void JSONWriter::addNeuron(const neurostr::Neuron& n){
+      if(state_ == state::kIdle){
+        throw std::logic_error("No open JSON reconstruction");
+      } else if(state_ == state::kContours){
+        throw std::logic_error("Neurons can't be added after contours");
+      }
+      writeNeuron(n);
+    }
+    
+    void JSONWriter::addContour(const neurostr::Contour& c){
+      if(state_ == state::kIdle){
+        throw std::logic_error("No open JSON reconstruction");
+      } else if(state_ == state::kNeurons){
+        // Close neuron array
+        writer->EndArray();
+        writer->Key("contours");
+        writer->StartArray();
+        state_ = state::kContours;
+      }
+      writeContour(c);
+    }
+    
+    void JSONWriter::endReconstruction(const neurostr::PropertyMap& p){
+      if(state_ == state::kIdle){
+        throw std::logic_error("No open JSON reconstruction");
+      }
+      
+      // Neurons / contours array
+      writer->EndArray();
+      
+      if(p.size()>0){
+        writer->Key("properties");  
+        writePropertyMap(p);
+      }
+      
+      writer->EndObject();
+      buffer.Flush();
+      state_ = state::kIdle;
+    }
+    
     /**
      * @brief Writes a single neuron (wo rec. contours)
      * @param n Neuron
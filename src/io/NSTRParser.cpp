@@ -0,0 +1,305 @@
+#include <neurostr/io/NSTRParser.h>
+
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
+
+namespace neurostr {
+namespace io {
+
+namespace {
+
+  float bits_float(std::uint32_t v){
+    float ret;
+    std::memcpy(&ret, &v, sizeof(float));
+    return ret;
+  }
+
+} // anonymous
+
+std::unique_ptr<Reconstruction> NSTRParser::read(const std::string& name){
+  // Copy the stream into an aligned buffer
+  std::string content{std::istreambuf_iterator<char>(stream_),
+                      std::istreambuf_iterator<char>()};
+  std::vector<std::uint64_t> buffer((content.size() + 7) / 8);
+  if(content.size() > 0) std::memcpy(buffer.data(), content.data(), content.size());
+
+  return read_buffer(reinterpret_cast<const char*>(buffer.data()), content.size(), name);
+}
+
+std::unique_ptr<Reconstruction> NSTRParser::read_mapped(const std::string& path,
+                                                        const std::string& name){
+  namespace bip = boost::interprocess;
+
+  // Empty files cannot be mapped (throws if the file doesnt exist)
+  if(boost::filesystem::file_size(path) == 0){
+    return read_buffer(nullptr, 0, name);
+  }
+
+  bip::file_mapping file(path.c_str(), bip::read_only);
+  bip::mapped_region region(file, bip::read_only);
+  return read_buffer(static_cast<const char*>(region.get_address()), region.get_size(), name);
+}
+
+std::unique_ptr<Reconstruction> NSTRParser::read_buffer(const char* data,
+                                                        std::size_t size,
+                                                        const std::string& name){
+  reset_errors();
+  std::unique_ptr<Reconstruction> r(new Reconstruction(name));
+
+  try {
+    map_sections_(data, size);
+
+    if(reconstruction_.count > 0){
+      r->properties = properties_(reconstruction_.at(0).properties);
+    }
+
+    for(std::size_t i = 0; i < neurons_.count; ++i){
+      r->addNeuron(neuron_(neurons_.data[i]));
+    }
+
+    for(std::size_t i = 0; i < contours_.count; ++i){
+      r->addContour(contour_(contours_.data[i]));
+    }
+  } catch(std::exception& e){
+    critical_error = true;
+    NSTR_LOG_(critical, e.what());
+    ++error_count;
+    r.reset(new Reconstruction(name));
+  }
+
+  // Views are only valid while the buffer exists
+  map_sections_(nullptr, 0);
+  return r;
+}
+
+template <typename T>
+void NSTRParser::map_section_(const char* data, std::size_t size,
+                              const nstr::section_entry& e, section_view<T>& v){
+  if(e.record_size != sizeof(T)){
+    throw std::runtime_error("Unexpected NSTR record size in section " + std::to_string(e.id));
+  }
+  if(e.offset % alignof(T) != 0 || e.offset > size ||
+     e.count > (size - e.offset) / sizeof(T)){
+    throw std::runtime_error("NSTR section " + std::to_string(e.id) + " out of file bounds");
+  }
+  v.data = reinterpret_cast<const T*>(data + e.offset);
+  v.count = e.count;
+}
+
+void NSTRParser::map_sections_(const char* data, std::size_t size){
+  strings_ = section_view<char>();
+  reconstruction_ = section_view<nstr::reconstruction_record>();
+  nodes_ = section_view<nstr::node_record>();
+  neurons_ = section_view<nstr::neuron_record>();
+  neurites_ = section_view<nstr::neurite_record>();
+  branches_ = section_view<nstr::branch_record>();
+  branch_ids_ = section_view<std::int32_t>();
+  markers_ = section_view<nstr::marker_record>();
+  contours_ = section_view<nstr::contour_record>();
+  points_ = section_view<nstr::point_record>();
+  property_maps_ = section_view<nstr::property_map_record>();
+  properties_records_ = section_view<nstr::property_record>();
+
+  if(data == nullptr) {
+    if(size == 0) return;
+    throw std::runtime_error("Invalid NSTR buffer");
+  }
+
+  // Header
+  nstr::file_header header;
+  if(size < sizeof(header)){
+    throw std::runtime_error("NSTR file too short");
+  }
+  std::memcpy(&header, data, sizeof(header));
+  if(std::memcmp(header.magic, nstr::magic, sizeof(header.magic)) != 0){
+    throw std::runtime_error("Not a NSTR file");
+  } else if(header.byte_order != nstr::byte_order){
+    throw std::runtime_error("NSTR file byte order doesnt match");
+  } else if(header.version != nstr::version){
+    throw std::runtime_error("Unsupported NSTR version " + std::to_string(header.version));
+  } else if(header.section_count > (size - sizeof(header)) / sizeof(nstr::section_entry)){
+    throw std::runtime_error("Truncated NSTR section table");
+  }
+
+  // Sections. Unknown sections are ignored
+  for(std::uint32_t i = 0; i < header.section_count; ++i){
+    nstr::section_entry e;
+    std::memcpy(&e, data + sizeof(header) + i * sizeof(e), sizeof(e));
+
+    switch(static_cast<nstr::section_id>(e.id)){
+      case nstr::section_id::kReconstruction: map_section_(data, size, e, reconstruction_); break;
+      case nstr::section_id::kStrings: map_section_(data, size, e, strings_); break;
+      case nstr::section_id::kNodes: map_section_(data, size, e, nodes_); break;
+      case nstr::section_id::kNeurons: map_section_(data, size, e, neurons_); break;
+      case nstr::section_id::kNeurites: map_section_(data, size, e, neurites_); break;
+      case nstr::section_id::kBranches: map_section_(data, size, e, branches_); break;
+      case nstr::section_id::kBranchIds: map_section_(data, size, e, branch_ids_); break;
+      case nstr::section_id::kMarkers: map_section_(data, size, e, markers_); break;
+      case nstr::section_id::kContours: map_section_(data, size, e, contours_); break;
+      case nstr::section_id::kPoints: map_section_(data, size, e, points_); break;
+      case nstr::section_id::kPropertyMaps: map_section_(data, size, e, property_maps_); break;
+      case nstr::section_id::kProperties: map_section_(data, size, e, properties_records_); break;
+      default:
+        NSTR_LOG_(warn, "Unknown NSTR section " + std::to_string(e.id) + " - Skipping");
+        ++warn_count;
+    }
+  }
+}
+
+std::string NSTRParser::string_(const nstr::string_ref& s) const {
+  if(s.offset > strings_.count || s.length > strings_.count - s.offset){
+    throw std::out_of_range("String reference out of range");
+  }
+  return std::string(strings_.data + s.offset, s.length);
+}
+
+PropertyMap NSTRParser::properties_(std::uint32_t i) const {
+  PropertyMap ret;
+  if(i == nstr::npos) return ret;
+
+  const auto& m = property_maps_.at(i);
+  for(std::uint32_t j = 0; j < m.count; ++j){
+    const auto& p = properties_records_.at(m.begin + j);
+    std::string key = string_(p.key);
+
+    switch(static_cast<nstr::property_kind>(p.kind)){
+      case nstr::property_kind::kEmpty:
+        ret.set(key);
+        break;
+      case nstr::property_kind::kInt: {
+        std::int32_t v;
+        std::memcpy(&v, &p.value[0], sizeof(v));
+        ret.set(key, static_cast<int>(v));
+        break;
+      }
+      case nstr::property_kind::kFloat:
+        ret.set(key, bits_float(p.value[0]));
+        break;
+      case nstr::property_kind::kBool:
+        ret.set(key, p.value[0] != 0);
+        break;
+      case nstr::property_kind::kPoint:
+        ret.set(key, point_type(bits_float(p.value[0]),
+                                bits_float(p.value[1]),
+                                bits_float(p.value[2])));
+        break;
+      case nstr::property_kind::kString:
+        ret.set(key, string_(nstr::string_ref{p.value[0], p.value[1]}));
+        break;
+      default:
+        throw std::runtime_error("Unknown NSTR property type for " + key);
+    }
+  }
+  return ret;
+}
+
+Node NSTRParser::node_(std::uint32_t i) const {
+  const auto& n = nodes_.at(i);
+  Node ret(n.id, point_type(n.x, n.y, n.z), n.r);
+  if(n.properties != nstr::npos){
+    ret.properties = properties_(n.properties);
+  }
+  return ret;
+}
+
+Neuron* NSTRParser::neuron_(const nstr::neuron_record& n) const {
+  std::unique_ptr<Neuron> ret(new Neuron(string_(n.id)));
+  ret->up(point_type(n.up[0], n.up[1], n.up[2]));
+  ret->properties = properties_(n.properties);
+
+  std::vector<Node> soma;
+  soma.reserve(n.soma_count);
+  for(std::uint32_t i = 0; i < n.soma_count; ++i){
+    soma.push_back(node_(n.soma_begin + i));
+  }
+  if(!soma.empty()) ret->add_soma(soma);
+
+  for(std::uint32_t i = 0; i < n.neurite_count; ++i){
+    ret->add_neurite(neurite_(neurites_.at(n.neurite_begin + i)));
+  }
+  return ret.release();
+}
+
+Neurite* NSTRParser::neurite_(const nstr::neurite_record& n) const {
+  std::unique_ptr<Neurite> ret(new Neurite(n.id, NeuriteType(n.type)));
+  ret->properties = properties_(n.properties);
+
+  // Markers
+  for(std::uint32_t i = 0; i < n.marker_count; ++i){
+    const auto& m = markers_.at(n.marker_begin + i);
+    std::vector<Node> nodes;
+    nodes.reserve(m.node_count);
+    for(std::uint32_t j = 0; j < m.node_count; ++j){
+      nodes.push_back(node_(m.node_begin + j));
+    }
+    ret->add_marker(string_(m.name), nodes.begin(), nodes.end());
+  }
+
+  // Branches (pre-order, so parents are always created before children)
+  std::vector<Neurite::branch_iterator> pos;
+  pos.reserve(n.branch_count);
+  for(std::uint32_t i = 0; i < n.branch_count; ++i){
+    const auto& b = branches_.at(n.branch_begin + i);
+
+    Neurite::branch_iterator it;
+    if(b.parent == nstr::npos){
+      if(i != 0) throw std::runtime_error("NSTR neurite with several root branches");
+      if((n.flags & nstr::neurite_root_is_soma) != 0 && b.root != nstr::npos){
+        ret->set_root(node_(b.root));
+      } else {
+        ret->set_root();
+      }
+      it = ret->begin_branch();
+    } else {
+      if(b.parent >= i) throw std::runtime_error("NSTR branch parent out of order");
+      it = ret->append_branch(pos[b.parent], Branch());
+    }
+
+    Branch::id_type id;
+    id.reserve(b.id_count);
+    for(std::uint32_t j = 0; j < b.id_count; ++j){
+      id.push_back(branch_ids_.at(b.id_begin + j));
+    }
+    it->id(id);
+    it->order(b.order);
+
+    if(b.root == nstr::npos) it->remove_root();
+    else it->root(node_(b.root));
+
+    for(std::uint32_t j = 0; j < b.node_count; ++j){
+      it->push_back(node_(b.node_begin + j));
+    }
+    it->properties = properties_(b.properties);
+
+    pos.push_back(it);
+  }
+
+  return ret.release();
+}
+
+Contour NSTRParser::contour_(const nstr::contour_record& c) const {
+  std::vector<point_type> points;
+  points.reserve(c.point_count);
+  for(std::uint32_t i = 0; i < c.point_count; ++i){
+    const auto& p = points_.at(c.point_begin + i);
+    points.emplace_back(p.x, p.y, p.z);
+  }
+
+  Contour ret(points);
+  ret.name(string_(c.name));
+  ret.face_color(string_(c.face_color));
+  ret.back_color(string_(c.back_color));
+  ret.fill_density(c.fill);
+  ret.resolution(c.resolution);
+  if(c.closed != 0) ret.close();
+  return ret;
+}
+
+} // io
+} // neurostr
@@ -0,0 +1,302 @@
+#include <neurostr/io/NSTRWriter.h>
+
+#include <cstring>
+#include <unordered_map>
+
+namespace neurostr {
+namespace io {
+
+namespace {
+
+  std::uint32_t float_bits(float f){
+    std::uint32_t ret;
+    std::memcpy(&ret, &f, sizeof(float));
+    return ret;
+  }
+
+  std::uint32_t as_index(std::size_t i){
+    if(i >= nstr::npos) throw std::length_error("Reconstruction too large for the NSTR format");
+    return static_cast<std::uint32_t>(i);
+  }
+
+  // Padding up to the next 8-byte boundary
+  std::size_t padding(std::size_t pos){
+    return (8 - pos % 8) % 8;
+  }
+
+} // anonymous
+
+NSTRWriter::NSTRWriter(std::ostream& s) : stream_(s) {};
+
+std::ostream& NSTRWriter::write(const Reconstruction& r){
+  clear_();
+
+  nstr::reconstruction_record rec;
+  rec.id = add_string_(r.id());
+  rec.properties = add_properties_(r.properties);
+  rec.reserved = 0;
+  reconstruction_.push_back(rec);
+
+  for(auto it = r.begin(); it != r.end(); ++it){
+    add_neuron_(*it);
+  }
+
+  for(auto it = r.contour_begin(); it != r.contour_end(); ++it){
+    add_contour_(*it);
+  }
+
+  write_file_();
+  clear_();
+  return stream_;
+}
+
+void NSTRWriter::clear_(){
+  strings_.clear();
+  reconstruction_.clear();
+  nodes_.clear();
+  neurons_.clear();
+  neurites_.clear();
+  branches_.clear();
+  branch_ids_.clear();
+  markers_.clear();
+  contours_.clear();
+  points_.clear();
+  property_maps_.clear();
+  properties_.clear();
+}
+
+nstr::string_ref NSTRWriter::add_string_(const std::string& s){
+  nstr::string_ref ret;
+  ret.offset = as_index(strings_.size());
+  ret.length = as_index(s.size());
+  strings_.append(s);
+  return ret;
+}
+
+std::uint32_t NSTRWriter::add_properties_(const PropertyMap& p){
+  if(p.size() == 0) return nstr::npos;
+
+  nstr::property_map_record m;
+  m.begin = as_index(properties_.size());
+  m.count = as_index(p.size());
+
+  for(auto it = p.begin(); it != p.end(); ++it){
+    nstr::property_record prop;
+    prop.key = add_string_(PropertyMap::key(*it));
+    prop.value[0] = prop.value[1] = prop.value[2] = 0;
+
+    if(PropertyMap::empty(*it)){
+      prop.kind = static_cast<std::uint32_t>(nstr::property_kind::kEmpty);
+    } else if(PropertyMap::is<int>(*it)){
+      prop.kind = static_cast<std::uint32_t>(nstr::property_kind::kInt);
+      std::int32_t v = PropertyMap::value<int>(*it);
+      std::memcpy(&prop.value[0], &v, sizeof(v));
+    } else if(PropertyMap::is<float>(*it)){
+      prop.kind = static_cast<std::uint32_t>(nstr::property_kind::kFloat);
+      prop.value[0] = float_bits(PropertyMap::value<float>(*it));
+    } else if(PropertyMap::is<bool>(*it)){
+      prop.kind = static_cast<std::uint32_t>(nstr::property_kind::kBool);
+      prop.value[0] = PropertyMap::value<bool>(*it) ? 1 : 0;
+    } else if(PropertyMap::is<point_type>(*it)){
+      prop.kind = static_cast<std::uint32_t>(nstr::property_kind::kPoint);
+      point_type v = PropertyMap::value<point_type>(*it);
+      prop.value[0] = float_bits(geometry::get<0>(v));
+      prop.value[1] = float_bits(geometry::get<1>(v));
+      prop.value[2] = float_bits(geometry::get<2>(v));
+    } else {
+      // Strings (and unknown types, as their string value)
+      prop.kind = static_cast<std::uint32_t>(nstr::property_kind::kString);
+      nstr::string_ref s = add_string_(PropertyMap::value_as_string(*it));
+      prop.value[0] = s.offset;
+      prop.value[1] = s.length;
+    }
+    properties_.push_back(prop);
+  }
+
+  property_maps_.push_back(m);
+  return as_index(property_maps_.size() - 1);
+}
+
+std::uint32_t NSTRWriter::add_node_(const Node& n){
+  nstr::node_record rec;
+  rec.id = n.id();
+  rec.x = n.x();
+  rec.y = n.y();
+  rec.z = n.z();
+  rec.r = n.radius();
+  rec.properties = add_properties_(n.properties);
+  nodes_.push_back(rec);
+  return as_index(nodes_.size() - 1);
+}
+
+void NSTRWriter::add_neuron_(const Neuron& n){
+  nstr::neuron_record rec;
+  rec.id = add_string_(n.id());
+  rec.up[0] = geometry::get<0>(n.up());
+  rec.up[1] = geometry::get<1>(n.up());
+  rec.up[2] = geometry::get<2>(n.up());
+  rec.properties = add_properties_(n.properties);
+
+  rec.soma_begin = as_index(nodes_.size());
+  for(auto it = n.begin_soma(); it != n.end_soma(); ++it){
+    add_node_(*it);
+  }
+  rec.soma_count = as_index(nodes_.size() - rec.soma_begin);
+
+  rec.neurite_begin = as_index(neurites_.size());
+  for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
+    add_neurite_(*it);
+  }
+  rec.neurite_count = as_index(neurites_.size() - rec.neurite_begin);
+  neurons_.push_back(rec);
+}
+
+void NSTRWriter::add_neurite_(const Neurite& n){
+  nstr::neurite_record rec;
+  rec.id = n.id();
+  rec.type = static_cast<std::uint32_t>(n.type());
+  rec.flags = n.root_is_soma() ? nstr::neurite_root_is_soma : 0;
+  rec.properties = add_properties_(n.properties);
+
+  // Markers
+  rec.marker_begin = as_index(markers_.size());
+  for(auto it = n.begin_marker(); it != n.end_marker(); ++it){
+    nstr::marker_record m;
+    m.name = add_string_(it->first);
+    m.node_begin = as_index(nodes_.size());
+    for(const auto& node : it->second) add_node_(node);
+    m.node_count = as_index(nodes_.size() - m.node_begin);
+    markers_.push_back(m);
+  }
+  rec.marker_count = as_index(markers_.size() - rec.marker_begin);
+
+  // Branches in DFS pre-order. Parents are relative to the neurite
+  rec.branch_begin = as_index(branches_.size());
+  std::unordered_map<const void*, std::uint32_t> local;
+  std::uint32_t count = 0;
+  for(auto it = n.begin_branch(); it != n.end_branch(); ++it, ++count){
+    local.emplace(it.node, count);
+
+    nstr::branch_record b;
+    b.parent = nstr::npos;
+    if(it.node->parent != nullptr){
+      auto p = local.find(it.node->parent);
+      if(p != local.end()) b.parent = p->second;
+    }
+    b.order = it->order();
+
+    b.id_begin = as_index(branch_ids_.size());
+    auto id = it->id();
+    branch_ids_.insert(branch_ids_.end(), id.begin(), id.end());
+    b.id_count = as_index(id.size());
+
+    b.root = it->has_root() ? add_node_(it->root()) : nstr::npos;
+    b.node_begin = as_index(nodes_.size());
+    for(auto node = it->begin(); node != it->end(); ++node){
+      add_node_(*node);
+    }
+    b.node_count = as_index(it->size());
+    b.properties = add_properties_(it->properties);
+    branches_.push_back(b);
+  }
+  rec.branch_count = count;
+
+  neurites_.push_back(rec);
+}
+
+void NSTRWriter::add_contour_(const Contour& c){
+  nstr::contour_record rec;
+  rec.name = add_string_(c.name());
+  rec.face_color = add_string_(c.face_color());
+  rec.back_color = add_string_(c.back_color());
+  rec.closed = c.is_closed() ? 1 : 0;
+  rec.fill = c.fill_density();
+  rec.resolution = c.resolution();
+
+  rec.point_begin = as_index(points_.size());
+  for(auto it = c.begin(); it != c.end(); ++it){
+    points_.push_back(nstr::point_record{ geometry::get<0>(*it),
+                                          geometry::get<1>(*it),
+                                          geometry::get<2>(*it) });
+  }
+  rec.point_count = as_index(c.size());
+  contours_.push_back(rec);
+}
+
+void NSTRWriter::write_file_(){
+
+  struct section {
+    nstr::section_id id;
+    std::size_t record_size;
+    std::size_t count;
+    const char* data;
+  };
+
+  const section sections[nstr::section_count] = {
+    {nstr::section_id::kReconstruction, sizeof(nstr::reconstruction_record),
+      reconstruction_.size(), reinterpret_cast<const char*>(reconstruction_.data())},
+    {nstr::section_id::kStrings, 1, strings_.size(), strings_.data()},
+    {nstr::section_id::kNodes, sizeof(nstr::node_record),
+      nodes_.size(), reinterpret_cast<const char*>(nodes_.data())},
+    {nstr::section_id::kNeurons, sizeof(nstr::neuron_record),
+      neurons_.size(), reinterpret_cast<const char*>(neurons_.data())},
+    {nstr::section_id::kNeurites, sizeof(nstr::neurite_record),
+      neurites_.size(), reinterpret_cast<const char*>(neurites_.data())},
+    {nstr::section_id::kBranches, sizeof(nstr::branch_record),
+      branches_.size(), reinterpret_cast<const char*>(branches_.data())},
+    {nstr::section_id::kBranchIds, sizeof(std::int32_t),
+      branch_ids_.size(), reinterpret_cast<const char*>(branch_ids_.data())},
+    {nstr::section_id::kMarkers, sizeof(nstr::marker_record),
+      markers_.size(), reinterpret_cast<const char*>(markers_.data())},
+    {nstr::section_id::kContours, sizeof(nstr::contour_record),
+      contours_.size(), reinterpret_cast<const char*>(contours_.data())},
+    {nstr::section_id::kPoints, sizeof(nstr::point_record),
+      points_.size(), reinterpret_cast<const char*>(points_.data())},
+    {nstr::section_id::kPropertyMaps, sizeof(nstr::property_map_record),
+      property_maps_.size(), reinterpret_cast<const char*>(property_maps_.data())},
+    {nstr::section_id::kProperties, sizeof(nstr::property_record),
+      properties_.size(), reinterpret_cast<const char*>(properties_.data())}
+  };
+
+  // Header
+  nstr::file_header header;
+  std::memcpy(header.magic, nstr::magic, sizeof(header.magic));
+  header.version = nstr::version;
+  header.byte_order = nstr::byte_order;
+  header.section_count = nstr::section_count;
+  header.reserved = 0;
+
+  // Section table
+  std::uint64_t offset = sizeof(nstr::file_header) +
+                         nstr::section_count * sizeof(nstr::section_entry);
+  offset += padding(offset);
+
+  nstr::section_entry table[nstr::section_count];
+  for(std::uint32_t i = 0; i < nstr::section_count; ++i){
+    table[i].id = static_cast<std::uint32_t>(sections[i].id);
+    table[i].record_size = static_cast<std::uint32_t>(sections[i].record_size);
+    table[i].offset = offset;
+    table[i].count = sections[i].count;
+    offset += sections[i].count * sections[i].record_size;
+    offset += padding(offset);
+  }
+
+  const char zeros[8] = {0,0,0,0,0,0,0,0};
+  std::size_t pos = sizeof(header) + sizeof(table);
+
+  stream_.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  stream_.write(reinterpret_cast<const char*>(table), sizeof(table));
+  stream_.write(zeros, padding(pos));
+  pos += padding(pos);
+
+  for(const auto& s : sections){
+    std::size_t size = s.count * s.record_size;
+    if(size > 0) stream_.write(s.data, size);
+    pos += size;
+    stream_.write(zeros, padding(pos));
+    pos += padding(pos);
+  }
+}
+
+} // io
+} // neurostr
@@ -1,11 +1,183 @@
 #include <stdexcept>
 #include <neurostr/io/SWCParser.h>
 #include <algorithm>
+#include <iterator>
 #include <string>
+#include <limits>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <cerrno>
+#include <cfloat>
+#include <cctype>
+#include <vector>
+
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 namespace neurostr {
 namespace io {
 
+namespace {
+
+  // Exact powers of ten in double precision
+  const double pow10_table[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+  inline bool is_digit(char c) { return c >= '0' && c <= '9'; }
+
+  /**
+   * @brief Parses an integer at the begining of [b,e) as std::stoi would do
+   * @param b Begin char
+   * @param e End char
+   * @param v Parsed value
+   * @throws out_of_range If the value doesnt fit in an int
+   * @return Number of characters consumed. Zero if the range is not numeric
+   */
+  std::size_t scan_int(const char* b, const char* e, int& v) {
+    const char* p = b;
+    bool negative = false;
+    if (p != e && (*p == '+' || *p == '-')) {
+      negative = (*p == '-');
+      ++p;
+    }
+
+    const char* digits = p;
+    long long value = 0;
+    for (; p != e && is_digit(*p); ++p) {
+      value = value * 10 + (*p - '0');
+      if (value > static_cast<long long>(std::numeric_limits<int>::max()) + 1)
+        throw std::out_of_range("Integer value out of range");
+    }
+
+    if (p == digits) return 0;
+    if (negative) value = -value;
+    if (value > std::numeric_limits<int>::max())
+      throw std::out_of_range("Integer value out of range");
+
+    v = static_cast<int>(value);
+    return p - b;
+  }
+
+  /**
+   * @brief strtof over a non null-terminated range. Used when the fast path
+   * cannot guarantee a correctly rounded result
+   */
+  std::size_t scan_float_slow(const char* b, const char* e, float& v) {
+    // Short tokens are copied in the stack. Long ones in a string so they
+    // are never truncated
+    char buffer[64];
+    std::string long_token;
+    const char* str = buffer;
+    std::size_t len = e - b;
+    if (len < sizeof(buffer)) {
+      std::memcpy(buffer, b, len);
+      buffer[len] = '\0';
+    } else {
+      long_token.assign(b, e);
+      str = long_token.c_str();
+    }
+
+    char* end;
+    errno = 0;
+    float value = std::strtof(str, &end);
+    if (end == str) return 0;
+    if (errno == ERANGE) throw std::out_of_range("Float value out of range");
+
+    v = value;
+    return end - str;
+  }
+
+  /**
+   * @brief Parses a float at the begining of [b,e) as std::stof would do.
+   * Plain decimal values are computed exactly in double precision and rounded
+   * once; anything else (long mantissas, hex, inf/nan, values close to a
+   * rounding tie) is delegated to strtof so results are always identical.
+   * @param b Begin char
+   * @param e End char
+   * @param v Parsed value
+   * @throws out_of_range If the value is out of float range
+   * @return Number of characters consumed. Zero if the range is not numeric
+   */
+  std::size_t scan_float(const char* b, const char* e, float& v) {
+    const char* p = b;
+    bool negative = false;
+    if (p != e && (*p == '+' || *p == '-')) {
+      negative = (*p == '-');
+      ++p;
+    }
+
+    std::uint64_t mantissa = 0;
+    int significant = 0;
+    int exponent = 0;
+    bool any_digit = false;
+
+    // Integer part
+    for (; p != e && is_digit(*p); ++p) {
+      any_digit = true;
+      if (mantissa != 0 || *p != '0') ++significant;
+      if (significant <= 19)
+        mantissa = mantissa * 10 + (*p - '0');
+      else
+        ++exponent;
+    }
+
+    // Fractional part
+    if (p != e && *p == '.') {
+      ++p;
+      for (; p != e && is_digit(*p); ++p) {
+        any_digit = true;
+        if (mantissa != 0 || *p != '0') ++significant;
+        if (significant <= 19) {
+          mantissa = mantissa * 10 + (*p - '0');
+          --exponent;
+        }
+      }
+    }
+
+    // Exponent
+    if (any_digit && p != e && (*p == 'e' || *p == 'E')) {
+      const char* q = p + 1;
+      bool exp_negative = false;
+      if (q != e && (*q == '+' || *q == '-')) {
+        exp_negative = (*q == '-');
+        ++q;
+      }
+      if (q != e && is_digit(*q)) {
+        int exp_value = 0;
+        for (; q != e && is_digit(*q); ++q) {
+          if (exp_value < 10000) exp_value = exp_value * 10 + (*q - '0');
+        }
+        exponent += exp_negative ? -exp_value : exp_value;
+        p = q;
+      }
+    }
+
+    // Fast path: exact mantissa and power of ten, whole token consumed
+    if (!any_digit || p != e || significant > 15 || exponent < -22 || exponent > 22)
+      return scan_float_slow(b, e, v);
+
+    double value = static_cast<double>(mantissa);
+    value = (exponent < 0) ? value / pow10_table[-exponent] : value * pow10_table[exponent];
+
+    if (value != 0.0) {
+      if (value < FLT_MIN || value > FLT_MAX) return scan_float_slow(b, e, v);
+
+      // Double rounding check: discarded bits too close to a float tie
+      std::uint64_t bits;
+      std::memcpy(&bits, &value, sizeof(bits));
+      std::uint64_t low = bits & ((std::uint64_t(1) << 29) - 1);
+      std::uint64_t tie = std::uint64_t(1) << 28;
+      if (low + 1 >= tie && low <= tie + 1) return scan_float_slow(b, e, v);
+    }
+
+    v = static_cast<float>(negative ? -value : value);
+    return p - b;
+  }
+
+}  // namespace
 
 SWCParser::SWCParser(std::istream& s) 
   : Parser(s)
@@ -13,11 +185,13 @@ SWCParser::SWCParser(std::istream& s)
   , neuron_(nullptr)
   ,last_node_pos_() {
   initialize_property_keys();
+  initialize_separators(" ");
 }
 
 SWCParser::SWCParser(std::istream& s, const std::string& separators)
     : Parser(s), sep_("", separators, "\""), neuron_(nullptr),last_node_pos_() {
   initialize_property_keys();
+  initialize_separators(separators);
 };
 
 SWCParser::~SWCParser() {};
@@ -28,12 +202,51 @@ std::unique_ptr<Reconstruction> SWCParser::read(const std::string& name) {
   std::string line;
 
   reset_errors();
+  clear_index_();
   neuron_ = new Neuron(name);
 
   while (getline(stream_, line)) {
-    process_line_(line);
+    process_line_(line.data(), line.data() + line.size());
+  }
+  
+  return build_reconstruction_(name);
+}
+
+std::unique_ptr<Reconstruction> SWCParser::read_mapped(const std::string& path, const std::string& name) {
+  
+  namespace bip = boost::interprocess;
+  
+  // Empty files cannot be mapped (throws if the file doesnt exist)
+  auto file_size = boost::filesystem::file_size(path);
+
+  reset_errors();
+  clear_index_();
+  neuron_ = new Neuron(name);
+  
+  if (file_size > 0) {
+    bip::file_mapping file(path.c_str(), bip::read_only);
+    bip::mapped_region region(file, bip::read_only);
+    region.advise(bip::mapped_region::advice_sequential);
+    
+    const char* b = static_cast<const char*>(region.get_address());
+    const char* e = b + region.get_size();
+    
+    while (b != e) {
+      const char* eol = static_cast<const char*>(std::memchr(b, '\n', e - b));
+      if (eol == nullptr) eol = e;
+      process_line_(b, eol);
+      b = (eol == e) ? e : eol + 1;
+    }
   }
   
+  return build_reconstruction_(name);
+}
+
+std::unique_ptr<Reconstruction> SWCParser::build_reconstruction_(const std::string& name) {
+  
+  // Index is no longer valid after correction
+  clear_index_();
+  
   // Correct neurites (and neuron)
   neuron_->correct();
 
@@ -80,15 +293,25 @@ void SWCParser::initialize_property_keys() {
                     "shrinkage_correction", "version_number", "version_date", "scale"};
 }
 
-void SWCParser::process_line_(const std::string& s) {
+void SWCParser::initialize_separators(const std::string& separators) {
+  separator_table_.fill(false);
+  for (auto c : separators) {
+    separator_table_[static_cast<unsigned char>(c)] = true;
+  }
+}
+
+void SWCParser::process_line_(const char* b, const char* e) {
+  // Ignore windows line endings
+  if (b != e && *(e - 1) == '\r') --e;
+  
   // Decide bw header and data
-  if (is_headerline(s))
-    process_header_(s);
+  if (is_headerline(b, e))
+    process_header_(std::string(b, e));
   else{
     try{
-      process_data_(s);
-    } catch(std::logic_error e){
-      process_error(e);
+      process_data_(b, e);
+    } catch(const std::logic_error& err){
+      process_error(err);
       // Just ignore the line
     }
   }
@@ -114,141 +337,149 @@ void SWCParser::process_header_(const std::string& s) {
   }
 }
 
-void SWCParser::process_data_(const std::string& s) {
-  tokenizer tok{s, sep_};
-
-  auto it = tok.begin();
+void SWCParser::process_data_(const char* b, const char* e) {
+  
+  // Current field [fb,fe)
+  const char* fb = b;
+  const char* fe = b;
+  
+  // Lines with quoted fields go through the tokenizer, that removes quotes
+  bool quoted = std::memchr(b, '"', e - b) != nullptr;
+  std::vector<std::string> tokens;
+  std::size_t next_token = 0;
+  if (quoted) {
+    std::string s(b, e);
+    tokenizer tok{s, sep_};
+    for (const auto& t : tok) {
+      if (!t.empty()) tokens.push_back(t);
+    }
+  }
+  
+  // Advances to the next non-empty field. False if there are no more fields
+  auto next_field = [&]() -> bool {
+    if (quoted) {
+      if (next_token == tokens.size()) return false;
+      fb = tokens[next_token].data();
+      fe = fb + tokens[next_token].size();
+      ++next_token;
+      return true;
+    }
+    fb = fe;
+    while (fb != e && is_separator(*fb)) ++fb;
+    fe = fb;
+    while (fe != e && !is_separator(*fe)) ++fe;
+    return fb != fe;
+  };
+  
+  // Strings are only built when reporting errors
+  auto line = [&]() { return std::string(b, e); };
+  auto field = [&]() { return std::string(fb, fe); };
+  
   int id, type, parent;
   float x, y, z, d;
   
   std::size_t num_chars;
 
-  // Skip initial empty fields
-  while (it->size() == 0) ++it;
-
   // Read every field
-  if (it == tok.end()) 
-    throw std::logic_error("Missing fields in line " + s);
-  try{
-    id = std::stoi(*it,&num_chars);
-    if(num_chars != it->size() || id < 0 )
-      throw std::logic_error("Id is not a non-negative integer in line "+ s +". Type: " + *it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("Id is not numeric in line "+ s +". ID: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  num_chars = scan_int(fb, fe, id);
+  if (num_chars == 0)
+    throw std::logic_error("Id is not numeric in line "+ line() +". ID: " + field());
+  if (num_chars != static_cast<std::size_t>(fe - fb) || id < 0 )
+    throw std::logic_error("Id is not a non-negative integer in line "+ line() +". Type: " + field());
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
-  if (it == tok.end()){
-    throw std::logic_error("Missing fields in line " + s);
-  }
-  try{
-    type = std::stoi(*it,&num_chars);
-    if(num_chars != it->size() )
-      throw std::logic_error("Type is not integer in line "+ s +". Type: " + *it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("Type is not numeric in line "+ s +". Type: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  num_chars = scan_int(fb, fe, type);
+  if (num_chars == 0)
+    throw std::logic_error("Type is not numeric in line "+ line() +". Type: " + field());
+  if (num_chars != static_cast<std::size_t>(fe - fb))
+    throw std::logic_error("Type is not integer in line "+ line() +". Type: " + field());
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
-  if (it == tok.end()){
-    throw std::logic_error("Missing fields in line " + s);
-  }
-  try{
-    x = std::stof(*it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("X value is not numeric in line "+ s +". X: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  if (scan_float(fb, fe, x) == 0)
+    throw std::logic_error("X value is not numeric in line "+ line() +". X: " + field());
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
-  if (it == tok.end()){
-    throw std::logic_error("Missing fields in line " + s);
-  }
-  try{
-    y = std::stof(*it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("Y value is not numeric in line "+ s +". Y: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  if (scan_float(fb, fe, y) == 0)
+    throw std::logic_error("Y value is not numeric in line "+ line() +". Y: " + field());
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
-  if (it == tok.end()){
-    throw std::logic_error("Missing fields in line " + s);
-  }
-  try{
-    z = std::stof(*it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("Z value is not numeric in line "+ s +". Z: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  if (scan_float(fb, fe, z) == 0)
+    throw std::logic_error("Z value is not numeric in line "+ line() +". Z: " + field());
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
-  if (it == tok.end()){
-    throw std::logic_error("Missing fields in line " + s);
-  }
-  try{
-    d = std::stof(*it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("Diameter is not numeric in line "+ s +". Diameter: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  if (scan_float(fb, fe, d) == 0)
+    throw std::logic_error("Diameter is not numeric in line "+ line() +". Diameter: " + field());
   
   if(d<0){
     throw std::logic_error("Negative diameter value " + std::to_string(d));
   }
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
-  if (it == tok.end()){
-    throw std::logic_error("Missing fields in line " + s);
-  }
-  try{
-    parent = std::stoi(*it,&num_chars);
-    if(num_chars != it->size() )
-      throw std::logic_error("Type is not integer in line "+ s +". Type: " + *it);
-  } catch(std::invalid_argument e){
-    throw std::logic_error("Parent is not numeric in line "+ s +". Parent: " + *it);
-  }
+  if (!next_field()) 
+    throw std::logic_error("Missing fields in line " + line());
+  num_chars = scan_int(fb, fe, parent);
+  if (num_chars == 0)
+    throw std::logic_error("Parent is not numeric in line "+ line() +". Parent: " + field());
+  if (num_chars != static_cast<std::size_t>(fe - fb))
+    throw std::logic_error("Type is not integer in line "+ line() +". Type: " + field());
   
-  // Skip empty fields
-  while ( (++it)!=tok.end() && it->size() == 0 );
   // Warn if there are extra fields
-  if(it != tok.end()){
+  if (next_field()) {
     ++warn_count;
-    NSTR_LOG_(warn,std::string("Extra fields in line ") + s);
+    NSTR_LOG_(warn,std::string("Extra fields in line ") + line());
   }
 
+  add_node_(id, type, x, y, z, d, parent);
+}
+
+void SWCParser::add_node_(int id, int type, float x, float y, float z, float d, int parent) {
+  
   // Create node
   Node node{id, x, y, z, d / 2.0};
 
   if (NeuriteType(type) == NeuriteType::kSoma) {
+    soma_index_.emplace(id, std::distance(neuron_->begin_soma(), neuron_->end_soma()));
     neuron_->add_soma(node);
   } else if (parent != -1) {
     // Parent in soma
-    auto soma_pos = neuron_->find_soma(parent);
-    if (soma_pos != neuron_->end_soma()) {
+    auto soma_it = soma_index_.find(parent);
+    if (soma_it != soma_index_.end()) {
       
       // Parent is soma -> new neurite with soma root
       Neurite* neurite(new Neurite(neuron_->size() + 1, NeuriteType(type)));
       // Create a branch with root given parent
-      neurite->set_root(*soma_pos);
+      neurite->set_root(*std::next(neuron_->begin_soma(), soma_it->second));
       last_node_pos_ = neurite->insert_node( neurite->begin_branch(), node);
       neuron_->add_neurite(neurite);
       
     } else {
       Neurite::base_node_iterator pos;
       // Find parent node
-      if(last_node_pos_->id() == parent){
+      if(!node_index_.empty() && last_node_pos_->id() == parent){
         pos = last_node_pos_;
       } else{
-        pos = neuron_->find(parent);
+        pos = find_node_(parent);
       }
       if (pos.begin() == pos.end()) {
         throw std::logic_error("Oprhan node "+ std::to_string(id) + "- Can't find parent node " + std::to_string(parent) );
       } else {
+        // Inserting after a non-last node splits the branch: the tail nodes
+        // move to a new first child
+        bool split = pos.node() < (pos.branch()->end() - 1);
+        Neurite::branch_iterator parent_branch = pos.branch();
+        
         // Set branch
         last_node_pos_ = pos.neurite().insert_node(pos, node);
+        
+        if (split) {
+          reindex_branch_(*pos.neurite().begin_children(parent_branch));
+        }
       }
     }
     
@@ -259,10 +490,71 @@ void SWCParser::process_data_(const std::string& s) {
     last_node_pos_ = neurite->insert_node(neurite->begin_node(), node); // Add node
     neuron_->add_neurite(neurite);
   }
+  
+  // Soma nodes are indexed apart
+  if (NeuriteType(type) != NeuriteType::kSoma) {
+    index_node_(last_node_pos_);
+  }
+}
+
+void SWCParser::clear_index_() {
+  node_index_.clear();
+  branch_index_.clear();
+  soma_index_.clear();
+}
+
+void SWCParser::index_node_(const Neurite::base_node_iterator& pos) {
+  // First occurrence wins (same as a linear search)
+  node_index_.emplace(pos->id(), 
+                      node_position{&(*pos), 
+                                    static_cast<std::size_t>(std::distance(pos.branch()->begin(), pos.node()))});
+  
+  auto b = pos.branch();
+  branch_index_[&(*b)] = b;
+  
+  // A split in the parent branch prepends a new child: index siblings too
+  if (b.node->parent != nullptr) {
+    auto& neurite = pos.neurite();
+    auto parent = Neurite::tree_type::parent(b);
+    for (auto ch = neurite.begin_children(parent); ch != neurite.end_children(parent); ++ch) {
+      branch_index_[&(*ch)] = Neurite::branch_iterator(ch);
+    }
+  }
+}
+
+void SWCParser::reindex_branch_(Branch& b) {
+  std::size_t i = 0;
+  for (auto it = b.begin(); it != b.end(); ++it, ++i) {
+    auto node_it = node_index_.find(it->id());
+    if (node_it != node_index_.end() && node_it->second.node == &(*it)) {
+      node_it->second.index = i;
+    }
+  }
+}
+
+Neurite::base_node_iterator SWCParser::find_node_(Node::id_type id) const {
+  auto node_it = node_index_.find(id);
+  if (node_it == node_index_.end()) {
+    return Neurite::base_node_iterator();
+  }
+  
+  const node_position& npos = node_it->second;
+  auto branch_it = branch_index_.find(&(npos.node->branch()));
+  if (branch_it == branch_index_.end()) {
+    return Neurite::base_node_iterator();
+  }
+  
+  Branch& b = npos.node->branch();
+  Neurite& neurite = b.neurite();
+  
+  return Neurite::base_node_iterator(neurite.begin_branch(), 
+                                     neurite.end_branch(), 
+                                     branch_it->second, 
+                                     std::next(b.begin(), npos.index));
 }
 
-bool SWCParser::is_headerline(const std::string& s) const {
-  for (auto it = s.begin(); it != s.end(); it++) {
+bool SWCParser::is_headerline(const char* b, const char* e) const {
+  for (auto it = b; it != e; it++) {
     if (!isspace(*it)) {
       if (*it == comment_char)
         return true;
@@ -1,19 +1,82 @@
 #include <neurostr/io/SWCWriter.h>
 
+#include <cmath>
+#include <cstdio>
+
 
 namespace neurostr {
 namespace io {
   
+namespace {
+  
+  // Buffered bytes that trigger a flush to the stream
+  constexpr std::size_t flush_size = 1 << 20;
+  
+  void append_uint(std::string& buf, unsigned long long v){
+    char tmp[20];
+    int i = 20;
+    do {
+      tmp[--i] = static_cast<char>('0' + v % 10);
+      v /= 10;
+    } while(v != 0);
+    buf.append(tmp + i, 20 - i);
+  }
+  
+  void append_int(std::string& buf, long long v){
+    if(v < 0){
+      buf.push_back('-');
+      append_uint(buf, 0ULL - static_cast<unsigned long long>(v));
+    } else {
+      append_uint(buf, static_cast<unsigned long long>(v));
+    }
+  }
+  
+  // Same text as printf("%.3f",v). Values that are not finite, large or too 
+  // close to a rounding tie are formatted with snprintf
+  void append_fixed3(std::string& buf, double v){
+    if(std::isfinite(v) && std::abs(v) < 1E6){
+      double s = std::abs(v) * 1000.;
+      double fl = std::floor(s);
+      double frac = s - fl;
+      if(std::abs(frac - 0.5) > 1E-6){
+        unsigned long long r = static_cast<unsigned long long>(fl) + (frac > 0.5 ? 1 : 0);
+        unsigned int dec = static_cast<unsigned int>(r % 1000);
+        
+        if(std::signbit(v)) buf.push_back('-');
+        append_uint(buf, r / 1000);
+        buf.push_back('.');
+        buf.push_back(static_cast<char>('0' + dec / 100));
+        buf.push_back(static_cast<char>('0' + (dec / 10) % 10));
+        buf.push_back(static_cast<char>('0' + dec % 10));
+        return;
+      }
+    }
+    
+    char tmp[512];
+    int n = std::snprintf(tmp, sizeof(tmp), "%.3f", v);
+    buf.append(tmp, n);
+  }
+  
+} // anonymous
   
 SWCWriter::SWCWriter(std::ostream& s) : stream_(s) {};
 SWCWriter::~SWCWriter() {};
 
       
 std::ostream& SWCWriter::write(Neuron& n) const{
+  buffer_.clear();
+  buffer_.reserve(flush_size + 256);
+  
   writeHeader(n);
   writeData(n);
+  flush_();
   return stream_;
 }
+
+void SWCWriter::flush_() const {
+  stream_.write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+}
       
 unsigned int SWCWriter::convertNeuriteType(const NeuriteType& t){
   switch(t){
@@ -43,32 +106,51 @@ void SWCWriter::writeData(Neuron& n) const {
     writeNode(*it, convertNeuriteType(NeuriteType::kSoma),std::prev(it,1)->id());
   }
     
-  // Write Neurites
+  // Write Neurites - parents are taken from the traversal (same as node_parent)
   for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
     unsigned int type = convertNeuriteType(it->type());
-    for(auto node = it->begin_node(); node != it->end_node(); ++node){
-      auto parent = selector::node_parent(*node);
-      unsigned int parent_id;
-  
-      if (parent == *node) parent_id = no_parent_id;
-      else parent_id = parent.id();
-      writeNode(*node, type, parent_id);
-   }
+    for(auto b = it->begin_branch(); b != it->end_branch(); ++b){
+      if(b->size() == 0) continue;
+      
+      int parent_id = firstParentId(*b, b.node->parent == nullptr ? nullptr : &(b.node->parent->data));
+      for(auto node = b->begin(); node != b->end(); ++node){
+        writeNode(*node, type, parent_id);
+        parent_id = node->id();
+      }
+    }
   }
   
 }
+
+int SWCWriter::firstParentId(const Branch& b, const Branch* parent) const {
+  const Node& first = b.first();
+  
+  // First node same as root
+  if(b.has_root() && first == b.root()){
+    if(parent == nullptr) return no_parent_id;
+    else if(parent->size() >= 2) return (parent->end()-2)->id();
+    else if(parent->has_root()) return parent->root().id();
+    else return no_parent_id;
+  } 
+  
+  if(parent == nullptr || parent->size() == 0){
+    return b.has_root() ? b.root().id() : no_parent_id;
+  } else {
+    return parent->last().id();
+  }
+}
       
 // Header management
 void SWCWriter::writeStaticHeader() const {
-  stream_ << boost::format("%c File generated by neurostrlib\n") % comment_char;
+  buffer_ += (boost::format("%c File generated by neurostrlib\n") % comment_char).str();
 }
 void SWCWriter::writeNeuroInfo(Neuron& n) const {
-  stream_ << boost::format("%c ID %s\n") % comment_char % n.id();
-  stream_ << boost::format("%c UP %.3f %.3f %.3f\n") 
+  buffer_ += (boost::format("%c ID %s\n") % comment_char % n.id()).str();
+  buffer_ += (boost::format("%c UP %.3f %.3f %.3f\n") 
     % comment_char 
     % geometry::get<0>(n.up())
     % geometry::get<1>(n.up())
-    % geometry::get<2>(n.up());
+    % geometry::get<2>(n.up())).str();
 }
 
 void SWCWriter::writeNeuroProperties(Neuron& n) const {
@@ -78,23 +160,29 @@ void SWCWriter::writeNeuroProperties(Neuron& n) const {
 
 
 void SWCWriter::writeProperty(const PropertyMap::property_type& p) const{
-  stream_ << boost::format("%c %s %s\n") % comment_char
+  buffer_ += (boost::format("%c %s %s\n") % comment_char
       % PropertyMap::key(p) 
-      % PropertyMap::value_as_string(p);
+      % PropertyMap::value_as_string(p)).str();
 }
       
-// Data management
-void SWCWriter::writeNode(Node& n, unsigned int type, int parent_id) const {
-  
+// Data management - "%u %u %.3f %.3f %.3f %.3f %u\n"
+void SWCWriter::writeNode(const Node& n, unsigned int type, int parent_id) const {
+  append_int(buffer_, n.id());
+  buffer_.push_back(' ');
+  append_uint(buffer_, type);
+  buffer_.push_back(' ');
+  append_fixed3(buffer_, n.x());
+  buffer_.push_back(' ');
+  append_fixed3(buffer_, n.y());
+  buffer_.push_back(' ');
+  append_fixed3(buffer_, n.z());
+  buffer_.push_back(' ');
+  append_fixed3(buffer_, n.radius()*2.0);
+  buffer_.push_back(' ');
+  append_int(buffer_, parent_id);
+  buffer_.push_back('\n');
   
-  stream_ << boost::format("%u %u %.3f %.3f %.3f %.3f %u\n")
-      % n.id() 
-      % type
-      % n.x()
-      % n.y()
-      % n.z()
-      % (n.radius()*2.0)
-      % parent_id;
+  if(buffer_.size() >= flush_size) flush_();
 }
 
     
@@ -0,0 +1,201 @@
+#include <neurostr/io/TableWriter.h>
+
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+namespace neurostr {
+namespace io {
+
+namespace {
+
+  // Buffered bytes that trigger a flush to the stream
+  constexpr std::size_t flush_size = 1 << 20;
+
+  const char table_magic[8] = {'N','S','T','R','T','B','L','\0'};
+  const std::uint32_t table_version = 1;
+  const std::uint32_t table_byte_order = 0x01020304;
+
+  // Shortest text that reads back as the same float
+  void append_float(std::string& buf, float v){
+    char tmp[32];
+    int n = std::snprintf(tmp, sizeof(tmp), "%.9g", static_cast<double>(v));
+    buf.append(tmp, n);
+  }
+
+  void append_csv_field(std::string& buf, const std::string& s){
+    if(s.find_first_of(",\"\r\n") == std::string::npos){
+      buf.append(s);
+      return;
+    }
+    buf.push_back('"');
+    for(char c : s){
+      if(c == '"') buf.push_back('"');
+      buf.push_back(c);
+    }
+    buf.push_back('"');
+  }
+
+  void append_json_string(std::string& buf, const std::string& s){
+    buf.push_back('"');
+    for(char c : s){
+      switch(c){
+        case '"':  buf.append("\\\""); break;
+        case '\\': buf.append("\\\\"); break;
+        case '\n': buf.append("\\n"); break;
+        case '\r': buf.append("\\r"); break;
+        case '\t': buf.append("\\t"); break;
+        default:
+          if(static_cast<unsigned char>(c) < 0x20){
+            char tmp[8];
+            int n = std::snprintf(tmp, sizeof(tmp), "\\u%04x", static_cast<int>(c));
+            buf.append(tmp, n);
+          } else {
+            buf.push_back(c);
+          }
+      }
+    }
+    buf.push_back('"');
+  }
+
+  template <typename T>
+  void append_raw(std::string& buf, const T& v){
+    buf.append(reinterpret_cast<const char*>(&v), sizeof(T));
+  }
+
+  void append_sized(std::string& buf, const std::string& s){
+    if(s.size() > UINT32_MAX) throw std::length_error("String too long for a binary table");
+    append_raw(buf, static_cast<std::uint32_t>(s.size()));
+    buf.append(s);
+  }
+
+} // anonymous
+
+TableWriter::TableWriter(std::ostream& s, table_format f)
+  : stream_(s), format_(f), header_written_(false), buffer_() {}
+
+table_format TableWriter::format_by_name(const std::string& name){
+  if(name == "csv") return table_format::kCSV;
+  else if(name == "jsonl") return table_format::kJSONLines;
+  else if(name == "bin") return table_format::kBinary;
+  else throw std::runtime_error("Unrecognized table format " + name);
+}
+
+std::ostream& TableWriter::write(const measure::ColumnTable& t){
+  buffer_.clear();
+  buffer_.reserve(flush_size + 256);
+
+  switch(format_){
+    case table_format::kCSV: write_csv_(t); break;
+    case table_format::kJSONLines: write_json_lines_(t); break;
+    case table_format::kBinary: write_binary_(t); break;
+  }
+  flush_();
+  return stream_;
+}
+
+void TableWriter::flush_(){
+  stream_.write(buffer_.data(), buffer_.size());
+  buffer_.clear();
+}
+
+void TableWriter::write_csv_(const measure::ColumnTable& t){
+  const std::size_t ncols = t.key_count() + t.value_count();
+
+  if(!header_written_){
+    for(std::size_t c = 0; c < ncols; ++c){
+      if(c > 0) buffer_.push_back(',');
+      append_csv_field(buffer_, c < t.key_count() ? t.key_name(c) : t.value_name(c - t.key_count()));
+    }
+    buffer_.push_back('\n');
+    header_written_ = true;
+  }
+
+  for(std::size_t r = 0; r < t.rows(); ++r){
+    for(std::size_t c = 0; c < t.key_count(); ++c){
+      if(c > 0) buffer_.push_back(',');
+      append_csv_field(buffer_, t.key(r, c));
+    }
+    for(std::size_t c = 0; c < t.value_count(); ++c){
+      if(c > 0 || t.key_count() > 0) buffer_.push_back(',');
+      float v = t.value(r, c);
+      if(!std::isnan(v)) append_float(buffer_, v);
+    }
+    buffer_.push_back('\n');
+    if(buffer_.size() > flush_size) flush_();
+  }
+}
+
+void TableWriter::write_json_lines_(const measure::ColumnTable& t){
+  // Escaped "name": prefixes
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+  for(std::size_t c = 0; c < t.key_count(); ++c){
+    std::string s;
+    append_json_string(s, t.key_name(c));
+    keys.push_back(s + ":");
+  }
+  for(std::size_t c = 0; c < t.value_count(); ++c){
+    std::string s;
+    append_json_string(s, t.value_name(c));
+    values.push_back(s + ":");
+  }
+
+  for(std::size_t r = 0; r < t.rows(); ++r){
+    bool first = true;
+    buffer_.push_back('{');
+    for(std::size_t c = 0; c < t.key_count(); ++c){
+      if(!first) buffer_.push_back(',');
+      first = false;
+      buffer_.append(keys[c]);
+      append_json_string(buffer_, t.key(r, c));
+    }
+    for(std::size_t c = 0; c < t.value_count(); ++c){
+      float v = t.value(r, c);
+      if(std::isnan(v)) continue;
+      if(!first) buffer_.push_back(',');
+      first = false;
+      buffer_.append(values[c]);
+      if(std::isinf(v)){
+        // Not representable in JSON
+        buffer_.append("null");
+      } else {
+        append_float(buffer_, v);
+      }
+    }
+    buffer_.append("}\n");
+    if(buffer_.size() > flush_size) flush_();
+  }
+}
+
+void TableWriter::write_binary_(const measure::ColumnTable& t){
+  buffer_.append(table_magic, sizeof(table_magic));
+  append_raw(buffer_, table_version);
+  append_raw(buffer_, table_byte_order);
+  append_raw(buffer_, static_cast<std::uint32_t>(t.key_count()));
+  append_raw(buffer_, static_cast<std::uint32_t>(t.value_count()));
+  append_raw(buffer_, static_cast<std::uint64_t>(t.rows()));
+
+  for(std::size_t c = 0; c < t.key_count(); ++c) append_sized(buffer_, t.key_name(c));
+  for(std::size_t c = 0; c < t.value_count(); ++c) append_sized(buffer_, t.value_name(c));
+
+  for(std::size_t c = 0; c < t.key_count(); ++c){
+    for(std::size_t r = 0; r < t.rows(); ++r){
+      append_sized(buffer_, t.key(r, c));
+    }
+    if(buffer_.size() > flush_size) flush_();
+  }
+
+  // Value columns are contiguous - written as they are
+  for(std::size_t c = 0; c < t.value_count(); ++c){
+    flush_();
+    const auto& col = t.column(c);
+    if(!col.empty()){
+      stream_.write(reinterpret_cast<const char*>(col.data()), col.size() * sizeof(float));
+    }
+  }
+}
+
+} // io
+} // neurostr
@@ -1,5 +1,7 @@
 #include <neurostr/io/parser_dispatcher.h>
 
+#include <algorithm>
+
 namespace neurostr {
 namespace io{
   
@@ -18,6 +20,8 @@ namespace io{
       return new io::DATParser(stream);
     } else if (ext == "json"){
       return new io::JSONParser(stream);
+    } else if (ext == "nstr"){
+      return new io::NSTRParser(stream);
     } else {
       //Errror
       throw std::runtime_error("Unrecognized type");
@@ -28,14 +32,22 @@ namespace io{
     std::string ext(s); // copy
     // Convert to lowercase
     std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
-    if (ext == "dat"){
+    if (ext == "dat" || ext == "nstr"){
       ret.open(path, std::ios_base::binary);
     } else {
       ret.open(path);
     }
   }
   
-  std::unique_ptr<Reconstruction> read_file_by_ext(const std::string& path){
+  std::unique_ptr<Reconstruction> read_file_by_ext(const std::string& path, bool use_arena){
+    if (use_arena){
+      auto arena = Arena::create();
+      ArenaScope scope(arena);
+      auto ret = read_file_by_ext(path, false);
+      ret->arena(arena);
+      return ret;
+    }
+    
     // Create path
     boost::filesystem::path fspath(path);
   
@@ -43,6 +55,22 @@ namespace io{
     std::string extension = fspath.extension().string<std::string>().erase(0,1);
     std::string name      = fspath.stem().string<std::string>();
     
+    // SWC files are memory-mapped and scanned in place
+    std::string lower_ext(extension);
+    std::transform(lower_ext.begin(), lower_ext.end(), lower_ext.begin(), ::tolower);
+    if (lower_ext == "swc" && boost::filesystem::is_regular_file(fspath)) {
+      std::ifstream unused;
+      io::SWCParser p(unused);
+      return p.read_mapped(path, name);
+    }
+    
+    // NSTR files are memory-mapped and read in place
+    if (lower_ext == "nstr" && boost::filesystem::is_regular_file(fspath)) {
+      std::ifstream unused;
+      io::NSTRParser p(unused);
+      return p.read_mapped(path, name);
+    }
+    
     std::ifstream in;
     open_filestream(path,extension,in);
     
@@ -54,5 +82,80 @@ namespace io{
     return ret;
   }
   
+  std::unique_ptr<Reconstruction> read_file_by_ext(const std::string& path,
+                                                   const neuron_callback& on_neuron,
+                                                   const contour_callback& on_contour,
+                                                   bool grouped){
+    boost::filesystem::path fspath(path);
+    std::string extension = fspath.extension().string<std::string>().erase(0,1);
+    std::string name      = fspath.stem().string<std::string>();
+    
+    std::string lower_ext(extension);
+    std::transform(lower_ext.begin(), lower_ext.end(), lower_ext.begin(), ::tolower);
+    
+    if (lower_ext == "asc" || lower_ext == "dat"){
+      std::ifstream in;
+      open_filestream(path,extension,in);
+      
+      std::unique_ptr<Reconstruction> ret;
+      if (lower_ext == "asc"){
+        io::ASCParser p(in);
+        ret = p.read(name, on_neuron, on_contour, grouped);
+      } else {
+        io::DATParser p(in);
+        ret = p.read(name, on_neuron, on_contour, grouped);
+      }
+      return ret;
+    }
+    
+    // Other formats are read at once
+    auto r = read_file_by_ext(path);
+    
+    if (on_contour){
+      for(auto it = r->contour_begin(); it != r->contour_end(); ++it){
+        on_contour(*it);
+      }
+    }
+    
+    std::unique_ptr<Reconstruction> ret(new Reconstruction(r->id()));
+    ret->properties = r->properties;
+    
+    auto neurons = r->release_neurons();
+    if (on_neuron){
+      for(auto& n : neurons){
+        on_neuron(std::move(n));
+      }
+    }
+    return ret;
+  }
+  
+  std::vector<std::string> list_reconstruction_files(const std::string& path){
+    namespace fs = boost::filesystem;
+    std::vector<std::string> files;
+    
+    if(fs::is_directory(path)){
+      for(fs::recursive_directory_iterator it(path), end; it != end; ++it){
+        if(!fs::is_regular_file(it->status())) continue;
+        
+        std::string ext = it->path().extension().string();
+        std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+        if(ext == ".swc" || ext == ".asc" || ext == ".dat" || ext == ".json" || ext == ".nstr")
+          files.push_back(it->path().string());
+      }
+      // Directory order is unspecified
+      std::sort(files.begin(), files.end());
+    } else {
+      std::ifstream is(path);
+      if(!is) throw std::runtime_error("Unable to open file list " + path);
+      
+      std::string line;
+      while(std::getline(is, line)){
+        if(!line.empty() && line.back() == '\r') line.pop_back();
+        if(!line.empty()) files.push_back(line);
+      }
+    }
+    return files;
+  }
+  
 }//io
 }//neurostr
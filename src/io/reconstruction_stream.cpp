@@ -0,0 +1,70 @@
+#include <neurostr/io/reconstruction_stream.h>
+
+namespace neurostr {
+namespace io {
+
+ReconstructionStream::ReconstructionStream(const std::string& id,
+                                           const neuron_callback& on_neuron,
+                                           const contour_callback& on_contour,
+                                           bool grouped)
+  : pending_(id)
+  , id_(id)
+  , on_neuron_(on_neuron)
+  , on_contour_(on_contour)
+  , grouped_(grouped)
+  , trees_since_soma_(false)
+  , count_(0) {}
+
+ReconstructionStream::~ReconstructionStream(){
+  // Callbacks shouldnt throw here
+  try{
+    flush();
+  } catch(...) {}
+}
+
+Neuron* ReconstructionStream::new_neuron_(const std::vector<Node>& soma){
+  Neuron* n = new Neuron(id_ + std::string("_") + std::to_string(++count_), soma);
+  // Invalidate all branches and parent int soma nodes!
+  for(auto it = n->begin_soma(); it != n->end_soma(); ++it){
+    it->parent(nullptr);
+    it->branch(nullptr);
+  }
+  return n;
+}
+
+void ReconstructionStream::add_soma(const std::vector<Node>& soma){
+  // Previous cells are complete
+  if(grouped_ && trees_since_soma_){
+    flush();
+  }
+  trees_since_soma_ = false;
+  pending_.addNeuron(new_neuron_(soma));
+}
+
+void ReconstructionStream::add_neurite(Neurite* n){
+  // Somas are required to be defined before neurites
+  if(pending_.size() == 0){
+    // We need to create the neuron before
+    pending_.addNeuron(new_neuron_(std::vector<Node>()));
+  }
+  std::unique_ptr<Neurite> guard(n);
+  pending_.add_neurite_to_closest_soma(n);
+  guard.release();
+  trees_since_soma_ = true;
+}
+
+void ReconstructionStream::add_contour(const Contour& c){
+  if(on_contour_) on_contour_(c);
+}
+
+void ReconstructionStream::flush(){
+  auto neurons = pending_.release_neurons();
+  if(on_neuron_){
+    for(auto& n : neurons){
+      on_neuron_(std::move(n));
+    }
+  }
+}
+
+} // io
+} // neurostr
@@ -0,0 +1,48 @@
+#include <neurostr/measure/column_table.h>
+
+#include <limits>
+#include <stdexcept>
+
+namespace neurostr {
+namespace measure {
+
+ColumnTable::ColumnTable(const std::vector<std::string>& keys,
+                         const std::vector<std::string>& values)
+  : key_names_(keys)
+  , value_names_(values)
+  , keys_(keys.size())
+  , values_(values.size())
+  , rows_(0) {}
+
+void ColumnTable::reserve(std::size_t n){
+  for(auto& c : keys_) c.reserve(n);
+  for(auto& c : values_) c.reserve(n);
+}
+
+std::size_t ColumnTable::add_row(){
+  for(auto& c : keys_) c.emplace_back();
+  for(auto& c : values_) c.push_back(std::numeric_limits<float>::quiet_NaN());
+  return rows_++;
+}
+
+void ColumnTable::append(const ColumnTable& other){
+  if(other.key_names_ != key_names_ || other.value_names_ != value_names_){
+    throw std::runtime_error("Table columns don't match");
+  }
+  for(std::size_t i = 0; i < keys_.size(); ++i){
+    keys_[i].insert(keys_[i].end(), other.keys_[i].begin(), other.keys_[i].end());
+  }
+  for(std::size_t i = 0; i < values_.size(); ++i){
+    values_[i].insert(values_[i].end(), other.values_[i].begin(), other.values_[i].end());
+  }
+  rows_ += other.rows_;
+}
+
+void ColumnTable::clear(){
+  for(auto& c : keys_) c.clear();
+  for(auto& c : values_) c.clear();
+  rows_ = 0;
+}
+
+} // measure
+} // neurostr
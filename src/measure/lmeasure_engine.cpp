@@ -0,0 +1,355 @@
+#include <neurostr/measure/lmeasure_engine.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+
+#include <neurostr/measure/node_measure.h>
+#include <neurostr/measure/branch_measure.h>
+#include <neurostr/measure/neuron_measure.h>
+#include <neurostr/measure/measure_operations.h>
+
+namespace neurostr{
+namespace measure{
+namespace lmeasure{
+
+namespace {
+
+  const std::array<std::string, lmeasure_count> lmeasure_names{ {
+    "soma_surface", "n_stems", "n_bifs", "n_branch", "n_tips",
+    "width", "height", "depth", "diameter", "diameter_pow",
+    "length", "surface", "branch_surface", "section_area", "volume",
+    "branch_volume", "euc_distance", "path_distance", "branch_order",
+    "terminal_degree", "taper_1", "taper_2", "branch_pathlength",
+    "contraction", "fragmentation", "daughter_ratio", "partition_asymmetry",
+    "rall_power", "pk", "pk_classic", "pk_2", "bif_ampl_local",
+    "bif_ampl_remote", "bif_tilt_local", "bif_tilt_remote",
+    "bif_torque_local", "bif_torque_remote", "last_parent_diam",
+    "hillman_threshold", "fractal_dim" } };
+
+  // Per-measure element values (float or int, as in lmeasure_decl.h)
+  struct value_store {
+    std::array<std::vector<float>, lmeasure_count> f;
+    std::array<std::vector<int>, lmeasure_count> i;
+
+    std::vector<float>& operator[](LMeasure m){ return f[static_cast<int>(m)]; }
+    std::vector<int>& ints(LMeasure m){ return i[static_cast<int>(m)]; }
+  };
+
+  // Branch data needed after the traversal
+  struct branch_info {
+    const Branch* branch;
+    int parent;
+    int children;
+    int first_child;
+    int second_child;
+    int tips;
+  };
+
+  // NAN values are not aggregated, as in measureEachAggregate
+  template <typename U>
+  Engine::summary_type summary(const std::vector<U>& v, bool online){
+    if(online){
+      aggregate::online_all_aggr<U,float> acc(0.);
+      for(const auto& x : v){
+        if(!measure::detail::is_nan_value(x)) acc.push(x);
+      }
+      auto s = acc.result();
+      return Engine::summary_type(s.sum, s.min, s.max, s.median, s.mean, s.sd);
+    }
+    
+    std::vector<U> tmp;
+    tmp.reserve(v.size());
+    for(const auto& x : v){
+      if(!measure::detail::is_nan_value(x)) tmp.push_back(x);
+    }
+    auto s = aggregate::all_aggr_factory<U,float>(0.)(tmp.begin(), tmp.end());
+    return Engine::summary_type(s.sum, s.min, s.max, s.median, s.mean, s.sd);
+  }
+
+  // Range length (NAN without values, as aggregate::range_length)
+  float range(bool any, float min, float max){
+    return any ? max - min : NAN;
+  }
+
+} // anonymous namespace
+
+const std::string& lmeasure_name(LMeasure m){
+  return lmeasure_names[static_cast<int>(m)];
+}
+
+std::ostream& operator<<(std::ostream& os, const LMeasure& m){
+  os << lmeasure_name(m);
+  return os;
+}
+
+Engine::value_type::value_type(LMeasure m)
+  : measure(m)
+  , is_summary(false)
+  , value(NAN)
+  , summary(NAN, NAN, NAN, NAN, NAN, NAN) {}
+
+Engine::Engine() : measures_(), enabled_set_(), online_(false) {
+  for(int i = 0; i < lmeasure_count; ++i){
+    measures_.push_back(static_cast<LMeasure>(i));
+  }
+  enabled_set_.set();
+}
+
+Engine::Engine(const std::vector<LMeasure>& m) : measures_(m), enabled_set_(), online_(false) {
+  for(auto it = m.begin(); it != m.end(); ++it){
+    enabled_set_.set(static_cast<int>(*it));
+  }
+}
+
+std::vector<Engine::value_type> Engine::compute(const Neuron& n) const {
+
+  using M = LMeasure;
+  value_store v;
+
+  // Enabled groups
+  const bool node_pass = enabled_(M::kWidth) || enabled_(M::kHeight) || enabled_(M::kDepth) ||
+    enabled_(M::kDiameter) || enabled_(M::kDiameterPow) || enabled_(M::kLength) ||
+    enabled_(M::kSurface) || enabled_(M::kBranchSurface) || enabled_(M::kSectionArea) ||
+    enabled_(M::kVolume) || enabled_(M::kBranchVolume) || enabled_(M::kEucDistance) ||
+    enabled_(M::kPathDistance) || enabled_(M::kBranchPathlength) || enabled_(M::kContraction);
+  const bool need_tips = enabled_(M::kTerminalDegree) || enabled_(M::kPartitionAsymmetry);
+  const bool need_preterminal = enabled_(M::kLastParentDiam) || enabled_(M::kHillmanThreshold);
+
+  unsigned int n_branch = 0, n_tips = 0;
+  const float inf = std::numeric_limits<float>::infinity();
+  float min_x = inf, max_x = -inf;
+  float min_y = inf, max_y = -inf;
+  float min_z = inf, max_z = -inf;
+  bool any_node = false;
+
+  std::vector<branch_info> info;
+  std::unordered_map<const Branch*, int> branch_pos;
+  std::vector<float> end_path;
+  std::vector<const Branch*> preterminal;
+  std::vector<selector::const_node_reference> branch_nodes;
+
+  for(auto ne = n.begin_neurite(); ne != n.end_neurite(); ++ne){
+
+    info.clear();
+    branch_pos.clear();
+    end_path.clear();
+    preterminal.clear();
+
+    // Reference for euclidean distances (as node_distance_to_root: the
+    // neurite root or its first node, skipping empty branches)
+    const Node* ref = nullptr;
+    if(ne->has_root()) ref = &(ne->root());
+    else {
+      for(auto it = ne->begin_branch(); it != ne->end_branch() && ref == nullptr; ++it)
+        if(it->size() > 0) ref = &(it->first());
+    }
+
+    for(auto it = ne->begin_branch(); it != ne->end_branch(); ++it){
+      const Branch& b = *it;
+      const Branch* pb = (it.node->parent == nullptr)? nullptr : &(it.node->parent->data);
+      int pos = info.size();
+      int parent_pos = (pb == nullptr)? -1 : branch_pos.at(pb);
+      int nchildren = it.number_of_children();
+
+      branch_pos.emplace(&b, pos);
+      info.push_back(branch_info{&b, parent_pos, nchildren, -1, -1, 0});
+      if(parent_pos != -1){
+        branch_info& pi = info[parent_pos];
+        if(pi.first_child == -1) pi.first_child = pos;
+        else if(pi.second_child == -1) pi.second_child = pos;
+      }
+
+      ++n_branch;
+      if(nchildren == 0){
+        ++n_tips;
+        if(pb != nullptr && need_preterminal) preterminal.push_back(pb);
+      }
+
+      // Node pass - parent resolution as in selector::node_parent
+      float path = (parent_pos == -1)? 0. : end_path[parent_pos];
+      float inner_length = 0, branch_surface = 0, branch_volume = 0;
+
+      if(node_pass){
+        const Node* prev = nullptr;
+        if(pb != nullptr && pb->size() > 0) prev = &(pb->last());
+        else if(b.has_root()) prev = &(b.root());
+
+        for(auto nit = b.begin(); nit != b.end(); ++nit){
+          const Node& node = *nit;
+          const Node& parent = (prev == nullptr)? node : *prev;
+
+          float d = node.distance(parent);
+          float pr = parent.radius();
+          float nr = node.radius();
+
+          any_node = true;
+          min_x = std::min(min_x, node.x()); max_x = std::max(max_x, node.x());
+          min_y = std::min(min_y, node.y()); max_y = std::max(max_y, node.y());
+          min_z = std::min(min_z, node.z()); max_z = std::max(max_z, node.z());
+
+          if(enabled_(M::kDiameter)) v[M::kDiameter].push_back(nr*2);
+          if(enabled_(M::kDiameterPow)) v[M::kDiameterPow].push_back(std::pow(nr*2,1.5));
+          if(enabled_(M::kLength)) v[M::kLength].push_back(d);
+
+          if(enabled_(M::kSurface) || enabled_(M::kBranchSurface)){
+            float s = std::sqrt(std::pow(d,2) + std::pow((pr-nr),2));
+            float surface = M_PI * (pr+nr) * s;
+            if(enabled_(M::kSurface)) v[M::kSurface].push_back(surface);
+            branch_surface += surface;
+          }
+
+          if(enabled_(M::kSectionArea))
+            v[M::kSectionArea].push_back(M_PI * std::pow( ((pr+nr)/2.),2));
+
+          if(enabled_(M::kVolume) || enabled_(M::kBranchVolume)){
+            const float pi = boost::math::constants::pi<float>();
+            float volume = pi/3. * (pr*pr + pr*nr + nr*nr) * d;
+            if(enabled_(M::kVolume)) v[M::kVolume].push_back(volume);
+            branch_volume += volume;
+          }
+
+          if(enabled_(M::kEucDistance)) v[M::kEucDistance].push_back(node.distance(*ref));
+
+          // The first node in the neurite is the origin of the path
+          if(parent_pos != -1 || nit != b.begin()) path += d;
+          if(enabled_(M::kPathDistance)) v[M::kPathDistance].push_back(path);
+
+          if(nit != b.begin()) inner_length += d;
+          prev = &node;
+        }
+      }
+      end_path.push_back(path);
+
+      // Branch measures
+      if(enabled_(M::kBranchSurface)) v[M::kBranchSurface].push_back(branch_surface);
+      if(enabled_(M::kBranchVolume)) v[M::kBranchVolume].push_back(branch_volume);
+      if(enabled_(M::kBranchOrder)) v.ints(M::kBranchOrder).push_back(b.order());
+      if(enabled_(M::kTaper1)) v[M::kTaper1].push_back(taper_rate_burker(b));
+      if(enabled_(M::kTaper2)) v[M::kTaper2].push_back(taper_rate_hillman(b));
+      if(enabled_(M::kFragmentation)) v.ints(M::kFragmentation).push_back(b.size());
+
+      if(enabled_(M::kBranchPathlength) || enabled_(M::kContraction)){
+        float len = NAN, contraction = NAN;
+        if(b.size() > 0){
+          len = inner_length + (b.has_root()? b.first().distance(b.root()) : 0.);
+          float d = b.has_root()? b.last().distance(b.root()) : b.first().distance(b.last());
+          contraction = (d == 0)? 1. : len / d;
+        }
+        if(enabled_(M::kBranchPathlength)) v[M::kBranchPathlength].push_back(len);
+        if(enabled_(M::kContraction)) v[M::kContraction].push_back(contraction);
+      }
+
+      if(enabled_(M::kFractalDim)){
+        branch_nodes.clear();
+        for(auto nit = b.begin(); nit != b.end(); ++nit) branch_nodes.emplace_back(*nit);
+        v[M::kFractalDim].push_back(node_set_fractal_dim(branch_nodes.begin(), branch_nodes.end()));
+      }
+
+      // Bifurcation measures
+      if(nchildren > 0){
+        if(enabled_(M::kDaughterRatio)) v[M::kDaughterRatio].push_back(child_diam_ratio(b));
+        if(enabled_(M::kRallPower)) v[M::kRallPower].push_back(rall_power_fit_factory(0,5)(b));
+        if(enabled_(M::kPk)) v[M::kPk].push_back(pk_fit_factory(0,5)(b));
+        if(enabled_(M::kPkClassic)) v[M::kPkClassic].push_back(pk_factory(1.5)(b));
+        if(enabled_(M::kPk2)) v[M::kPk2].push_back(pk_factory(2)(b));
+        if(enabled_(M::kBifAmplLocal)) v[M::kBifAmplLocal].push_back(local_bifurcation_angle(b));
+        if(enabled_(M::kBifAmplRemote)) v[M::kBifAmplRemote].push_back(remote_bifurcation_angle(b));
+        if(enabled_(M::kBifTiltLocal)) v[M::kBifTiltLocal].push_back(local_tilt_angle(b));
+        if(enabled_(M::kBifTiltRemote)) v[M::kBifTiltRemote].push_back(remote_tilt_angle(b));
+
+        // Torque is not measured in the first branch
+        if(pb != nullptr){
+          if(enabled_(M::kBifTorqueLocal)) v[M::kBifTorqueLocal].push_back(local_torque_angle(b));
+          if(enabled_(M::kBifTorqueRemote)) v[M::kBifTorqueRemote].push_back(remote_torque_angle(b));
+        }
+      }
+    }
+
+    // Subtree terminals (children are always after their parent)
+    if(need_tips){
+      for(auto it = info.rbegin(); it != info.rend(); ++it){
+        if(it->children == 0) it->tips += 1;
+        if(it->parent != -1) info[it->parent].tips += it->tips;
+      }
+
+      for(auto it = info.begin(); it != info.end(); ++it){
+        // As selector::node_subtree_terminals, terminal branches count 0
+        if(enabled_(M::kTerminalDegree))
+          v.ints(M::kTerminalDegree).insert(v.ints(M::kTerminalDegree).end(),
+                                            it->branch->size(),
+                                            it->children == 0 ? 0 : it->tips);
+
+        if(enabled_(M::kPartitionAsymmetry) && it->children > 0){
+          if(it->children < 2){
+            v[M::kPartitionAsymmetry].push_back(NAN);
+          } else {
+            long n1 = info[it->first_child].tips;
+            long n2 = info[it->second_child].tips;
+            v[M::kPartitionAsymmetry].push_back( (n1 == n2)? 0 : std::abs(n1 - n2) / (n1 + n2 - 2) );
+          }
+        }
+      }
+    }
+
+    // Pre-terminal branches. As selector::neurite_pre_terminal_branches,
+    // std::unique keeps the vector size
+    if(need_preterminal){
+      std::unique(preterminal.begin(), preterminal.end());
+      for(auto it = preterminal.begin(); it != preterminal.end(); ++it){
+        if(enabled_(M::kLastParentDiam)) v[M::kLastParentDiam].push_back(node_diameter((*it)->last()));
+        if(enabled_(M::kHillmanThreshold)) v[M::kHillmanThreshold].push_back(hillman_threshold(**it));
+      }
+    }
+  }
+
+  // Output
+  std::vector<value_type> ret;
+  for(auto it = measures_.begin(); it != measures_.end(); ++it){
+    value_type r(*it);
+    switch(*it){
+      case M::kSomaSurface:
+        r.value = soma_surface(n);
+        break;
+      case M::kNStems:
+        r.value = neuron_neurite_count(n);
+        break;
+      case M::kNBifs:
+        r.value = n_branch - n_tips;
+        break;
+      case M::kNBranch:
+        r.value = n_branch;
+        break;
+      case M::kNTips:
+        r.value = n_tips;
+        break;
+      case M::kWidth:
+        r.value = range(any_node, min_x, max_x);
+        break;
+      case M::kHeight:
+        r.value = range(any_node, min_y, max_y);
+        break;
+      case M::kDepth:
+        r.value = range(any_node, min_z, max_z);
+        break;
+      case M::kBranchOrder:
+      case M::kTerminalDegree:
+      case M::kFragmentation:
+        r.is_summary = true;
+        r.summary = summary(v.ints(*it), online_);
+        break;
+      default:
+        r.is_summary = true;
+        r.summary = summary(v[*it], online_);
+        break;
+    }
+    ret.push_back(r);
+  }
+  return ret;
+}
+
+} // lmeasure
+} // measure
+} // neurostr
@@ -1,145 +1,302 @@
 #include <neurostr/methods/branchComparison.h>
 
+#include <algorithm>
+#include <cmath>
+#include <future>
+
+#include <neurostr/core/thread_pool.h>
+
 // FIXME: This shouldnt be in the library. Create an indep. project for it 
 
 namespace neurostr {
 namespace methods {
   
-  // align branches and computes theri f. dist
-  float oriented_frechet_branch_distance(const Branch &a,const  Branch &b, bool normalize){
+namespace {
+  
+  using point_vector = std::vector<point_type>;
+  using frechet_type = geometry::DiscreteFrechet<point_vector::const_iterator, point_vector::const_iterator>;
+  
+  // Branches per tile side in the pair matrix
+  constexpr std::size_t tile_size = 32;
+  
+  /**
+   * @brief Branch line-segment (root included) and the nodes used to align
+   * it, computed once per branch
+   */
+  struct prepared_branch {
+    point_vector points;
+    std::size_t size;      // Node count (root not included)
+    int root_id;           // Root (or first node if there is no root)
+    point_type root;
+    int last_id;           // Last node
+    point_type last;
+    float reach;           // Max. distance from the root to the line-segment
+  };
+  
+  // Same as Node::vectorTo
+  point_type node_vector(int from_id, const point_type& from, int to_id, const point_type& to){
+    if(from_id == -1 || to_id == -1) return point_type(0,0,0);
+    else return geometry::vectorFromTo(from, to);
+  }
+  
+  prepared_branch prepare_branch(const Branch& b, bool normalize){
     
-    Node root_a, root_b;
+    const Branch* src = &b;
     
-    // Copy
-    Branch tmp_a,tmp_b;
-    if(a.has_root()){
-      tmp_a.root(a.root());
+    // Normalized copy
+    Branch tmp;
+    if(normalize){
+      if(b.has_root()){
+        tmp.root(b.root());
+      }
+      tmp.insert(tmp.begin(), b.begin(), b.end());
+      tmp.normalize();
+      src = &tmp;
     }
-    tmp_a.insert(tmp_a.begin(), a.begin(), a.end());
     
-    if(b.has_root()){
-      tmp_b.root(b.root());
+    prepared_branch p;
+    p.points.reserve(src->size() + 1);
+    if(src->has_root())
+      p.points.push_back(src->root().position());
+    for(auto it = src->begin(); it != src->end() ; ++it ){
+      p.points.push_back(it->position());
     }
-    tmp_b.insert(tmp_b.begin(), b.begin(), b.end());
     
-    // normalize
-    if( normalize ){
-      tmp_a.normalize();
-      tmp_b.normalize();
+    p.size = src->size();
+    p.root_id = -1;
+    p.last_id = -1;
+    p.reach = 0;
+    if(p.size > 0){
+      const Node& root = src->has_root() ? src->root() : src->first();
+      p.root_id = root.id();
+      p.root = root.position();
+      p.last_id = src->last().id();
+      p.last = src->last().position();
+      for(auto it = p.points.begin(); it != p.points.end(); ++it){
+        p.reach = std::max(p.reach, geometry::distance(p.root, *it));
+      }
     }
+    return p;
+  }
+  
+  float frechet_value(const point_vector& a, const point_vector& b, float bound, frechet_type& f){
+    f.reset(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+    
+    // Values that round to the bound are not abandoned, and abandoned values
+    // have to stay above the bound once rounded
+    return f.value(std::nextafter(bound, std::numeric_limits<float>::infinity()));
+  }
+  
+  /**
+   * @brief Aligns a with b (a is rotated and translated so both roots and
+   * root-to-last vectors match) and computes their frechet distance
+   * @param prune If true, pairs farther than bound by their lower bounds are
+   * not computed (infinity is returned)
+   * @param buffer Aligned points buffer
+   * @param f Frechet buffer
+   */
+  float aligned_distance(const prepared_branch& a, const prepared_branch& b, float bound, bool prune,
+                         point_vector& buffer, frechet_type& f){
     
     // No alignment needed
-    if(tmp_a.size() == 0 || tmp_b.size() == 0) {
-      return(tmp_a.discrete_frechet(tmp_b));
+    if(a.size == 0 || b.size == 0) {
+      return frechet_value(a.points, b.points, bound, f);
     }
     
-    // Get roots
-    if(tmp_a.has_root()) { root_a = tmp_a.root(); }
-    else { root_a = tmp_a.first();}
-    
-    if(tmp_b.has_root()) { root_b = tmp_b.root(); }
-    else { root_b = tmp_b.first();}
-    
     // Compute node local basis
-    point_type ref_a = root_a.vectorTo(tmp_a.last());
-    point_type ref_b = root_b.vectorTo(tmp_b.last());
+    point_type ref_a = node_vector(a.root_id, a.root, a.last_id, a.last);
+    point_type ref_b = node_vector(b.root_id, b.root, b.last_id, b.last);
     
     // If any ref is 0 -> no alignment
-    if(geometry::norm(ref_a) == 0 || geometry::norm(ref_b) == 0){
-      return(tmp_a.discrete_frechet(tmp_b));
+    float norm_a = geometry::norm(ref_a);
+    float norm_b = geometry::norm(ref_b);
+    if(norm_a == 0 || norm_b == 0){
+      return frechet_value(a.points, b.points, bound, f);
     }
     
-    // Align branches
-    tmp_a.rotate( geometry::align_vectors(ref_a, ref_b) );
-    if(tmp_a.has_root()) { tmp_a.traslate(tmp_a.root().vectorTo(root_b)); }
-    else { tmp_a.traslate(tmp_a.first().vectorTo(root_b)); }
+    // Once aligned, the roots match: both the last nodes and the farthest
+    // points are at least as far as their distances to the root differ
+    if(prune){
+      float lower = std::max(std::abs(norm_a - norm_b), std::abs(a.reach - b.reach));
+      if(lower > bound * (1 + 1E-4) + 1E-6){
+        return std::numeric_limits<float>::infinity();
+      }
+    }
     
+    // Align branches (same as Branch::rotate and Branch::traslate)
+    Eigen::Quaternionf q = geometry::align_vectors(ref_a, ref_b);
+    buffer.clear();
+    for(auto it = a.points.begin(); it != a.points.end(); ++it){
+      Eigen::Vector3f tmp(geometry::getx(*it), geometry::gety(*it), geometry::getz(*it));
+      tmp = q * tmp;
+      buffer.push_back(point_type(tmp[0],tmp[1],tmp[2]));
+    }
     
+    point_type t = node_vector(a.root_id, buffer.front(), b.root_id, b.root);
+    for(auto it = buffer.begin(); it != buffer.end(); ++it){
+      geometry::traslate(*it, t);
+    }
     
     // Now compute frechet distance
-    return tmp_a.discrete_frechet( tmp_b );
+    return frechet_value(buffer, b.points, bound, f);
   }
   
-  std::vector<float> inter_pair_distance(const  Neuron& n, bool restrict_order, bool sided ){
-  
-    auto v = selector::compose_selector(
-              selector::selector_in_single_to_set(selector::neurite_branch_selector), 
-              selector::neuron_neurites)(n);
-              
-    std::vector<float> distances( ( v.size() * (v.size()-1) ) / 2 ); // Biggest size possible
+  /**
+   * @brief Computes the distances between the branches in a group with the
+   * same side, in row-major order (j < k). The pair matrix is split in tiles
+   * processed by the pool (or sequentially if there is none)
+   * @param branches Prepared branches
+   * @param group Branch positions
+   * @param sides Group branch sides
+   * @param threshold Greater distances are reported as infinity
+   * @param pool Thread pool (may be nullptr)
+   * @return Pair distances
+   */
+  std::vector<float> group_distances(const std::vector<prepared_branch>& branches,
+                                     const std::vector<std::size_t>& group,
+                                     const std::vector<unsigned int>& sides,
+                                     float threshold, ThreadPool* pool){
     
-    std::vector<float>::size_type pos = 0;
-    if(!restrict_order){
-      for(auto i = v.begin(); i != --v.end(); ++i ){
-        for(auto j = i+1 ; j != v.end(); ++j){
-          distances[pos++] = oriented_frechet_branch_distance(i->get(),j->get());
+    std::size_t m = group.size();
+    
+    // Pair (j,k) is at row_start[j] + rank[k] - rank[j] - 1, where rank is
+    // the position among the branches with the same side
+    std::vector<std::size_t> rank(m);
+    std::vector<std::size_t> side_count;
+    for(std::size_t j = 0; j < m; ++j){
+      if(sides[j] >= side_count.size()) side_count.resize(sides[j] + 1, 0);
+      rank[j] = side_count[sides[j]]++;
+    }
+    
+    std::vector<std::size_t> row_start(m + 1, 0);
+    for(std::size_t j = 0; j < m; ++j){
+      row_start[j+1] = row_start[j] + (side_count[sides[j]] - rank[j] - 1);
+    }
+    
+    std::vector<float> distances(row_start[m]);
+    bool prune = !std::isinf(threshold);
+    
+    auto tile = [&branches, &group, &sides, &rank, &row_start, &distances, threshold, prune, m]
+                (std::size_t tj, std::size_t tk){
+      point_vector buffer;
+      frechet_type f;
+      std::size_t j_end = std::min(tj + tile_size, m);
+      std::size_t k_end = std::min(tk + tile_size, m);
+      for(std::size_t j = tj; j < j_end; ++j){
+        for(std::size_t k = std::max(tk, j + 1); k < k_end; ++k){
+          if(sides[j] != sides[k]) continue;
+          float d = aligned_distance(branches[group[j]], branches[group[k]], threshold, prune, buffer, f);
+          if(d > threshold) d = std::numeric_limits<float>::infinity();
+          distances[row_start[j] + rank[k] - rank[j] - 1] = d;
         }
       }
-    } else {
-      
-      int maxOrder = 0;
-      for( auto it = n.begin_neurite(); it != n.end_neurite(); ++it )
-        if(it->max_centrifugal_order() > maxOrder) maxOrder = it->max_centrifugal_order();
-      
-      // Compute for each order
-      std::vector<selector::const_branch_reference> tmp;
-      
-      for(int i = 0; i<= maxOrder ; ++i ){
-        // Filter references
-        tmp = selector::branch_order_filter_factory(i)(v.begin(),v.end()); 
-        for(auto j = tmp.begin(); j != --tmp.end(); ++j ){
-          for(auto k = j+1 ; k != tmp.end(); ++k){
-            if( i != 0 && sided ){
-              // Get "J" positions (0 left, 1 right) if they match. compute distance
-              if( measure::branch_index(j->get()) == measure::branch_index(k->get()) ){
-                    distances[pos++] = oriented_frechet_branch_distance(j->get(),k->get()); 
-              }
-            }
-            else {
-              distances[pos++] = oriented_frechet_branch_distance(j->get(),k->get());  
-            }
-            
-          }
-        }
+    };
+    
+    std::vector<std::future<void>> done;
+    for(std::size_t tj = 0; tj < m; tj += tile_size){
+      for(std::size_t tk = tj; tk < m; tk += tile_size){
+        if(pool == nullptr) tile(tj, tk);
+        else done.push_back(pool->submit([&tile, tj, tk](){ tile(tj, tk); }));
       }
-      distances.resize(pos);
     }
-    return distances;
+    
+    // Rethrow in order
+    for(auto it = done.begin(); it != done.end(); ++it)
+      it->get();
+    
+    return distances;
   }
   
-  std::vector<std::vector<float>> inter_pair_distance_byorder(const Neuron& n, bool sided){
+  /**
+   * @brief Branches of the neuron and their groups by order
+   */
+  struct neuron_branches {
+    std::vector<prepared_branch> branches;
+    std::vector<std::vector<std::size_t>> by_order;
+    std::vector<std::vector<unsigned int>> sides;
+  };
   
+  neuron_branches prepare_neuron(const Neuron& n, bool sided, ThreadPool* pool){
+    
     auto v = selector::compose_selector(
               selector::selector_in_single_to_set(selector::neurite_branch_selector), 
               selector::neuron_neurites)(n);
     
+    neuron_branches nb;
+    nb.branches.resize(v.size());
+    
+    // Prepare (in parallel)
+    std::vector<std::future<void>> done;
+    for(std::size_t b = 0; b < v.size(); b += tile_size){
+      auto f = [&nb, &v, b](){
+        for(std::size_t i = b; i < std::min(b + tile_size, v.size()); ++i)
+          nb.branches[i] = prepare_branch(v[i].get(), false);
+      };
+      if(pool == nullptr) f();
+      else done.push_back(pool->submit(f));
+    }
+    for(auto it = done.begin(); it != done.end(); ++it)
+      it->get();
+    
     int maxOrder = 0;
     for( auto it = n.begin_neurite(); it != n.end_neurite(); ++it )
       if(it->max_centrifugal_order() > maxOrder) maxOrder = it->max_centrifugal_order();
     
-    std::vector<std::vector<float>> distances(maxOrder+1);
+    nb.by_order.resize(maxOrder + 1);
+    nb.sides.resize(maxOrder + 1);
+    for(std::size_t i = 0; i < v.size(); ++i){
+      int order = v[i].get().order();
+      if(order < 0 || order > maxOrder) continue;
+      nb.by_order[order].push_back(i);
+      // Get "J" positions (0 left, 1 right)
+      nb.sides[order].push_back( (order != 0 && sided) ? measure::branch_index(v[i].get()) : 0 );
+    }
+    
+    return nb;
+  }
+  
+} // anonymous
+  
+  // align branches and computes theri f. dist
+  float oriented_frechet_branch_distance(const Branch &a,const  Branch &b, bool normalize, float bound){
+    point_vector buffer;
+    frechet_type f;
+    return aligned_distance(prepare_branch(a, normalize), prepare_branch(b, normalize),
+                            bound, false, buffer, f);
+  }
+  
+  std::vector<float> inter_pair_distance(const  Neuron& n, bool restrict_order, bool sided,
+                                         ThreadPool* pool, float threshold){
+    
+    neuron_branches nb = prepare_neuron(n, sided, pool);
+    
+    if(!restrict_order){
+      std::vector<std::size_t> all(nb.branches.size());
+      for(std::size_t i = 0; i < all.size(); ++i) all[i] = i;
+      return group_distances(nb.branches, all, std::vector<unsigned int>(all.size(), 0),
+                             threshold, pool);
+    } else {
+      // Compute for each order
+      std::vector<float> distances;
+      for(std::size_t i = 0; i < nb.by_order.size(); ++i){
+        std::vector<float> d = group_distances(nb.branches, nb.by_order[i], nb.sides[i],
+                                               threshold, pool);
+        distances.insert(distances.end(), d.begin(), d.end());
+      }
+      return distances;
+    }
+  }
+  
+  std::vector<std::vector<float>> inter_pair_distance_byorder(const Neuron& n, bool sided,
+                                                              ThreadPool* pool, float threshold){
+    
+    neuron_branches nb = prepare_neuron(n, sided, pool);
     
     // Compute for each order
-    std::vector<selector::const_branch_reference> tmp;
-      
-    for(int i = 0; i<= maxOrder ; ++i ){
-        distances[i] = std::vector<float>();
-        // Filter references
-        tmp = selector::branch_order_filter_factory(i)(v.begin(),v.end()); 
-        for(auto j = tmp.begin(); j != --tmp.end(); ++j ){
-          for(auto k = j+1 ; k != tmp.end(); ++k){
-            if( i != 0 && sided ){
-              // Get "J" positions (0 left, 1 right) if they match. compute distance
-              if( measure::branch_index(j->get()) == measure::branch_index(k->get()) ){
-                    distances[i].push_back(oriented_frechet_branch_distance(j->get(), k->get())); 
-              }
-            }
-            else {
-              distances[i].push_back(oriented_frechet_branch_distance(j->get(),k->get()));  
-            }
-            
-          }
-        }
+    std::vector<std::vector<float>> distances(nb.by_order.size());
+    for(std::size_t i = 0; i < nb.by_order.size(); ++i){
+      distances[i] = group_distances(nb.branches, nb.by_order[i], nb.sides[i],
+                                     threshold, pool);
     }
     return distances;
   }
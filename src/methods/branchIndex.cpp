@@ -0,0 +1,70 @@
+#include <neurostr/methods/branchIndex.h>
+
+#include <algorithm>
+#include <iterator>
+
+namespace neurostr {
+namespace methods {
+  
+  namespace bgi = boost::geometry::index;
+
+  BranchIndex::BranchIndex(const Neuron& n) 
+    : branches_(), boxes_(), positions_(), rtree_() {
+    
+    std::vector<value_type> values;
+    
+    for (auto it = n.begin_neurite(); it != n.end_neurite(); ++it) {
+      for (auto bit = it->begin_branch(); bit != it->end_branch(); ++bit) {
+        positions_.emplace(&(*bit), branches_.size());
+        values.emplace_back(bit->boundingBox(), branches_.size());
+        boxes_.push_back(values.back().first);
+        branches_.push_back(&(*bit));
+      }
+    }
+    
+    // Bulk load (packing)
+    rtree_ = rtree_type(values.begin(), values.end());
+  }
+  
+  geometry::box_type BranchIndex::box(const Branch& b) const {
+    auto it = positions_.find(&b);
+    if (it == positions_.end())
+      return b.boundingBox();
+    else
+      return boxes_[it->second];
+  }
+  
+  std::vector<const Branch*> BranchIndex::candidates(const Branch& b) const {
+    
+    geometry::box_type bbox_b = box(b);
+    
+    // Any box that can contain one corner has to intersect bbox_b
+    std::vector<value_type> hits;
+    rtree_.query(bgi::intersects(bbox_b), std::back_inserter(hits));
+    
+    // Restore traversal order
+    std::sort(hits.begin(), hits.end(), 
+              [](const value_type& x, const value_type& y) { return x.second < y.second; });
+    
+    std::vector<const Branch*> ret;
+    ret.reserve(hits.size());
+    for (auto it = hits.begin(); it != hits.end(); ++it) {
+      const Branch* other = branches_[it->second];
+      if (*other != b && geometry::box_box_intersection(bbox_b, it->first))
+        ret.push_back(other);
+    }
+    return ret;
+  }
+  
+  const Branch* BranchIndex::first_collision(const Branch& b, bool ignore_radius) const {
+    
+    auto cand = candidates(b);
+    for (auto it = cand.begin(); it != cand.end(); ++it) {
+      if (b.distance(**it, ignore_radius) == 0.0)
+        return *it;
+    }
+    return nullptr;
+  }
+
+} // methods
+} // neurostr
@@ -0,0 +1,98 @@
+#include <neurostr/methods/segmentIndex.h>
+
+#include <algorithm>
+#include <limits>
+
+#include <neurostr/selector/node_selector.h>
+#include <neurostr/selector/neuron_selector.h>
+
+namespace neurostr {
+namespace methods {
+  
+  namespace bg = boost::geometry;
+  namespace bgi = boost::geometry::index;
+
+  SegmentIndex::SegmentIndex(const Neuron& n) : segments_(), rtree_() {
+    
+    std::vector<value_type> values;
+    
+    auto sel = selector::neuron_node_selector(n);
+    segments_.reserve(sel.size());
+    values.reserve(sel.size());
+    
+    for (auto it = sel.begin(); it != sel.end(); ++it) {
+      const Node& node = it->get();
+      const Node& parent = selector::node_parent(node);
+      
+      // Nodes without parent dont define any segment
+      if (node != parent) {
+        values.emplace_back(segment_box(node, parent), segments_.size());
+        segments_.push_back({&node, &parent});
+      }
+    }
+    
+    // Bulk load (packing)
+    rtree_ = rtree_type(values.begin(), values.end());
+  }
+  
+  geometry::box_type SegmentIndex::segment_box(const Node& n, const Node& parent) {
+    
+    float r = (n.radius() + parent.radius()) / 2.0;
+    const point_type& a = n.position();
+    const point_type& b = parent.position();
+    
+    return geometry::box_type(
+        point_type(std::min(geometry::getx(a), geometry::getx(b)) - r,
+                   std::min(geometry::gety(a), geometry::gety(b)) - r,
+                   std::min(geometry::getz(a), geometry::getz(b)) - r),
+        point_type(std::max(geometry::getx(a), geometry::getx(b)) + r,
+                   std::max(geometry::gety(a), geometry::gety(b)) + r,
+                   std::max(geometry::getz(a), geometry::getz(b)) + r));
+  }
+  
+  float SegmentIndex::distance_to_closest(const Node& n) const {
+    
+    const Node& parent = selector::node_parent(n);
+    float mindist = std::numeric_limits<float>::max();
+    float aux;
+    
+    if (n == parent)
+      return mindist;
+    
+    geometry::box_type query = segment_box(n, parent);
+    
+    // Segments are visited nearest first. Box distance is a lower bound
+    // of the real distance, so we can stop once it exceeds the current minimum
+    for (auto it = rtree_.qbegin(bgi::nearest(query, rtree_.size()));
+         it != rtree_.qend(); ++it) {
+      
+      if (bg::distance(query, it->first) > mindist)
+        break;
+      
+      const segment& s = segments_[it->second];
+      const Node& o = *s.node;
+      const Node& o_parent = *s.parent;
+      
+      // Same exclusion rules as measure::segment_distance_to_closest
+      if (o != n && o != parent && o_parent != n) {
+        // Same parent -> return 0 if same position
+        if (o_parent == parent) {
+          if (o.distance(n) == 0)
+            return 0;
+        } else {
+          aux = geometry::segment_segment_distance(parent.position(), n.position(),
+                                                   o_parent.position(), o.position());
+          
+          // Real distance is ....
+          aux = std::max(0.0, aux - (parent.radius() + n.radius() + o.radius() + o_parent.radius()) / 2.0);
+          
+          if (aux == 0) return 0;
+          else if (aux < mindist) mindist = aux;
+        }
+      }
+    }
+    return mindist;
+  }
+
+} // methods
+} // neurostr
@@ -1,5 +1,10 @@
 #include <neurostr/methods/triContour.h>
+
 #include <algorithm>
+#include <future>
+
+#include <neurostr/core/thread_pool.h>
+
 namespace neurostr{
 namespace methods{
   
@@ -56,13 +61,35 @@ namespace methods{
     return trs;
   }
   
+namespace {
+  
   /**
-   * @brief 
-   * @param r
-   * @param name
-   * @param component
+   * @brief Contour tags of a branch, computed without modifying it
    */
-  void reconstructionContourProcess( Reconstruction& r, const std::string& name, int component, bool nointer_nodes){
+  struct branch_tags {
+    bool root_in;
+    bool branch_in;
+    std::vector<bool> nodes_in;
+    // Virtual nodes and the position of the node they precede
+    std::vector<std::pair<std::size_t, Node>> virtual_nodes;
+  };
+  
+  /**
+   * @brief Contour tags of the branches (in branch order) and markers of a neurite
+   */
+  struct neurite_tags {
+    std::vector<branch_tags> branches;
+    std::vector<bool> markers_in;
+  };
+  
+  /**
+   * @brief Builds the triangular mesh of the contours with the given name
+   * @param r Reconstruction
+   * @param name Contour name
+   * @param component Contour plane normal component
+   * @return Mesh
+   */
+  triMesh_type contour_mesh(const Reconstruction& r, const std::string& name, int component){
     
     std::vector<Contour> selected;
     
@@ -70,7 +97,12 @@ namespace methods{
     for(auto it = r.contour_begin(); it != r.contour_end(); ++it){
       if(it->name() == name){
         selected.push_back(*it);
-      }
+      }
+    }
+    
+    if(selected.empty()){
+      NSTR_LOG_(warn, "No contours named " + name);
+      return triMesh_type();
     }
     
     // Order by depth
@@ -93,12 +125,142 @@ namespace methods{
     }
     
     // Join and create triangular contour
-    triMesh_type tricontour = create_triangular_contour(selected.begin(),selected.end(),component);
+    return create_triangular_contour(selected.begin(),selected.end(),component);
+  }
+  
+  branch_tags classify_branch(const Branch& b, const std::string& name, const triMesh_type& contour, bool nointer_nodes){
+    
+    branch_tags t;
+    t.root_in = false;
+    t.branch_in = true;
+    t.nodes_in.reserve(b.size());
+    
+    if(b.has_root()){
+      if(contour.point_inside(b.root().position())){
+        t.root_in = true;
+      } else {
+        t.branch_in = false;
+      }
+    }
+    
+    for(auto it = b.begin(); it != b.end() ; ++it){
+      std::size_t pos = std::distance(b.begin(), it);
+      
+      // Check if the node is inside the contour
+      if( !contour.point_inside(it->position()) ){
+        t.nodes_in.push_back(false);
+        t.branch_in = false;
+        
+        // If node is not in the contour (and the parent is) add a virtual node
+        if(!nointer_nodes){
+          const Node* parent;
+          bool parent_in;
+          
+          // Find parent (and whether it is tagged once this pass is applied)
+          if(it == b.begin()){
+            if(b.has_root()){
+              parent = &b.root();
+              parent_in = t.root_in || parent->properties.exists(name);
+            } else {
+              parent = &(*it);
+              parent_in = false;
+            }
+          } else {
+            parent = &(*(it-1));
+            parent_in = t.nodes_in[pos-1] || parent->properties.exists(name);
+          }
+          
+          // Already set
+          if(*parent != *it && parent_in){
+            // Find cutpoint - ray direction
+            point_type ray_direction = parent->vectorTo(*it);
+            geometry::normalize(ray_direction);
+            
+            point_type intersection = contour.ray_intersection(parent->position(), ray_direction);
+            // Check that the intersection is not at some of the already existing nodes
+            if( geometry::distance(intersection, parent->position()) > 1E-3 
+                && geometry::distance(intersection, it->position()) > 1E-3 ){
+                  // Insert a node with id -3
+                t.virtual_nodes.emplace_back(pos, Node(-3,intersection, (parent->radius() + it->radius())/2 ));
+            }
+          }
+        }
+      } else {
+        // End IF -  inside
+        t.nodes_in.push_back(true);
+      }
+    } // End for loop
+    
+    return t;
+  }
+  
+  void apply_branch_tags(Branch& b, const std::string& name, const branch_tags& t){
+    
+    if(t.root_in){
+      b.root().properties.set(name);
+    }
+    
+    std::size_t pos = 0;
+    for(auto it = b.begin(); it != b.end(); ++it, ++pos){
+      if(t.nodes_in[pos]) it->properties.set(name);
+    }
+    
+    // Backwards, so positions stay valid
+    for(auto it = t.virtual_nodes.rbegin(); it != t.virtual_nodes.rend(); ++it){
+      b.insert(std::next(b.begin(), it->first), it->second);
+    }
+    
+    // If branch in is still true..
+    if(t.branch_in)
+      b.properties.set(name);
+  }
+  
+  neurite_tags classify_neurite(const Neurite& n, const std::string& name, const triMesh_type& contour, bool nointer_nodes){
+    
+    neurite_tags t;
+    t.branches.reserve(n.size());
+    for( auto it = n.begin_branch() ; it != n.end_branch(); ++it ){
+      t.branches.push_back(classify_branch( *it, name, contour, nointer_nodes));
+    }
+    
+    // Markers
+    for( auto it = n.begin_marker(); it != n.end_marker(); ++it){
+      for(auto n_it = it->second.begin(); n_it != it->second.end(); ++n_it){
+        t.markers_in.push_back(contour.point_inside(n_it->position()));
+      }
+    }
+    return t;
+  }
+  
+  void apply_neurite_tags(Neurite& n, const std::string& name, const neurite_tags& t){
     
-    // DELETEME
-    // tricontour.toJSON(std::cout);
+    auto b_it = t.branches.begin();
+    for( auto it = n.begin_branch() ; it != n.end_branch(); ++it, ++b_it ){
+      apply_branch_tags( *it, name, *b_it);
+    }
+    
+    auto m_it = t.markers_in.begin();
+    for( auto it = n.begin_marker(); it != n.end_marker(); ++it){
+      for(auto n_it = it->second.begin(); n_it != it->second.end(); ++n_it, ++m_it){
+        if(*m_it){
+          n_it->properties.set(name);
+        }
+      }
+    }
+  }
+  
+} // anonymous
+  
+  /**
+   * @brief 
+   * @param r
+   * @param name
+   * @param component
+   */
+  void reconstructionContourProcess( Reconstruction& r, const std::string& name, int component, bool nointer_nodes){
     
-    // Print
+    // Join and create triangular contour
+    triMesh_type tricontour = contour_mesh(r, name, component);
     
     // Apply to each neuron in the rec
     for(auto it = r.begin(); it != r.end(); ++it){
@@ -109,6 +271,72 @@ namespace methods{
     
   }
   
+  void reconstructionContoursProcess( Reconstruction& r, const std::vector<std::string>& names,
+                                      int component, bool nointer_nodes, std::size_t nthreads){
+    
+    if(nthreads == 0) nthreads = ThreadPool::default_size();
+    
+    // Sequential
+    if(nthreads == 1){
+      for(auto it = names.begin(); it != names.end(); ++it){
+        reconstructionContourProcess(r, *it, component, nointer_nodes);
+      }
+      return;
+    }
+    
+    ThreadPool pool(nthreads);
+    
+    // Meshes
+    std::vector<std::future<triMesh_type>> meshes;
+    meshes.reserve(names.size());
+    for(auto it = names.begin(); it != names.end(); ++it){
+      const std::string& name = *it;
+      meshes.push_back(pool.submit([&r, &name, component](){
+        return contour_mesh(r, name, component);
+      }));
+    }
+    
+    // Names are applied in order: the virtual nodes of a name are tagged by the next ones
+    for(std::size_t i = 0; i < names.size(); ++i){
+      const std::string& name = names[i];
+      triMesh_type contour = meshes[i].get();
+      
+      // Classify
+      std::vector<std::future<neurite_tags>> neurites;
+      std::vector<std::future<std::vector<bool>>> somas;
+      for(auto n = r.begin(); n != r.end(); ++n){
+        const Neuron* neuron = &(*n);
+        for(auto it = n->begin_neurite() ; it != n->end_neurite(); ++it ){
+          const Neurite* neurite = &(*it);
+          neurites.push_back(pool.submit([neurite, &name, &contour, nointer_nodes](){
+            return classify_neurite(*neurite, name, contour, nointer_nodes);
+          }));
+        }
+        somas.push_back(pool.submit([neuron, &contour](){
+          std::vector<bool> soma_in;
+          for( auto it = neuron->begin_soma() ; it != neuron->end_soma() ; ++it ){
+            soma_in.push_back(contour.point_inside(it->position()));
+          }
+          return soma_in;
+        }));
+      }
+      
+      // Apply (same order as the sequential version)
+      auto t_it = neurites.begin();
+      auto s_it = somas.begin();
+      for(auto n = r.begin(); n != r.end(); ++n, ++s_it){
+        for(auto it = n->begin_neurite() ; it != n->end_neurite(); ++it, ++t_it ){
+          apply_neurite_tags(*it, name, t_it->get());
+        }
+        std::vector<bool> soma_in = s_it->get();
+        auto in_it = soma_in.begin();
+        for( auto it = n->begin_soma() ; it != n->end_soma() ; ++it, ++in_it ){
+          it->properties.set(name, static_cast<bool>(*in_it));
+        }
+      }
+    }
+  }
+  
   /**
    * @brief 
    * @param n
@@ -135,20 +363,7 @@ namespace methods{
    * @param contour
    */
   void neuriteContourProcess( Neurite& n, const std::string& name, const triMesh_type& contour, bool nointer_nodes){
-     
-     // ITerate over the neurite
-    for( auto it = n.begin_branch() ; it != n.end_branch(); ++it ){
-      branchContourProcess( *it, name, contour, nointer_nodes);
-    }
-    
-    // Markers
-    for( auto it = n.begin_marker(); it != n.end_marker(); ++it){
-      for(auto n_it = it->second.begin(); n_it != it->second.end(); ++n_it){
-        if(contour.point_inside(n_it->position())){
-          n_it->properties.set(name);
-        }
-      }
-    }
+    apply_neurite_tags(n, name, classify_neurite(n, name, contour, nointer_nodes));
   }
   
   /**
@@ -159,62 +374,7 @@ namespace methods{
    * @return 
    */
   void branchContourProcess( Branch& b, const std::string& name, const triMesh_type& contour, bool nointer_nodes){
-    
-    bool branch_in = true;
-    
-     if(b.has_root()){
-       if(contour.point_inside(b.root().position())){
-        b.root().properties.set(name);
-       } else {
-         branch_in=false;
-       }
-     } 
-    
-     for(auto it = b.begin(); it != b.end() ; ++it){
-      // Check if the node is inside the contour
-      if( !contour.point_inside(it->position()) ){
-        branch_in = false;
-        // If node is not in the contour (and the parent is) add a virtual node
-        if(!nointer_nodes){
-          Node parent;
-          
-          // Find parent
-          if(it == b.begin()){
-            if(b.has_root()){
-              parent = b.root();
-            } else {
-              parent = *it;
-            }
-          } else {
-            parent = *(it-1);
-          }
-          
-          // Already set
-          if(parent != *it && parent.properties.exists(name)){
-            // Find cutpoint - ray direction
-            point_type ray_direction = parent.vectorTo(*it);
-            geometry::normalize(ray_direction);
-            
-            point_type intersection = contour.ray_intersection(parent.position(), ray_direction);
-            // Check that the intersection is not at some of the already existing nodes
-            if( geometry::distance(intersection, parent.position()) > 1E-3 
-                && geometry::distance(intersection, it->position()) > 1E-3 ){
-                  // Insert a node with id -3
-                auto insert_it = b.insert(it, Node(-3,intersection, (parent.radius() + it->radius())/2 ) );
-                it = insert_it;
-                branch_in = false;
-            }
-          }
-        }
-      } else {
-        // End IF -  inside
-        it->properties.set(name);
-      }
-    } // End for loop
-    
-    // If branch in is still true..
-    if(branch_in)
-      b.properties.set(name);
+    apply_branch_tags(b, name, classify_branch(b, name, contour, nointer_nodes));
   }
   
   /**
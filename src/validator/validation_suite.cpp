@@ -0,0 +1,61 @@
+#include <neurostr/validator/validation_suite.h>
+
+#include <algorithm>
+#include <future>
+
+#include <neurostr/core/thread_pool.h>
+#include <neurostr/measure/node_measure.h>
+
+namespace neurostr {
+namespace validator {
+  
+  ValidationSuite::ValidationSuite(std::size_t nthreads)
+    : validators_(), nthreads_(nthreads == 0 ? ThreadPool::default_size() : nthreads) {}
+  
+  void ValidationSuite::validate(const Neuron& n){
+    
+    std::size_t nthreads = std::min(nthreads_, validators_.size());
+    
+    // Sequential
+    if(nthreads <= 1){
+      for(auto it = validators_.begin(); it != validators_.end(); ++it)
+        (*it)->validate(n);
+      return;
+    }
+    
+    // Concurrent validators must not write the node caches
+    measure::fill_node_caches(n);
+    
+    std::vector<std::future<void>> done;
+    done.reserve(validators_.size());
+    {
+      ThreadPool pool(nthreads);
+      for(auto it = validators_.begin(); it != validators_.end(); ++it){
+        suite_entry_base* v = it->get();
+        done.push_back(pool.submit([v, &n](){ v->validate(n); }));
+      }
+    } // Wait for all
+    
+    // Rethrow in insertion order
+    for(auto it = done.begin(); it != done.end(); ++it)
+      it->get();
+  }
+  
+  bool ValidationSuite::pass() const {
+    return std::all_of(validators_.begin(), validators_.end(), 
+                       [](const std::unique_ptr<suite_entry_base>& v){ return v->pass(); });
+  }
+  
+  std::ostream& ValidationSuite::toJSON(std::ostream& os, bool failuresOnly) const {
+    os << "[" << std::endl;
+    for(auto it = validators_.begin(); it != validators_.end(); ++it){
+      if(it != validators_.begin())
+        os << "," << std::endl;
+      (*it)->toJSON(os, failuresOnly);
+    }
+    os << "]" << std::endl;
+    return os;
+  }
+  
+}  // validation
+}  // neurostr
@@ -0,0 +1,170 @@
+#include <unittest++/UnitTest++.h>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <neurostr/core/arena.h>
+#include <neurostr/core/node.h>
+#include <neurostr/core/neurite.h>
+#include <neurostr/core/neuron.h>
+#include <neurostr/io/parser_dispatcher.h>
+
+#define ARENA_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(arena_tests){
+using namespace neurostr;
+
+const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  ARENA_TEST_DATA_SUBDIR : ARENA_TEST_DATA_SUBDIR;
+
+TEST(no_scope_heap){
+  auto a = Arena::create();
+  CHECK(Arena::current() == nullptr);
+
+  std::unique_ptr<Node> n(new Node(1));
+  CHECK_EQUAL(0u, a->live());
+  CHECK_EQUAL(0u, a->reserved());
+}
+
+TEST(heap_with_live_arena){
+  auto a = Arena::create(1024);
+  std::unique_ptr<Node> in_arena, in_heap;
+  {
+    ArenaScope scope(a);
+    in_arena.reset(new Node(1));
+  }
+  in_heap.reset(new Node(2));
+  CHECK_EQUAL(1u, a->live());
+
+  // Heap blocks are not taken as arena blocks
+  in_heap.reset();
+  CHECK_EQUAL(1u, a->live());
+  in_arena.reset();
+  CHECK_EQUAL(0u, a->live());
+}
+
+TEST(scope_nodes){
+  auto a = Arena::create(1024);
+  std::unique_ptr<Node> n, m;
+  {
+    ArenaScope scope(a);
+    CHECK(Arena::current() == a.get());
+    n.reset(new Node(1));
+    m.reset(new Node(2, 1.0, 2.0, 3.0, 0.5));
+  }
+  CHECK(Arena::current() == nullptr);
+  CHECK_EQUAL(2u, a->live());
+  CHECK(a->reserved() >= 1024u);
+
+  CHECK_EQUAL(2, m->id());
+  CHECK_CLOSE(0.5, m->radius(), 1E-6);
+
+  n.reset();
+  CHECK_EQUAL(1u, a->live());
+}
+
+TEST(nested_scopes){
+  auto a = Arena::create();
+  auto b = Arena::create();
+  {
+    ArenaScope sa(a);
+    {
+      ArenaScope sb(b);
+      CHECK(Arena::current() == b.get());
+      {
+        ArenaScope heap(nullptr);
+        CHECK(Arena::current() == nullptr);
+      }
+      CHECK(Arena::current() == b.get());
+    }
+    CHECK(Arena::current() == a.get());
+  }
+  CHECK(Arena::current() == nullptr);
+}
+
+TEST(big_blocks){
+  auto a = Arena::create(256);
+  {
+    ArenaScope scope(a);
+    void* small = Arena::allocate(16);
+    void* big = Arena::allocate(4096);
+    void* other = Arena::allocate(16);
+    CHECK(small != nullptr && big != nullptr && other != nullptr);
+    CHECK(a->reserved() >= 4096u + 256u);
+
+    // Aligned blocks
+    CHECK_EQUAL(0u, reinterpret_cast<std::uintptr_t>(big) % alignof(std::max_align_t));
+    CHECK_EQUAL(0u, reinterpret_cast<std::uintptr_t>(other) % alignof(std::max_align_t));
+
+    Arena::deallocate(small);
+    Arena::deallocate(big);
+    Arena::deallocate(other);
+  }
+  CHECK_EQUAL(0u, a->live());
+}
+
+TEST(outlives_owner){
+  std::unique_ptr<Node> n;
+  {
+    auto a = Arena::create();
+    ArenaScope scope(a);
+    n.reset(new Node(3, 1.0, 1.0, 1.0, 1.0));
+  }
+  // Arena is kept until the node is freed
+  CHECK_EQUAL(3, n->id());
+  n.reset();
+}
+
+TEST(free_other_thread){
+  auto a = Arena::create();
+  std::unique_ptr<Node> n;
+  {
+    ArenaScope scope(a);
+    n.reset(new Node(1));
+  }
+  std::thread t([&n](){
+    CHECK(Arena::current() == nullptr);
+    n.reset();
+  });
+  t.join();
+  CHECK_EQUAL(0u, a->live());
+}
+
+TEST(neurite_in_arena){
+  auto a = Arena::create();
+  std::unique_ptr<Neurite> n;
+  {
+    ArenaScope scope(a);
+    n.reset(new Neurite(1));
+    n->insert_node(n->begin_node(), Node(1));
+    n->insert_node(1, Node(2));
+    n->insert_node(2, Node(3));
+    n->insert_node(2, Node(4));
+    n->properties.set("test", 1);
+  }
+  // Nodes and tree nodes. Property maps are always in the heap
+  CHECK(a->live() >= 4u + 3u);
+  CHECK_EQUAL(4, n->node_count());
+  CHECK_EQUAL(3, n->size());
+
+  // Elements added out of the scope are in the heap
+  std::size_t live = a->live();
+  n->insert_node(4, Node(5));
+  CHECK_EQUAL(live, a->live());
+
+  n.reset();
+  CHECK_EQUAL(0u, a->live());
+}
+
+TEST(read_file_arena){
+  auto r = io::read_file_by_ext(test_files_folder + "real.swc", true);
+  auto h = io::read_file_by_ext(test_files_folder + "real.swc");
+
+  CHECK(r->arena() != nullptr);
+  CHECK(h->arena() == nullptr);
+  CHECK(r->arena()->live() >= static_cast<std::size_t>(r->node_count()));
+  CHECK_EQUAL(h->node_count(), r->node_count());
+}
+
+}
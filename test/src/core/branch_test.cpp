@@ -22,7 +22,9 @@ TEST(partial_constructor) {
   Branch b{id,1,r};
   CHECK_EQUAL(b.size(),0);
   CHECK_EQUAL(b.has_root(), true);
-  CHECK_EQUAL(b.id().size(), 3);
+  CHECK_EQUAL(b.id().size(), 1);
+  CHECK_EQUAL(b.position(), 0);
+  CHECK_EQUAL(b.number(), -1);
   CHECK_EQUAL(b.order(), 1);
   CHECK(b.root()==r);
   CHECK(!b.valid_neurite());
@@ -35,7 +37,8 @@ TEST(full_constructor) {
   Branch b{id,1,r,nodes};
   CHECK_EQUAL(b.size(),2);
   CHECK_EQUAL(b.has_root(), true);
-  CHECK_EQUAL(b.id().size(), 3);
+  CHECK_EQUAL(b.id().size(), 1);
+  CHECK_EQUAL(b.position(), 1);
   CHECK_EQUAL(b.order(), 1);
   CHECK(b.root()==r);
   CHECK(b.first()==a);
@@ -53,18 +56,19 @@ TEST(order_set){
 }
 
 TEST(id_set){
-  Branch::id_type id{0,0,0};
-  Branch::id_type id_b{0,0,1};
+  // Detached branches only keep their position
+  Branch::id_type id{0,0,2};
+  Branch::id_type id_b{0,0,3};
   Branch b{id,1};
   
-  for(unsigned int i = 0 ; i<id.size() ; ++i){
-    CHECK_EQUAL(b.id()[i],id[i]);
-  }
+  CHECK(b.id() == Branch::id_type{2});
   
   b.id(id_b);
-  for(unsigned int i = 0 ; i<id.size() ; ++i){
-    CHECK_EQUAL(b.id()[i],id_b[i]);
-  }
+  CHECK(b.id() == Branch::id_type{3});
+  CHECK_EQUAL(b.position(), 3);
+  
+  b.number(7);
+  CHECK_EQUAL(b.number(), 7);
 }
 
 TEST(id_string){
@@ -72,12 +76,27 @@ TEST(id_string){
   Branch::id_type id_b{};
   Branch b{id,1};
   
-  CHECK_EQUAL(b.idString(),std::string("1-2-3"));
+  CHECK_EQUAL(b.idString(),std::string("3"));
   
   b.id(id_b);
   CHECK_EQUAL(b.idString(),std::string());
 }
 
+TEST(id_from_tree){
+  // Path ids follow the neurite tree
+  Neurite n(1);
+  n.set_root();
+  n.insert_node(n.begin_branch(),Node(1));
+  auto ch = n.append_branch(n.begin_branch(),Branch({1,1},1));
+  auto gch = n.append_branch(ch,Branch({1,1,2},2));
+  
+  CHECK(gch->id() == (Branch::id_type{1,1,2}));
+  CHECK_EQUAL(std::string("1-1-2"), gch->idString());
+  
+  ch->position(3);
+  CHECK_EQUAL(std::string("1-3-2"), gch->idString());
+}
+
 TEST(set_neurite){
   Neurite n(1);
   Branch b{};
@@ -208,6 +227,30 @@ TEST(insert) {
   // Middle
   b.insert(++b.begin(),f);
   CHECK( *(++b.begin())==f);
+  
+  // Inserted node and the next one are relinked
+  CHECK(&(std::next(b.begin(),1)->parent()) == &(b.first()));
+  CHECK(&(std::next(b.begin(),2)->parent()) == &(*std::next(b.begin(),1)));
+}
+
+TEST(insert_range) {
+  Node r(1),a(2),c(3),d(4),e(5);
+  std::vector<Node> nodes{a,c};
+  std::vector<Node> range{d,e};
+  Branch::id_type id{0,0,1};
+  Branch b{id,1,r,nodes};
+  
+  // Range order is kept
+  b.insert(++b.begin(), range.begin(), range.end());
+  CHECK_EQUAL(b.size(),4);
+  CHECK(b.first()==a);
+  CHECK( *std::next(b.begin(),1)==d);
+  CHECK( *std::next(b.begin(),2)==e);
+  CHECK(b.last()==c);
+  
+  // Parents follow the new order
+  for(auto it = std::next(b.begin(),1); it != b.end(); ++it)
+    CHECK(&(it->parent()) == &(*std::prev(it,1)));
 }
 
 TEST(equality_op) {
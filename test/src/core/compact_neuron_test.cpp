@@ -0,0 +1,152 @@
+#include <unittest++/UnitTest++.h>
+#include <cmath>
+#include <fstream>
+#include <memory>
+
+#include <neurostr/core/compact_neuron.h>
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/lmeasure_decl.h>
+#include <neurostr/measure/compact_measure.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(compact_neuron_tests){
+
+  using namespace neurostr;
+  namespace nlm = neurostr::measure::lmeasure;
+  namespace ncm = neurostr::measure::lmeasure::compact;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR;
+
+  std::unique_ptr<Reconstruction> read_swc(const std::string& s){
+    std::ifstream is(test_files_folder + s);
+    io::SWCParser p(is);
+    return p.read("test");
+  }
+
+  void check_close(float a, float b){
+    if(std::isnan(a) || std::isnan(b)){
+      CHECK(std::isnan(a) && std::isnan(b));
+    } else if(std::isinf(a) || std::isinf(b)){
+      CHECK_EQUAL(a, b);
+    } else {
+      CHECK_CLOSE(a, b, 1E-3 * std::max(1.f, std::abs(a)));
+    }
+  }
+
+  template <typename U>
+  void check_aggr(const measure::aggregate::aggr_pack<U,float>& a,
+                  const measure::aggregate::aggr_pack<U,float>& b){
+    check_close(a.sum, b.sum);
+    check_close(a.min, b.min);
+    check_close(a.max, b.max);
+    check_close(a.median, b.median);
+    check_close(a.mean, b.mean);
+    check_close(a.sd, b.sd);
+  }
+
+  TEST(structure){
+    auto rec = read_swc("simple_tree.swc");
+    const Neuron& n = *(rec->begin());
+    CompactNeuron c(n);
+
+    CHECK_EQUAL(n.id(), c.id());
+    CHECK_EQUAL(static_cast<std::size_t>(n.node_count()), c.node_count());
+    CHECK_EQUAL(static_cast<std::size_t>(n.size()), c.neurite_count());
+    CHECK_EQUAL(static_cast<std::size_t>(std::distance(n.begin_soma(), n.end_soma())), c.soma_size());
+
+    // Parents are stored before children and match node_parent
+    for(CompactNeuron::index_type i = 0; i < static_cast<CompactNeuron::index_type>(c.size()); ++i)
+      CHECK(c.parent(i) < i);
+
+    auto sel = selector::neuron_node_selector(n);
+    std::size_t idx = 0;
+    for(CompactNeuron::index_type b = 0; b < static_cast<CompactNeuron::index_type>(c.branch_count()); ++b){
+      for(auto i = c.branch_begin(b); i < c.branch_end(b); ++i, ++idx){
+        const Node& node = sel[idx].get();
+        CHECK_EQUAL(node.id(), c.node_id(i));
+        CHECK_EQUAL(selector::node_parent(node).id(), c.node_id(c.node_parent(i)));
+      }
+    }
+    CHECK_EQUAL(sel.size(), idx);
+  }
+
+  void check_lmeasures(const Neuron& n){
+    CompactNeuron c(n);
+
+    check_close(nlm::soma_surface(n), ncm::soma_surface(c));
+    CHECK_EQUAL(nlm::n_stems(n), ncm::n_stems(c));
+    CHECK_EQUAL(nlm::n_bifs(n), ncm::n_bifs(c));
+    CHECK_EQUAL(nlm::n_branch(n), ncm::n_branch(c));
+    CHECK_EQUAL(nlm::n_tips(n), ncm::n_tips(c));
+    check_close(nlm::width(n), ncm::width(c));
+    check_close(nlm::height(n), ncm::height(c));
+    check_close(nlm::depth(n), ncm::depth(c));
+
+    check_aggr(nlm::diameter(n), ncm::diameter(c));
+    check_aggr(nlm::diameter_pow(n), ncm::diameter_pow(c));
+    check_aggr(nlm::length(n), ncm::length(c));
+    check_aggr(nlm::surface(n), ncm::surface(c));
+    check_aggr(nlm::section_area(n), ncm::section_area(c));
+    check_aggr(nlm::volume(n), ncm::volume(c));
+    check_aggr(nlm::euc_distance(n), ncm::euc_distance(c));
+    check_aggr(nlm::path_distance(n), ncm::path_distance(c));
+    check_aggr(nlm::branch_order(n), ncm::branch_order(c));
+    check_aggr(nlm::terminal_degree(n), ncm::terminal_degree(c));
+    check_aggr(nlm::taper_1(n), ncm::taper_1(c));
+    check_aggr(nlm::taper_2(n), ncm::taper_2(c));
+    check_aggr(nlm::branch_pathlength(n), ncm::branch_pathlength(c));
+    check_aggr(nlm::contraction(n), ncm::contraction(c));
+    check_aggr(nlm::fragmentation(n), ncm::fragmentation(c));
+    check_aggr(nlm::partition_asymmetry(n), ncm::partition_asymmetry(c));
+    check_aggr(nlm::rall_power(n), ncm::rall_power(c));
+    check_aggr(nlm::pk(n), ncm::pk(c));
+    check_aggr(nlm::pk_classic(n), ncm::pk_classic(c));
+    check_aggr(nlm::pk_2(n), ncm::pk_2(c));
+    check_aggr(nlm::bif_ampl_local(n), ncm::bif_ampl_local(c));
+    check_aggr(nlm::bif_ampl_remote(n), ncm::bif_ampl_remote(c));
+    check_aggr(nlm::last_parent_diam(n), ncm::last_parent_diam(c));
+  }
+
+  TEST(lmeasures){
+    auto rec = read_swc("real.swc");
+    Neuron& n = *(rec->begin());
+    n.remove_null_segments();
+    check_lmeasures(n);
+  }
+
+  // Empty non-terminal branch: its children are attached to the last node
+  // of the root branch
+  TEST(lmeasures_empty_branch){
+    Neuron n("test");
+    Neurite* ne = new Neurite(1, NeuriteType::kDendrite);
+    ne->set_root();
+    ne->insert_node(ne->begin_branch(), Node(1, 0, 0, 0, 1));
+    ne->insert_node(ne->begin_branch(), Node(2, 1, 0, 0, 1));
+    auto e = ne->append_branch(ne->begin_branch(), Branch({1,1},1));
+    auto ch_a = ne->append_branch(e, Branch({1,1,1},2));
+    ne->insert_node(ch_a, Node(3, 2, 1, 0, 0.5));
+    auto ch_b = ne->append_branch(e, Branch({1,1,2},2));
+    ne->insert_node(ch_b, Node(4, 2, -1, 0, 0.5));
+    auto ch_c = ne->append_branch(ne->begin_branch(), Branch({1,2},1));
+    ne->insert_node(ch_c, Node(5, 1, 2, 0, 0.5));
+    n.add_neurite(ne);
+    CompactNeuron c(n);
+
+    // The root bifurcation has an empty child: only the empty branch counts
+    auto pk = ncm::pk_classic(c);
+    check_close(2/std::pow(2,1.5), pk.mean);
+    check_close(pk.mean, pk.max);
+    check_close(2., ncm::last_parent_diam(c).mean);
+    // Angles are not defined at an empty branch or an empty child
+    check_close(0., ncm::bif_ampl_local(c).sum);
+  }
+
+  // Zero radius nodes: NAN values are not aggregated
+  TEST(lmeasures_nan){
+    auto rec = read_swc("simple_tree.swc");
+    check_lmeasures(*(rec->begin()));
+  }
+
+}
@@ -0,0 +1,130 @@
+#include <unittest++/UnitTest++.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/node.h>
+#include <neurostr/core/branch.h>
+
+SUITE(frechet_tests){
+using namespace neurostr;
+using namespace neurostr::geometry;
+
+using point_vector = std::vector<point_type>;
+using frechet_type = DiscreteFrechet<point_vector::const_iterator, point_vector::const_iterator>;
+
+// Full coupling matrix
+double reference_frechet(const point_vector& a, const point_vector& b){
+  std::vector<std::vector<double>> c(a.size(), std::vector<double>(b.size()));
+  for(std::size_t i = 0; i < a.size(); ++i){
+    for(std::size_t j = 0; j < b.size(); ++j){
+      double d = boost::geometry::distance(a[i], b[j]);
+      if(i == 0 && j == 0) c[i][j] = d;
+      else if(i == 0) c[i][j] = std::max(c[i][j-1], d);
+      else if(j == 0) c[i][j] = std::max(c[i-1][j], d);
+      else c[i][j] = std::max(std::min({c[i-1][j], c[i][j-1], c[i-1][j-1]}), d);
+    }
+  }
+  return c.back().back();
+}
+
+point_vector wave(int n, float amplitude, float phase, float dz){
+  point_vector v;
+  for(int i = 0; i < n; ++i){
+    v.push_back(point_type(i * 0.5, amplitude * std::sin(i * 0.3 + phase), dz));
+  }
+  return v;
+}
+
+TEST(parallel_lines){
+  point_vector a = {point_type(0,0,0), point_type(1,0,0), point_type(2,0,0)};
+  point_vector b = {point_type(0,1,0), point_type(1,1,0), point_type(2,1,0)};
+  frechet_type f(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+  CHECK_CLOSE(1.0, f.value(), 1E-6);
+}
+
+TEST(single_points){
+  point_vector a = {point_type(0,0,0)};
+  point_vector b = {point_type(3,4,0)};
+  frechet_type f(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+  CHECK_CLOSE(5.0, f.value(), 1E-6);
+}
+
+TEST(empty){
+  point_vector a = {point_type(0,0,0)};
+  point_vector b;
+  frechet_type f(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+  CHECK(std::isnan(f.value()));
+}
+
+TEST(same_as_reference){
+  for(int p : {1, 2, 7, 30}){
+    for(int q : {1, 3, 12, 45}){
+      point_vector a = wave(p, 1.0, 0.0, 0.0);
+      point_vector b = wave(q, 1.5, 0.7, 0.2);
+      frechet_type ab(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+      frechet_type ba(b.cbegin(), b.cend(), a.cbegin(), a.cend());
+      double expected = reference_frechet(a, b);
+      CHECK_EQUAL(expected, ab.value());
+      CHECK_EQUAL(expected, ba.value());
+    }
+  }
+}
+
+TEST(bound){
+  point_vector a = wave(40, 1.0, 0.0, 0.0);
+  point_vector b = wave(50, 2.0, 0.4, 0.5);
+  frechet_type f(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+  double d = f.value();
+  
+  // Bounds above the distance give the distance
+  CHECK_EQUAL(d, f.value(d));
+  CHECK_EQUAL(d, f.value(d + 1));
+  
+  // Bounds below it give a greater value
+  CHECK(f.value(d * 0.5) > d * 0.5);
+  CHECK(f.value(d * 0.99) > d * 0.99);
+  CHECK(f.value(0) > 0);
+}
+
+TEST(reset){
+  point_vector a = wave(20, 1.0, 0.0, 0.0);
+  point_vector b = wave(25, 2.0, 0.4, 0.5);
+  point_vector c = wave(5, 0.5, 1.0, 0.0);
+  
+  frechet_type f;
+  f.reset(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+  CHECK_EQUAL(reference_frechet(a, b), f.value());
+  f.reset(c.cbegin(), c.cend(), a.cbegin(), a.cend());
+  CHECK_EQUAL(reference_frechet(c, a), f.value());
+}
+
+TEST(long_lines){
+  // Deep enough to overflow a recursive computation
+  point_vector a = wave(20000, 1.0, 0.0, 0.0);
+  point_vector b = wave(20000, 1.0, 0.1, 0.0);
+  frechet_type f(a.cbegin(), a.cend(), b.cbegin(), b.cend());
+  double d = f.value();
+  CHECK(d > 0 && d < 1.0);
+}
+
+TEST(branch_frechet){
+  Branch a(Branch::id_type(), 0, Node(0, 0, 0, 0, 1));
+  Branch b(Branch::id_type(), 0, Node(0, 0, 0, 0, 1));
+  for(int i = 1; i < 10; ++i){
+    a.push_back(Node(i, i, 0, 0, 1));
+    b.push_back(Node(i, i, 2, 0, 1));
+  }
+  
+  CHECK_CLOSE(2.0, a.discrete_frechet(b), 1E-6);
+  CHECK_CLOSE(2.0, a.discrete_frechet(b, 3.0), 1E-6);
+  CHECK(a.discrete_frechet(b, 1.0) > 1.0);
+  CHECK(a.discrete_frechet(b, 2.0 - 1E-6) > 2.0 - 1E-6);
+  
+  // The distance itself is not abandoned
+  float d = a.discrete_frechet(b);
+  CHECK_EQUAL(d, a.discrete_frechet(b, d));
+}
+
+}
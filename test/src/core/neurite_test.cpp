@@ -1,10 +1,12 @@
 #include <unittest++/UnitTest++.h>
+#include <set>
 #include <boost/iterator/filter_iterator.hpp>
 #include <neurostr/core/neurite_type.h>
 #include <neurostr/core/node.h>
 #include <neurostr/core/branch.h>
 #include <neurostr/core/neurite.h>
 #include <neurostr/core/neuron.h>
+#include <neurostr/selector/node_selector.h>
 
 
 
@@ -198,6 +200,50 @@ TEST(branch_iterator_dfs){
   CHECK_EQUAL("1-2",std::next(n.begin_branch(),4)->idString());
 }
 
+TEST(branch_numbers){
+  SampleNeurite test_data;
+  Neurite& n = test_data.neurite_example;
+  
+  // Unique while inserting
+  std::set<int> numbers;
+  for(auto it = n.begin_branch(); it != n.end_branch(); ++it)
+    numbers.insert(it->number());
+  CHECK_EQUAL(5, numbers.size());
+  
+  // DFS index after reassign
+  n.reassign_branch_ids();
+  int i = 0;
+  for(auto it = n.begin_branch(); it != n.end_branch(); ++it, ++i){
+    CHECK_EQUAL(i, it->number());
+    CHECK_EQUAL(it->id().size() - 1, it->order());
+  }
+  
+  // New branches continue the numbering
+  n.insert_node(4,Node(9));
+  CHECK_EQUAL(5, std::next(n.begin_branch(),2)->number());
+}
+
+TEST(branch_id_cache){
+  SampleNeurite test_data;
+  Neurite& n = test_data.neurite_example;
+  
+  const Branch* b = nullptr;
+  for(auto it = n.begin_node(); it != n.end_node(); ++it)
+    if(it->id() == 7) b = &(it->branch());
+  
+  // Built once
+  CHECK_EQUAL("1-1-1", b->idString());
+  CHECK(&(b->id()) == &(b->id()));
+  
+  // Split above: one more level in the path
+  n.insert_node(2,Node(9));
+  CHECK_EQUAL("1-1-1-1", b->idString());
+  
+  // Parent position change
+  n.begin_branch().begin()->position(2);
+  CHECK_EQUAL("1-2-1-1", b->idString());
+}
+
 TEST(branch_iterator_dfs_subtree){
   SampleNeurite test_data;
   Neurite& n = test_data.neurite_example;
@@ -253,6 +299,49 @@ TEST(find_branch_noexists){
   CHECK(f == n.end_branch() );
 }
 
+TEST(find_branch_every){
+  SampleNeurite test_data;
+  Neurite& n = test_data.neurite_example;
+  
+  // Split, then look up every branch by reference
+  n.insert_node(4,Node(9));
+  for(auto it = n.begin_branch(); it != n.end_branch(); ++it){
+    CHECK(n.find(*it) == it);
+  }
+}
+
+TEST(find_branch_other_neurite){
+  SampleNeurite test_data;
+  SampleNeurite other_data;
+  Neurite& n = test_data.neurite_example;
+  Neurite& other = other_data.neurite_example;
+  
+  // Rooted branches of other neurite don't belong to n
+  for(auto it = std::next(other.begin_branch(),1); it != other.end_branch(); ++it){
+    CHECK(n.find(*it) == n.end_branch());
+  }
+}
+
+TEST(find_branch_moved){
+  SampleNeurite test_data;
+  int size = test_data.neurite_example.size();
+  Neurite n(std::move(test_data.neurite_example));
+  
+  CHECK_EQUAL(size, n.size());
+  for(auto it = n.begin_branch(); it != n.end_branch(); ++it){
+    CHECK(&it->neurite() == &n);
+    CHECK(n.find(*it) == it);
+  }
+  
+  Neurite m(2);
+  m = std::move(n);
+  CHECK_EQUAL(size, m.size());
+  for(auto it = m.begin_branch(); it != m.end_branch(); ++it){
+    CHECK(&it->neurite() == &m);
+    CHECK(m.find(*it) == it);
+  }
+}
+
 TEST(find_node_exists){
   SampleNeurite test_data;
   Neurite& n = test_data.neurite_example;
@@ -358,6 +447,52 @@ TEST(insert_node_parent_split){
   CHECK(f->id() == 9);
 }
 
+TEST(node_parent_after_split){
+  SampleNeurite test_data;
+  Neurite& n = test_data.neurite_example;
+  
+  // Warm parent pointers before modifying the neurite
+  for(auto it = n.begin_node(); it != n.end_node(); ++it)
+    selector::node_parent(*it);
+  
+  // Split at 4 and append 9 / insert in the middle of a branch
+  n.insert_node(4,Node(9));
+  n.insert_node(6,Node(10));
+  
+  std::map<int,int> expected{ {2,1}, {3,2}, {4,3}, {5,4}, {6,3}, {7,5},
+                              {8,5}, {9,4}, {10,6} };
+  for(auto it = n.begin_node(); it != n.end_node(); ++it){
+    if(it->id() == 1) continue;
+    CHECK_EQUAL(expected[it->id()], selector::node_parent(*it).id());
+  }
+  
+  // Parent branch is reachable from the branch itself
+  for(auto it = n.begin_branch(); it != n.end_branch(); ++it){
+    if(it.node->parent == nullptr)
+      CHECK(it->parent_branch() == nullptr);
+    else
+      CHECK(it->parent_branch() == &(it.node->parent->data));
+  }
+}
+
+TEST(node_parent_after_erase){
+  SampleNeurite test_data;
+  Neurite& n = test_data.neurite_example;
+  
+  for(auto it = n.begin_node(); it != n.end_node(); ++it)
+    selector::node_parent(*it);
+  
+  // Remove node 2 (middle) and 3 (last) from the first branch
+  Branch& b = *n.begin_branch();
+  b.erase(std::next(b.begin(),1));
+  b.erase(std::prev(b.end(),1));
+  
+  CHECK_EQUAL(1, b.size());
+  for(auto it = std::next(n.begin_branch(),1); it != n.end_branch(); ++it){
+    if(it.node->parent == n.begin_branch().node)
+      CHECK_EQUAL(1, selector::node_parent(*(it->begin())).id());
+  }
+}
 
 // Split correct in different ops
 TEST(correct){
@@ -412,6 +547,26 @@ TEST(append_branch){
   CHECK_EQUAL(3, n_a.size());
 }
 
+TEST(simplify_invalidates_children){
+  Neurite n(1);
+  n.set_root();
+  n.insert_node(n.begin_branch(), Node(1,0,0,0,1));
+  n.insert_node(n.begin_branch(), Node(2,1,0,0,1));
+  n.insert_node(n.begin_branch(), Node(3,2,0,0,1));
+  auto ch = n.append_branch(n.begin_branch(), Branch({1,1},1));
+  n.insert_node(ch, Node(4,3,1,0,1));
+  
+  // Cache the child first node parent
+  selector::node_parent(ch->first());
+  CHECK(ch->first().valid_parent());
+  
+  // Node 2 (before the last one) is removed
+  n.begin_branch()->simplify(0.1);
+  CHECK_EQUAL(2, n.begin_branch()->size());
+  CHECK(!ch->first().valid_parent());
+  CHECK_EQUAL(3, selector::node_parent(ch->first()).id());
+}
+
 TEST(remove_empty_branch_empty){
   Neurite n(1);
   CHECK(!n.remove_empty_branches());
@@ -542,7 +697,7 @@ TEST(collapse_single_branch_multiple){
   CHECK(f.begin() != f.end());
 }
 
-TEST(reassign_roots_empty){
+TEST(reassign_roots_empty){
   Neurite n(1);
   
   n.reassign_branch_roots();
@@ -0,0 +1,85 @@
+#include <unittest++/UnitTest++.h>
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+#include <neurostr/core/pipeline.h>
+#include <neurostr/core/thread_pool.h>
+
+SUITE(pipeline_tests){
+using namespace neurostr;
+
+TEST(order){
+  std::vector<std::size_t> out;
+  ordered_pipeline(100, 4,
+                   [](std::size_t i){ return i; },
+                   [&out](std::size_t v){ out.push_back(v); });
+
+  CHECK_EQUAL(100u, out.size());
+  for(std::size_t i = 0; i < out.size(); ++i)
+    CHECK_EQUAL(i, out[i]);
+}
+
+TEST(window){
+  std::atomic<int> ahead(0);
+  int max_ahead = 0;
+  ordered_pipeline(50, 3,
+                   [&ahead](std::size_t i){ ++ahead; return i; },
+                   [&](std::size_t){
+                     max_ahead = std::max(max_ahead, ahead.load());
+                     --ahead;
+                   });
+
+  // Window values plus the one being produced
+  CHECK(max_ahead <= 4);
+}
+
+TEST(move_only){
+  int sum = 0;
+  ordered_pipeline(10, 2,
+                   [](std::size_t i){ return std::unique_ptr<int>(new int(i)); },
+                   [&sum](std::unique_ptr<int>& v){ sum += *v; });
+  CHECK_EQUAL(45, sum);
+}
+
+TEST(with_pool){
+  ThreadPool pool(3);
+  std::vector<int> out;
+  ordered_pipeline(20, 4,
+                   [&pool](std::size_t i){
+                     std::vector<std::future<int>> v;
+                     for(int j = 0; j < 5; ++j)
+                       v.push_back(pool.submit([i, j](){ return static_cast<int>(i) * 10 + j; }));
+                     return v;
+                   },
+                   [&out](std::vector<std::future<int>>& v){
+                     for(auto& f : v) out.push_back(f.get());
+                   });
+
+  CHECK_EQUAL(100u, out.size());
+  for(std::size_t i = 0; i < out.size(); ++i)
+    CHECK_EQUAL(static_cast<int>((i / 5) * 10 + i % 5), out[i]);
+}
+
+TEST(exceptions){
+  // Producer exception is rethrown in order
+  std::vector<std::size_t> out;
+  CHECK_THROW(ordered_pipeline(10, 2,
+                               [](std::size_t i){
+                                 if(i == 5) throw std::runtime_error("fail");
+                                 return i;
+                               },
+                               [&out](std::size_t v){ out.push_back(v); }),
+              std::runtime_error);
+  CHECK_EQUAL(5u, out.size());
+
+  // Consumer exception stops the reader
+  CHECK_THROW(ordered_pipeline(1000, 2,
+                               [](std::size_t i){ return i; },
+                               [](std::size_t v){ if(v == 3) throw std::logic_error("fail"); }),
+              std::logic_error);
+}
+
+}
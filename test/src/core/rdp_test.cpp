@@ -0,0 +1,149 @@
+#include <unittest++/UnitTest++.h>
+#include <cmath>
+#include <cstdlib>
+#include <vector>
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/node.h>
+#include <neurostr/core/branch.h>
+#include <neurostr/core/neuron.h>
+#include <neurostr/io/parser_dispatcher.h>
+
+#define RDP_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(rdp_tests){
+using namespace neurostr;
+using namespace neurostr::geometry;
+
+const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  RDP_TEST_DATA_SUBDIR : RDP_TEST_DATA_SUBDIR;
+
+// Kept point positions
+std::vector<std::size_t> kept(const std::vector<bool>& keep){
+  std::vector<std::size_t> v;
+  for(std::size_t i = 0; i < keep.size(); ++i)
+    if(keep[i]) v.push_back(i);
+  return v;
+}
+
+TEST(empty_line){
+  std::vector<point_type> line;
+  std::vector<bool> keep{true};
+  rdp_simplify(line, 1.0, keep);
+  CHECK(keep.empty());
+}
+
+TEST(straight_line){
+  std::vector<point_type> line;
+  for(int i = 0; i < 10; ++i) line.push_back(point_type(i, 0, 0));
+  std::vector<bool> keep;
+  rdp_simplify(line, 0.1, keep);
+  CHECK(kept(keep) == std::vector<std::size_t>({0, 9}));
+}
+
+TEST(corner){
+  std::vector<point_type> line{
+    point_type(0,0,0), point_type(1,0,0), point_type(2,0,0),
+    point_type(2,1,0), point_type(2,2,0)
+  };
+  std::vector<bool> keep;
+  rdp_simplify(line, 0.1, keep);
+  CHECK(kept(keep) == std::vector<std::size_t>({0, 2, 4}));
+
+  // Big tolerance
+  rdp_simplify(line, 10, keep);
+  CHECK(kept(keep) == std::vector<std::size_t>({0, 4}));
+}
+
+TEST(long_line){
+  // Deep enough to overflow a recursive simplification
+  std::vector<point_type> line;
+  for(int i = 0; i < 100000; ++i) line.push_back(point_type(i, std::sin(i * 0.01), 0));
+  std::vector<bool> keep;
+  rdp_simplify(line, 1E-3, keep);
+
+  auto k = kept(keep);
+  CHECK(k.size() > 2 && k.size() < line.size());
+  CHECK_EQUAL(0u, k.front());
+  CHECK_EQUAL(line.size() - 1, k.back());
+
+  // Removed points are within the tolerance of their kept segment
+  for(std::size_t i = 1; i < k.size(); ++i){
+    segment_type s(line[k[i-1]], line[k[i]]);
+    for(std::size_t j = k[i-1] + 1; j < k[i]; ++j){
+      CHECK(boost::geometry::distance(s, line[j]) <= 1E-3);
+    }
+  }
+}
+
+TEST(node_simplifier){
+  std::vector<Node> nodes{Node(1,0,0,0,1), Node(2,1,0,0,1), Node(3,2,0,0,1),
+                          Node(4,2,1,0,1), Node(5,2,2,0,1)};
+  RDPSimplifier<Node>(0.1, nodes).simplify();
+  CHECK_EQUAL(3u, nodes.size());
+  CHECK_EQUAL(1, nodes[0].id());
+  CHECK_EQUAL(3, nodes[1].id());
+  CHECK_EQUAL(5, nodes[2].id());
+}
+
+TEST(branch_no_root){
+  Branch::id_type id{0};
+  Branch b{id, 0};
+  b.push_back(Node(1,0,0,0,1));
+  b.push_back(Node(2,1,0,0,1));
+  b.push_back(Node(3,2,0,0,1));
+  b.push_back(Node(4,2,1,0,1));
+  b.push_back(Node(5,2,2,0,1));
+
+  // Negative tolerance uses the first node radius
+  b.simplify(-0.1);
+  CHECK_EQUAL(b.size(), 3);
+  CHECK_EQUAL(1, b.first().id());
+  CHECK_EQUAL(3, std::next(b.begin(),1)->id());
+  CHECK_EQUAL(5, b.last().id());
+}
+
+TEST(branch_parents){
+  Branch::id_type id{0};
+  Branch b{id, 0, Node(1,0,0,0,1), std::vector<Node>{Node(2,1,0,0,1), Node(3,2,0,0,1),
+                                                     Node(4,2,1,0,1), Node(5,2,2,0,1)}};
+  const Node* last = &b.last();
+  b.simplify(0.1);
+  CHECK_EQUAL(b.size(), 2);
+  CHECK_EQUAL(3, b.first().id());
+
+  // Same last node, linked to the previous one
+  CHECK(last == &b.last());
+  CHECK(&b.last().parent() == &b.first());
+}
+
+TEST(neuron_parallel){
+  auto seq = io::read_file_by_ext(test_files_folder + "real.swc");
+  auto par = io::read_file_by_ext(test_files_folder + "real.swc");
+  Neuron& ns = *seq->begin();
+  Neuron& np = *par->begin();
+
+  int count = ns.node_count();
+  ns.simplify(-1.5, 1);
+  np.simplify(-1.5, 4);
+  CHECK(ns.node_count() < count);
+  CHECK_EQUAL(ns.node_count(), np.node_count());
+
+  auto sn = ns.begin_neurite();
+  for(auto it = np.begin_neurite(); it != np.end_neurite(); ++it, ++sn){
+    auto sb = sn->begin_branch();
+    for(auto b = it->begin_branch(); b != it->end_branch(); ++b, ++sb){
+      CHECK_EQUAL(sb->size(), b->size());
+      if(sb->size() != b->size()) continue;
+      
+      auto sm = sb->begin();
+      for(auto n = b->begin(); n != b->end(); ++n, ++sm){
+        CHECK_EQUAL(sm->id(), n->id());
+        
+        // Parent links
+        if(n != b->begin()) CHECK(&n->parent() == &(*std::prev(n,1)));
+      }
+    }
+  }
+}
+
+}
@@ -0,0 +1,48 @@
+#include <unittest++/UnitTest++.h>
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+#include <neurostr/core/thread_pool.h>
+
+SUITE(thread_pool_tests){
+using namespace neurostr;
+
+TEST(size){
+  ThreadPool p(3);
+  CHECK_EQUAL(3u, p.size());
+  
+  ThreadPool q;
+  CHECK_EQUAL(ThreadPool::default_size(), q.size());
+  CHECK(q.size() > 0);
+}
+
+TEST(results){
+  ThreadPool p(4);
+  std::vector<std::future<int>> v;
+  for(int i = 0; i < 100; ++i)
+    v.push_back(p.submit([i](){ return i*i; }));
+  
+  for(int i = 0; i < 100; ++i)
+    CHECK_EQUAL(i*i, v[i].get());
+}
+
+TEST(exception){
+  ThreadPool p(2);
+  auto f = p.submit([]() -> int { throw std::runtime_error("fail"); });
+  CHECK_THROW(f.get(), std::runtime_error);
+  
+  // Pool still works
+  CHECK_EQUAL(1, p.submit([](){ return 1; }).get());
+}
+
+TEST(drain_on_destruction){
+  std::atomic<int> count(0);
+  {
+    ThreadPool p(2);
+    for(int i = 0; i < 50; ++i)
+      p.submit([&count](){ ++count; });
+  }
+  CHECK_EQUAL(50, count.load());
+}
+
+}
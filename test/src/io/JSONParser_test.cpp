@@ -1,6 +1,7 @@
 #include <unittest++/UnitTest++.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <neurostr/io/JSONParser.h>
 
@@ -199,6 +200,28 @@ SUITE(json_parser_tests){
     }
   }
   
+  TEST(member_order){
+    // Members may come in any order (tree/neurites before ids)
+    std::istringstream is(
+      "{\"neurites\":[{\"tree\":{\"nodes\":[{\"r\":1,\"z\":0,\"y\":0,\"x\":1,\"id\":2}],"
+      "\"root\":{\"id\":1,\"x\":0,\"y\":0,\"z\":0,\"r\":1}},\"type\":2,\"id\":1}],"
+      "\"soma\":{\"nodes\":[{\"id\":1,\"x\":0,\"y\":0,\"z\":0,\"r\":1}]},"
+      "\"properties\":{\"key\":\"value\"},\"id\":\"test\"}");
+    JSONParser p(is);
+    auto r = p.read("test");
+    
+    CHECK_EQUAL(1, r->size());
+    if(r->size() == 1){
+      const neurostr::Neuron& n = *(r->begin());
+      basic_jsonparser_checks(p,n,false,0,0,true,1,1);
+      CHECK_EQUAL("test", n.id());
+      CHECK_EQUAL(1, std::distance(n.begin_soma(), n.end_soma()));
+      CHECK_EQUAL(1, n.axon_count());
+      CHECK(n.properties.exists("key"));
+      CHECK(n.begin_neurite()->begin_branch()->has_root());
+    }
+  }
+  
   /*******************
   * ERROR
   ******************/
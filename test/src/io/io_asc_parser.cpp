@@ -2,6 +2,7 @@
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <sstream>
 #include <neurostr/io/nl_structure.h>
 #include <neurostr/io/ASCParser.h>
 
@@ -330,10 +331,64 @@ SUITE(NL_ASC_parser_tests){
       basic_ascparser_checks(p,n,false,1,0,true,1,7);
     }
   }
+  // Streaming read gives the same neurons and contours
+  TEST(stream_callbacks){
+    for(const auto& f : {"real.asc", "single_contour.asc", "simple_tree.asc"}){
+      asc_parser_data test_data(f);
+      
+      std::ifstream is(test_files_folder + f);
+      ASCParser p(is);
+      std::vector<std::unique_ptr<neurostr::Neuron>> neurons;
+      std::size_t contours = 0;
+      auto props = p.read("test",
+                          [&neurons](std::unique_ptr<neurostr::Neuron> n){ neurons.push_back(std::move(n)); },
+                          [&contours](const neurostr::Contour&){ ++contours; });
+      
+      CHECK_EQUAL(0, props->size());
+      CHECK_EQUAL(test_data.rec->properties.size(), props->properties.size());
+      CHECK_EQUAL(test_data.rec->n_contours(), contours);
+      CHECK_EQUAL(test_data.parser.error(), p.error());
+      CHECK_EQUAL(test_data.rec->size(), neurons.size());
+      
+      auto it = test_data.rec->begin();
+      for(std::size_t i = 0; i < neurons.size() && it != test_data.rec->end(); ++i, ++it){
+        CHECK_EQUAL(it->id(), neurons[i]->id());
+        CHECK_EQUAL(it->size(), neurons[i]->size());
+        CHECK_EQUAL(it->node_count(), neurons[i]->node_count());
+      }
+    }
+  }
   
-  
-  
-  
+  // Grouped mode passes each cell once the next soma is found
+  TEST(stream_grouped){
+    const std::string content = 
+      "(\"CellBody\"\n (CellBody)\n (0.0 0.0 0.0 1.0)\n (1.0 0.0 0.0 1.0)\n)\n"
+      "(\n (Dendrite)\n (1.0 0.0 0.0 0.0)\n (2.0 0.0 0.0 0.0)\n)\n"
+      "(\"CellBody\"\n (CellBody)\n (100.0 0.0 0.0 1.0)\n (101.0 0.0 0.0 1.0)\n)\n"
+      "(\n (Dendrite)\n (101.0 0.0 0.0 0.0)\n (102.0 0.0 0.0 0.0)\n)\n"
+      "(\"Contour\"\n (Closed)\n (0.0 0.0 0.0 0.5)\n (10.0 0.0 0.0 0.5)\n (10.0 10.0 0.0 0.5)\n)\n";
+    
+    for(bool grouped : {false, true}){
+      std::istringstream is(content);
+      ASCParser p(is);
+      std::string events;
+      std::vector<std::unique_ptr<neurostr::Neuron>> neurons;
+      p.read("test",
+             [&](std::unique_ptr<neurostr::Neuron> n){ events += "N"; neurons.push_back(std::move(n)); },
+             [&](const neurostr::Contour&){ events += "C"; },
+             grouped);
+      
+      CHECK_EQUAL(0, p.error());
+      CHECK_EQUAL(grouped ? "NCN" : "CNN", events);
+      CHECK_EQUAL(2, neurons.size());
+      if(neurons.size() == 2){
+        CHECK_EQUAL("test_1", neurons[0]->id());
+        CHECK_EQUAL("test_2", neurons[1]->id());
+        CHECK_EQUAL(1, neurons[0]->size());
+        CHECK_EQUAL(1, neurons[1]->size());
+      }
+    }
+  }
 
 
 } // END SUITE
@@ -0,0 +1,90 @@
+#include <unittest++/UnitTest++.h>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <neurostr/io/parser_dispatcher.h>
+#include <neurostr/io/JSONParser.h>
+#include <neurostr/io/JSONWriter.h>
+
+SUITE(json_writer_tests){
+
+  using namespace neurostr::io;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  "test_data/" : "test_data/";
+
+  std::string to_json(const neurostr::Reconstruction& r){
+    std::ostringstream os;
+    JSONWriter w(os);
+    w.write(r);
+    return os.str();
+  }
+
+  std::unique_ptr<neurostr::Reconstruction> from_json(std::istream& is, const std::string& id){
+    JSONParser p(is);
+    auto r = p.read(id);
+    CHECK(!p.critical());
+    CHECK_EQUAL(0, p.error());
+    return r;
+  }
+
+  // Writes the reconstruction incrementally, reads it back and compares with
+  // the regular output (JSON output is rounded, so both are read back)
+  void check_incremental(const std::string& file){
+    auto r = read_file_by_ext(test_files_folder + file);
+
+    std::stringstream ss;
+    JSONWriter w(ss);
+    w.beginReconstruction();
+    for(auto it = r->begin(); it != r->end(); ++it){
+      w.addNeuron(*it);
+    }
+    for(auto it = r->contour_begin(); it != r->contour_end(); ++it){
+      w.addContour(*it);
+    }
+    w.endReconstruction(r->properties);
+
+    std::istringstream regular(to_json(*r));
+    auto expected = from_json(regular, r->id());
+    auto reloaded = from_json(ss, r->id());
+    CHECK_EQUAL(r->size(), reloaded->size());
+    CHECK_EQUAL(r->n_contours(), reloaded->n_contours());
+    CHECK_EQUAL(to_json(*expected), to_json(*reloaded));
+  }
+
+  TEST(incremental_neurons){
+    check_incremental("json/real.json");
+    check_incremental("swc/real.swc");
+  }
+
+  TEST(incremental_contours){
+    check_incremental("asc/real.asc");
+    check_incremental("json/single_contour.json");
+    check_incremental("json/single_property.json");
+  }
+
+  TEST(incremental_empty){
+    std::ostringstream os;
+    JSONWriter w(os);
+    w.beginReconstruction();
+    w.endReconstruction();
+    CHECK_EQUAL("{\"neurons\":[]}", os.str());
+  }
+
+  TEST(incremental_order){
+    auto r = read_file_by_ext(test_files_folder + "json/single_contour.json");
+    neurostr::Neuron n("test");
+
+    std::ostringstream os;
+    JSONWriter w(os);
+    CHECK_THROW(w.addNeuron(n), std::logic_error);
+    CHECK_THROW(w.endReconstruction(), std::logic_error);
+
+    w.beginReconstruction();
+    CHECK_THROW(w.beginReconstruction(), std::logic_error);
+    w.addContour(*(r->contour_begin()));
+    CHECK_THROW(w.addNeuron(n), std::logic_error);
+    w.endReconstruction();
+  }
+}
@@ -0,0 +1,139 @@
+#include <unittest++/UnitTest++.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#define BOOST_FILESYSTEM_NO_DEPRECATED
+#include <boost/filesystem.hpp>
+
+#include <neurostr/io/parser_dispatcher.h>
+#include <neurostr/io/JSONWriter.h>
+#include <neurostr/io/NSTRWriter.h>
+#include <neurostr/io/NSTRParser.h>
+#include <neurostr/validator/predefined_validators.h>
+
+SUITE(nstr_format_tests){
+
+  using namespace neurostr::io;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  "test_data/" : "test_data/";
+
+  std::string to_json(const neurostr::Reconstruction& r){
+    std::ostringstream os;
+    JSONWriter w(os);
+    w.write(r);
+    return os.str();
+  }
+
+  std::string to_nstr(const neurostr::Reconstruction& r){
+    std::ostringstream os(std::ios_base::binary);
+    NSTRWriter w(os);
+    w.write(r);
+    return os.str();
+  }
+
+  // Writes, reloads and checks that the JSON output is the same
+  void check_roundtrip(const std::string& file){
+    auto r = read_file_by_ext(test_files_folder + file);
+
+    std::istringstream is(to_nstr(*r), std::ios_base::binary);
+    NSTRParser p(is);
+    auto reloaded = p.read(r->id());
+
+    CHECK(!p.critical());
+    CHECK_EQUAL(0, p.error());
+    CHECK_EQUAL(r->size(), reloaded->size());
+    CHECK_EQUAL(r->node_count(), reloaded->node_count());
+    CHECK_EQUAL(to_json(*r), to_json(*reloaded));
+  }
+
+  TEST(roundtrip_swc){
+    check_roundtrip("swc/real.swc");
+  }
+
+  TEST(roundtrip_asc){
+    check_roundtrip("asc/real.asc");
+    check_roundtrip("asc/single_contour.asc");
+    check_roundtrip("asc/single_marker.asc");
+  }
+
+  TEST(roundtrip_json){
+    check_roundtrip("json/real.json");
+    check_roundtrip("json/single_property.json");
+  }
+
+  TEST(branch_structure){
+    auto r = read_file_by_ext(test_files_folder + "swc/simple_tree.swc");
+    std::istringstream is(to_nstr(*r), std::ios_base::binary);
+    NSTRParser p(is);
+    auto reloaded = p.read("test");
+
+    const auto& a = *(r->begin()->begin_neurite());
+    const auto& b = *(reloaded->begin()->begin_neurite());
+    CHECK_EQUAL(a.size(), b.size());
+    for(auto ia = a.begin_branch(), ib = b.begin_branch(); ia != a.end_branch(); ++ia, ++ib){
+      CHECK(ia->id() == ib->id());
+      CHECK_EQUAL(ia->order(), ib->order());
+      CHECK_EQUAL(ia->has_root(), ib->has_root());
+      CHECK_EQUAL(ia->size(), ib->size());
+      CHECK_EQUAL(ia.number_of_children(), ib.number_of_children());
+      CHECK(&(ib->neurite()) == &b);
+    }
+  }
+
+  TEST(soma_attachment){
+    auto r = read_file_by_ext(test_files_folder + "swc/real.swc");
+    std::istringstream is(to_nstr(*r), std::ios_base::binary);
+    NSTRParser p(is);
+    auto reloaded = p.read("test");
+
+    const auto& a = *(r->begin());
+    const auto& b = *(reloaded->begin());
+    CHECK_EQUAL(a.size(), b.size());
+    for(auto ia = a.begin_neurite(), ib = b.begin_neurite(); ia != a.end_neurite(); ++ia, ++ib){
+      CHECK(ia->root_is_soma());
+      CHECK_EQUAL(ia->root_is_soma(), ib->root_is_soma());
+    }
+
+    auto validator = neurostr::validator::neurites_attached_to_soma;
+    validator.validate(b);
+    CHECK(validator.pass());
+  }
+
+  TEST(mapped_file){
+    auto r = read_file_by_ext(test_files_folder + "swc/real.swc");
+
+    auto path = boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("%%%%-%%%%.nstr");
+    {
+      std::ofstream ofs(path.string(), std::ios_base::binary);
+      NSTRWriter w(ofs);
+      w.write(*r);
+    }
+
+    auto reloaded = read_file_by_ext(path.string());
+    boost::filesystem::remove(path);
+
+    CHECK_EQUAL(path.stem().string(), reloaded->id());
+    CHECK_EQUAL(to_json(*r), to_json(*reloaded));
+  }
+
+  TEST(invalid){
+    // Not a NSTR file
+    std::istringstream is("# Not a binary file\n1 1 0 0 0 1 -1\n");
+    NSTRParser p(is);
+    auto r = p.read("test");
+    CHECK(p.critical());
+    CHECK_EQUAL(0, r->size());
+
+    // Truncated file
+    auto rec = read_file_by_ext(test_files_folder + "swc/real.swc");
+    std::string content = to_nstr(*rec);
+    std::istringstream truncated(content.substr(0, content.size() / 2), std::ios_base::binary);
+    NSTRParser p2(truncated);
+    r = p2.read("test");
+    CHECK(p2.critical());
+    CHECK_EQUAL(0, r->size());
+  }
+}
@@ -1,6 +1,7 @@
 #include <unittest++/UnitTest++.h>
 #include <iostream>
 #include <fstream>
+#include <sstream>
 #include <stdexcept>
 #include <neurostr/io/SWCParser.h>
 
@@ -138,6 +139,45 @@ SUITE(swc_parser_tests){
     }
   }
   
+  TEST(out_of_order){
+    swc_parser_data test_data("out_of_order.swc");
+    CHECK(test_data.rec->size() == 1);
+    if(test_data.rec->size() == 1){
+      neurostr::Neuron&n = *(test_data.rec->begin());
+      SWCParser&p = test_data.parser;
+      
+      // No errors - no crit
+      basic_swcparser_checks(p,n,false,0,true,1,7);
+      CHECK_EQUAL(1,n.dendrite_count());
+      
+      // Same structure as simple tree
+      CHECK_EQUAL(5,n.begin_dendrite()->size());
+      CHECK_EQUAL(2,n.begin_dendrite()->max_centrifugal_order());
+    }
+  }
+  
+  TEST(split_reindex){
+    swc_parser_data test_data("split_reindex.swc");
+    CHECK(test_data.rec->size() == 1);
+    if(test_data.rec->size() == 1){
+      neurostr::Neuron&n = *(test_data.rec->begin());
+      SWCParser&p = test_data.parser;
+      
+      // No errors - no crit
+      basic_swcparser_checks(p,n,false,0,true,1,8);
+      
+      // 2-3 | 4 | 5-7-9 | 8 | 6
+      auto& neurite = *n.begin_dendrite();
+      CHECK_EQUAL(5,neurite.size());
+      CHECK_EQUAL(2,neurite.max_centrifugal_order());
+      
+      // Nodes moved by the splits keep their parents
+      CHECK_EQUAL(7,neurite.find(9)->parent().id());
+      CHECK_EQUAL(5,neurite.find(7)->parent().id());
+      CHECK_EQUAL(4,neurite.find(8).branch()->root().id());
+    }
+  }
+  
   TEST(real){
     swc_parser_data test_data("real.swc");
     CHECK(test_data.rec->size() == 1);
@@ -150,6 +190,53 @@ SUITE(swc_parser_tests){
     }
   }
   
+  TEST(mapped_real){
+    std::ifstream unused;
+    SWCParser p(unused);
+    auto rec = p.read_mapped(test_files_folder + "real.swc", "test");
+    CHECK(rec->size() == 1);
+    if(rec->size() == 1){
+      neurostr::Neuron&n = *(rec->begin());
+      
+      // Same result as the stream parser
+      basic_swcparser_checks(p,n,false,0,true,8,2026);
+    }
+  }
+  
+  TEST(mapped_missing_file){
+    std::ifstream unused;
+    SWCParser p(unused);
+    CHECK_THROW(p.read_mapped(test_files_folder + "does_not_exist.swc", "test"), std::exception);
+  }
+  
+  TEST(quoted_fields){
+    std::istringstream is("1 1 \"0.5\" 0 0 1 -1\n2 3 1 \"0\" 0 1 1\n");
+    SWCParser p(is);
+    auto rec = p.read("test");
+    neurostr::Neuron&n = *(rec->begin());
+    basic_swcparser_checks(p,n,false,0,true,1,1);
+    CHECK_EQUAL(0.5, n.begin_soma()->x());
+  }
+  
+  TEST(crlf_line_endings){
+    std::istringstream is("1 1 0 0 0 1 -1\r\n2 3 1 0 0 1 1\r\n");
+    SWCParser p(is);
+    auto rec = p.read("test");
+    neurostr::Neuron&n = *(rec->begin());
+    basic_swcparser_checks(p,n,false,0,true,1,1);
+  }
+  
+  TEST(long_float_field){
+    // 78 characters: longer than the scanner stack buffer
+    std::string x = "0." + std::string(70, '0') + "1e72";
+    std::istringstream is("1 1 " + x + " 0 0 1 -1\n");
+    SWCParser p(is);
+    auto rec = p.read("test");
+    neurostr::Neuron&n = *(rec->begin());
+    basic_swcparser_checks(p,n,false,0,true,0,0);
+    CHECK_CLOSE(10.0, n.begin_soma()->x(), 1e-5);
+  }
+  
   // ERROR CASES
   TEST(missing_fields){
     swc_parser_data test_data("missing_fields.swc");
@@ -204,6 +291,26 @@ SUITE(swc_parser_tests){
     }
   }
   
+  TEST(mapped_wrong_num){
+    std::ifstream unused;
+    SWCParser p(unused);
+    auto rec = p.read_mapped(test_files_folder + "wrong_numeric_fields.swc", "test");
+    CHECK(rec->size() == 1);
+    if(rec->size() == 1){
+      neurostr::Neuron&n = *(rec->begin());
+      basic_swcparser_checks(p,n,false,2,true,1,5);
+    }
+  }
+  
+  TEST(tab_separated){
+    // Tabs are not separators by default
+    std::istringstream is("1\t1\t0\t0\t0\t1\t-1\n");
+    SWCParser p(is);
+    auto rec = p.read("test");
+    neurostr::Neuron&n = *(rec->begin());
+    basic_swcparser_checks(p,n,false,1,false,0,0);
+  }
+  
   TEST(wrong_parent){
     swc_parser_data test_data("wrong_parent_type.swc");
     CHECK(test_data.rec->size() == 1);
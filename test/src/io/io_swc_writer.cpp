@@ -0,0 +1,89 @@
+#include <unittest++/UnitTest++.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <boost/format.hpp>
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/io/SWCWriter.h>
+#include <neurostr/selector/node_selector.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(swc_writer_tests){
+
+  using namespace neurostr::io;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR;
+
+  // Node lines as written by boost::format
+  std::string expected_data(neurostr::Neuron& n){
+    std::ostringstream os;
+
+    int prev = -1;
+    for(auto it = n.begin_soma(); it != n.end_soma(); ++it){
+      os << boost::format("%u %u %.3f %.3f %.3f %.3f %u\n")
+        % it->id() % 1 % it->x() % it->y() % it->z() % (it->radius()*2.0) % prev;
+      prev = it->id();
+    }
+
+    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
+      unsigned int type = SWCWriter::convertNeuriteType(it->type());
+      for(auto node = it->begin_node(); node != it->end_node(); ++node){
+        const auto& parent = neurostr::selector::node_parent(*node);
+        int parent_id = (parent == *node) ? -1 : parent.id();
+        os << boost::format("%u %u %.3f %.3f %.3f %.3f %u\n")
+          % node->id() % type % node->x() % node->y() % node->z()
+          % (node->radius()*2.0) % parent_id;
+      }
+    }
+    return os.str();
+  }
+
+  std::string written_data(neurostr::Neuron& n){
+    std::ostringstream os;
+    SWCWriter w(os);
+    w.write(n);
+
+    // Skip comments
+    std::string s = os.str();
+    std::size_t pos = 0;
+    while(pos < s.size() && s[pos] == '#') pos = s.find('\n', pos) + 1;
+    return s.substr(pos);
+  }
+
+  TEST(real){
+    std::ifstream is(test_files_folder + "real.swc");
+    SWCParser p(is);
+    auto r = p.read("test");
+    neurostr::Neuron& n = *(r->begin());
+
+    CHECK_EQUAL(expected_data(n), written_data(n));
+  }
+
+  TEST(number_format){
+    std::istringstream is(
+      "1 1 0.0 0.0 0.0 5.0 -1\n"
+      "2 3 -0.0004 1.0005 2.12345 0.25 1\n"
+      "3 3 -1.9996 1234.5675 -0.5 0.0 2\n"
+      "4 3 999999.9 -2500000.125 1e-7 3.0625 3\n"
+      "5 3 0.0625 -0.0625 1e20 0.5 2\n");
+    SWCParser p(is);
+    auto r = p.read("test");
+    neurostr::Neuron& n = *(r->begin());
+
+    CHECK_EQUAL(expected_data(n), written_data(n));
+  }
+
+  TEST(header){
+    std::istringstream is("1 1 0.0 0.0 0.0 5.0 -1\n");
+    SWCParser p(is);
+    auto r = p.read("test");
+
+    std::ostringstream os;
+    SWCWriter w(os);
+    w.write(*(r->begin()));
+    CHECK_EQUAL("# File generated by neurostrlib\n# ID test\n# UP 0.000 0.000 1.000\n"
+                "1 1 0.000 0.000 0.000 5.000 -1\n", os.str());
+  }
+}
@@ -0,0 +1,90 @@
+#include <unittest++/UnitTest++.h>
+#include <cstdint>
+#include <cstring>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#include <neurostr/io/TableWriter.h>
+
+SUITE(table_writer_tests){
+
+  using namespace neurostr::io;
+  using neurostr::measure::ColumnTable;
+
+  ColumnTable sample_table(){
+    ColumnTable t({"neuron", "branch"}, {"length", "angle"});
+    t.add_row();
+    t.key(0, 0, "n1");
+    t.key(0, 1, "1-2");
+    t.row(0)[0] = 1.5f;
+    t.row(0)[1] = 0.25f;
+    t.add_row();
+    t.key(1, 0, "n,\"2\"");
+    t.key(1, 1, "1");
+    t.row(1)[0] = 3.0f;   // angle is NaN
+    return t;
+  }
+
+  TEST(csv){
+    std::ostringstream os;
+    TableWriter w(os, table_format::kCSV);
+    w.write(sample_table());
+    CHECK_EQUAL("neuron,branch,length,angle\n"
+                "n1,1-2,1.5,0.25\n"
+                "\"n,\"\"2\"\"\",1,3,\n", os.str());
+
+    // Header is written once
+    w.write(sample_table());
+    CHECK_EQUAL(std::string::npos, os.str().find("neuron", 10));
+  }
+
+  TEST(json_lines){
+    std::ostringstream os;
+    TableWriter w(os, table_format::kJSONLines);
+    w.write(sample_table());
+    CHECK_EQUAL("{\"neuron\":\"n1\",\"branch\":\"1-2\",\"length\":1.5,\"angle\":0.25}\n"
+                "{\"neuron\":\"n,\\\"2\\\"\",\"branch\":\"1\",\"length\":3}\n", os.str());
+  }
+
+  TEST(binary){
+    std::ostringstream os(std::ios_base::binary);
+    TableWriter w(os, table_format::kBinary);
+    ColumnTable t = sample_table();
+    w.write(t);
+    const std::string s = os.str();
+
+    CHECK_EQUAL(0, std::memcmp(s.data(), "NSTRTBL", 8));
+    std::uint32_t u32[4];
+    std::uint64_t rows;
+    std::memcpy(u32, s.data() + 8, sizeof(u32));
+    std::memcpy(&rows, s.data() + 24, sizeof(rows));
+    CHECK_EQUAL(1u, u32[0]);
+    CHECK_EQUAL(0x01020304u, u32[1]);
+    CHECK_EQUAL(2u, u32[2]);
+    CHECK_EQUAL(2u, u32[3]);
+    CHECK_EQUAL(2u, rows);
+
+    // Value columns at the end
+    float values[4];
+    CHECK(s.size() > sizeof(values));
+    std::memcpy(values, s.data() + s.size() - sizeof(values), sizeof(values));
+    CHECK_EQUAL(1.5f, values[0]);
+    CHECK_EQUAL(3.0f, values[1]);
+    CHECK_EQUAL(0.25f, values[2]);
+    CHECK(values[3] != values[3]);
+
+    // Names and keys: 4 + 4 strings
+    std::size_t strings = 0;
+    for(const char* c : {"neuron","branch","length","angle","n1","n,\"2\"","1-2","1"})
+      strings += 4 + std::strlen(c);
+    CHECK_EQUAL(32 + strings + sizeof(values), s.size());
+  }
+
+  TEST(format_names){
+    CHECK(TableWriter::format_by_name("csv") == table_format::kCSV);
+    CHECK(TableWriter::format_by_name("jsonl") == table_format::kJSONLines);
+    CHECK(TableWriter::format_by_name("bin") == table_format::kBinary);
+    CHECK_THROW(TableWriter::format_by_name("xml"), std::runtime_error);
+  }
+}
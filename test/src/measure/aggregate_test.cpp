@@ -0,0 +1,122 @@
+#include <unittest++/UnitTest++.h>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <memory>
+#include <random>
+#include <vector>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/aggregate.h>
+#include <neurostr/measure/measure_operations.h>
+#include <neurostr/measure/node_measure.h>
+#include <neurostr/selector/neuron_selector.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(aggregate_tests){
+
+  using namespace neurostr;
+  namespace na = neurostr::measure::aggregate;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR;
+
+  std::vector<float> random_values(std::size_t n){
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<float> dist(0., 100.);
+    std::vector<float> v(n);
+    for(auto& x : v) x = dist(gen);
+    return v;
+  }
+
+  TEST(online_matches_range){
+    auto v = random_values(1001);
+
+    auto range = na::all_aggr_factory<float,float>(0.)(v.begin(), v.end());
+    auto online = na::online_all_aggr_factory<float,float>(0.)(v.begin(), v.end());
+
+    CHECK_CLOSE(range.sum, online.sum, 1E-2);
+    CHECK_EQUAL(range.min, online.min);
+    CHECK_EQUAL(range.max, online.max);
+    CHECK_CLOSE(range.mean, online.mean, 1E-4);
+    CHECK_CLOSE(range.sd, online.sd, 1E-3);
+
+    // P2 median is an estimate
+    std::vector<float> tmp(v);
+    std::nth_element(tmp.begin(), tmp.begin() + tmp.size()/2, tmp.end());
+    CHECK_CLOSE(tmp[tmp.size()/2], online.median, 2.);
+  }
+
+  TEST(online_empty){
+    na::online_all_aggr<float,float> acc;
+    auto r = acc.result();
+    CHECK_EQUAL(0, acc.count());
+    CHECK_EQUAL(0., r.sum);
+    CHECK(std::isinf(r.min));
+    CHECK(std::isinf(r.max));
+    CHECK(std::isinf(r.median));
+    CHECK(std::isnan(r.mean));
+  }
+
+  TEST(p2_median_small){
+    na::p2_median<int,float> m;
+    m.push(7);
+    CHECK_EQUAL(7, m.result());
+    m.push(1);
+    m.push(4);
+    CHECK_EQUAL(4, m.result());
+    m.push(10);
+    // Even count: mean of middle values in the input type
+    CHECK_EQUAL(5, m.result());
+
+    na::p2_median<int,int> mi;
+    mi.push(1);
+    mi.push(4);
+    CHECK_EQUAL(2, mi.result());
+  }
+
+  TEST(p2_median_large){
+    std::vector<float> v(10001);
+    std::iota(v.begin(), v.end(), 0.);
+    std::shuffle(v.begin(), v.end(), std::mt19937(7));
+
+    na::p2_median<float> m;
+    for(auto x : v) m.push(x);
+    CHECK_EQUAL(v.size(), m.count());
+    CHECK_CLOSE(5000., m.result(), 50.);
+  }
+
+  TEST(measure_each_aggregate_online){
+    std::ifstream is(test_files_folder + "real.swc");
+    io::SWCParser p(is);
+    auto rec = p.read("test");
+    const Neuron& n = *(rec->begin());
+
+    auto nodes = selector::neuron_node_selector(n);
+    auto range = measure::measureEachAggregate(measure::node_length_to_parent,
+                    na::all_aggr_factory<float,float>(0.))(nodes.begin(), nodes.end());
+    auto online = measure::measureEachAggregate(measure::node_length_to_parent,
+                    na::online_all_aggr_factory<float,float>(0.))(nodes.begin(), nodes.end());
+
+    CHECK_CLOSE(range.sum, online.sum, 1E-3 * range.sum);
+    CHECK_CLOSE(range.min, online.min, 1E-6);
+    CHECK_CLOSE(range.max, online.max, 1E-6);
+    CHECK_CLOSE(range.mean, online.mean, 1E-4);
+    CHECK_CLOSE(range.sd, online.sd, 1E-3);
+  }
+
+  TEST(measure_each_aggregate_nan){
+    std::vector<float> v{1., NAN, 3.};
+    std::vector<std::reference_wrapper<const float>> refs(v.begin(), v.end());
+    auto id = [](const float& x) -> float { return x; };
+
+    auto r = measure::measureEachAggregate(id, na::online_all_aggr_factory<float,float>(0.))(refs.begin(), refs.end());
+    CHECK_EQUAL(4., r.sum);
+    CHECK_EQUAL(2., r.mean);
+    CHECK_EQUAL(2., r.median);
+
+    r = measure::measureEachAggregate(id, na::online_all_aggr_factory<float,float>(0.), false)(refs.begin(), refs.end());
+    CHECK(std::isnan(r.sum));
+  }
+}
@@ -0,0 +1,198 @@
+#include <unittest++/UnitTest++.h>
+#include <cmath>
+#include <fstream>
+#include <memory>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/lmeasure_decl.h>
+#include <neurostr/measure/lmeasure_engine.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(lmeasure_engine_tests){
+
+  using namespace neurostr;
+  namespace nlm = neurostr::measure::lmeasure;
+  using nlm::LMeasure;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR;
+
+  std::unique_ptr<Reconstruction> read_swc(const std::string& s){
+    std::ifstream is(test_files_folder + s);
+    io::SWCParser p(is);
+    return p.read("test");
+  }
+
+  void check_close(float a, float b){
+    if(std::isnan(a) || std::isnan(b)){
+      CHECK(std::isnan(a) && std::isnan(b));
+    } else if(std::isinf(a) || std::isinf(b)){
+      CHECK_EQUAL(a, b);
+    } else {
+      CHECK_CLOSE(a, b, 1E-3 * std::max(1.f, std::abs(a)));
+    }
+  }
+
+  void check_value(float expected, const nlm::Engine::value_type& v){
+    CHECK(!v.is_summary);
+    check_close(expected, v.value);
+  }
+
+  template <typename U>
+  void check_value(const measure::aggregate::aggr_pack<U,float>& a,
+                   const nlm::Engine::value_type& v){
+    CHECK(v.is_summary);
+    check_close(a.sum, v.summary.sum);
+    check_close(a.min, v.summary.min);
+    check_close(a.max, v.summary.max);
+    check_close(a.median, v.summary.median);
+    check_close(a.mean, v.summary.mean);
+    check_close(a.sd, v.summary.sd);
+  }
+
+  void check_engine(Neuron& n){
+    nlm::Engine engine;
+    auto r = engine.compute(n);
+    CHECK_EQUAL(static_cast<std::size_t>(nlm::lmeasure_count), r.size());
+
+    auto at = [&r](LMeasure m) -> const nlm::Engine::value_type& {
+      return r[static_cast<int>(m)];
+    };
+
+    check_value(nlm::soma_surface(n), at(LMeasure::kSomaSurface));
+    check_value(nlm::n_stems(n), at(LMeasure::kNStems));
+    check_value(nlm::n_bifs(n), at(LMeasure::kNBifs));
+    check_value(nlm::n_branch(n), at(LMeasure::kNBranch));
+    check_value(nlm::n_tips(n), at(LMeasure::kNTips));
+    check_value(nlm::width(n), at(LMeasure::kWidth));
+    check_value(nlm::height(n), at(LMeasure::kHeight));
+    check_value(nlm::depth(n), at(LMeasure::kDepth));
+    check_value(nlm::diameter(n), at(LMeasure::kDiameter));
+    check_value(nlm::diameter_pow(n), at(LMeasure::kDiameterPow));
+    check_value(nlm::length(n), at(LMeasure::kLength));
+    check_value(nlm::surface(n), at(LMeasure::kSurface));
+    check_value(nlm::branch_surface(n), at(LMeasure::kBranchSurface));
+    check_value(nlm::section_area(n), at(LMeasure::kSectionArea));
+    check_value(nlm::volume(n), at(LMeasure::kVolume));
+    check_value(nlm::branch_volume(n), at(LMeasure::kBranchVolume));
+    check_value(nlm::euc_distance(n), at(LMeasure::kEucDistance));
+    check_value(nlm::path_distance(n), at(LMeasure::kPathDistance));
+    check_value(nlm::branch_order(n), at(LMeasure::kBranchOrder));
+    check_value(nlm::terminal_degree(n), at(LMeasure::kTerminalDegree));
+    check_value(nlm::taper_1(n), at(LMeasure::kTaper1));
+    check_value(nlm::taper_2(n), at(LMeasure::kTaper2));
+    check_value(nlm::branch_pathlength(n), at(LMeasure::kBranchPathlength));
+    check_value(nlm::contraction(n), at(LMeasure::kContraction));
+    check_value(nlm::fragmentation(n), at(LMeasure::kFragmentation));
+    check_value(nlm::daughter_ratio(n), at(LMeasure::kDaughterRatio));
+    check_value(nlm::partition_asymmetry(n), at(LMeasure::kPartitionAsymmetry));
+    check_value(nlm::rall_power(n), at(LMeasure::kRallPower));
+    check_value(nlm::pk(n), at(LMeasure::kPk));
+    check_value(nlm::pk_classic(n), at(LMeasure::kPkClassic));
+    check_value(nlm::pk_2(n), at(LMeasure::kPk2));
+    check_value(nlm::bif_ampl_local(n), at(LMeasure::kBifAmplLocal));
+    check_value(nlm::bif_ampl_remote(n), at(LMeasure::kBifAmplRemote));
+    check_value(nlm::bif_tilt_local(n), at(LMeasure::kBifTiltLocal));
+    check_value(nlm::bif_tilt_remote(n), at(LMeasure::kBifTiltRemote));
+    check_value(nlm::bif_torque_local(n), at(LMeasure::kBifTorqueLocal));
+    check_value(nlm::bif_torque_remote(n), at(LMeasure::kBifTorqueRemote));
+    check_value(nlm::last_parent_diam(n), at(LMeasure::kLastParentDiam));
+    check_value(nlm::hillman_threshold(n), at(LMeasure::kHillmanThreshold));
+    check_value(nlm::fractal_dim(n), at(LMeasure::kFractalDim));
+  }
+
+  TEST(names){
+    CHECK_EQUAL("soma_surface", nlm::lmeasure_name(LMeasure::kSomaSurface));
+    CHECK_EQUAL("path_distance", nlm::lmeasure_name(LMeasure::kPathDistance));
+    CHECK_EQUAL("fractal_dim", nlm::lmeasure_name(LMeasure::kFractalDim));
+  }
+
+  TEST(simple_tree){
+    auto rec = read_swc("simple_tree.swc");
+    check_engine(*(rec->begin()));
+  }
+
+  TEST(real){
+    auto rec = read_swc("real.swc");
+    Neuron& n = *(rec->begin());
+    n.remove_null_segments();
+    check_engine(n);
+  }
+
+  TEST(online_summaries){
+    auto rec = read_swc("real.swc");
+    Neuron& n = *(rec->begin());
+    n.remove_null_segments();
+
+    nlm::Engine exact;
+    nlm::Engine online;
+    CHECK(!exact.online());
+    online.online(true);
+    CHECK(online.online());
+
+    auto re = exact.compute(n);
+    auto ro = online.compute(n);
+    CHECK_EQUAL(re.size(), ro.size());
+
+    // Exact median by default, as in lmeasure_decl.h
+    check_value(nlm::length(n), re[static_cast<int>(LMeasure::kLength)]);
+
+    for(std::size_t i = 0; i < re.size() && i < ro.size(); ++i){
+      CHECK_EQUAL(re[i].is_summary, ro[i].is_summary);
+      if(!re[i].is_summary){
+        check_close(re[i].value, ro[i].value);
+      } else {
+        check_close(re[i].summary.sum, ro[i].summary.sum);
+        check_close(re[i].summary.min, ro[i].summary.min);
+        check_close(re[i].summary.max, ro[i].summary.max);
+        check_close(re[i].summary.mean, ro[i].summary.mean);
+        check_close(re[i].summary.sd, ro[i].summary.sd);
+        // P-square median is an estimate within the value range
+        if(!std::isinf(ro[i].summary.median)){
+          CHECK(ro[i].summary.median >= re[i].summary.min);
+          CHECK(ro[i].summary.median <= re[i].summary.max);
+        }
+      }
+    }
+  }
+
+  TEST(empty_first_branch){
+    // Detached neurite whose root branch has no nodes
+    Neuron n("test");
+    Neurite* ne = new Neurite(1, NeuriteType::kDendrite);
+    ne->set_root();
+    auto ch_a = ne->append_branch(ne->begin_branch(), Branch({1,1},1));
+    ne->insert_node(ch_a, Node(1, 1, 0, 0, 0.5));
+    ne->insert_node(ch_a, Node(2, 2, 0, 0, 0.5));
+    auto ch_b = ne->append_branch(ne->begin_branch(), Branch({1,2},1));
+    ne->insert_node(ch_b, Node(3, 1, 3, 0, 0.5));
+    ne->insert_node(ch_b, Node(4, 1, 4, 0, 0.5));
+    n.add_neurite(ne);
+
+    nlm::Engine engine({LMeasure::kEucDistance});
+    auto r = engine.compute(n);
+    CHECK_EQUAL(1u, r.size());
+    check_value(nlm::euc_distance(n), r[0]);
+    // Distances are measured from the first node (1,0,0)
+    check_close(0., r[0].summary.min);
+    check_close(4., r[0].summary.max);
+  }
+
+  TEST(subset_order){
+    auto rec = read_swc("real.swc");
+    Neuron& n = *(rec->begin());
+    n.remove_null_segments();
+
+    nlm::Engine engine({LMeasure::kPathDistance, LMeasure::kNTips, LMeasure::kLength});
+    auto r = engine.compute(n);
+    CHECK_EQUAL(3u, r.size());
+    CHECK(r[0].measure == LMeasure::kPathDistance);
+    CHECK(r[1].measure == LMeasure::kNTips);
+    CHECK(r[2].measure == LMeasure::kLength);
+    check_value(nlm::path_distance(n), r[0]);
+    check_value(nlm::n_tips(n), r[1]);
+    check_value(nlm::length(n), r[2]);
+  }
+
+}
@@ -0,0 +1,104 @@
+#include <unittest++/UnitTest++.h>
+#include <cmath>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/measure_set.h>
+#include <neurostr/measure/column_table.h>
+#include <neurostr/measure/branch_measure.h>
+#include <neurostr/selector/neuron_selector.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(measure_set_tests){
+
+  using namespace neurostr;
+  namespace nm = neurostr::measure;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR;
+
+  TEST(names_and_order){
+    auto set = nm::make_measure_set(
+      nm::named("double", [](int i){ return 2 * i; }),
+      nm::named("square", [](int i){ return i * i; }),
+      nm::named("half", [](int i){ return i / 2.0f; }));
+
+    CHECK_EQUAL(3u, set.size());
+    CHECK_EQUAL(std::string("double"), set.names()[0]);
+    CHECK_EQUAL(std::string("half"), set.column_names()[2]);
+
+    float row[3];
+    set(3, row);
+    CHECK_EQUAL(6.0f, row[0]);
+    CHECK_EQUAL(9.0f, row[1]);
+    CHECK_EQUAL(1.5f, row[2]);
+  }
+
+  TEST(table_rows){
+    nm::ColumnTable t({"id"}, {"a", "b"});
+    CHECK_EQUAL(0u, t.rows());
+
+    std::size_t r = t.add_row();
+    CHECK_EQUAL(0u, r);
+    CHECK_EQUAL(1u, t.rows());
+    CHECK(std::isnan(t.value(0, 0)));
+    CHECK(t.key(0, 0).empty());
+
+    t.key(0, 0, "first");
+    t.row(0)[1] = 2.0f;
+    CHECK_EQUAL("first", t.key(0, 0));
+    CHECK(std::isnan(t.value(0, 0)));
+    CHECK_EQUAL(2.0f, t.value(0, 1));
+    CHECK_EQUAL(1u, t.column(1).size());
+
+    nm::ColumnTable u({"id"}, {"a", "b"});
+    u.add_row();
+    u.add_row();
+    t.append(u);
+    CHECK_EQUAL(3u, t.rows());
+    CHECK_EQUAL(3u, t.column(0).size());
+
+    nm::ColumnTable other({"id"}, {"c"});
+    CHECK_THROW(t.append(other), std::runtime_error);
+
+    t.clear();
+    CHECK_EQUAL(0u, t.rows());
+    CHECK_EQUAL(0u, t.column(0).size());
+  }
+
+  TEST(branch_measures_in_table){
+    std::ifstream is(test_files_folder + "real.swc");
+    io::SWCParser p(is);
+    auto r = p.read("test");
+    const Neuron& n = *(r->begin());
+
+    auto set = nm::make_measure_set(
+      nm::named("length", [](const Branch& b){ return b.length(); }),
+      nm::named("tortuosity", nm::tortuosity));
+
+    auto branches = selector::neuron_branch_selector(n);
+    nm::ColumnTable t({"branch"}, set.column_names());
+    t.reserve(branches.size());
+    for(const Branch& b : branches){
+      std::size_t row = t.add_row();
+      t.key(row, 0, b.idString());
+      set(b, t.row(row));
+    }
+
+    CHECK_EQUAL(branches.size(), t.rows());
+    for(std::size_t i = 0; i < branches.size(); ++i){
+      const Branch& b = branches[i];
+      CHECK_EQUAL(b.idString(), t.key(i, 0));
+      CHECK_EQUAL(b.length(), t.value(i, 0));
+      float tort = nm::tortuosity(b);
+      if(std::isnan(tort)) CHECK(std::isnan(t.value(i, 1)));
+      else CHECK_EQUAL(tort, t.value(i, 1));
+    }
+  }
+
+}
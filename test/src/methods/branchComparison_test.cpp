@@ -0,0 +1,144 @@
+#include <unittest++/UnitTest++.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <limits>
+#include <vector>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/methods/branchComparison.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(branch_comparison_tests){
+
+  using namespace neurostr;
+
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR;
+
+  std::unique_ptr<Reconstruction> read_swc(const std::string& s){
+    std::ifstream is(test_files_folder + s);
+    io::SWCParser p(is);
+    return p.read("test");
+  }
+
+  std::vector<const Branch*> neuron_branches(const Neuron& n){
+    std::vector<const Branch*> v;
+    for(auto ne = n.begin_neurite(); ne != n.end_neurite(); ++ne)
+      for(auto b = ne->begin_branch(); b != ne->end_branch(); ++b)
+        v.push_back(&*b);
+    return v;
+  }
+
+  // Aligns a copy of a with Branch::rotate and Branch::traslate
+  float reference_distance(const Branch& a, const Branch& b){
+    Branch tmp_a, tmp_b;
+    if(a.has_root()) tmp_a.root(a.root());
+    tmp_a.insert(tmp_a.begin(), a.begin(), a.end());
+    if(b.has_root()) tmp_b.root(b.root());
+    tmp_b.insert(tmp_b.begin(), b.begin(), b.end());
+
+    if(tmp_a.size() == 0 || tmp_b.size() == 0) return tmp_a.discrete_frechet(tmp_b);
+
+    Node root_a = tmp_a.has_root() ? tmp_a.root() : tmp_a.first();
+    Node root_b = tmp_b.has_root() ? tmp_b.root() : tmp_b.first();
+    point_type ref_a = root_a.vectorTo(tmp_a.last());
+    point_type ref_b = root_b.vectorTo(tmp_b.last());
+    if(geometry::norm(ref_a) == 0 || geometry::norm(ref_b) == 0) return tmp_a.discrete_frechet(tmp_b);
+
+    tmp_a.rotate(geometry::align_vectors(ref_a, ref_b));
+    if(tmp_a.has_root()) tmp_a.traslate(tmp_a.root().vectorTo(root_b));
+    else tmp_a.traslate(tmp_a.first().vectorTo(root_b));
+    return tmp_a.discrete_frechet(tmp_b);
+  }
+
+  TEST(oriented_same_shape){
+    Branch::id_type id{0};
+    Branch a{id, 0, Node(1, 0, 0, 0, 1), std::vector<Node>{Node(2, 1, 0, 0, 1),
+                                                          Node(3, 2, 1, 0, 1),
+                                                          Node(4, 3, 0, 0, 1)}};
+    // Rotated 90 degrees around z and translated
+    Branch b{id, 0, Node(5, 10, 10, 10, 1), std::vector<Node>{Node(6, 10, 11, 10, 1),
+                                                             Node(7, 9, 12, 10, 1),
+                                                             Node(8, 10, 13, 10, 1)}};
+    CHECK_CLOSE(0.0, methods::oriented_frechet_branch_distance(a, b), 1E-4);
+    CHECK_CLOSE(0.0, methods::oriented_frechet_branch_distance(b, a), 1E-4);
+  }
+
+  TEST(oriented_reference){
+    auto r = read_swc("real.swc");
+    auto v = neuron_branches(*r->begin());
+    CHECK(v.size() > 4);
+    for(std::size_t k = 1; k < 5; ++k){
+      CHECK_CLOSE(reference_distance(*v[0], *v[k]),
+                  methods::oriented_frechet_branch_distance(*v[0], *v[k]), 1E-3);
+    }
+  }
+
+  TEST(inter_pair_sequential){
+    auto r = read_swc("real.swc");
+    const Neuron& n = *r->begin();
+    auto v = neuron_branches(n);
+
+    auto d = methods::inter_pair_distance(n);
+    CHECK_EQUAL(v.size() * (v.size() - 1) / 2, d.size());
+
+    // Row-major order
+    std::size_t pos = 0;
+    for(std::size_t j = 0; j < v.size() && pos < 50; ++j){
+      for(std::size_t k = j + 1; k < v.size() && pos < 50; ++k){
+        CHECK_CLOSE(methods::oriented_frechet_branch_distance(*v[j], *v[k]), d[pos++], 1E-4);
+      }
+    }
+  }
+
+  TEST(inter_pair_parallel){
+    auto r = read_swc("real.swc");
+    const Neuron& n = *r->begin();
+    ThreadPool pool(4);
+
+    for(int mode = 0; mode < 3; ++mode){
+      bool restrict_order = mode > 0;
+      bool sided = mode > 1;
+      auto seq = methods::inter_pair_distance(n, restrict_order, sided);
+      auto par = methods::inter_pair_distance(n, restrict_order, sided, &pool);
+      CHECK(seq == par);
+    }
+  }
+
+  TEST(inter_pair_byorder){
+    auto r = read_swc("real.swc");
+    const Neuron& n = *r->begin();
+    ThreadPool pool(2);
+
+    for(int sided = 0; sided < 2; ++sided){
+      auto all = methods::inter_pair_distance(n, true, sided == 1, &pool);
+      auto byorder = methods::inter_pair_distance_byorder(n, sided == 1, &pool);
+
+      std::vector<float> joined;
+      for(auto it = byorder.begin(); it != byorder.end(); ++it)
+        joined.insert(joined.end(), it->begin(), it->end());
+      CHECK(all == joined);
+    }
+  }
+
+  TEST(inter_pair_threshold){
+    auto r = read_swc("real.swc");
+    const Neuron& n = *r->begin();
+
+    ThreadPool pool(2);
+    auto full = methods::inter_pair_distance(n, false, false, &pool);
+    std::vector<float> sorted(full);
+    std::sort(sorted.begin(), sorted.end());
+    float threshold = sorted[sorted.size() / 2];
+
+    auto cut = methods::inter_pair_distance(n, false, false, &pool, threshold);
+    CHECK_EQUAL(full.size(), cut.size());
+    for(std::size_t i = 0; i < full.size(); ++i){
+      if(full[i] > threshold) CHECK(std::isinf(cut[i]));
+      else CHECK_EQUAL(full[i], cut[i]);
+    }
+  }
+}
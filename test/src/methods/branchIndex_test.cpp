@@ -0,0 +1,70 @@
+#include <unittest++/UnitTest++.h>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <algorithm>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/branch_measure.h>
+#include <neurostr/methods/branchIndex.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(branch_index_tests){
+  
+  using namespace neurostr;
+  
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR; 
+  
+  std::unique_ptr<Reconstruction> read_swc(const std::string& s){
+    std::ifstream is(test_files_folder + s);
+    io::SWCParser p(is);
+    return p.read("test");
+  }
+  
+  // Index and brute force collisions have to be the same for every branch
+  void check_same_collisions(const Neuron& n, bool ignore_radius){
+    methods::BranchIndex index(n);
+    auto brute = measure::branch_intersects_factory(ignore_radius);
+    
+    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
+      for(auto bit = it->begin_branch(); bit != it->end_branch(); ++bit){
+        const Branch* other = index.first_collision(*bit, ignore_radius);
+        std::string indexed = (other == nullptr) ? std::string() :
+          other->idString()+" @ Neurite: "+std::to_string(other->neurite().id());
+        CHECK_EQUAL(brute(*bit), indexed);
+      }
+    }
+  }
+  
+  TEST(simple_tree){
+    auto rec = read_swc("simple_tree.swc");
+    const Neuron& n = *(rec->begin());
+    
+    methods::BranchIndex index(n);
+    int count = 0;
+    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it)
+      count += it->size();
+    CHECK_EQUAL(static_cast<std::size_t>(count), index.size());
+    
+    check_same_collisions(n, false);
+    check_same_collisions(n, true);
+  }
+  
+  TEST(real){
+    auto rec = read_swc("real.swc");
+    check_same_collisions(*(rec->begin()), false);
+    check_same_collisions(*(rec->begin()), true);
+  }
+  
+  TEST(candidates_exclude_self){
+    auto rec = read_swc("real.swc");
+    const Neuron& n = *(rec->begin());
+    methods::BranchIndex index(n);
+    
+    const Branch& b = *(n.begin_neurite()->begin_branch());
+    auto cand = index.candidates(b);
+    CHECK(std::find(cand.begin(), cand.end(), &b) == cand.end());
+  }
+}
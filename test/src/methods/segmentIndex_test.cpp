@@ -0,0 +1,59 @@
+#include <unittest++/UnitTest++.h>
+#include <iostream>
+#include <fstream>
+#include <stdexcept>
+#include <limits>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/node_measure.h>
+#include <neurostr/selector/neuron_selector.h>
+#include <neurostr/methods/segmentIndex.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(segment_index_tests){
+  
+  using namespace neurostr;
+  
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR; 
+  
+  std::unique_ptr<Reconstruction> read_swc(const std::string& s){
+    std::ifstream is(test_files_folder + s);
+    io::SWCParser p(is);
+    return p.read("test");
+  }
+  
+  // Index and brute force distances have to be the same for every node
+  void check_same_distances(const Neuron& n){
+    methods::SegmentIndex index(n);
+    auto sel = selector::neuron_node_selector(n);
+    for(auto it = sel.begin(); it != sel.end(); ++it){
+      CHECK_EQUAL(measure::segment_distance_to_closest(it->get()),
+                  index.distance_to_closest(it->get()));
+    }
+  }
+  
+  TEST(simple_tree){
+    auto rec = read_swc("simple_tree.swc");
+    const Neuron& n = *(rec->begin());
+    
+    methods::SegmentIndex index(n);
+    // Every node but the neurite roots defines a segment
+    CHECK(index.size() > 0);
+    CHECK(index.size() <= static_cast<std::size_t>(n.node_count()));
+    
+    check_same_distances(n);
+  }
+  
+  TEST(real){
+    auto rec = read_swc("real.swc");
+    check_same_distances(*(rec->begin()));
+  }
+  
+  TEST(empty){
+    Neuron n("empty");
+    methods::SegmentIndex index(n);
+    CHECK_EQUAL(0, index.size());
+  }
+}
@@ -1,13 +1,18 @@
 #include <unittest++/UnitTest++.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <stdexcept>
 #include <vector>
 
 
-#include "core/geometry.h"
-#include "core/contour.h"
-#include "methods/triContour.h"
+#include <neurostr/core/geometry.h>
+#include <neurostr/core/contour.h>
+#include <neurostr/methods/triContour.h>
+#include <neurostr/io/parser_dispatcher.h>
 
 
 namespace ng = neurostr::geometry;
@@ -96,7 +101,7 @@ TEST(join_contours) {
   
   // Call.... triangulation
   auto mesh = nm::create_triangular_contour(cs.begin(),cs.end(),2);
-  std::cout << mesh;
+  CHECK(mesh.face_count() > 0);
   
 } // End contour join
 
@@ -148,3 +153,189 @@ TEST(in_contour) {
   CHECK(res);
   
 } // End contour join
+
+// Rings of n points at depths 0..depths-1, with varying radius
+static std::vector<Contour> ring_contours(int depths, int n){
+  std::vector<Contour> cs;
+  for(int d = 0; d < depths; ++d){
+    float r = 10 + 3 * std::sin(d * 0.7);
+    std::vector<point_type> pts;
+    for(int i = 0; i < n; ++i){
+      float a = 2 * M_PI * i / n;
+      pts.push_back(point_type(r * std::cos(a), r * std::sin(a), d));
+    }
+    Contour c(pts);
+    c.close();
+    cs.push_back(c);
+  }
+  return cs;
+}
+
+TEST(mesh_index_built){
+  auto cs = ring_contours(3, 8);
+  auto mesh = nm::create_triangular_contour(cs.begin(),cs.end(),2);
+  CHECK(mesh.indexed());
+  
+  // Adding faces drops the index
+  mesh.add(point_type(0,0,0), point_type(1,0,0), point_type(0,1,0));
+  CHECK(!mesh.indexed());
+  
+  mesh.build_index();
+  CHECK(mesh.indexed());
+  mesh.clear_faces();
+  CHECK(!mesh.indexed());
+}
+
+TEST(mesh_index_point_inside){
+  auto cs = ring_contours(12, 40);
+  auto mesh = nm::create_triangular_contour(cs.begin(),cs.end(),2);
+  CHECK(mesh.indexed());
+  
+  // Same mesh without index
+  ng::TriangleMesh::face_storage faces;
+  for(auto it = mesh.begin_face(); it != mesh.end_face(); ++it){
+    faces.push_back(mesh.get_triangle(*it));
+  }
+  ng::TriangleMesh plain(faces);
+  CHECK(!plain.indexed());
+  CHECK_EQUAL(mesh.face_count(), plain.face_count());
+  
+  int inside = 0;
+  for(float x = -15; x <= 15; x += 1.3){
+    for(float y = -15; y <= 15; y += 1.7){
+      for(float z = -1.5; z <= 12.5; z += 0.9){
+        point_type p(x,y,z);
+        bool res = mesh.point_inside(p);
+        CHECK_EQUAL(plain.point_inside(p), res);
+        if(res) ++inside;
+      }
+    }
+  }
+  CHECK(inside > 0);
+  
+  // Center points are inside, far points are not
+  CHECK(mesh.point_inside(point_type(0.1,0.2,5.5)));
+  CHECK(!mesh.point_inside(point_type(0.1,0.2,20)));
+  CHECK(!mesh.point_inside(point_type(30,0.2,5.5)));
+}
+
+TEST(mesh_index_ray_intersection){
+  auto cs = ring_contours(12, 40);
+  auto mesh = nm::create_triangular_contour(cs.begin(),cs.end(),2);
+  
+  point_type origin(0.5,-0.3,5.2);
+  for(int i = 0; i < 50; ++i){
+    float a = 2 * M_PI * i / 50;
+    point_type dir(std::cos(a), std::sin(a), 0.3 * std::sin(3 * a));
+    ng::normalize(dir);
+    
+    // Closest hit by brute force
+    float best = std::numeric_limits<float>::max();
+    point_type expected, hit;
+    for(auto it = mesh.begin_face(); it != mesh.end_face(); ++it){
+      if(ng::triangle_ray_intersection(mesh.get_triangle(*it), origin, dir, hit)){
+        float d = ng::distance(origin, hit);
+        if(d < best){
+          best = d;
+          expected = hit;
+        }
+      }
+    }
+    CHECK(best < std::numeric_limits<float>::max());
+    
+    point_type res = mesh.ray_intersection(origin, dir);
+    CHECK_CLOSE(0.0, ng::distance(res, expected), 1E-4);
+  }
+}
+
+// Adds rings around the neurites bounding box, shifted along x
+static void add_layer_contours(Reconstruction& r, const std::string& name, float shift){
+  float lo[3] = {1E9, 1E9, 1E9}, hi[3] = {-1E9, -1E9, -1E9};
+  for(auto n = r.begin(); n != r.end(); ++n){
+    for(auto ne = n->begin_neurite(); ne != n->end_neurite(); ++ne){
+      for(auto it = ne->begin_node(); it != ne->end_node(); ++it){
+        for(int k = 0; k < 3; ++k){
+          lo[k] = std::min(lo[k], ng::get(it->position(), k));
+          hi[k] = std::max(hi[k], ng::get(it->position(), k));
+        }
+      }
+    }
+  }
+  
+  int depths = 6, n = 40;
+  for(int d = 0; d < depths; ++d){
+    float z = lo[2] - 1 + (hi[2] - lo[2] + 2) * d / (depths - 1);
+    float rx = 0.35 * (hi[0] - lo[0]) * (1 + 0.2 * std::sin(d)), ry = 0.35 * (hi[1] - lo[1]);
+    float cx = (lo[0] + hi[0]) / 2 + shift * (hi[0] - lo[0]);
+    std::vector<point_type> pts;
+    for(int i = 0; i < n; ++i){
+      float a = 2 * M_PI * i / n;
+      pts.push_back(point_type(cx + rx * std::cos(a), (lo[1] + hi[1]) / 2 + ry * std::sin(a), z));
+    }
+    Contour c(pts);
+    c.name(name);
+    c.close();
+    r.addContour(c);
+  }
+}
+
+TEST(contours_process_parallel){
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  std::string path = std::string(env_test_data_dir ? env_test_data_dir : "") + "test_data/swc/real.swc";
+  std::vector<std::string> names({"A", "B"});
+  
+  auto seq = io::read_file_by_ext(path);
+  auto par = io::read_file_by_ext(path);
+  for(auto r : {seq.get(), par.get()}){
+    add_layer_contours(*r, "A", 0);
+    add_layer_contours(*r, "B", 0.25);
+  }
+  
+  nm::reconstructionContoursProcess(*seq, names, 2, false, 1);
+  nm::reconstructionContoursProcess(*par, names, 2, false, 4);
+  
+  // Same nodes and tags
+  int tagged = 0, virtual_nodes = 0;
+  auto n_par = par->begin();
+  for(auto n = seq->begin(); n != seq->end(); ++n, ++n_par){
+    CHECK_EQUAL(n->node_count(), n_par->node_count());
+    auto ne_par = n_par->begin_neurite();
+    for(auto ne = n->begin_neurite(); ne != n->end_neurite(); ++ne, ++ne_par){
+      auto b_par = ne_par->begin_branch();
+      for(auto b = ne->begin_branch(); b != ne->end_branch(); ++b, ++b_par){
+        CHECK_EQUAL(b->size(), b_par->size());
+        for(auto& name : names){
+          CHECK_EQUAL(b->properties.exists(name), b_par->properties.exists(name));
+        }
+        auto it_par = b_par->begin();
+        for(auto it = b->begin(); it != b->end(); ++it, ++it_par){
+          CHECK_EQUAL(it->id(), it_par->id());
+          CHECK_CLOSE(0.0, ng::distance(it->position(), it_par->position()), 1E-6);
+          for(auto& name : names){
+            CHECK_EQUAL(it->properties.exists(name), it_par->properties.exists(name));
+            if(it->properties.exists(name)) ++tagged;
+          }
+          if(it->id() == -3) ++virtual_nodes;
+        }
+      }
+    }
+  }
+  CHECK(tagged > 0);
+  CHECK(virtual_nodes > 0);
+}
+
+TEST(contours_process_missing_name){
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  std::string path = std::string(env_test_data_dir ? env_test_data_dir : "") + "test_data/swc/real.swc";
+  auto r = io::read_file_by_ext(path);
+  
+  // No contours: nothing is inside
+  nm::reconstructionContoursProcess(*r, {"missing"}, 2, false, 2);
+  for(auto n = r->begin(); n != r->end(); ++n){
+    for(auto ne = n->begin_neurite(); ne != n->end_neurite(); ++ne){
+      for(auto it = ne->begin_node(); it != ne->end_node(); ++it){
+        CHECK(!it->properties.exists("missing"));
+      }
+    }
+  }
+}
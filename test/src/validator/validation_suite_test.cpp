@@ -0,0 +1,101 @@
+#include <unittest++/UnitTest++.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/measure/node_measure.h>
+#include <neurostr/validator/predefined_validators.h>
+#include <neurostr/validator/validation_suite.h>
+
+#define SWC_TEST_DATA_SUBDIR "test_data/swc/"
+
+SUITE(validation_suite_tests){
+  
+  using namespace neurostr;
+  namespace nv = neurostr::validator;
+  
+  const char* env_test_data_dir = std::getenv("NSTR_TEST_DIR");
+  const std::string test_files_folder = env_test_data_dir?std::string(env_test_data_dir) +  SWC_TEST_DATA_SUBDIR : SWC_TEST_DATA_SUBDIR; 
+  
+  std::unique_ptr<Reconstruction> read_swc(const std::string& s){
+    std::ifstream is(test_files_folder + s);
+    io::SWCParser p(is);
+    return p.read("test");
+  }
+  
+  // Same validators as the validator tool defaults
+  void fill_suite(nv::ValidationSuite& s, const Neuron& n){
+    s.add(nv::neurites_attached_to_soma);
+    s.add(nv::neuron_has_soma);
+    s.add(nv::planar_reconstruction_validator_factory(1.01));
+    s.add(nv::dendrite_count_validator_factory(2,13));
+    s.add(nv::no_trifurcations_validator);
+    s.add(nv::linear_branches_validator_factory(1.01));
+    s.add(nv::zero_length_segments_validator);
+    s.add(nv::radius_length_segments_validator);
+    s.add(nv::increasing_radius_validator);
+    s.add(nv::branch_collision_validator_factory(n, false));
+    s.add(nv::extreme_angles_validator);
+  }
+  
+  TEST(empty_suite){
+    nv::ValidationSuite s;
+    CHECK_EQUAL(0u, s.size());
+    CHECK(s.pass());
+    
+    std::ostringstream os;
+    s.toJSON(os);
+    CHECK_EQUAL("[\n]\n", os.str());
+  }
+  
+  TEST(fill_node_caches){
+    auto rec = read_swc("real.swc");
+    const Neuron& n = *(rec->begin());
+    
+    measure::fill_node_caches(n);
+    
+    // First nodes point to the parent branch last node
+    for(auto ne = n.begin_neurite(); ne != n.end_neurite(); ++ne){
+      for(auto b = ne->begin_branch(); b != ne->end_branch(); ++b){
+        const Branch* pb = b->parent_branch();
+        if(b->size() == 0 || pb == nullptr || pb->size() == 0) continue;
+        CHECK(b->first().valid_parent());
+        if(b->first().valid_parent()) CHECK(&(b->first().parent()) == &(pb->last()));
+      }
+    }
+  }
+  
+  TEST(concurrent_equals_sequential){
+    auto rec_seq = read_swc("real.swc");
+    auto rec_par = read_swc("real.swc");
+    const Neuron& n_seq = *(rec_seq->begin());
+    const Neuron& n_par = *(rec_par->begin());
+    
+    nv::ValidationSuite seq(1);
+    nv::ValidationSuite par(4);
+    fill_suite(seq, n_seq);
+    fill_suite(par, n_par);
+    CHECK_EQUAL(11u, par.size());
+    
+    seq.validate(n_seq);
+    par.validate(n_par);
+    CHECK_EQUAL(seq.pass(), par.pass());
+    
+    std::ostringstream os_seq, os_par;
+    seq.toJSON(os_seq, false);
+    par.toJSON(os_par, false);
+    CHECK(os_seq.str() == os_par.str());
+  }
+  
+  TEST(exception_is_rethrown){
+    auto rec = read_swc("simple_tree.swc");
+    
+    nv::ValidationSuite s(2);
+    s.add(nv::neuron_has_soma);
+    s.add(nv::create_validator([](const Neuron& n) -> bool { throw std::runtime_error("fail"); },
+                               nv::is_true));
+    CHECK_THROW(s.validate(*(rec->begin())), std::runtime_error);
+  }
+}
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <utility>
 #include <fstream>
+#include <sstream>
 #include <numeric>
 #include <iostream>
 #include <algorithm>
@@ -27,9 +28,13 @@
 #include <neurostr/core/log.h>
 #include <neurostr/core/neuron.h>
 #include <neurostr/io/parser_dispatcher.h>
+#include <neurostr/io/SWCParser.h>
+#include <neurostr/io/SWCWriter.h>
 #include <neurostr/validator/validator.h>
 #include <neurostr/validator/predefined_validators.h>
 #include <neurostr/measure/lmeasure_decl.h>
+#include <neurostr/measure/compact_measure.h>
+#include <neurostr/measure/lmeasure_engine.h>
 
 using Neuron = neurostr::Neuron;
 
@@ -390,6 +395,37 @@ const auto load_file_test = [](const std::string& path){
   // ...aaaand thats it
 };
 
+// Synthetic SWC file with nsamples nodes. Samples are written in breadth-first
+// order so consecutive lines almost never share parent (worst case for parent lookup)
+std::string synthetic_swc(int nsamples){
+  
+  std::mt19937 gen(2016);
+  std::normal_distribution<float> step(0.0,1.0);
+  std::uniform_int_distribution<int> bif(0,19);
+  
+  // Tip: id, position
+  struct tip { int id; float x, y, z; };
+  
+  std::ostringstream os;
+  os << "# Synthetic out-of-order reconstruction" << std::endl;
+  os << "1 1 0 0 0 5 -1" << std::endl;
+  
+  std::vector<tip> tips{ {1,0,0,0}, {1,0,0,0} };
+  int id = 2;
+  while(id <= nsamples){
+    std::vector<tip> next;
+    for(auto it = tips.begin(); it != tips.end() && id <= nsamples; ++it){
+      tip t{id++, it->x + step(gen), it->y + step(gen), it->z + 1.0f};
+      os << boost::format("%d 3 %.3f %.3f %.3f 0.5 %d") % t.id % t.x % t.y % t.z % it->id << std::endl;
+      next.push_back(t);
+      // Bifurcate
+      if(bif(gen) == 0) next.push_back(t);
+    }
+    tips = next;
+  }
+  return os.str();
+}
+
 // VALIDATION TESTS
 const auto neurites_attached_to_soma = [](const Neuron& n){
   auto test = neurostr::validator::neurites_attached_to_soma;
@@ -448,7 +484,7 @@ const auto increasing_radius_validator = [](const Neuron& n){
 
 const auto segment_collision_validator = [](const Neuron& n){
   //auto test = neurostr::validator::segment_collision_validator;
-  auto test = neurostr::validator::branch_collision_validator_factory(false);
+  auto test = neurostr::validator::branch_collision_validator_factory(n, false);
   test.validate(n);
 };
 
@@ -518,6 +554,53 @@ void lmeasures_benchmark(bmk::benchmark<std::chrono::microseconds>& bm, Neuron&
   bm.run("last_parent_diam",nrep, [&](){nlm::last_parent_diam(n);});
   bm.run("hillman_threshold",nrep, [&](){nlm::hillman_threshold(n);});
   bm.run("fractal_dim",nrep, [&](){nlm::fractal_dim(n);});
+  
+  nlm::Engine engine;
+  bm.run("lmeasure_engine",nrep, [&](){engine.compute(n);});
+  
+  nlm::Engine online_engine;
+  online_engine.online(true);
+  bm.run("lmeasure_engine_online",nrep, [&](){online_engine.compute(n);});
+}
+
+void compact_lmeasures_benchmark(bmk::benchmark<std::chrono::microseconds>& bm, Neuron& n, int nrep){
+  namespace ncm = neurostr::measure::lmeasure::compact;
+  
+  n.remove_null_segments();
+  bm.run("compact_build",nrep, [&](){neurostr::CompactNeuron c(n);});
+  
+  neurostr::CompactNeuron c(n);
+  bm.run("soma_surface",nrep, [&](){ncm::soma_surface(c);});
+  bm.run("n_stems",nrep, [&](){ncm::n_stems(c);});
+  bm.run("n_bifs",nrep, [&](){ncm::n_bifs(c);});
+  bm.run("n_branch",nrep, [&](){ncm::n_branch(c);});
+  bm.run("n_tips",nrep, [&](){ncm::n_tips(c);});
+  bm.run("width",nrep, [&](){ncm::width(c);});
+  bm.run("height",nrep, [&](){ncm::height(c);});
+  bm.run("depth",nrep, [&](){ncm::depth(c);});
+  bm.run("diameter",nrep, [&](){ncm::diameter(c);});
+  bm.run("diameter_pow",nrep, [&](){ncm::diameter_pow(c);});
+  bm.run("length",nrep, [&](){ncm::length(c);});
+  bm.run("surface",nrep, [&](){ncm::surface(c);});
+  bm.run("section_area",nrep, [&](){ncm::section_area(c);});
+  bm.run("volume",nrep, [&](){ncm::volume(c);});
+  bm.run("euc_distance",nrep, [&](){ncm::euc_distance(c);});
+  bm.run("path_distance",nrep, [&](){ncm::path_distance(c);});
+  bm.run("branch_order",nrep, [&](){ncm::branch_order(c);});
+  bm.run("terminal_degree",nrep, [&](){ncm::terminal_degree(c);});
+  bm.run("taper_1",nrep, [&](){ncm::taper_1(c);});
+  bm.run("taper_2",nrep, [&](){ncm::taper_2(c);});
+  bm.run("branch_pathlength",nrep, [&](){ncm::branch_pathlength(c);});
+  bm.run("contraction",nrep, [&](){ncm::contraction(c);});
+  bm.run("fragmentation",nrep, [&](){ncm::fragmentation(c);});
+  bm.run("partition_asymmetry",nrep, [&](){ncm::partition_asymmetry(c);});
+  bm.run("rall_power",nrep, [&](){ncm::rall_power(c);});
+  bm.run("pk",nrep, [&](){ncm::pk(c);});
+  bm.run("pk_classic",nrep, [&](){ncm::pk_classic(c);});
+  bm.run("pk_2",nrep, [&](){ncm::pk_2(c);});
+  bm.run("bif_ampl_local",nrep, [&](){ncm::bif_ampl_local(c);});
+  bm.run("bif_ampl_remote",nrep, [&](){ncm::bif_ampl_remote(c);});
+  bm.run("last_parent_diam",nrep, [&](){ncm::last_parent_diam(c);});
 }
 
 namespace po = boost::program_options;
@@ -583,8 +666,34 @@ int main(int ac, char **av)
     /** Read speed test **/
     bmk::benchmark<std::chrono::microseconds> bm_read;
     bm_read.run("Read_speed",nrep, [_f = ifile](){auto  r = neurostr::io::read_file_by_ext(_f);});
+    bm_read.run("Read_speed_arena",nrep, [_f = ifile](){auto  r = neurostr::io::read_file_by_ext(_f, true);});
+    
+    std::map<int,std::string> synthetic_files;
+    for(int size : {1000, 5000, 25000}){
+      synthetic_files.emplace(size, synthetic_swc(size));
+    }
+    bm_read.run("Read_speed_synthetic_swc",nrep, [&synthetic_files](int size){
+      std::istringstream is(synthetic_files.at(size));
+      neurostr::io::SWCParser p(is);
+      auto r = p.read("synthetic");
+    }, "samples", {1000, 5000, 25000});
     bm_read.print("Read", std::cout);
     
+    /** Write speed test **/
+    bmk::benchmark<std::chrono::microseconds> bm_write;
+    std::map<int,std::unique_ptr<neurostr::Reconstruction>> synthetic_recs;
+    for(const auto& f : synthetic_files){
+      std::istringstream is(f.second);
+      neurostr::io::SWCParser p(is);
+      synthetic_recs.emplace(f.first, p.read("synthetic"));
+    }
+    bm_write.run("Write_speed_synthetic_swc",nrep, [&synthetic_recs](int size){
+      std::ostringstream os;
+      neurostr::io::SWCWriter w(os);
+      w.write(*(synthetic_recs.at(size)->begin()));
+    }, "samples", {1000, 5000, 25000});
+    bm_write.print("Write", std::cout);
+    
     // Run Validation tests
     bmk::benchmark<std::chrono::microseconds> bm_validation;
     validation_benchmark(bm_validation,n, nrep);
@@ -595,6 +704,11 @@ int main(int ac, char **av)
     lmeasures_benchmark(bm_measures, n, nrep);
     bm_measures.print("Measures", std::cout);
     
+    // Run Measure test over the compact representation
+    bmk::benchmark<std::chrono::microseconds> bm_compact;
+    compact_lmeasures_benchmark(bm_compact, n, nrep);
+    bm_compact.print("Compact measures", std::cout);
+    
     // Mock object and close
     std::cout << " {}]} "<< std::endl;
 }
@@ -4,6 +4,12 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <future>
+#include <limits>
+#include <cmath>
+#include <cstring>
 #include <algorithm>
 #include <boost/program_options/cmdline.hpp>
 #include <boost/program_options/parsers.hpp>
@@ -17,6 +23,8 @@
 
 #include <neurostr/core/log.h>
 #include <neurostr/core/neuron.h>
+#include <neurostr/core/thread_pool.h>
+#include <neurostr/core/pipeline.h>
 
 #include <neurostr/measure/universal_measure.h>
 #include <neurostr/measure/branch_measure.h>
@@ -24,10 +32,13 @@
 #include <neurostr/measure/node_measure.h>
 #include <neurostr/measure/aggregate.h>
 #include <neurostr/measure/measure_operations.h>
+#include <neurostr/measure/measure_set.h>
+#include <neurostr/measure/column_table.h>
 
 #include <neurostr/selector/neurite_selector.h>
 
 #include <neurostr/io/parser_dispatcher.h>
+#include <neurostr/io/TableWriter.h>
 
 namespace po = boost::program_options;
 namespace ns = neurostr::selector;
@@ -42,116 +53,138 @@ namespace nm = neurostr::measure;
  }
  
  
- std::map<std::string, float> get_branch_measures(const neurostr::Branch& b){
-   
-   std::map<std::string, float> m; // measures
-   bool is_bifurcation = false;
-   
+ /**
+  * @brief Branch and the values shared by several measures
+  */
+ struct branch_entry {
+   const neurostr::Branch& b;
+   int n_descs;
    
+   bool is_bifurcation() const { return n_descs > 1; }
+ };
+ 
+ // Branch measure as entry measure
+ template <typename F>
+ auto on_branch(const F& f){
+   return [f](const branch_entry& e) -> float { return f(e.b); };
+ }
+ 
+ // Bifurcation measures are NaN (not printed) for non-bifurcation branches
+ template <typename F>
+ auto on_bifurcation(const F& f){
+   return [f](const branch_entry& e) -> float { 
+     return e.is_bifurcation() ? f(e.b) : std::numeric_limits<float>::quiet_NaN(); 
+   };
+ }
+ 
+ // Branch measures (output columns). Fixed at compile time
+ const auto branch_measures = nm::make_measure_set(
   // Number of nodes
-  m.emplace( "N_nodes", b.size());
-   
+  nm::named("N_nodes", [](const branch_entry& e) -> float { return e.b.size(); }),
   // Tortuosity
-  m.emplace( "tortuosity", nm::tortuosity(b));
-   
+  nm::named("tortuosity", on_branch(nm::tortuosity)),
   // Hillman taper rate
-  m.emplace( "hill_taper_rate", nm::taper_rate_hillman(b)); 
-  
+  nm::named("hill_taper_rate", on_branch(nm::taper_rate_hillman)),
   // Burker taper rate
-  m.emplace( "burker_taper_rate", nm::taper_rate_burker(b)); 
-  
+  nm::named("burker_taper_rate", on_branch(nm::taper_rate_burker)),
   // Centrifugal order
-  m.emplace( "centrifugal_order", b.order()); 
-  
+  nm::named("centrifugal_order", [](const branch_entry& e) -> float { return e.b.order(); }),
   // Length
-  m.emplace("length", b.length());
-  
+  nm::named("length", [](const branch_entry& e) -> float { return e.b.length(); }),
   // Number of descs
-  int ndescs = b.neurite().find(b).number_of_children();
-  is_bifurcation = ndescs > 1;
-  m.emplace("N_descs", ndescs);
-  
+  nm::named("N_descs", [](const branch_entry& e) -> float { return e.n_descs; }),
   // Volume
-  m.emplace("volume",   nm::selectorMeasureCompose(ns::branch_node_selector,
+  nm::named("volume", on_branch(nm::selectorMeasureCompose(ns::branch_node_selector,
                           nm::measureEachAggregate( nm::node_volume,
-                                                    nm::aggregate::sum_aggr_factory<float,float>(0.0)))(b));
-                                                    
+                                                    nm::aggregate::sum_aggr_factory<float,float>(0.0))))),
   // Surface
-  m.emplace("surface",   nm::selectorMeasureCompose(ns::branch_node_selector,
+  nm::named("surface", on_branch(nm::selectorMeasureCompose(ns::branch_node_selector,
                           nm::measureEachAggregate( nm::node_compartment_surface,
-                                                    nm::aggregate::sum_aggr_factory<float,float>(0.0)))(b));
-  
+                                                    nm::aggregate::sum_aggr_factory<float,float>(0.0))))),
   // Box volume
-  m.emplace("box_volume",   nm::selectorMeasureCompose(ns::branch_node_selector,
-                                                       nm::box_volume)(b));
-                                                       
+  nm::named("box_volume", on_branch(nm::selectorMeasureCompose(ns::branch_node_selector,
+                                                                nm::box_volume))),
   // Fractal dim
-  m.emplace("fractal_dimension",   nm::branch_fractal_dim(b));
-
-
+  nm::named("fractal_dimension", on_branch(nm::branch_fractal_dim)),
+  
   /** Bifurcation measures **/
-  if(is_bifurcation){
-    
-    // Local bifurcation angle
-    m.emplace( "local_bifurcation_angle", nm::local_bifurcation_angle(b)); 
-                                          
-    // Local tilt angle
-    m.emplace( "local_tilt_angle", nm::local_tilt_angle(b)); 
-
-    // Local torque angle
-    m.emplace( "local_torque_angle", nm::local_torque_angle(b)); 
-                                          
-    // Remote bifurcation angle
-    m.emplace( "remote_bifurcation_angle", nm::remote_bifurcation_angle(b)); 
-                                          
-    // Remote tilt angle
-    m.emplace( "remote_tilt_angle", nm::remote_tilt_angle(b)); 
-
-    // Remote torque angle
-    m.emplace( "remote_torque_angle", nm::remote_torque_angle(b)); 
-                                          
-    // Child diameter ratio
-    m.emplace( "child_diam_ratio", nm::child_diam_ratio(b)); 
-    // Partition asymmetry
-    m.emplace( "partition_asymmetry", nm::selectorMeasureCompose(ns::branch_node_selector,
-                                                                 nm::node_set_fractal_dim)(b)); 
+  nm::named("local_bifurcation_angle", on_bifurcation(nm::local_bifurcation_angle)),
+  nm::named("local_tilt_angle", on_bifurcation(nm::local_tilt_angle)),
+  nm::named("local_torque_angle", on_bifurcation(nm::local_torque_angle)),
+  nm::named("remote_bifurcation_angle", on_bifurcation(nm::remote_bifurcation_angle)),
+  nm::named("remote_tilt_angle", on_bifurcation(nm::remote_tilt_angle)),
+  nm::named("remote_torque_angle", on_bifurcation(nm::remote_torque_angle)),
+  nm::named("child_diam_ratio", on_bifurcation(nm::child_diam_ratio)),
+  // Partition asymmetry
+  nm::named("partition_asymmetry", on_bifurcation(nm::selectorMeasureCompose(ns::branch_node_selector,
+                                                                             nm::node_set_fractal_dim)))
+ );
+ 
+ // Key columns
+ const std::vector<std::string> branch_keys = {"neuron", "neurite", "neurite_type", "branch"};
+ 
+ /**
+  * @brief Computes the branch measures
+  * @param b Branch
+  * @param out Output row (one value per branch_measures column)
+  */
+ template <typename Row>
+ void get_branch_measures(const neurostr::Branch& b, Row&& out){
+   branch_entry e{b, static_cast<int>(b.neurite().find(b).number_of_children())};
+   
+   if(!e.is_bifurcation()){
+     NSTR_LOG_(info, std::string("Branch ") + b.idString() + " is not a bifurcation branch. Bif. measures are skipped" );
+   }
+   
+   branch_measures(e, out);
+ }
+ 
+std::string neurite_type_string(const neurostr::Neurite& n){
+  if(n.type() == neurostr::NeuriteType::kAxon){ 
+    return "Axon";
+  } else if(n.type() == neurostr::NeuriteType::kApical){ 
+    return "Apical";
+  } else if(n.type() == neurostr::NeuriteType::kDendrite){ 
+    return "Dendrite";
   } else {
-    NSTR_LOG_(info, std::string("Branch ") + b.idString() + " is not a bifurcation branch. Bif. measures are skipped" );
+    return "Unknown";
   }
-  
-  return m;
-  
 }
  
 void print_branch_id(const neurostr::Branch& b, std::ostream& os){
   os << escape_string("neuron") << " : " << escape_string(b.neurite().neuron().id()) << ", ";
   os << escape_string("neurite") << " : " << b.neurite().id() << ", ";
-  os << escape_string("neurite_type") << " : ";
-  if(b.neurite().type() == neurostr::NeuriteType::kAxon){ 
-    os << escape_string("Axon");
-  } else if(b.neurite().type() == neurostr::NeuriteType::kApical){ 
-    os << escape_string("Apical");
-  } else if(b.neurite().type() == neurostr::NeuriteType::kDendrite){ 
-    os << escape_string("Dendrite");
-  } else {
-    os << escape_string("Unknown");
-  }
-  
+  os << escape_string("neurite_type") << " : " << escape_string(neurite_type_string(b.neurite()));
   os << ", " << escape_string("branch") << " : " << escape_string(b.idString()) ;
 }
 
+/**
+ * @brief Measure columns sorted by name (JSON output order)
+ */
+const std::vector<std::size_t>& sorted_measures(){
+  static const std::vector<std::size_t> order = [](){
+    std::vector<std::size_t> v(branch_measures.size());
+    for(std::size_t i = 0; i < v.size(); ++i) v[i] = i;
+    std::sort(v.begin(), v.end(), [](std::size_t a, std::size_t b){
+      return std::strcmp(branch_measures.names()[a], branch_measures.names()[b]) < 0;
+    });
+    return v;
+  }();
+  return order;
+}
+
 // Note: This should be done with rapidjson
-void print_measures(std::map<std::string, float>& m , 
-                            std::ostream& os ){
+void print_measures(const nm::ColumnTable& t, std::size_t row, std::ostream& os ){
   bool first = true;
   // Measures json element
   os << escape_string("measures") << " : { ";   
 
   // Print each measure
-  for(auto it = m.begin(); it!=m.end();++it ){
+  for(std::size_t c : sorted_measures()){
+    float v = t.value(row, c);
     
-    // If values vector is not empty
-    if(!std::isnan(it->second)){
+    // If value is not nan
+    if(!std::isnan(v)){
       if(first){
         first = false;
       } else {
@@ -159,7 +192,7 @@ void print_measures(std::map<std::string, float>& m ,
       }      
     
      // Print key and value
-      os << escape_string(it->first) << " : " << std::to_string(it->second) ;
+      os << escape_string(branch_measures.names()[c]) << " : " << std::to_string(v) ;
     
     } // End if value is nan
     
@@ -167,22 +200,158 @@ void print_measures(std::map<std::string, float>& m ,
   os << " }"; // Close measures
 }
 
-void print_branch_measures(const neurostr::Branch& b, std::ostream& os){
+void print_branch_measures(const neurostr::Branch& b, const nm::ColumnTable& t, 
+                           std::size_t row, std::ostream& os){
   os << "{" ;
   // Print neurite ID
   print_branch_id(b,os);
   os << ", ";
   
-  // Get measures
-  auto m = get_branch_measures(b);
-  
-  // Print them
-  print_measures(m,os);
+  // Print measures
+  print_measures(t, row, os);
   
   // End obj
   os << "}";
 }
 
+/**
+ * @brief Branch feature extractor options
+ */
+struct extraction_options {
+  bool omitapical = false;
+  bool omitaxon = false;
+  bool omitdend = false;
+  bool correct = false;
+  std::string selection = "all";
+};
+
+/**
+ * @brief Selects the branch subset to measure
+ * @param n Neuron
+ * @param selection all, terminal, nonterminal, preterminal or root
+ * @return Branch references
+ */
+std::vector<ns::const_branch_reference> select_branches(const neurostr::Neuron& n, 
+                                                        const std::string& selection){
+  if(selection == "all"){
+    return ns::neuron_branch_selector(n);
+  } else if (selection == "terminal"){
+    return ns::selector_foreach(ns::neuron_neurites,ns::neurite_terminal_branches)(n);
+  } else if (selection == "nonterminal"){
+    return ns::selector_foreach(ns::neuron_neurites,ns::neurite_non_terminal_branches)(n);
+  } else if (selection == "preterminal"){
+    return ns::selector_foreach(ns::neuron_neurites,ns::neurite_pre_terminal_branches)(n);
+  } else if (selection == "root"){
+    return ns::compose_selector(ns::branch_order_filter_factory(0),ns::neuron_branch_selector)(n);
+  } else {
+    NSTR_LOG_(error, "Unrecognized selection type. Selecting all branches.")
+    return ns::neuron_branch_selector(n);
+  }
+}
+
+/**
+ * @brief A read reconstruction and its branch measure table
+ */
+struct branch_job {
+  std::unique_ptr<neurostr::Reconstruction> rec;
+  std::vector<ns::const_branch_reference> branches; // One per table row
+  std::unique_ptr<nm::ColumnTable> table;
+  std::vector<std::future<void>> done;
+};
+
+/**
+ * @brief Reader stage. Reads the file, prepares each neuron, adds a table row
+ * per selected branch and submits one measure task per row to the pool
+ * @param path File path
+ * @param o Options
+ * @param pool Measure stage pool
+ * @return Job
+ */
+branch_job read_branches(const std::string& path, const extraction_options& o, 
+                         neurostr::ThreadPool& pool){
+  branch_job job;
+  job.table.reset(new nm::ColumnTable(branch_keys, branch_measures.column_names()));
+  try {
+    job.rec = neurostr::io::read_file_by_ext(path, true);
+  } catch(const std::exception& e){
+    NSTR_LOG_(error, path + ": " + e.what());
+    return job;
+  }
+  
+  // For each neuron
+  for(auto n_it = job.rec->begin(); n_it != job.rec->end(); ++n_it){
+    neurostr::Neuron& n = *n_it;
+    
+    /** Remove **/
+    if(o.omitapical) n.erase_apical();
+    if(o.omitaxon) n.erase_axon();
+    if(o.omitdend) n.erase_dendrites();
+    if(o.correct) n.correct();
+    
+    // Node values are cached on first use. Fill them before branches are 
+    // measured concurrently
+    nm::fill_node_caches(n);
+    
+    auto branches = select_branches(n, o.selection);
+    job.branches.insert(job.branches.end(), branches.begin(), branches.end());
+  }
+  
+  // Rows are added before any of them is filled
+  nm::ColumnTable& t = *job.table;
+  t.reserve(job.branches.size());
+  for(const neurostr::Branch& b : job.branches){
+    std::size_t r = t.add_row();
+    t.key(r, 0, b.neurite().neuron().id());
+    t.key(r, 1, std::to_string(b.neurite().id()));
+    t.key(r, 2, neurite_type_string(b.neurite()));
+    t.key(r, 3, b.idString());
+  }
+  
+  nm::ColumnTable* tp = job.table.get();
+  job.done.reserve(job.branches.size());
+  for(std::size_t r = 0; r < job.branches.size(); ++r){
+    ns::const_branch_reference b = job.branches[r];
+    job.done.push_back(pool.submit([b, tp, r](){ get_branch_measures(b, tp->row(r)); }));
+  }
+  return job;
+}
+
+/**
+ * @brief Waits for the job measure tasks
+ * @param job Job
+ */
+void wait_branches(branch_job& job){
+  for(auto it = job.done.begin(); it != job.done.end(); ++it){
+    try {
+      it->get();
+    } catch(const std::exception& e){
+      NSTR_LOG_(error, e.what());
+    }
+  }
+}
+
+/**
+ * @brief Writer stage. Writes the job measures
+ * @param job Job (measured)
+ * @param w Table writer. nullptr for the JSON array output
+ * @param first First record flag (JSON array output)
+ * @param os Output stream
+ */
+void write_branches(branch_job& job, neurostr::io::TableWriter* w, bool& first, std::ostream& os){
+  if(w != nullptr){
+    w->write(*job.table);
+    return;
+  }
+  
+  for(std::size_t r = 0; r < job.branches.size(); ++r){
+    if(!first){
+      os << " , ";
+    }
+    first = false;
+    print_branch_measures(job.branches[r], *job.table, r, os);
+  }
+}
+
 /**
  * @brief 
  * @param ac
@@ -197,23 +366,29 @@ int main(int ac, char **av)
   
   std::string ifile;
   
-  // omits
-  bool omitapical = false;
-  bool omitaxon = false;
-  bool omitdend = false;
-  bool correct = false;
+  extraction_options opt;
   
-  std::string selection;
+  // Batch mode
+  std::string batch;
+  
+  // Worker threads
+  int nthreads = 0;
+  
+  // Output format
+  std::string format;
   
   po::options_description desc("Allowed options");
   desc.add_options()
     ("help,h", "Produce help message")
     ("input,i", po::value< std::string >(&ifile), "Neuron reconstruction file")
     ("correct,c", "Try to correct the errors in the reconstruction")
-    ("selection,s", po::value< std::string >(&selection) -> default_value("all"), "Branch subset: all, terminal, nonterminal, preterminal or root")
+    ("selection,s", po::value< std::string >(&opt.selection) -> default_value("all"), "Branch subset: all, terminal, nonterminal, preterminal or root")
     ("omitapical", "Ignore the apical dendrite")
     ("omitaxon", "Ignore the axon")
-    ("omitdend", "Ignore the non-apical dendrites");
+    ("omitdend", "Ignore the non-apical dendrites")
+    ("batch", po::value< std::string >(&batch), "Batch mode. Directory or file list (one path per line) to process")
+    ("threads,j", po::value< int >(&nthreads)->default_value(0), "Measure worker threads (0: one per core)")
+    ("format,f", po::value< std::string >(&format) -> default_value("json"), "Output format: json (array of branch objects), csv, jsonl (one object per line) or bin (binary columnar table)");
   
   
   
@@ -227,7 +402,7 @@ int main(int ac, char **av)
     return 1;
   }
   
-  if(!vm.count("input") || !vm.count("input")){
+  if(!vm.count("input") && !vm.count("batch")){
     std::cout << "ERROR: input file required" << std::endl << std::endl;
     std::cout << desc << "\n";
     std::cout << "Example: neurostr_branchfeature -i test.swc " << std::endl << std::endl ;
@@ -235,62 +410,61 @@ int main(int ac, char **av)
   }
   
   
-  omitapical = (vm.count("omitapical") > 0);
-  omitaxon = (vm.count("omitaxon") > 0);
-  omitdend = (vm.count("omitdend") > 0);
-  correct = (vm.count("correct") > 0);
+  opt.omitapical = (vm.count("omitapical") > 0);
+  opt.omitaxon = (vm.count("omitaxon") > 0);
+  opt.omitdend = (vm.count("omitdend") > 0);
+  opt.correct = (vm.count("correct") > 0);
   
   /*** END PARAMETER PARSING */
   
-  // Read
-  auto r = neurostr::io::read_file_by_ext(ifile);
-  
-  // Measure each neurite and output report
-  bool first = true;
-  std::cout << "[" << std::endl;
+  std::vector<std::string> files;
+  if(vm.count("batch")){
+    try {
+      files = neurostr::io::list_reconstruction_files(batch);
+    } catch(const std::exception& e){
+      std::cout << "ERROR: " << e.what() << std::endl;
+      return 2;
+    }
+  } else {
+    files.push_back(ifile);
+  }
   
-  // For each neuron
-  for(auto n_it = r->begin(); n_it != r->end(); ++n_it){
-    neurostr::Neuron& n = *n_it;
-    
-    /** Remove **/
-    if(omitapical) n.erase_apical();
-    if(omitaxon) n.erase_axon();
-    if(omitdend) n.erase_dendrites();
-    if(correct) n.correct();
-    
-    // Select branch subset
-    std::vector<ns::const_branch_reference> branches;
-    
-    if(selection == "all"){
-      branches = ns::neuron_branch_selector(n);
-    } else if (selection == "terminal"){
-      branches = ns::selector_foreach(ns::neuron_neurites,ns::neurite_terminal_branches)(n);
-    } else if (selection == "nonterminal"){
-      branches = ns::selector_foreach(ns::neuron_neurites,ns::neurite_non_terminal_branches)(n);
-    } else if (selection == "preterminal"){
-      branches = ns::selector_foreach(ns::neuron_neurites,ns::neurite_pre_terminal_branches)(n);
-    } else if (selection == "root"){
-      branches = ns::compose_selector(ns::branch_order_filter_factory(0),ns::neuron_branch_selector)(n);
-    } else {
-      NSTR_LOG_(error, "Unrecognized selection type. Selecting all branches.")
-      branches = ns::neuron_branch_selector(n);
+  // Table output
+  std::unique_ptr<neurostr::io::TableWriter> writer;
+  if(format != "json"){
+    try {
+      writer.reset(new neurostr::io::TableWriter(std::cout, neurostr::io::TableWriter::format_by_name(format)));
+    } catch(const std::exception& e){
+      std::cout << "ERROR: " << e.what() << std::endl;
+      return 2;
     }
-
- 
+  }
+  
+  // Binary tables are written at once
+  const bool binary = (format == "bin");
+  nm::ColumnTable all(branch_keys, branch_measures.column_names());
   
-    // Select branches
-    for(auto it = branches.begin(); it != branches.end(); ++it){
-      if(!first){
-        std::cout << " , ";
+  // Files are read in order while the branches of the previous ones are 
+  // measured in the pool. Records are written in input order
+  neurostr::ThreadPool pool(nthreads > 0 ? nthreads : 0);
+  bool first = true;
+  if(!writer) std::cout << "[" << std::endl;
+  
+  neurostr::ordered_pipeline(files.size(), 2 * pool.size(),
+    [&](std::size_t i){ return read_branches(files[i], opt, pool); },
+    [&](branch_job& job){ 
+      wait_branches(job);
+      if(binary){
+        all.append(*job.table);
+      } else {
+        write_branches(job, writer.get(), first, std::cout);
       }
-      first = false;
-      
-      print_branch_measures(*it, std::cout);
-    }  
-  }
+    });
   
-  std::cout << "]" << std::endl;
+  if(binary){
+    writer->write(all);
+  } else if(!writer){
+    std::cout << "]" << std::endl;
+  }
   
 }
-
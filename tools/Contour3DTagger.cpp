@@ -32,12 +32,16 @@ int main(int ac, char **av)
   std::string ifile;
   std::string ofile;
   
+  // Worker threads
+  int nthreads = 0;
+  
   po::options_description desc("Allowed options");
   desc.add_options()
     ("help,h", "Produce help message")
     ("input,i", po::value< std::string >(&ifile), "Neuron reconstruction file")
     ("output,o", po::value< std::string>(&ofile), "Output file")
     ("name,n", po::value< std::vector<std::string>>(), "Contour names")
+    ("threads,j", po::value< int >(&nthreads)->default_value(0), "Worker threads (0: one per core). Meshes and neurites are processed concurrently")
     ;
     
   po::variables_map vm;
@@ -65,10 +69,8 @@ int main(int ac, char **av)
   
   // Process contour
    std::vector<std::string> names = vm["name"].as<std::vector<std::string>>();
-   for(auto it = names.begin(); it != names.end(); ++it){
-     // always assume contours are parallel in "z" - 2 is static
-      neurostr::methods::reconstructionContourProcess(*r,*it,2);
-   }
+   // always assume contours are parallel in "z" - 2 is static
+   neurostr::methods::reconstructionContoursProcess(*r, names, 2, false, nthreads > 0 ? nthreads : 0);
   
   
   // Write in JSON (We should get the property set)
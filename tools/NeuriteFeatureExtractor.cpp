@@ -4,6 +4,9 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <vector>
+#include <future>
 #include <algorithm>
 #include <boost/program_options/cmdline.hpp>
 #include <boost/program_options/parsers.hpp>
@@ -17,6 +20,8 @@
 
 #include <neurostr/core/log.h>
 #include <neurostr/core/neuron.h>
+#include <neurostr/core/thread_pool.h>
+#include <neurostr/core/pipeline.h>
 
 #include <neurostr/measure/universal_measure.h>
 #include <neurostr/measure/branch_measure.h>
@@ -218,7 +223,7 @@ void print_vector_measures(std::map<std::string, std::vector<float>>& m ,
     
     // Remove nans (FIX! nans shouldnt appear here)
     for(auto val = v.begin(); val != v.end(); ++val){
-      if( std::isnan(*val) ){
+      if( std::isnan(*val) ){
         val = v.erase(val)-1;
         NSTR_LOG_(info, std::string("Nan value removed in measure ") + it->first );
       }
@@ -268,6 +273,95 @@ void print_neurite_measures(const neurostr::Neurite& n, const std::vector<std::s
   os << "}";
 }
 
+/**
+ * @brief Neurite feature extractor options
+ */
+struct extraction_options {
+  bool omitapical = false;
+  bool omitaxon = false;
+  bool omitdend = false;
+  bool correct = false;
+  std::vector<std::string> markers;
+};
+
+/**
+ * @brief A read reconstruction and its pending neurite records
+ */
+struct neurite_job {
+  std::unique_ptr<neurostr::Reconstruction> rec;
+  std::vector<std::future<std::string>> records;
+};
+
+/**
+ * @brief Reader stage. Reads the file, prepares each neuron and submits one
+ * measure task per neurite to the pool
+ * @param path File path
+ * @param o Options
+ * @param pool Measure stage pool
+ * @return Job
+ */
+neurite_job read_neurites(const std::string& path, const extraction_options& o, 
+                          neurostr::ThreadPool& pool){
+  neurite_job job;
+  try {
+    job.rec = neurostr::io::read_file_by_ext(path, true);
+  } catch(const std::exception& e){
+    NSTR_LOG_(error, path + ": " + e.what());
+    return job;
+  }
+  
+  // For each neuron
+  for(auto n_it = job.rec->begin(); n_it != job.rec->end(); ++n_it){
+    neurostr::Neuron& n = *n_it;
+    
+    /** Remove **/
+    if(o.omitapical) n.erase_apical();
+    if(o.omitaxon) n.erase_axon();
+    if(o.omitdend) n.erase_dendrites();
+    if(o.correct) n.correct();
+    
+    // Node values are cached on first use. Fill them before neurites are 
+    // measured concurrently
+    nm::fill_node_caches(n);
+    
+    // For each neurite
+    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
+      const neurostr::Neurite* neurite = &(*it);
+      const std::vector<std::string>* markers = &o.markers;
+      job.records.push_back(pool.submit([neurite, markers](){
+        std::ostringstream os;
+        print_neurite_measures(*neurite, *markers, os);
+        return os.str();
+      }));
+    }
+  }
+  return job;
+}
+
+/**
+ * @brief Writer stage. Waits for the job records and writes them in order
+ * @param job Job
+ * @param first First record flag
+ * @param os Output stream
+ */
+void write_neurites(neurite_job& job, bool& first, std::ostream& os){
+  for(auto it = job.records.begin(); it != job.records.end(); ++it){
+    std::string record;
+    try {
+      record = it->get();
+    } catch(const std::exception& e){
+      NSTR_LOG_(error, e.what());
+      continue;
+    }
+    
+    if(!first){
+      os << " , ";
+    }
+    first = false;
+    os << record;
+  }
+}
+
 /**
  * @brief 
  * @param ac
@@ -282,11 +376,13 @@ int main(int ac, char **av)
   
   std::string ifile;
   
-  // omits
-  bool omitapical = false;
-  bool omitaxon = false;
-  bool omitdend = false;
-  bool correct = false;
+  extraction_options opt;
+  
+  // Batch mode
+  std::string batch;
+  
+  // Worker threads
+  int nthreads = 0;
   
   po::options_description desc("Allowed options");
   desc.add_options()
@@ -296,7 +392,9 @@ int main(int ac, char **av)
     ("marker,m", po::value< std::vector<std::string>>(), "Marker names")
     ("omitapical", "Ignore the apical dendrite")
     ("omitaxon", "Ignore the axon")
-    ("omitdend", "Ignore the non-apical dendrites");
+    ("omitdend", "Ignore the non-apical dendrites")
+    ("batch", po::value< std::string >(&batch), "Batch mode. Directory or file list (one path per line) to process")
+    ("threads,j", po::value< int >(&nthreads)->default_value(0), "Measure worker threads (0: one per core)");
   
   
   
@@ -310,7 +408,7 @@ int main(int ac, char **av)
     return 1;
   }
   
-  if(!vm.count("input") || !vm.count("input")){
+  if(!vm.count("input") && !vm.count("batch")){
     std::cout << "ERROR: input file required" << std::endl << std::endl;
     std::cout << desc << "\n";
     std::cout << "Example: neurostr_neuritefeature -i test.swc " << std::endl << std::endl ;
@@ -318,48 +416,40 @@ int main(int ac, char **av)
   }
   
   
-  omitapical = (vm.count("omitapical") > 0);
-  omitaxon = (vm.count("omitaxon") > 0);
-  omitdend = (vm.count("omitdend") > 0);
-  correct = (vm.count("correct") > 0);
+  opt.omitapical = (vm.count("omitapical") > 0);
+  opt.omitaxon = (vm.count("omitaxon") > 0);
+  opt.omitdend = (vm.count("omitdend") > 0);
+  opt.correct = (vm.count("correct") > 0);
   
   // Process contour
-   std::vector<std::string> markers;
-   
-   if(vm.count("marker") > 0){
-     markers=vm["marker"].as<std::vector<std::string>>();
-   }
+  if(vm.count("marker") > 0){
+    opt.markers = vm["marker"].as<std::vector<std::string>>();
+  }
   
   /*** END PARAMETER PARSING */
   
-  // Read
-  auto r = neurostr::io::read_file_by_ext(ifile);
+  std::vector<std::string> files;
+  if(vm.count("batch")){
+    try {
+      files = neurostr::io::list_reconstruction_files(batch);
+    } catch(const std::exception& e){
+      std::cout << "ERROR: " << e.what() << std::endl;
+      return 2;
+    }
+  } else {
+    files.push_back(ifile);
+  }
   
-  // Measure each neurite and output report
+  // Files are read in order while the neurites of the previous ones are 
+  // measured in the pool. Records are written in input order
+  neurostr::ThreadPool pool(nthreads > 0 ? nthreads : 0);
   bool first = true;
   std::cout << "[" << std::endl;
   
-  // For each neuron
-  for(auto n_it = r->begin(); n_it != r->end(); ++n_it){
-    neurostr::Neuron& n = *n_it;
-    
-    /** Remove **/
-    if(omitapical) n.erase_apical();
-    if(omitaxon) n.erase_axon();
-    if(omitdend) n.erase_dendrites();
-    if(correct) n.correct();
-  
-    // For each neurite
-    for(auto it = n.begin_neurite(); it != n.end_neurite(); ++it){
-      if(!first){
-        std::cout << " , ";
-      }
-      first = false;
-      print_neurite_measures(*it, markers, std::cout);
-    }  
-  }
+  neurostr::ordered_pipeline(files.size(), 2 * pool.size(),
+    [&](std::size_t i){ return read_neurites(files[i], opt, pool); },
+    [&](neurite_job& job){ write_neurites(job, first, std::cout); });
   
   std::cout << "]" << std::endl;
   
 }
-
@@ -2,6 +2,7 @@
 #include <iostream>
 #include <algorithm>
 #include <exception>
+#include <vector>
 
 #include <boost/program_options/cmdline.hpp>
 #include <boost/program_options/parsers.hpp>
@@ -16,6 +17,7 @@
 #include <neurostr/core/log.h>
 #include <neurostr/io/parser_dispatcher.h>
 #include <neurostr/io/SWCWriter.h>
+#include <neurostr/io/NSTRWriter.h>
 #include <neurostr/io/JSONWriter.h>
 
 namespace po = boost::program_options;
@@ -41,15 +43,23 @@ int main(int ac, char **av)
   // Apply RDP simplification
   float eps = 0.0;
   
+  // Worker threads
+  int nthreads = 0;
+  
+  // Neurolucida cells are declared one after another
+  bool grouped = false;
+  
   // Program options declaration
   po::options_description desc("Allowed options");
   desc.add_options()
     ("help,h", "Produce help message")
     ("input,i", po::value< std::string >(&ifile), "Neuron reconstruction file")
-    ("format,f", po::value< std::string>(&ext), "Output format (swc or json)")
+    ("format,f", po::value< std::string>(&ext), "Output format (swc, json or nstr)")
     ("output,o", po::value< std::string>(&ofile), "Output file")
     ("correct,c", "Try to correct errors in the reconstruction")
     ("eps,e", po::value< float >(&eps) -> default_value(0.0), "Output file")
+    ("threads,j", po::value< int >(&nthreads)->default_value(0), "Simplification worker threads (0: one per core)")
+    ("grouped,g", "ASC/DAT input declares each cell (soma and trees) before the next soma. JSON output is written neuron by neuron")
     ("verbose,v", "Verbose log output")
     ;
   
@@ -84,44 +94,73 @@ int main(int ac, char **av)
   //Get correct flag
   correct = vm.count("correct");
   
+  // Get grouped flag
+  grouped = vm.count("grouped");
+  
   // Verbosity
   if(vm.count("verbose")){
     neurostr::log::set_level(neurostr::log::severity_level::debug);
   }
   
-  // Create ofstream /ifstreams
-  std::ofstream ofs(ofile);
+  // Transform extension to lower
+  std::transform(ext.begin(),ext.end(),ext.begin(),::tolower);
   
-  // Read
-  auto r = neurostr::io::read_file_by_ext(ifile);
+  // Create ofstream /ifstreams
+  std::ofstream ofs(ofile, ext == "nstr" ? std::ios_base::binary : std::ios_base::out);
   
   // Simpify / correct
-  for(auto it = r->begin(); it != r->end(); ++it){
-    if(correct) it->correct();
+  auto process = [&](neurostr::Neuron& n){
+    if(correct) n.correct();
     if(eps != 0.0 ){
-      it->simplify(eps);
+      n.simplify(eps, nthreads > 0 ? nthreads : 0);
     }
+  };
+  
+  if (ext == "json"){
+    // Neurons are processed and written as the reader passes them. ASC/DAT
+    // neurons are only known to be complete at the end of the file, unless
+    // the input is grouped
+    neurostr::io::JSONWriter writer(ofs);
+    std::vector<neurostr::Contour> contours;
+    writer.beginReconstruction();
+    auto r = neurostr::io::read_file_by_ext(ifile, 
+      [&](std::unique_ptr<neurostr::Neuron> n){
+        process(*n);
+        writer.addNeuron(*n);
+      },
+      [&](const neurostr::Contour& c){ contours.push_back(c); },
+      grouped);
+    for(const auto& c : contours){
+      writer.addContour(c);
+    }
+    writer.endReconstruction(r->properties);
+    ofs.close();
+    return 0;
   }
   
-  // Transform extension to lower
-  std::transform(ext.begin(),ext.end(),ext.begin(),::tolower);
+  // Read
+  auto r = neurostr::io::read_file_by_ext(ifile);
   
   // Select a writer depending on the extension
   if(ext == "swc"){
     if(r->size() > 1){
       NSTR_LOG_(warn, "The output SWC file will only contain the first neuron in the reconstruction. The rest are ignored");
-    }
+    }
+    process(*(r->begin()));
     neurostr::io::SWCWriter writer(ofs);
     writer.write(*(r->begin()));  // Writes first neuron
     
-  } else if (ext == "json"){
-    neurostr::io::JSONWriter writer(ofs);
+  } else if (ext == "nstr"){
+    for(auto it = r->begin(); it != r->end(); ++it){
+      process(*it);
+    }
+    neurostr::io::NSTRWriter writer(ofs);
     writer.write(*r);
   } else {
     // Error - Unrecognized
     NSTR_LOG_(error,"Unrecognized output format");
     std::cout << desc << "\n";
-    std::cout << "Accepted formats: swc, json" << std::endl << std::endl ;
+    std::cout << "Accepted formats: swc, json, nstr" << std::endl << std::endl ;
     return 4;
   }
   
@@ -4,6 +4,11 @@
 
 #include <string>
 #include <iostream>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <future>
+#include <mutex>
 #include <algorithm>
 #include <boost/program_options/cmdline.hpp>
 #include <boost/program_options/parsers.hpp>
@@ -17,8 +22,10 @@
 
 #include <neurostr/core/log.h>
 #include <neurostr/core/neuron.h>
+#include <neurostr/core/thread_pool.h>
 #include <neurostr/io/parser_dispatcher.h>
 #include <neurostr/validator/predefined_validators.h>
+#include <neurostr/validator/validation_suite.h>
 
 namespace po = boost::program_options;
 namespace nv = neurostr::validator;
@@ -31,38 +38,10 @@ void set_validation_flag( const po::variables_map& map, const std::string& basen
   }
 }
 
-template <typename V>
-void output_validation(const neurostr::Neuron& n, 
-                       const V& validation, 
-                       std::ostream& os, 
-                       const bool exhaustive,
-                       bool& first){
-    
-    V test = validation;
-    test.validate(n);
-    
-    if(!first)
-      std::cout << "," << std::endl;
-    
-    test.toJSON(os,!exhaustive);
-    
-    first = false;
-};
-
 /**
- * @brief 
- * @param ac
- * @param av
- * @return 
+ * @brief Validator tool options
  */
-int main(int ac, char **av)
-{
-  
-  neurostr::log::init_log_cerr();
-  //neurostr::log::log_level(neurostr::log::warning); // emit warning error or critical
-  
-  std::string ifile;
-
+struct validation_options {
   // Parameters
   float planar_rec_threshold = 1.01;
   float linear_branch_threshold = 1.01;
@@ -102,6 +81,233 @@ int main(int ac, char **av)
   bool omitaxon = false;
   bool omitdend = false;
   bool omitsoma = false;
+};
+
+/**
+ * @brief Runs the enabled validations over the neuron and writes the report
+ * (a JSON array) in the output stream
+ * @param n Neuron. Omitted neurites are erased
+ * @param o Validation options
+ * @param os Output stream
+ * @param nthreads Validators run concurrently (0: one per core)
+ */
+void validate_neuron(neurostr::Neuron& n, const validation_options& o, std::ostream& os, 
+                     std::size_t nthreads = 1){
+  
+  /** Remove **/
+  if(o.omitapical) n.erase_apical();
+  if(o.omitaxon) n.erase_axon();
+  if(o.omitdend) n.erase_dendrites();
+  
+  nv::ValidationSuite suite(nthreads);
+  
+  // Execute attached
+  if(o.attached && !o.omitsoma){
+    suite.add(nv::neurites_attached_to_soma);
+  }
+
+  // Execute has soma
+  if(o.soma && !o.omitsoma){
+    suite.add(nv::neuron_has_soma);
+  }
+  
+  // Execute planar rec - disabled for 2D
+  if(o.planar && !o.bidim){
+    suite.add(nv::planar_reconstruction_validator_factory(o.planar_rec_threshold));
+  }
+  
+  if(o.dendcount && !o.omitdend){
+    suite.add(nv::dendrite_count_validator_factory(o.dcount_min,o.dcount_max));
+  }
+  
+  if(o.apcount && !o.omitapical){
+    suite.add(nv::apical_count_validator_factory(!o.nostrict));
+  }
+  
+  if(o.axoncount && !o.omitaxon){
+    suite.add(nv::axon_count_validator_factory(!o.nostrict));
+  }
+  
+  if(o.trif){
+    suite.add(nv::no_trifurcations_validator);
+  }
+  
+  if(o.linear){
+    suite.add(nv::linear_branches_validator_factory(o.linear_branch_threshold));
+  }
+  
+  if(o.zerolen){
+    suite.add(nv::zero_length_segments_validator);
+  }
+  
+  // Intersecting nodes - disabled when nodiams flag is present
+  if(o.intersec && !o.nodiams){
+    suite.add(nv::radius_length_segments_validator);
+  }
+
+  // Non decreasing radius - disabled when nodiams flag is present
+  if(o.nodecr  && !o.nodiams ){
+    suite.add(nv::increasing_radius_validator);
+  }
+  
+  if(o.branchcoll){
+    suite.add(nv::branch_collision_validator_factory(n, o.nodiams));
+  }
+
+  if(o.segcoll){
+    suite.add(nv::segment_collision_validator_factory(n));
+  }
+
+
+  if(o.angles){
+    suite.add(nv::extreme_angles_validator);
+  }
+  
+  // Run validations and output report
+  suite.validate(n);
+  suite.toJSON(os, !o.exhaustive);
+}
+
+/**
+ * @brief Escapes a string as a JSON string literal
+ * @param s String
+ * @return Quoted string
+ */
+std::string json_string(const std::string& s){
+  std::string ret("\"");
+  for(auto it = s.begin(); it != s.end(); ++it){
+    switch(*it){
+      case '"':  ret += "\\\""; break;
+      case '\\': ret += "\\\\"; break;
+      case '\n': ret += "\\n"; break;
+      case '\r': ret += "\\r"; break;
+      case '\t': ret += "\\t"; break;
+      default:
+        if(static_cast<unsigned char>(*it) < 0x20)
+          ret += (boost::format("\\u%04x") % static_cast<int>(*it)).str();
+        else
+          ret += *it;
+    }
+  }
+  return ret + "\"";
+}
+
+/**
+ * @brief Reads and validates every neuron in one file. Errors are reported
+ * in an error record
+ * @param path File path
+ * @param o Validation options
+ * @return One JSON object per neuron with the file path, the neuron id and its
+ * report (plus one with the error, if any)
+ */
+std::vector<std::string> batch_records(const std::string& path, const validation_options& o){
+  std::vector<std::string> ret;
+  
+  try {
+    auto r = neurostr::io::read_file_by_ext(path, true);
+    if(r->size() == 0)
+      throw std::runtime_error("Empty reconstruction");
+    
+    for(auto it = r->begin(); it != r->end(); ++it){
+      std::ostringstream report;
+      // Files are already processed in parallel
+      validate_neuron(*it, o, report, 1);
+      
+      std::ostringstream os;
+      os << "{ \"file\" : " << json_string(path) << "," << std::endl;
+      os << "\"neuron\" : " << json_string(it->id()) << "," << std::endl;
+      os << "\"validation\" : " << report.str() << "}";
+      ret.push_back(os.str());
+    }
+  } catch(const std::exception& e){
+    std::ostringstream os;
+    os << "{ \"file\" : " << json_string(path) << "," << std::endl;
+    os << "\"error\" : " << json_string(e.what()) << " }" << std::endl;
+    ret.push_back(os.str());
+  }
+  return ret;
+}
+
+/**
+ * @brief Validates every file in the batch in a thread pool. The reports are
+ * written to the standard output as soon as they are completed (or in
+ * input order) as elements of a JSON array
+ * @param path Directory or file list
+ * @param o Validation options
+ * @param nthreads Number of worker threads (0: one per core)
+ * @param ordered Keep input order
+ * @return Exit code
+ */
+int run_batch(const std::string& path, const validation_options& o, int nthreads, bool ordered){
+  
+  std::vector<std::string> files;
+  try {
+    files = neurostr::io::list_reconstruction_files(path);
+  } catch(const std::exception& e){
+    std::cout << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+  
+  std::mutex out_mutex;
+  bool first = true;
+  
+  // Writes the file records as array elements
+  auto write = [&](const std::vector<std::string>& records){
+    std::lock_guard<std::mutex> lock(out_mutex);
+    for(auto it = records.begin(); it != records.end(); ++it){
+      if(!first) std::cout << "," << std::endl;
+      std::cout << *it;
+      first = false;
+    }
+    std::cout.flush();
+  };
+  
+  std::cout << "[" << std::endl;
+  {
+    neurostr::ThreadPool pool(nthreads > 0 ? nthreads : 0);
+    std::vector<std::future<std::vector<std::string>>> pending;
+    pending.reserve(files.size());
+    
+    for(auto it = files.begin(); it != files.end(); ++it){
+      const std::string& f = *it;
+      if(ordered){
+        pending.push_back(pool.submit([&f, &o](){ return batch_records(f, o); }));
+      } else {
+        pool.submit([&f, &o, &write](){ write(batch_records(f, o)); });
+      }
+    }
+    
+    // In order output - wait for each one
+    for(auto it = pending.begin(); it != pending.end(); ++it)
+      write(it->get());
+    
+  } // Pool waits for the pending tasks
+  std::cout << "]" << std::endl;
+  
+  return 0;
+}
+
+/**
+ * @brief 
+ * @param ac
+ * @param av
+ * @return 
+ */
+int main(int ac, char **av)
+{
+  
+  neurostr::log::init_log_cerr();
+  //neurostr::log::log_level(neurostr::log::warning); // emit warning error or critical
+  
+  std::string ifile;
+
+  validation_options opt;
+  
+  // Batch mode
+  std::string batch;
+  
+  // Worker threads
+  int nthreads = 0;
   
   po::options_description desc("Allowed options");
   desc.add_options()
@@ -144,10 +350,13 @@ int main(int ac, char **av)
     ("omitaxon", "Ignore the axon")
     ("omitdend", "Ignore the non-apical dendrites")
     ("omitsoma", "Disable soma tests")
-    ("planarth", po::value< float >(&planar_rec_threshold)->default_value(1.01), "Planar reconstruction threshold")
-    ("linearth", po::value< float >(&linear_branch_threshold)->default_value(1.01), "Linear branch threshold")
-    ("mindend", po::value< int >(&dcount_min)->default_value(2), "Number of dendrites minimum (in)")
-    ("maxdend", po::value< int >(&dcount_max)->default_value(13), "Number of dendrites maximum (out)")
+    ("planarth", po::value< float >(&opt.planar_rec_threshold)->default_value(1.01), "Planar reconstruction threshold")
+    ("linearth", po::value< float >(&opt.linear_branch_threshold)->default_value(1.01), "Linear branch threshold")
+    ("mindend", po::value< int >(&opt.dcount_min)->default_value(2), "Number of dendrites minimum (in)")
+    ("maxdend", po::value< int >(&opt.dcount_max)->default_value(13), "Number of dendrites maximum (out)")
+    ("batch", po::value< std::string >(&batch), "Batch mode. Directory or file list (one path per line) to validate")
+    ("threads,j", po::value< int >(&nthreads)->default_value(0), "Worker threads (0: one per core). Validators run concurrently, or files in batch mode")
+    ("ordered", "Batch mode. Output reports in input order instead of completion order")
     ;
   
   
@@ -162,7 +371,7 @@ int main(int ac, char **av)
     return 1;
   }
   
-  if(!vm.count("input") || !vm.count("input")){
+  if(!vm.count("input") && !vm.count("batch")){
     std::cout << "ERROR: input/output file required" << std::endl << std::endl;
     std::cout << desc << "\n";
     std::cout << "Example: neurostr_validator -i test.swc -e" << std::endl << std::endl ;
@@ -170,175 +379,49 @@ int main(int ac, char **av)
   }
   
   /** Set validation test flags*/
-  set_validation_flag(vm,"attached",attached);
-  set_validation_flag(vm,"soma",soma);
-  set_validation_flag(vm,"planar",planar);
-  set_validation_flag(vm,"dendcnt",dendcount);
-  set_validation_flag(vm,"apical",apcount);
-  set_validation_flag(vm,"axon",axoncount);
-  set_validation_flag(vm,"trifurcation",trif);
-  set_validation_flag(vm,"linear",linear);
-  set_validation_flag(vm,"zero",zerolen);
-  set_validation_flag(vm,"intersect",intersec);
-  set_validation_flag(vm,"decrease",nodecr);
-  set_validation_flag(vm,"segcoll",segcoll);
-  set_validation_flag(vm,"branchcoll",branchcoll);
-  set_validation_flag(vm,"extremeang",angles);
+  set_validation_flag(vm,"attached",opt.attached);
+  set_validation_flag(vm,"soma",opt.soma);
+  set_validation_flag(vm,"planar",opt.planar);
+  set_validation_flag(vm,"dendcnt",opt.dendcount);
+  set_validation_flag(vm,"apical",opt.apcount);
+  set_validation_flag(vm,"axon",opt.axoncount);
+  set_validation_flag(vm,"trifurcation",opt.trif);
+  set_validation_flag(vm,"linear",opt.linear);
+  set_validation_flag(vm,"zero",opt.zerolen);
+  set_validation_flag(vm,"intersect",opt.intersec);
+  set_validation_flag(vm,"decrease",opt.nodecr);
+  set_validation_flag(vm,"segcoll",opt.segcoll);
+  set_validation_flag(vm,"branchcoll",opt.branchcoll);
+  set_validation_flag(vm,"extremeang",opt.angles);
   
   // Get other flags
-  exhaustive = (vm.count("exhaustive") > 0);
-  nostrict = (vm.count("nostrict") > 0);
-  nodiams = (vm.count("nodiameters") > 0);
-  bidim = (vm.count("is2D") > 0);
+  opt.exhaustive = (vm.count("exhaustive") > 0);
+  opt.nostrict = (vm.count("nostrict") > 0);
+  opt.nodiams = (vm.count("nodiameters") > 0);
+  opt.bidim = (vm.count("is2D") > 0);
   
   // ATM these are ignored
-  omitapical = (vm.count("omitapical") > 0);
-  omitaxon = (vm.count("omitaxon") > 0);
-  omitdend = (vm.count("omitdend") > 0);
-  omitsoma = (vm.count("omitsoma") > 0);
+  opt.omitapical = (vm.count("omitapical") > 0);
+  opt.omitaxon = (vm.count("omitaxon") > 0);
+  opt.omitdend = (vm.count("omitdend") > 0);
+  opt.omitsoma = (vm.count("omitsoma") > 0);
   
   if((vm.count("neuron") > 0)){
-    omitapical = false;
-    omitaxon = false;
-    omitdend = false;
-    omitsoma = false;
+    opt.omitapical = false;
+    opt.omitaxon = false;
+    opt.omitdend = false;
+    opt.omitsoma = false;
   }
   
-  bool first = true;
-  
-  /*** END PARAMETER PARSING */
+  // Batch mode
+  if(vm.count("batch")){
+    return run_batch(batch, opt, nthreads, vm.count("ordered") > 0);
+  }
   
   // Read
   auto r = neurostr::io::read_file_by_ext(ifile);
   neurostr::Neuron& n = *(r->begin());
   
-  /** Remove **/
-  if(omitapical) n.erase_apical();
-  if(omitaxon) n.erase_axon();
-  if(omitdend) n.erase_dendrites();
-  
-  
-  // Run validations and output report
-  std::cout << "[" << std::endl;
-  
-  // Execute attached
-  if(attached && !omitsoma){
-    output_validation(n, 
-                      nv::neurites_attached_to_soma, 
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-
-  // Execute has soma
-  if(soma && !omitsoma){
-    output_validation(n, 
-                      nv::neuron_has_soma, 
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  // Execute planar rec - disabled for 2D
-  if(planar && !bidim){
-    output_validation(n, 
-                      nv::planar_reconstruction_validator_factory(planar_rec_threshold), 
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(dendcount && !omitdend){
-    output_validation(n, 
-                      nv::dendrite_count_validator_factory(dcount_min,dcount_max),
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(apcount && !omitapical){
-    output_validation(n, 
-                      nv::apical_count_validator_factory(!nostrict),
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(axoncount && !omitaxon){
-    output_validation(n, 
-                      nv::axon_count_validator_factory(!nostrict),
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(trif){
-    output_validation(n, 
-                      nv::no_trifurcations_validator,
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(linear){
-    output_validation(n, 
-                      nv::linear_branches_validator_factory(linear_branch_threshold),
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(zerolen){
-    output_validation(n, 
-                      nv::zero_length_segments_validator,
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  // Intersecting nodes - disabled when nodiams flag is present
-  if(intersec && !nodiams){
-    output_validation(n, 
-                      nv::radius_length_segments_validator,
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-
-  // Non decreasing radius - disabled when nodiams flag is present
-  if(nodecr  && !nodiams ){
-    output_validation(n, 
-                      nv::increasing_radius_validator,
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  if(branchcoll){
-    output_validation(n, 
-                      nv::branch_collision_validator_factory(nodiams),
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-
-  if(segcoll){
-    output_validation(n, 
-                      nv::segment_collision_validator,
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-
-
-  if(angles){
-    output_validation(n, 
-                      nv::extreme_angles_validator,
-                      std::cout, 
-                      exhaustive,
-                      first);
-  }
-  
-  std::cout << "]" << std::endl;
+  validate_neuron(n, opt, std::cout, nthreads > 0 ? nthreads : 0);
   
 }